@@ -633,6 +633,16 @@ static void close_all_output_streams(OutputStream *ost, OSTFinished this_stream,
     }
 }
 
+/**
+ * Check whether the data of pkt ends where the data of src does and lies
+ * within it, so that it can share the buffer and padding of src.
+ */
+static int is_packet_tail(const AVPacket *pkt, const AVPacket *src)
+{
+    return src->buf && pkt->data >= src->data &&
+           pkt->data + pkt->size == src->data + src->size;
+}
+
 static void write_frame(AVFormatContext *s, AVPacket *pkt, OutputStream *ost)
 {
     AVBitStreamFilterContext *bsfc = ost->bitstream_filters;
@@ -698,7 +708,7 @@ FF_DISABLE_DEPRECATION_WARNINGS
 #if FF_API_DESTRUCT_PACKET
            && new_pkt.destruct
 #endif
-           ) {
+           && !is_packet_tail(&new_pkt, pkt)) {
 FF_ENABLE_DEPRECATION_WARNINGS
             uint8_t *t = av_malloc(new_pkt.size + AV_INPUT_BUFFER_PADDING_SIZE); //the new should be a subset of the old so cannot overflow
             if(t) {
@@ -711,6 +721,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 a = AVERROR(ENOMEM);
         }
         if (a > 0) {
+            ost->copied_size += new_pkt.size;
             pkt->side_data = NULL;
             pkt->side_data_elems = 0;
             av_free_packet(pkt);
@@ -771,6 +782,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     ost->data_size += pkt->size;
     ost->packets_written++;
+    /* the muxer makes its own copy of unreferenced packets */
+    if (!pkt->buf)
+        ost->copied_size += pkt->size;
 
     pkt->stream_index = ost->index;
 
@@ -1467,6 +1481,8 @@ static void print_final_stats(int64_t total_size)
                    i, j, media_type_string(type));
             av_log(NULL, AV_LOG_VERBOSE, "%"PRIu64" packets read (%"PRIu64" bytes); ",
                    ist->nb_packets, ist->data_size);
+            av_log(NULL, AV_LOG_VERBOSE, "%"PRIu64" bytes copied outside the demuxer (%.1f per packet); ",
+                   ist->copied_size, ist->nb_packets ? (double)ist->copied_size / ist->nb_packets : 0.0);
 
             if (ist->decoding_needed) {
                 av_log(NULL, AV_LOG_VERBOSE, "%"PRIu64" frames decoded",
@@ -1509,6 +1525,8 @@ static void print_final_stats(int64_t total_size)
 
             av_log(NULL, AV_LOG_VERBOSE, "%"PRIu64" packets muxed (%"PRIu64" bytes); ",
                    ost->packets_written, ost->data_size);
+            av_log(NULL, AV_LOG_VERBOSE, "%"PRIu64" bytes copied outside the muxer (%.1f per packet); ",
+                   ost->copied_size, ost->packets_written ? (double)ost->copied_size / ost->packets_written : 0.0);
 
             av_log(NULL, AV_LOG_VERBOSE, "\n");
         }
@@ -1886,11 +1904,18 @@ static void do_streamcopy(InputStream *ist, OutputStream *ost, const AVPacket *p
             opkt.buf = av_buffer_create(opkt.data, opkt.size, av_buffer_default_free, NULL, 0);
             if (!opkt.buf)
                 exit_program(1);
+            ost->copied_size += opkt.size;
         }
     } else {
         opkt.data = pkt->data;
         opkt.size = pkt->size;
     }
+    /* reference the input packet rather than have the muxer copy it */
+    if (!opkt.buf && is_packet_tail(&opkt, pkt)) {
+        opkt.buf = av_buffer_ref(pkt->buf);
+        if (!opkt.buf)
+            exit_program(1);
+    }
     av_copy_packet_side_data(&opkt, pkt);
 
     if (ost->st->codec->codec_type == AVMEDIA_TYPE_VIDEO &&
@@ -1903,6 +1928,8 @@ static void do_streamcopy(InputStream *ist, OutputStream *ost, const AVPacket *p
                    av_err2str(ret));
             exit_program(1);
         }
+        /* the AVPicture is on the stack, the muxer has to copy it */
+        av_buffer_unref(&opkt.buf);
         opkt.data = (uint8_t *)&pict;
         opkt.size = sizeof(AVPicture);
         opkt.flags |= AV_PKT_FLAG_KEY;
@@ -3505,6 +3532,8 @@ static void *input_thread(void *arg)
             av_thread_message_queue_set_err_recv(f->in_thread_queue, ret);
             break;
         }
+        if (!pkt.buf && pkt.stream_index < f->nb_streams)
+            input_streams[f->ist_index + pkt.stream_index]->copied_size += pkt.size;
         av_dup_packet(&pkt);
         ret = av_thread_message_queue_send(f->in_thread_queue, &pkt, flags);
         if (flags && ret == AVERROR(EAGAIN)) {
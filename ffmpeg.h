@@ -332,6 +332,9 @@ typedef struct InputStream {
     uint64_t data_size;
     /* number of packets successfully read for this stream */
     uint64_t nb_packets;
+    // payload bytes copied because the demuxer returned unreferenced packets,
+    // copies made by the demuxer itself are not counted
+    uint64_t copied_size;
     // number of frames/samples retrieved from the decoder
     uint64_t frames_decoded;
     uint64_t samples_decoded;
@@ -455,6 +458,10 @@ typedef struct OutputStream {
     uint64_t data_size;
     // number of packets send to the muxer
     uint64_t packets_written;
+    // payload bytes copied on the way to the muxer, including its copy of
+    // unreferenced packets but not the copies the muxer makes while writing,
+    // e.g. mpegtsenc batching small audio packets into one PES packet
+    uint64_t copied_size;
     // number of frames/samples sent to the encoder
     uint64_t frames_encoded;
     uint64_t samples_encoded;
@@ -514,6 +521,8 @@ extern int copy_ts;
 extern int start_at_zero;
 extern int copy_tb;
 extern int debug_ts;
+extern int filter_nbthreads;
+extern int filter_pipeline_threads;
 extern int exit_on_error;
 extern int print_stats;
 extern int qp_hist;
@@ -961,6 +961,8 @@ int configure_filtergraph(FilterGraph *fg)
     avfilter_graph_free(&fg->graph);
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
+    fg->graph->nb_threads       = filter_nbthreads;
+    fg->graph->pipeline_threads = filter_pipeline_threads;
 
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
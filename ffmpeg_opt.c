@@ -103,6 +103,8 @@ int copy_ts           = 0;
 int start_at_zero     = 0;
 int copy_tb           = -1;
 int debug_ts          = 0;
+int filter_nbthreads = 0;
+int filter_pipeline_threads = 0;
 int exit_on_error     = 0;
 int print_stats       = -1;
 int qp_hist           = 0;
@@ -3146,6 +3148,10 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
         "read complex filtergraph description from a file", "filename" },
+    { "filter_threads", HAS_ARG | OPT_INT | OPT_EXPERT,              { &filter_nbthreads },
+        "number of slice threads used by the filters of each filtergraph", "n" },
+    { "filter_pipeline_threads", HAS_ARG | OPT_INT | OPT_EXPERT,     { &filter_pipeline_threads },
+        "number of threads running the filters of each filtergraph as a pipeline", "n" },
     { "stats",          OPT_BOOL,                                    { &print_stats },
         "print progress report during encoding", },
     { "attach",         HAS_ARG | OPT_PERFILE | OPT_EXPERT |
@@ -482,6 +482,108 @@ static void copy_input_samples(AACEncContext *s, const AVFrame *frame)
     }
 }
 
+void ff_quantize_band_cost_cache_init(struct AACEncContext *s)
+{
+    ++s->quantize_band_cost_cache_generation;
+    if (s->quantize_band_cost_cache_generation == 0) {
+        memset(s->quantize_band_cost_cache, 0, sizeof(s->quantize_band_cost_cache));
+        s->quantize_band_cost_cache_generation = 1;
+    }
+}
+
+/* coding tools used by a channel element, see encode_channel_element() */
+#define ELEMENT_IS   1
+#define ELEMENT_TNS  2
+#define ELEMENT_PRED 4
+
+/**
+ * Run the quantizer search and the stereo, PNS, TNS and prediction tools on
+ * one channel element. Elements do not depend on each other once the psy
+ * model has analyzed them, so they are run as slice thread jobs, each one on
+ * the scratch context of the thread it runs on.
+ *
+ * @return a mask of the ELEMENT_* tools the element ended up using
+ */
+static int encode_channel_element(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    AACEncContext *t = s->thread_ctx[threadnr];
+    ChannelElement *cpe = &s->cpe[jobnr];
+    const int chans = s->chan_map[jobnr + 1] == TYPE_CPE ? 2 : 1;
+    FFPsyWindowInfo *wi = arg;
+    SingleChannelElement *sce;
+    int i, ch, w, start_ch = 0, modes = 0;
+
+    for (i = 0; i < jobnr; i++)
+        start_ch += s->chan_map[i + 1] == TYPE_CPE ? 2 : 1;
+    wi += start_ch;
+
+    for (ch = 0; ch < chans; ch++) {
+        t->cur_channel = start_ch + ch;
+        t->coder->search_for_quantizers(avctx, t, &cpe->ch[ch], t->lambda);
+    }
+    if (chans > 1
+        && wi[0].window_type[0] == wi[1].window_type[0]
+        && wi[0].window_shape   == wi[1].window_shape) {
+
+        cpe->common_window = 1;
+        for (w = 0; w < wi[0].num_windows; w++) {
+            if (wi[0].grouping[w] != wi[1].grouping[w]) {
+                cpe->common_window = 0;
+                break;
+            }
+        }
+    }
+    for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
+        sce = &cpe->ch[ch];
+        t->cur_channel = start_ch + ch;
+        if (t->options.pns && t->coder->search_for_pns)
+            t->coder->search_for_pns(t, avctx, sce);
+        if (t->options.tns && t->coder->search_for_tns)
+            t->coder->search_for_tns(t, sce);
+        if (t->options.tns && t->coder->apply_tns_filt)
+            t->coder->apply_tns_filt(t, sce);
+        if (sce->tns.present)
+            modes |= ELEMENT_TNS;
+    }
+    t->cur_channel = start_ch;
+    if (t->options.intensity_stereo) { /* Intensity Stereo */
+        if (t->coder->search_for_is)
+            t->coder->search_for_is(t, avctx, cpe);
+        if (cpe->is_mode) modes |= ELEMENT_IS;
+        apply_intensity_stereo(cpe);
+    }
+    if (t->options.pred) { /* Prediction */
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            t->cur_channel = start_ch + ch;
+            if (t->options.pred && t->coder->search_for_pred)
+                t->coder->search_for_pred(t, sce);
+            if (cpe->ch[ch].ics.predictor_present) modes |= ELEMENT_PRED;
+        }
+        if (t->coder->adjust_common_prediction)
+            t->coder->adjust_common_prediction(t, cpe);
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            t->cur_channel = start_ch + ch;
+            if (t->options.pred && t->coder->apply_main_pred)
+                t->coder->apply_main_pred(t, sce);
+        }
+        t->cur_channel = start_ch;
+    }
+    if (t->options.stereo_mode) { /* Mid/Side stereo */
+        if (t->options.stereo_mode == -1 && t->coder->search_for_ms)
+            t->coder->search_for_ms(t, cpe);
+        else if (cpe->common_window)
+            memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
+        for (w = 0; w < 128; w++)
+            cpe->ms_mask[w] = cpe->is_mask[w] ? 0 : cpe->ms_mask[w];
+        apply_mid_side_stereo(cpe);
+    }
+    adjust_frame_information(cpe, chans);
+    return modes;
+}
+
 static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                             const AVFrame *frame, int *got_packet_ptr)
 {
@@ -492,6 +594,7 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
     int i, ch, w, chans, tag, start_ch, ret;
     int ms_mode = 0, is_mode = 0, tns_mode = 0, pred_mode = 0;
     int chan_el_counter[4];
+    int el_modes[AAC_MAX_CHANNELS];
     FFPsyWindowInfo windows[AAC_MAX_CHANNELS];
 
     if (s->last_frame == 2)
@@ -588,8 +691,9 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 
         if ((avctx->frame_number & 0xFF)==1 && !(avctx->flags & AV_CODEC_FLAG_BITEXACT))
             put_bitstream_info(s, LIBAVCODEC_IDENT);
+        /* the psy model carries its bit demand state from one channel to the
+         * next, so the analysis has to run in order */
         start_ch = 0;
-        memset(chan_el_counter, 0, sizeof(chan_el_counter));
         for (i = 0; i < s->chan_map[0]; i++) {
             FFPsyWindowInfo* wi = windows + start_ch;
             const float *coeffs[2];
@@ -599,8 +703,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             cpe->common_window = 0;
             memset(cpe->is_mask, 0, sizeof(cpe->is_mask));
             memset(cpe->ms_mask, 0, sizeof(cpe->ms_mask));
-            put_bits(&s->pb, 3, tag);
-            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             for (ch = 0; ch < chans; ch++) {
                 sce = &cpe->ch[ch];
                 coeffs[ch] = sce->coeffs;
@@ -612,69 +714,27 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                         sce->band_type[w] = 0;
             }
             s->psy.model->analyze(&s->psy, start_ch, coeffs, wi);
-            for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
-            }
-            if (chans > 1
-                && wi[0].window_type[0] == wi[1].window_type[0]
-                && wi[0].window_shape   == wi[1].window_shape) {
-
-                cpe->common_window = 1;
-                for (w = 0; w < wi[0].num_windows; w++) {
-                    if (wi[0].grouping[w] != wi[1].grouping[w]) {
-                        cpe->common_window = 0;
-                        break;
-                    }
-                }
-            }
-            for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
-                sce = &cpe->ch[ch];
-                s->cur_channel = start_ch + ch;
-                if (s->options.pns && s->coder->search_for_pns)
-                    s->coder->search_for_pns(s, avctx, sce);
-                if (s->options.tns && s->coder->search_for_tns)
-                    s->coder->search_for_tns(s, sce);
-                if (s->options.tns && s->coder->apply_tns_filt)
-                    s->coder->apply_tns_filt(s, sce);
-                if (sce->tns.present)
-                    tns_mode = 1;
-            }
-            s->cur_channel = start_ch;
-            if (s->options.intensity_stereo) { /* Intensity Stereo */
-                if (s->coder->search_for_is)
-                    s->coder->search_for_is(s, avctx, cpe);
-                if (cpe->is_mode) is_mode = 1;
-                apply_intensity_stereo(cpe);
-            }
-            if (s->options.pred) { /* Prediction */
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->search_for_pred)
-                        s->coder->search_for_pred(s, sce);
-                    if (cpe->ch[ch].ics.predictor_present) pred_mode = 1;
-                }
-                if (s->coder->adjust_common_prediction)
-                    s->coder->adjust_common_prediction(s, cpe);
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->apply_main_pred)
-                        s->coder->apply_main_pred(s, sce);
-                }
-                s->cur_channel = start_ch;
-            }
-            if (s->options.stereo_mode) { /* Mid/Side stereo */
-                if (s->options.stereo_mode == -1 && s->coder->search_for_ms)
-                    s->coder->search_for_ms(s, cpe);
-                else if (cpe->common_window)
-                    memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
-                for (w = 0; w < 128; w++)
-                    cpe->ms_mask[w] = cpe->is_mask[w] ? 0 : cpe->ms_mask[w];
-                apply_mid_side_stereo(cpe);
-            }
-            adjust_frame_information(cpe, chans);
+            start_ch += chans;
+        }
+
+        for (i = 1; i < s->nb_thread_ctx; i++)
+            s->thread_ctx[i]->lambda = s->lambda;
+        avctx->execute2(avctx, encode_channel_element, windows, el_modes, s->chan_map[0]);
+
+        start_ch = 0;
+        memset(chan_el_counter, 0, sizeof(chan_el_counter));
+        for (i = 0; i < s->chan_map[0]; i++) {
+            tag      = s->chan_map[i+1];
+            chans    = tag == TYPE_CPE ? 2 : 1;
+            cpe      = &s->cpe[i];
+            if (el_modes[i] & ELEMENT_IS)
+                is_mode = 1;
+            if (el_modes[i] & ELEMENT_TNS)
+                tns_mode = 1;
+            if (el_modes[i] & ELEMENT_PRED)
+                pred_mode = 1;
+            put_bits(&s->pb, 3, tag);
+            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             if (chans == 2) {
                 put_bits(&s->pb, 1, cpe->common_window);
                 if (cpe->common_window) {
@@ -736,11 +796,18 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 static av_cold int aac_encode_end(AVCodecContext *avctx)
 {
     AACEncContext *s = avctx->priv_data;
+    int i;
 
     ff_mdct_end(&s->mdct1024);
     ff_mdct_end(&s->mdct128);
     ff_psy_end(&s->psy);
     ff_lpc_end(&s->lpc);
+    for (i = 1; i < s->nb_thread_ctx; i++) {
+        if (s->thread_ctx[i])
+            ff_lpc_end(&s->thread_ctx[i]->lpc);
+        av_freep(&s->thread_ctx[i]);
+    }
+    av_freep(&s->thread_ctx);
     if (s->psypp)
         ff_psy_preprocess_end(s->psypp);
     av_freep(&s->buffer.samples);
@@ -787,6 +854,39 @@ alloc_fail:
     return AVERROR(ENOMEM);
 }
 
+/**
+ * Set up the scratch contexts the channel element jobs run on. They are
+ * copies of the fully initialized main context with their own LPC context;
+ * only lambda changes afterwards and is updated before every run.
+ */
+static av_cold int alloc_thread_contexts(AVCodecContext *avctx, AACEncContext *s)
+{
+    int i;
+
+    s->nb_thread_ctx = 1;
+    if (avctx->active_thread_type & FF_THREAD_SLICE)
+        s->nb_thread_ctx = av_clip(avctx->thread_count, 1, s->chan_map[0]);
+
+    s->thread_ctx = av_mallocz_array(s->nb_thread_ctx, sizeof(*s->thread_ctx));
+    if (!s->thread_ctx) {
+        s->nb_thread_ctx = 0;
+        return AVERROR(ENOMEM);
+    }
+    s->thread_ctx[0] = s;
+
+    for (i = 1; i < s->nb_thread_ctx; i++) {
+        AACEncContext *t = av_malloc(sizeof(*t));
+        if (!t)
+            return AVERROR(ENOMEM);
+        memcpy(t, s, sizeof(*t));
+        t->thread_ctx    = NULL;
+        t->nb_thread_ctx = 0;
+        ff_lpc_init(&t->lpc, 2*avctx->frame_size, TNS_MAX_ORDER, FF_LPC_TYPE_LEVINSON);
+        s->thread_ctx[i] = t;
+    }
+    return 0;
+}
+
 static av_cold int aac_encode_init(AVCodecContext *avctx)
 {
     AACEncContext *s = avctx->priv_data;
@@ -864,6 +964,9 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
 
     ff_aac_tableinit();
 
+    if ((ret = alloc_thread_contexts(avctx, s)) < 0)
+        goto fail;
+
     avctx->initial_padding = 1024;
     ff_af_queue_init(avctx, &s->afq);
 
@@ -917,7 +1020,7 @@ AVCodec ff_aac_encoder = {
     .close          = aac_encode_end,
     .supported_samplerates = mpeg4audio_sample_rates,
     .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_EXPERIMENTAL,
+                      AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_EXPERIMENTAL,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_FLTP,
                                                      AV_SAMPLE_FMT_NONE },
     .priv_class     = &aacenc_class,
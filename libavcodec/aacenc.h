@@ -74,6 +74,13 @@ typedef struct AACCoefficientsEncoder {
 
 extern AACCoefficientsEncoder ff_aac_coders[];
 
+typedef struct AACQuantizeBandCostCacheEntry {
+    float rd;
+    int bits;
+    uint16_t generation;
+    uint8_t cb;
+} AACQuantizeBandCostCacheEntry;
+
 /**
  * AAC encoder context
  */
@@ -106,8 +113,15 @@ typedef struct AACEncContext {
     struct {
         float *samples;
     } buffer;
+
+    int nb_thread_ctx;                           ///< number of channel element thread contexts
+    struct AACEncContext **thread_ctx;           ///< scratch copies for the element threads, [0] is the context itself
+
+    uint16_t quantize_band_cost_cache_generation;
+    AACQuantizeBandCostCacheEntry quantize_band_cost_cache[256][128]; ///< quantize_band_cost() results by [scalefactor][window*16+band]
 } AACEncContext;
 
 void ff_aac_coder_init_mips(AACEncContext *c);
+void ff_quantize_band_cost_cache_init(struct AACEncContext *s);
 
 #endif /* AVCODEC_AACENC_H */
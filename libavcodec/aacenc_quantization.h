@@ -28,6 +28,8 @@
 #ifndef AVCODEC_AACENC_QUANTIZATION_H
 #define AVCODEC_AACENC_QUANTIZATION_H
 
+#include "libavutil/avassert.h"
+
 #include "aactab.h"
 #include "aacenc.h"
 #include "aacenctab.h"
@@ -249,6 +251,32 @@ static inline float quantize_band_cost(struct AACEncContext *s, const float *in,
                                          cb, lambda, uplim, bits, rtz);
 }
 
+/**
+ * quantize_band_cost() for band g of window w, taken from the band cost cache
+ * if that scalefactor was already tried since the last
+ * ff_quantize_band_cost_cache_init(). lambda, uplim and rtz are not part of
+ * the key, so they must not change between calls in one cache generation.
+ */
+static inline float quantize_band_cost_cached(struct AACEncContext *s, int w, int g,
+                                             const float *in, const float *scaled,
+                                             int size, int scale_idx, int cb,
+                                             const float lambda, const float uplim,
+                                             int *bits, int rtz)
+{
+    AACQuantizeBandCostCacheEntry *entry;
+    av_assert1(scale_idx >= 0 && scale_idx < 256);
+    entry = &s->quantize_band_cost_cache[scale_idx][w*16+g];
+    if (entry->generation != s->quantize_band_cost_cache_generation || entry->cb != cb) {
+        entry->rd = quantize_band_cost(s, in, scaled, size, scale_idx, cb,
+                                       lambda, uplim, &entry->bits, rtz);
+        entry->cb = cb;
+        entry->generation = s->quantize_band_cost_cache_generation;
+    }
+    if (bits)
+        *bits = entry->bits;
+    return entry->rd;
+}
+
 static inline void quantize_and_encode_band(struct AACEncContext *s, PutBitContext *pb,
                                             const float *in, float *out, int size, int scale_idx,
                                             int cb, const float lambda, int rtz)
@@ -640,6 +640,7 @@ void avcodec_register_all(void)
     REGISTER_BSF(AAC_ADTSTOASC,         aac_adtstoasc);
     REGISTER_BSF(CHOMP,                 chomp);
     REGISTER_BSF(DUMP_EXTRADATA,        dump_extradata);
+    REGISTER_BSF(H264_DRMEMB,           h264_drmemb);
     REGISTER_BSF(H264_MP4TOANNEXB,      h264_mp4toannexb);
     REGISTER_BSF(HEVC_MP4TOANNEXB,      hevc_mp4toannexb);
     REGISTER_BSF(IMX_DUMP_HEADER,       imx_dump_header);
@@ -837,6 +837,13 @@ typedef struct RcOverride{
  * Do not skip samples and export skip information as frame side data
  */
 #define AV_CODEC_FLAG2_SKIP_MANUAL    (1 << 29)
+/**
+ * Frame threading without the fixed pipeline delay: each frame is returned
+ * as soon as its thread has finished it, and the caller only waits once all
+ * threads hold a frame not returned yet. This also permits frame threading
+ * together with AV_CODEC_FLAG_LOW_DELAY.
+ */
+#define AV_CODEC_FLAG2_LOW_DELAY_THREADS (1 << 30)
 
 /* Unsupported options :
  *              Syntax Arithmetic coding (SAC)
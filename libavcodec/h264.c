@@ -1652,12 +1652,19 @@ again:
                     av_log(h->avctx, AV_LOG_ERROR, "decode_slice_header error\n");
                 sl->ref_count[0] = sl->ref_count[1] = sl->list_count = 0;
             } else if (err == SLICE_SINGLETHREAD) {
-                if (context_count > 1) {
-                    ret = ff_h264_execute_decode_slices(h, context_count - 1);
+                if (context_count) {
+                    ret = ff_h264_execute_decode_slices(h, context_count);
                     if (ret < 0 && (h->avctx->err_recognition & AV_EF_EXPLODE))
                         goto end;
                     context_count = 0;
                 }
+                if (h->deblock_postpass_active) {
+                    ret = ff_h264_deblock_picture(h);
+                    h->deblock_postpass_active = 0;
+                    h->max_contexts            = 1;
+                    if (ret < 0)
+                        goto end;
+                }
                 /* Slice could not be decoded in parallel mode, restart. Note
                  * that rbsp_buffer is not transferred, but since we no longer
                  * run in parallel mode this should not be an issue. */
@@ -1922,6 +1929,9 @@ av_cold void ff_h264_free_context(H264Context *h)
     av_freep(&h->slice_ctx);
     h->nb_slice_ctx = 0;
 
+    av_freep(&h->pipeline_mb);
+    h->pipeline_mb_size = 0;
+
     for (i = 0; i < MAX_SPS_COUNT; i++)
         av_freep(h->sps_buffers + i);
 
@@ -1950,6 +1960,8 @@ static const AVOption h264_options[] = {
     {"is_avc", "is avc", offsetof(H264Context, is_avc), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 1, 0},
     {"nal_length_size", "nal_length_size", offsetof(H264Context, nal_length_size), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 4, 0},
     { "enable_er", "Enable error resilience on damaged frames (unsafe)", OFFSET(enable_er), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 1, VD },
+    { "deblock_postpass", "Deblock frames in a row parallel pass after all slices are decoded", OFFSET(deblock_postpass), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, VD },
+    { "slice_pipeline", "Entropy decode and reconstruct single slice CABAC pictures in separate slice threads", OFFSET(slice_pipeline), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, VD },
     { NULL },
 };
 
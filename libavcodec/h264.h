@@ -511,6 +511,50 @@ typedef struct H264SliceContext {
     unsigned int rbsp_buffer_size;
 } H264SliceContext;
 
+/**
+ * Loop filter parameters of a slice, kept for deblocking the picture
+ * after all of its slices have been decoded.
+ */
+typedef struct H264SliceDeblock {
+    int deblocking_filter;
+    int slice_alpha_c0_offset;
+    int slice_beta_offset;
+    int qp_thresh;
+} H264SliceDeblock;
+
+/**
+ * Macroblock handed from the CABAC entropy decoder to the reconstruction
+ * thread when a slice is decoded as a two stage pipeline.
+ * Only the parts of H264SliceContext read by ff_h264_hl_decode_mb() are kept.
+ */
+typedef struct H264PipelineMB {
+    DECLARE_ALIGNED(16, int16_t, mb)[16 * 48 * 2];
+    DECLARE_ALIGNED(16, int16_t, mb_luma_dc)[3][16 * 2];
+    DECLARE_ALIGNED(16, int16_t, mv_cache)[2][5 * 8][2];
+    DECLARE_ALIGNED(8,  int8_t,  ref_cache)[2][5 * 8];
+    DECLARE_ALIGNED(8,  uint8_t, non_zero_count_cache)[15 * 8];
+    int8_t intra4x4_pred_mode_cache[5 * 8];
+    uint16_t sub_mb_type[4];
+
+    const uint8_t *intra_pcm_ptr;
+    unsigned int topleft_samples_available;
+    unsigned int topright_samples_available;
+
+    int mb_x, mb_y;
+    int mb_xy;
+    int qscale;
+    int chroma_qp[2];
+    int chroma_pred_mode;
+    int intra16x16_pred_mode;
+    int cbp;
+    int top_type;
+
+    int has_coeffs;     ///< mb / mb_luma_dc hold residual data
+    int end_of_row;     ///< last macroblock of a row, filter and finish it
+    int end_of_slice;   ///< no macroblock, the slice ends here
+    int filter_end;     ///< end_of_slice: end_x for the final loop_filter() or -1
+} H264PipelineMB;
+
 /**
  * H264Context
  */
@@ -827,6 +871,25 @@ typedef struct H264Context {
 
     int enable_er;
 
+    /**
+     * Split single slice CABAC pictures into an entropy decoding and
+     * a reconstruction/deblocking thread when slice threading is active.
+     */
+    int slice_pipeline;
+    H264PipelineMB *pipeline_mb;        ///< ring of entropy decoded macroblocks
+    unsigned int pipeline_mb_size;
+    int pipeline_mb_count;              ///< number of entries in pipeline_mb
+    int pipeline_active;
+
+    /**
+     * Deblock frames in a row parallel pass once all of their slices are
+     * decoded, instead of behind each slice.
+     */
+    int deblock_postpass;
+    int deblock_postpass_active;        ///< current picture is deblocked by ff_h264_deblock_picture()
+    H264SliceDeblock deblock_slice[MAX_SLICES]; ///< indexed by slice_num & (MAX_SLICES - 1)
+    int deblock_ref2frm[MAX_SLICES][2][64];
+
     AVBufferPool *qscale_table_pool;
     AVBufferPool *mb_type_pool;
     AVBufferPool *motion_val_pool;
@@ -1223,6 +1286,7 @@ int ff_h264_decode_slice_header(H264Context *h, H264SliceContext *sl);
 #define SLICE_SKIPED 2
 
 int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count);
+int ff_h264_deblock_picture(H264Context *h);
 int ff_h264_update_thread_context(AVCodecContext *dst,
                                   const AVCodecContext *src);
 
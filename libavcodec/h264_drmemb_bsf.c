@@ -0,0 +1,1541 @@
+/*
+ * H.264 compressed domain DRM watermark embedding
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Embed the drmEmb watermark into an H.264 stream without re-encoding it.
+ *
+ * The drmDec filter reads one bit per 8x8 luma block from the block sum,
+ * dither modulated with the step dm_step. Every CAVLC I slice is parsed,
+ * its luma is reconstructed, and the DC level of each intra 8x8 block, or
+ * of the last 4x4 block of each 8x8 quarter of intra 4x4 macroblocks, is
+ * moved so that the reconstructed block sum decodes to the watermark bit.
+ * Intra 16x16 macroblocks are left alone.
+ * Since the reconstruction follows the modified neighbours, the intra
+ * prediction drift is compensated block after block. All other syntax
+ * elements are written back unchanged, non-I slices are passed through.
+ *
+ * Only the in-loop deblocking filter is not modelled, it slightly blurs
+ * the block sums along the edges.
+ *
+ * > ffmpeg -i drmIn.bmp -pix_fmt gray drm.pgm
+ * > ffmpeg -i main.mp4 -c copy -bsf:v h264_drmemb=wm=drm.pgm:step=32 emb.mp4
+ */
+
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/common.h"
+#include "libavutil/file.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "avcodec.h"
+#include "get_bits.h"
+#include "golomb.h"
+#include "h264data.h"
+#include "h264dsp.h"
+#include "h264pred.h"
+#include "mathops.h"
+#include "put_bits.h"
+
+#define COEFF_TOKEN_VLC_BITS           8
+#define CHROMA_DC_COEFF_TOKEN_VLC_BITS 8
+#define TOTAL_ZEROS_VLC_BITS           9
+#define CHROMA_DC_TOTAL_ZEROS_VLC_BITS 3
+#define RUN_VLC_BITS                   3
+#define RUN7_VLC_BITS                  6
+
+#define I_PCM_MB_TYPE  25
+#define MAX_MMCO_COUNT 66
+#define PAD            32
+#define EMBED_SEARCH   4    ///< DC levels tried around the estimated one
+
+typedef struct DrmSPS {
+    int valid;
+    int supported;              ///< the slices of this SPS can be rewritten
+    int log2_max_frame_num;
+    int poc_type;
+    int log2_max_poc_lsb;
+    int delta_pic_order_always_zero;
+    int mb_width, mb_height;
+    int width, height;          ///< cropped picture size
+} DrmSPS;
+
+typedef struct DrmPPS {
+    int valid;
+    int supported;
+    int sps_id;
+    int pic_order_present;
+    int redundant_pic_cnt_present;
+    int deblocking_filter_params_present;
+    int transform_8x8_mode;
+    int init_qp;
+} DrmPPS;
+
+/**
+ * Syntax of one I slice macroblock, residual levels in coding order.
+ */
+typedef struct DrmMB {
+    int mb_type;
+    int transform_8x8;
+    uint8_t prev_pred_flag[16];
+    uint8_t rem_pred_mode[16];
+    int chroma_pred_mode;
+    int cbp;
+    int qp_delta;
+    int16_t luma_dc[16];
+    int16_t luma[16][16];       ///< per 4x4 block, interleaved for 8x8 blocks
+    int16_t chroma_dc[2][4];
+    int16_t chroma_ac[2][4][16];
+    uint8_t pcm[384];
+} DrmMB;
+
+typedef struct H264DrmEmbContext {
+    const AVClass *class;
+    char *wm_filename;
+    int dm_step;
+    int xshift, yshift;
+
+    int initialized;
+    uint8_t *wm;
+    int wm_w, wm_h;
+    int nal_length_size;        ///< 0 for Annex B
+    int warned;
+    int cabac_warned;
+
+    DrmSPS sps[MAX_SPS_COUNT];
+    DrmPPS pps[MAX_PPS_COUNT];
+
+    VLC coeff_token_vlc[4];
+    VLC chroma_dc_coeff_token_vlc;
+    VLC total_zeros_vlc[15];
+    VLC chroma_dc_total_zeros_vlc[3];
+    VLC run_vlc[6];
+    VLC run7_vlc;
+    uint8_t intra_cbp_to_golomb[48];
+
+    H264DSPContext h264dsp;
+    H264PredContext hpc;
+    uint32_t dequant4[52][16];  ///< flat scaling lists, in ffmpeg's transposed order
+    uint32_t dequant8[52][64];
+    uint8_t scan4[16];          ///< 4x4 zigzag in the idct coefficient order
+    uint8_t scan8x8[4][16];     ///< interleaved CAVLC 8x8 zigzag
+
+    /* picture state, sized after the active SPS */
+    int mb_width, mb_height;
+    int width, height;
+    int *slice_table;           ///< slice number owning each macroblock
+    int slice_num;
+    int8_t *pred_mode;          ///< intra 4x4/8x8 mode per 4x4 block, 2 otherwise
+    uint8_t *nnz_in[3];         ///< total_coeff per 4x4 block, as parsed
+    uint8_t *nnz_out[3];        ///< total_coeff per 4x4 block, as written
+    uint8_t *recon_base;
+    uint8_t *recon;             ///< reconstructed luma, without deblocking
+    int recon_stride;
+
+    uint8_t *rbsp;
+    unsigned rbsp_size;
+    uint8_t *nal;
+    unsigned nal_size;
+    uint8_t *out;
+    unsigned out_size;
+
+    DrmMB mb;
+} H264DrmEmbContext;
+
+#define OFFSET(x) offsetof(H264DrmEmbContext, x)
+static const AVOption h264_drmemb_options[] = {
+    { "wm",     "watermark picture (binary PGM)",   OFFSET(wm_filename), AV_OPT_TYPE_STRING, { .str = NULL } },
+    { "step",   "dither modulation step",           OFFSET(dm_step),     AV_OPT_TYPE_INT,    { .i64 = 32 }, 4, 256 },
+    { "xshift", "where to embed on the main picture", OFFSET(xshift),    AV_OPT_TYPE_INT,    { .i64 = 0 },  0, 4096 },
+    { "yshift", "where to embed on the main picture", OFFSET(yshift),    AV_OPT_TYPE_INT,    { .i64 = 0 },  0, 4096 },
+    { NULL }
+};
+
+static const AVClass h264_drmemb_class = {
+    .class_name = "h264_drmemb",
+    .item_name  = av_default_item_name,
+    .option     = h264_drmemb_options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
+/* position of the 4x4 blocks of a macroblock, in decoding order */
+static const uint8_t blk_x[16] = { 0, 1, 0, 1, 2, 3, 2, 3, 0, 1, 0, 1, 2, 3, 2, 3 };
+static const uint8_t blk_y[16] = { 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 3, 3, 2, 2, 3, 3 };
+static const uint8_t blk_idx[4][4] = {
+    { 0, 1, 4, 5 }, { 2, 3, 6, 7 }, { 8, 9, 12, 13 }, { 10, 11, 14, 15 },
+};
+
+/****************************************************************************
+ * watermark and setup
+ ****************************************************************************/
+
+static int pgm_next_int(const uint8_t **p, const uint8_t *end)
+{
+    int v = 0, digits = 0;
+
+    while (*p < end) {
+        if (**p == '#') {
+            while (*p < end && **p != '\n')
+                (*p)++;
+        } else if (av_isspace(**p)) {
+            (*p)++;
+        } else
+            break;
+    }
+    while (*p < end && av_isdigit(**p) && v < 65536) {
+        v = v * 10 + **p - '0';
+        (*p)++;
+        digits++;
+    }
+    return digits ? v : -1;
+}
+
+static int load_watermark(H264DrmEmbContext *s)
+{
+    const uint8_t *p, *end;
+    uint8_t *buf;
+    size_t size;
+    int w, h, maxval, ret;
+
+    if (!s->wm_filename) {
+        av_log(s, AV_LOG_ERROR, "No watermark picture given, use wm=<file.pgm>\n");
+        return AVERROR(EINVAL);
+    }
+    if ((ret = av_file_map(s->wm_filename, &buf, &size, 0, s)) < 0)
+        return ret;
+
+    p   = buf + 2;
+    end = buf + size;
+    if (size < 2 || buf[0] != 'P' || buf[1] != '5' ||
+        (w = pgm_next_int(&p, end)) <= 0 || (h = pgm_next_int(&p, end)) <= 0 ||
+        (maxval = pgm_next_int(&p, end)) <= 0 || maxval > 255 ||
+        end - ++p < (int64_t)w * h) {
+        av_log(s, AV_LOG_ERROR, "%s is not a binary 8-bit PGM file\n", s->wm_filename);
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+    /* drmDec wraps the rows modulo the width as well */
+    if (h < w) {
+        av_log(s, AV_LOG_ERROR, "The watermark must not be wider than high\n");
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+    if (!(s->wm = av_malloc(w * h))) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    memcpy(s->wm, p, w * h);
+    s->wm_w = w;
+    s->wm_h = h;
+    ret = 0;
+end:
+    av_file_unmap(buf, size);
+    return ret;
+}
+
+static av_cold int init_vlcs(H264DrmEmbContext *s)
+{
+    int i, ret;
+
+    if ((ret = init_vlc(&s->chroma_dc_coeff_token_vlc, CHROMA_DC_COEFF_TOKEN_VLC_BITS, 4 * 5,
+                        ff_h264_chroma_dc_coeff_token_len,  1, 1,
+                        ff_h264_chroma_dc_coeff_token_bits, 1, 1, 0)) < 0)
+        return ret;
+    for (i = 0; i < 4; i++)
+        if ((ret = init_vlc(&s->coeff_token_vlc[i], COEFF_TOKEN_VLC_BITS, 4 * 17,
+                            ff_h264_coeff_token_len[i],  1, 1,
+                            ff_h264_coeff_token_bits[i], 1, 1, 0)) < 0)
+            return ret;
+    for (i = 0; i < 3; i++)
+        if ((ret = init_vlc(&s->chroma_dc_total_zeros_vlc[i], CHROMA_DC_TOTAL_ZEROS_VLC_BITS, 4,
+                            ff_h264_chroma_dc_total_zeros_len[i],  1, 1,
+                            ff_h264_chroma_dc_total_zeros_bits[i], 1, 1, 0)) < 0)
+            return ret;
+    for (i = 0; i < 15; i++)
+        if ((ret = init_vlc(&s->total_zeros_vlc[i], TOTAL_ZEROS_VLC_BITS, 16,
+                            ff_h264_total_zeros_len[i],  1, 1,
+                            ff_h264_total_zeros_bits[i], 1, 1, 0)) < 0)
+            return ret;
+    for (i = 0; i < 6; i++)
+        if ((ret = init_vlc(&s->run_vlc[i], RUN_VLC_BITS, 7,
+                            ff_h264_run_len[i],  1, 1,
+                            ff_h264_run_bits[i], 1, 1, 0)) < 0)
+            return ret;
+    return init_vlc(&s->run7_vlc, RUN7_VLC_BITS, 16,
+                    ff_h264_run_len[6],  1, 1,
+                    ff_h264_run_bits[6], 1, 1, 0);
+}
+
+static av_cold int drmemb_init(H264DrmEmbContext *s, AVCodecContext *avctx,
+                               const char *args)
+{
+    int i, q, x, ret;
+
+    s->class = &h264_drmemb_class;
+    av_opt_set_defaults(s);
+    if (args && (ret = av_set_options_string(s, args, "=", ":")) < 0) {
+        av_log(s, AV_LOG_ERROR, "Error parsing options string '%s'\n", args);
+        return ret;
+    }
+    if ((ret = load_watermark(s)) < 0 || (ret = init_vlcs(s)) < 0)
+        return ret;
+
+    for (i = 0; i < 48; i++)
+        s->intra_cbp_to_golomb[golomb_to_intra4x4_cbp[i]] = i;
+
+    /* same layout as the decoder, so that h264dsp can be used as is */
+    for (q = 0; q < 52; q++) {
+        for (x = 0; x < 16; x++)
+            s->dequant4[q][(x >> 2) | ((x << 2) & 0xF)] =
+                (ff_h264_dequant4_coeff_init[q % 6][(x & 1) + ((x >> 2) & 1)] * 16) << (q / 6 + 2);
+        for (x = 0; x < 64; x++)
+            s->dequant8[q][(x >> 3) | ((x & 7) << 3)] =
+                (ff_h264_dequant8_coeff_init[q % 6][ff_h264_dequant8_coeff_init_scan[((x >> 1) & 12) | (x & 3)]] * 16) << (q / 6);
+    }
+    for (i = 0; i < 16; i++) {
+        x = zigzag_scan[i];
+        s->scan4[i] = (x >> 2) | ((x << 2) & 0xF);
+    }
+    for (i = 0; i < 64; i++) {
+        x = ff_zigzag_direct[i];
+        s->scan8x8[i & 3][i >> 2] = (x >> 3) | ((x & 7) << 3);
+    }
+
+    ff_h264dsp_init(&s->h264dsp, 8, 1);
+    ff_h264_pred_init(&s->hpc, AV_CODEC_ID_H264, 8, 1);
+
+    if (avctx->extradata_size >= 7 && avctx->extradata[0] == 1)
+        s->nal_length_size = (avctx->extradata[4] & 3) + 1;
+    return 0;
+}
+
+static int alloc_picture_state(H264DrmEmbContext *s, const DrmSPS *sps)
+{
+    int mb_count = sps->mb_width * sps->mb_height;
+    int i;
+
+    if (s->mb_width == sps->mb_width && s->mb_height == sps->mb_height) {
+        s->width  = sps->width;
+        s->height = sps->height;
+        return 0;
+    }
+
+    av_freep(&s->slice_table);
+    av_freep(&s->pred_mode);
+    av_freep(&s->recon_base);
+    for (i = 0; i < 3; i++) {
+        av_freep(&s->nnz_in[i]);
+        av_freep(&s->nnz_out[i]);
+    }
+    s->mb_width = s->mb_height = 0;
+
+    s->recon_stride = sps->mb_width * 16 + 2 * PAD;
+    s->slice_table  = av_malloc_array(mb_count, sizeof(*s->slice_table));
+    s->pred_mode    = av_malloc(mb_count * 16);
+    s->recon_base   = av_mallocz(s->recon_stride * (sps->mb_height * 16 + 2 * PAD));
+    for (i = 0; i < 3; i++) {
+        s->nnz_in[i]  = av_malloc(mb_count * (i ? 4 : 16));
+        s->nnz_out[i] = av_malloc(mb_count * (i ? 4 : 16));
+        if (!s->nnz_in[i] || !s->nnz_out[i])
+            return AVERROR(ENOMEM);
+    }
+    if (!s->slice_table || !s->pred_mode || !s->recon_base)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < mb_count; i++)
+        s->slice_table[i] = -1;
+    s->slice_num  = 0;
+    s->recon      = s->recon_base + PAD * s->recon_stride + PAD;
+    s->mb_width   = sps->mb_width;
+    s->mb_height  = sps->mb_height;
+    s->width      = sps->width;
+    s->height     = sps->height;
+    return 0;
+}
+
+/****************************************************************************
+ * parameter sets and slice header
+ ****************************************************************************/
+
+static int more_rbsp_data(GetBitContext *gb, int size_in_bits)
+{
+    return get_bits_count(gb) < size_in_bits;
+}
+
+/**
+ * @return the position of the rbsp_stop_one_bit
+ */
+static int rbsp_size_in_bits(const uint8_t *buf, int size)
+{
+    while (size > 0 && !buf[size - 1])
+        size--;
+    if (!size)
+        return 0;
+    return 8 * size - 1 - ff_ctz(buf[size - 1]);
+}
+
+static void skip_scaling_list(GetBitContext *gb, int size)
+{
+    int i, last = 8, next = 8;
+
+    for (i = 0; i < size && next; i++) {
+        next = (last + get_se_golomb(gb)) & 0xff;
+        if (next)
+            last = next;
+    }
+}
+
+static int decode_sps(H264DrmEmbContext *s, GetBitContext *gb)
+{
+    DrmSPS sps = { 0 };
+    int profile_idc, sps_id, i;
+    int chroma_format_idc = 1, bit_depth_luma = 8, bit_depth_chroma = 8;
+    int transform_bypass = 0, scaling_matrix = 0, frame_mbs_only;
+    int crop_left = 0, crop_right = 0, crop_top = 0, crop_bottom = 0;
+
+    profile_idc = get_bits(gb, 8);
+    skip_bits(gb, 16);
+    sps_id = get_ue_golomb_31(gb);
+    if (sps_id >= MAX_SPS_COUNT)
+        return AVERROR_INVALIDDATA;
+
+    if (profile_idc == 100 || profile_idc == 110 || profile_idc == 122 ||
+        profile_idc == 244 || profile_idc ==  44 || profile_idc ==  83 ||
+        profile_idc ==  86 || profile_idc == 118 || profile_idc == 128 ||
+        profile_idc == 138 || profile_idc == 139 || profile_idc == 134 ||
+        profile_idc == 135) {
+        chroma_format_idc = get_ue_golomb_31(gb);
+        if (chroma_format_idc == 3)
+            skip_bits1(gb);
+        bit_depth_luma   = get_ue_golomb(gb) + 8;
+        bit_depth_chroma = get_ue_golomb(gb) + 8;
+        transform_bypass = get_bits1(gb);
+        if ((scaling_matrix = get_bits1(gb)))
+            for (i = 0; i < (chroma_format_idc != 3 ? 8 : 12); i++)
+                if (get_bits1(gb))
+                    skip_scaling_list(gb, i < 6 ? 16 : 64);
+    }
+
+    sps.log2_max_frame_num = get_ue_golomb(gb) + 4;
+    sps.poc_type           = get_ue_golomb_31(gb);
+    if (sps.poc_type == 0) {
+        sps.log2_max_poc_lsb = get_ue_golomb(gb) + 4;
+    } else if (sps.poc_type == 1) {
+        int cycle;
+        sps.delta_pic_order_always_zero = get_bits1(gb);
+        get_se_golomb_long(gb);
+        get_se_golomb_long(gb);
+        cycle = get_ue_golomb(gb);
+        if (cycle > 255)
+            return AVERROR_INVALIDDATA;
+        for (i = 0; i < cycle; i++)
+            get_se_golomb_long(gb);
+    } else if (sps.poc_type != 2)
+        return AVERROR_INVALIDDATA;
+    if (sps.log2_max_frame_num > 16 || sps.log2_max_poc_lsb > 16)
+        return AVERROR_INVALIDDATA;
+
+    get_ue_golomb(gb);          // max_num_ref_frames
+    skip_bits1(gb);             // gaps_in_frame_num_value_allowed_flag
+    sps.mb_width   = get_ue_golomb(gb) + 1;
+    sps.mb_height  = get_ue_golomb(gb) + 1;
+    frame_mbs_only = get_bits1(gb);
+    if (!frame_mbs_only)
+        skip_bits1(gb);
+    skip_bits1(gb);             // direct_8x8_inference_flag
+    if (get_bits1(gb)) {
+        crop_left   = get_ue_golomb(gb);
+        crop_right  = get_ue_golomb(gb);
+        crop_top    = get_ue_golomb(gb);
+        crop_bottom = get_ue_golomb(gb);
+    }
+    if (get_bits_left(gb) < 0 ||
+        (unsigned)sps.mb_width  >= INT_MAX / 16 / 16 ||
+        (unsigned)sps.mb_height >= INT_MAX / 16 / 16 / sps.mb_width)
+        return AVERROR_INVALIDDATA;
+
+    sps.width  = 16 * sps.mb_width  - 2 * FFMIN(crop_right,  8 * sps.mb_width);
+    sps.height = 16 * sps.mb_height - 2 * FFMIN(crop_bottom, 8 * sps.mb_height);
+    sps.supported = chroma_format_idc == 1 && bit_depth_luma == 8 &&
+                    bit_depth_chroma == 8 && !transform_bypass &&
+                    !scaling_matrix && frame_mbs_only &&
+                    !crop_left && !crop_top;
+    sps.valid = 1;
+    s->sps[sps_id] = sps;
+    return 0;
+}
+
+static int decode_pps(H264DrmEmbContext *s, GetBitContext *gb, int size_in_bits)
+{
+    DrmPPS pps = { 0 };
+    int pps_id, cabac, slice_groups, qp;
+
+    pps_id = get_ue_golomb(gb);
+    if (pps_id >= MAX_PPS_COUNT)
+        return AVERROR_INVALIDDATA;
+    pps.sps_id = get_ue_golomb_31(gb);
+    if (pps.sps_id >= MAX_SPS_COUNT)
+        return AVERROR_INVALIDDATA;
+    cabac                 = get_bits1(gb);
+    if (cabac && !s->cabac_warned++)
+        av_log(s, AV_LOG_WARNING, "CABAC PPS %d: slices using it are passed "
+               "through without a watermark\n", pps_id);
+    pps.pic_order_present = get_bits1(gb);
+    slice_groups          = get_ue_golomb(gb) + 1;
+    if (slice_groups > 1) {
+        /* FMO is only allowed in the baseline profile, do not bother */
+        pps.valid = 1;
+        s->pps[pps_id] = pps;
+        return 0;
+    }
+    get_ue_golomb(gb);          // num_ref_idx_l0_default_active_minus1
+    get_ue_golomb(gb);          // num_ref_idx_l1_default_active_minus1
+    skip_bits(gb, 3);           // weighted_pred_flag, weighted_bipred_idc
+    qp = 26 + get_se_golomb(gb);
+    get_se_golomb(gb);          // pic_init_qs_minus26
+    get_se_golomb(gb);          // chroma_qp_index_offset
+    pps.deblocking_filter_params_present = get_bits1(gb);
+    skip_bits1(gb);             // constrained_intra_pred_flag
+    pps.redundant_pic_cnt_present = get_bits1(gb);
+    pps.supported = !cabac && qp >= 0 && qp <= 51;
+    if (more_rbsp_data(gb, size_in_bits)) {
+        pps.transform_8x8_mode = get_bits1(gb);
+        if (get_bits1(gb))
+            pps.supported = 0;  // pic_scaling_matrix_present_flag
+    }
+    pps.init_qp = qp;
+    pps.valid   = 1;
+    s->pps[pps_id] = pps;
+    return 0;
+}
+
+/****************************************************************************
+ * CAVLC residual
+ ****************************************************************************/
+
+static inline int pred_nnz(const uint8_t *nnz, int stride, int x, int y,
+                           int left_avail, int top_avail)
+{
+    if (left_avail && top_avail)
+        return (nnz[y * stride + x - 1] + nnz[(y - 1) * stride + x] + 1) >> 1;
+    if (left_avail)
+        return nnz[y * stride + x - 1];
+    if (top_avail)
+        return nnz[(y - 1) * stride + x];
+    return 0;
+}
+
+/**
+ * Parse a residual_block_cavlc() into coef[0..max_coeff-1].
+ * @param nc predicted number of coefficients, -1 for chroma DC
+ * @return total_coeff, or <0 on error
+ */
+static int decode_block(H264DrmEmbContext *s, GetBitContext *gb,
+                        int16_t *coef, int nc, int max_coeff)
+{
+    int level[16];
+    int coeff_token, total_coeff, trailing_ones, suffix_length;
+    int zeros_left, i, pos;
+
+    if (nc < 0)
+        coeff_token = get_vlc2(gb, s->chroma_dc_coeff_token_vlc.table,
+                               CHROMA_DC_COEFF_TOKEN_VLC_BITS, 1);
+    else
+        coeff_token = get_vlc2(gb, s->coeff_token_vlc[nc < 2 ? 0 : nc < 4 ? 1 : nc < 8 ? 2 : 3].table,
+                               COEFF_TOKEN_VLC_BITS, 2);
+    if (coeff_token < 0)
+        return AVERROR_INVALIDDATA;
+    total_coeff   = coeff_token >> 2;
+    trailing_ones = coeff_token & 3;
+    if (!total_coeff)
+        return 0;
+    if (total_coeff > max_coeff)
+        return AVERROR_INVALIDDATA;
+
+    suffix_length = total_coeff > 10 && trailing_ones < 3;
+    for (i = 0; i < total_coeff; i++) {
+        int prefix = 0, level_code;
+
+        if (i < trailing_ones) {
+            level[i] = 1 - 2 * get_bits1(gb);
+            continue;
+        }
+        while (!get_bits1(gb)) {
+            if (++prefix > 25 || get_bits_left(gb) <= 0)
+                return AVERROR_INVALIDDATA;
+        }
+        level_code = FFMIN(15, prefix) << suffix_length;
+        if (prefix >= 15)
+            level_code += get_bits_long(gb, prefix - 3);
+        else if (prefix == 14 && !suffix_length)
+            level_code += get_bits(gb, 4);
+        else if (suffix_length)
+            level_code += get_bits(gb, suffix_length);
+        if (prefix >= 15 && !suffix_length)
+            level_code += 15;
+        if (prefix >= 16)
+            level_code += (1 << (prefix - 3)) - 4096;
+        if (i == trailing_ones && trailing_ones < 3)
+            level_code += 2;
+
+        level[i] = level_code & 1 ? (-level_code - 1) >> 1 : (level_code + 2) >> 1;
+        if (!suffix_length)
+            suffix_length = 1;
+        if (FFABS(level[i]) > (3 << (suffix_length - 1)) && suffix_length < 6)
+            suffix_length++;
+    }
+
+    if (total_coeff == max_coeff) {
+        zeros_left = 0;
+    } else if (nc < 0) {
+        zeros_left = get_vlc2(gb, s->chroma_dc_total_zeros_vlc[total_coeff - 1].table,
+                              CHROMA_DC_TOTAL_ZEROS_VLC_BITS, 1);
+    } else {
+        zeros_left = get_vlc2(gb, s->total_zeros_vlc[total_coeff - 1].table,
+                              TOTAL_ZEROS_VLC_BITS, 1);
+    }
+    if (zeros_left < 0 || zeros_left + total_coeff > max_coeff)
+        return AVERROR_INVALIDDATA;
+
+    pos = zeros_left + total_coeff - 1;
+    coef[pos] = level[0];
+    for (i = 1; i < total_coeff; i++) {
+        int run = 0;
+        if (zeros_left > 0) {
+            if (zeros_left < 7)
+                run = get_vlc2(gb, s->run_vlc[zeros_left - 1].table, RUN_VLC_BITS, 1);
+            else
+                run = get_vlc2(gb, s->run7_vlc.table, RUN7_VLC_BITS, 2);
+            if (run < 0 || run > zeros_left)
+                return AVERROR_INVALIDDATA;
+            zeros_left -= run;
+        }
+        pos -= 1 + run;
+        coef[pos] = level[i];
+    }
+    return total_coeff;
+}
+
+/**
+ * Write coef[0..max_coeff-1] as a residual_block_cavlc().
+ * @return total_coeff
+ */
+static int encode_block(PutBitContext *pb, const int16_t *coef, int nc, int max_coeff)
+{
+    int level[16], run[16];
+    int total_coeff = 0, trailing_ones = 0, total_zeros, suffix_length;
+    int last = -1, i, token;
+
+    for (i = max_coeff - 1; i >= 0; i--) {
+        if (coef[i]) {
+            if (last < 0)
+                last = i;
+            level[total_coeff] = coef[i];
+            run[total_coeff]   = 0;
+            total_coeff++;
+        } else if (total_coeff) {
+            run[total_coeff - 1]++;
+        }
+    }
+    /* the zeros below the lowest coefficient are not coded */
+    if (total_coeff)
+        run[total_coeff - 1] = 0;
+    for (i = 0; i < FFMIN(3, total_coeff) && FFABS(level[i]) == 1; i++)
+        trailing_ones++;
+
+    token = 4 * total_coeff + trailing_ones;
+    if (nc < 0)
+        put_bits(pb, ff_h264_chroma_dc_coeff_token_len[token], ff_h264_chroma_dc_coeff_token_bits[token]);
+    else {
+        int t = nc < 2 ? 0 : nc < 4 ? 1 : nc < 8 ? 2 : 3;
+        put_bits(pb, ff_h264_coeff_token_len[t][token], ff_h264_coeff_token_bits[t][token]);
+    }
+    if (!total_coeff)
+        return 0;
+
+    suffix_length = total_coeff > 10 && trailing_ones < 3;
+    for (i = 0; i < total_coeff; i++) {
+        int level_code, prefix;
+
+        if (i < trailing_ones) {
+            put_bits(pb, 1, level[i] < 0);
+            continue;
+        }
+        level_code = level[i] > 0 ? 2 * level[i] - 2 : -2 * level[i] - 1;
+        if (i == trailing_ones && trailing_ones < 3)
+            level_code -= 2;
+
+        if (!suffix_length && level_code < 14) {
+            put_bits(pb, level_code + 1, 1);
+        } else if (!suffix_length && level_code < 30) {
+            put_bits(pb, 15, 1);
+            put_bits(pb, 4, level_code - 14);
+        } else if (suffix_length && level_code < (15 << suffix_length)) {
+            put_bits(pb, (level_code >> suffix_length) + 1, 1);
+            put_bits(pb, suffix_length, level_code & ((1 << suffix_length) - 1));
+        } else {
+            int escape = level_code - (15 << suffix_length) - (suffix_length ? 0 : 15);
+            if (escape < 4096) {
+                prefix = 15;
+            } else {
+                for (prefix = 16; escape + 4096 >= 2 << (prefix - 3); prefix++)
+                    ;
+                escape -= (1 << (prefix - 3)) - 4096;
+            }
+            put_bits(pb, prefix + 1, 1);
+            put_bits(pb, prefix - 3, escape);
+        }
+
+        if (!suffix_length)
+            suffix_length = 1;
+        if (FFABS(level[i]) > (3 << (suffix_length - 1)) && suffix_length < 6)
+            suffix_length++;
+    }
+
+    if (total_coeff < max_coeff) {
+        total_zeros = last + 1 - total_coeff;
+        if (nc < 0)
+            put_bits(pb, ff_h264_chroma_dc_total_zeros_len[total_coeff - 1][total_zeros],
+                         ff_h264_chroma_dc_total_zeros_bits[total_coeff - 1][total_zeros]);
+        else
+            put_bits(pb, ff_h264_total_zeros_len[total_coeff - 1][total_zeros],
+                         ff_h264_total_zeros_bits[total_coeff - 1][total_zeros]);
+        for (i = 0; i < total_coeff - 1 && total_zeros > 0; i++) {
+            int t = FFMIN(total_zeros, 7) - 1;
+            put_bits(pb, ff_h264_run_len[t][run[i]], ff_h264_run_bits[t][run[i]]);
+            total_zeros -= run[i];
+        }
+    }
+    return total_coeff;
+}
+
+/****************************************************************************
+ * macroblock layer
+ ****************************************************************************/
+
+static inline int mb_available(const H264DrmEmbContext *s, int mb_x, int mb_y)
+{
+    return mb_x >= 0 && mb_x < s->mb_width && mb_y >= 0 &&
+           s->slice_table[mb_y * s->mb_width + mb_x] == s->slice_num;
+}
+
+/**
+ * Availability of the luma sample (x, y), relative to the current
+ * macroblock, once its first done 4x4 blocks are reconstructed.
+ */
+static int sample_available(const H264DrmEmbContext *s, int mb_x, int mb_y,
+                            int x, int y, int done)
+{
+    if (y < 0)
+        return mb_available(s, mb_x + (x < 0 ? -1 : x >= 16), mb_y - 1);
+    if (x < 0)
+        return mb_available(s, mb_x - 1, mb_y);
+    if (x >= 16)
+        return 0;
+    return blk_idx[y >> 2][x >> 2] < done;
+}
+
+/* PCM samples count as 16 coefficients in the nC prediction */
+static void fill_pcm_nnz(H264DrmEmbContext *s, uint8_t **nnz, int mb_x, int mb_y)
+{
+    const int stride4 = 4 * s->mb_width, stride2 = 2 * s->mb_width;
+    int y;
+
+    for (y = 0; y < 4; y++)
+        memset(nnz[0] + (4 * mb_y + y) * stride4 + 4 * mb_x, 16, 4);
+    for (y = 0; y < 2; y++) {
+        memset(nnz[1] + (2 * mb_y + y) * stride2 + 2 * mb_x, 16, 2);
+        memset(nnz[2] + (2 * mb_y + y) * stride2 + 2 * mb_x, 16, 2);
+    }
+}
+
+static int decode_mb(H264DrmEmbContext *s, GetBitContext *gb, const DrmPPS *pps,
+                     int mb_x, int mb_y, int *qp)
+{
+    DrmMB *mb = &s->mb;
+    const int left = mb_available(s, mb_x - 1, mb_y);
+    const int top  = mb_available(s, mb_x, mb_y - 1);
+    const int stride4 = 4 * s->mb_width, stride2 = 2 * s->mb_width;
+    uint8_t *nnz = s->nnz_in[0] + 4 * (mb_y * stride4 + mb_x);
+    int i, c, nc, ret;
+
+    memset(mb, 0, sizeof(*mb));
+    mb->mb_type = get_ue_golomb(gb);
+    if (mb->mb_type > I_PCM_MB_TYPE)
+        return AVERROR_INVALIDDATA;
+
+    if (mb->mb_type == I_PCM_MB_TYPE) {
+        skip_bits(gb, -get_bits_count(gb) & 7);
+        if (get_bits_left(gb) < 384 * 8)
+            return AVERROR_INVALIDDATA;
+        for (i = 0; i < 384; i++)
+            mb->pcm[i] = get_bits(gb, 8);
+        fill_pcm_nnz(s, s->nnz_in, mb_x, mb_y);
+        return 0;
+    }
+
+    if (!mb->mb_type) {
+        unsigned code;
+        if (pps->transform_8x8_mode)
+            mb->transform_8x8 = get_bits1(gb);
+        for (i = 0; i < (mb->transform_8x8 ? 4 : 16); i++) {
+            mb->prev_pred_flag[i] = get_bits1(gb);
+            if (!mb->prev_pred_flag[i])
+                mb->rem_pred_mode[i] = get_bits(gb, 3);
+        }
+        mb->chroma_pred_mode = get_ue_golomb_31(gb);
+        code = get_ue_golomb(gb);
+        if (code > 47)
+            return AVERROR_INVALIDDATA;
+        mb->cbp = golomb_to_intra4x4_cbp[code];
+    } else {
+        mb->chroma_pred_mode = get_ue_golomb_31(gb);
+        mb->cbp = i_mb_type_info[mb->mb_type].cbp;
+    }
+    if (mb->chroma_pred_mode > 3)
+        return AVERROR_INVALIDDATA;
+
+    if (mb->cbp || mb->mb_type) {
+        mb->qp_delta = get_se_golomb(gb);
+        if (mb->qp_delta < -26 || mb->qp_delta > 25)
+            return AVERROR_INVALIDDATA;
+        *qp = (*qp + mb->qp_delta + 52) % 52;
+    }
+
+    if (mb->mb_type) {
+        nc = pred_nnz(nnz, stride4, 0, 0, left, top);
+        if ((ret = decode_block(s, gb, mb->luma_dc, nc, 16)) < 0)
+            return ret;
+    }
+    for (i = 0; i < 16; i++) {
+        int x = blk_x[i], y = blk_y[i];
+
+        ret = 0;
+        if (mb->mb_type ? mb->cbp & 15 : mb->cbp & (1 << (i >> 2))) {
+            nc  = pred_nnz(nnz, stride4, x, y, x || left, y || top);
+            ret = mb->mb_type ? decode_block(s, gb, mb->luma[i] + 1, nc, 15)
+                              : decode_block(s, gb, mb->luma[i],     nc, 16);
+            if (ret < 0)
+                return ret;
+        }
+        nnz[y * stride4 + x] = ret;
+    }
+
+    if (mb->cbp & 0x30)
+        for (c = 0; c < 2; c++)
+            if ((ret = decode_block(s, gb, mb->chroma_dc[c], -1, 4)) < 0)
+                return ret;
+    for (c = 0; c < 2; c++) {
+        uint8_t *cnnz = s->nnz_in[1 + c] + 2 * (mb_y * stride2 + mb_x);
+        for (i = 0; i < 4; i++) {
+            int x = i & 1, y = i >> 1;
+
+            ret = 0;
+            if (mb->cbp & 0x20) {
+                nc  = pred_nnz(cnnz, stride2, x, y, x || left, y || top);
+                ret = decode_block(s, gb, mb->chroma_ac[c][i] + 1, nc, 15);
+                if (ret < 0)
+                    return ret;
+            }
+            cnnz[y * stride2 + x] = ret;
+        }
+    }
+    return 0;
+}
+
+static void encode_mb(H264DrmEmbContext *s, PutBitContext *pb, const DrmPPS *pps,
+                      int mb_x, int mb_y)
+{
+    const DrmMB *mb = &s->mb;
+    const int left = mb_available(s, mb_x - 1, mb_y);
+    const int top  = mb_available(s, mb_x, mb_y - 1);
+    const int stride4 = 4 * s->mb_width, stride2 = 2 * s->mb_width;
+    uint8_t *nnz = s->nnz_out[0] + 4 * (mb_y * stride4 + mb_x);
+    int i, c, nc, ret;
+
+    set_ue_golomb(pb, mb->mb_type);
+    if (mb->mb_type == I_PCM_MB_TYPE) {
+        put_bits(pb, -put_bits_count(pb) & 7, 0);
+        for (i = 0; i < 384; i++)
+            put_bits(pb, 8, mb->pcm[i]);
+        fill_pcm_nnz(s, s->nnz_out, mb_x, mb_y);
+        return;
+    }
+
+    if (!mb->mb_type) {
+        if (pps->transform_8x8_mode)
+            put_bits(pb, 1, mb->transform_8x8);
+        for (i = 0; i < (mb->transform_8x8 ? 4 : 16); i++) {
+            put_bits(pb, 1, mb->prev_pred_flag[i]);
+            if (!mb->prev_pred_flag[i])
+                put_bits(pb, 3, mb->rem_pred_mode[i]);
+        }
+        set_ue_golomb(pb, mb->chroma_pred_mode);
+        set_ue_golomb(pb, s->intra_cbp_to_golomb[mb->cbp]);
+    } else {
+        set_ue_golomb(pb, mb->chroma_pred_mode);
+    }
+
+    if (mb->cbp || mb->mb_type)
+        set_se_golomb(pb, mb->qp_delta);
+
+    if (mb->mb_type)
+        encode_block(pb, mb->luma_dc, pred_nnz(nnz, stride4, 0, 0, left, top), 16);
+    for (i = 0; i < 16; i++) {
+        int x = blk_x[i], y = blk_y[i];
+
+        ret = 0;
+        if (mb->mb_type ? mb->cbp & 15 : mb->cbp & (1 << (i >> 2))) {
+            nc  = pred_nnz(nnz, stride4, x, y, x || left, y || top);
+            ret = mb->mb_type ? encode_block(pb, mb->luma[i] + 1, nc, 15)
+                              : encode_block(pb, mb->luma[i],     nc, 16);
+        }
+        nnz[y * stride4 + x] = ret;
+    }
+
+    if (mb->cbp & 0x30)
+        for (c = 0; c < 2; c++)
+            encode_block(pb, mb->chroma_dc[c], -1, 4);
+    for (c = 0; c < 2; c++) {
+        uint8_t *cnnz = s->nnz_out[1 + c] + 2 * (mb_y * stride2 + mb_x);
+        for (i = 0; i < 4; i++) {
+            int x = i & 1, y = i >> 1;
+
+            ret = 0;
+            if (mb->cbp & 0x20) {
+                nc  = pred_nnz(cnnz, stride2, x, y, x || left, y || top);
+                ret = encode_block(pb, mb->chroma_ac[c][i] + 1, nc, 15);
+            }
+            cnnz[y * stride2 + x] = ret;
+        }
+    }
+}
+
+/****************************************************************************
+ * luma reconstruction and embedding
+ ****************************************************************************/
+
+static inline int binary_dm(int x, int bit, int q)
+{
+    int d = bit ? -q / 4 : q / 4;
+    return (x + d + q / 2) / q * q - d;
+}
+
+/**
+ * @return the watermark dc (block sum >> 3) of the 8x8 block ptr once the
+ *         coefficients coef are added to it, as an 8x8 transform or, for
+ *         4x4 transforms, to its bottom right 4x4 block
+ */
+static int block_dc(H264DrmEmbContext *s, const uint8_t *ptr, int16_t *coef,
+                    int transform_8x8)
+{
+    LOCAL_ALIGNED_8(uint8_t, pix, [64]);
+    int i, sum = 0;
+
+    for (i = 0; i < 8; i++)
+        memcpy(pix + 8 * i, ptr + i * s->recon_stride, 8);
+    if (transform_8x8)
+        s->h264dsp.h264_idct8_add(pix, coef, 8);
+    else
+        s->h264dsp.h264_idct_add(pix + 4 * 8 + 4, coef, 8);
+    for (i = 0; i < 64; i++)
+        sum += pix[i];
+    return sum >> 3;
+}
+
+/**
+ * Cost of moving the DC level by k, when it leads to the watermark dc.
+ * A block that cannot carry its bit is best left alone.
+ */
+static inline int embed_cost(int dc, int bit, int q, int k)
+{
+    int e_bit = FFABS(binary_dm(dc,  bit, q) - dc);
+    int e_not = FFABS(binary_dm(dc, !bit, q) - dc);
+
+    /* drmDec reads a 1 on e1 < e0 */
+    if (bit ? e_bit >= e_not : e_bit > e_not)
+        return INT_MAX - 256 + FFMIN(FFABS(k), 255);
+    return (e_bit << 16) + FFABS(k);
+}
+
+/**
+ * Move the DC level of the intra 8x8 block at ptr, predicted but not yet
+ * reconstructed, so that its reconstructed sum carries the watermark bit.
+ * With 4x4 transforms the first three 4x4 blocks are reconstructed, and
+ * only the DC level of the last one, level[0], is moved.
+ */
+static void embed_block(H264DrmEmbContext *s, const uint8_t *ptr,
+                        int16_t (*level)[16], int qp, int bx, int by,
+                        int transform_8x8)
+{
+    LOCAL_ALIGNED_16(int16_t, coef_ac, [64]);
+    LOCAL_ALIGNED_16(int16_t, coef,    [64]);
+    const int q    = s->dm_step;
+    const int qmul = transform_8x8 ? s->dequant8[qp][0] : s->dequant4[qp][0];
+    /* One DC level step moves the sum of the transformed pixels by about
+     * qmul / 64, so the dc by qmul / 512, or by qmul / 2048 for a 4x4
+     * block covering a quarter of the pixels. */
+    const int scale = transform_8x8 ? 512 : 2048;
+    const int size  = transform_8x8 ? 64 : 16;
+    int best_cost = INT_MAX, best_k = 0;
+    int bit, x2, y2, i, k, k0, d, dc;
+
+    if (8 * bx >= s->width || 8 * by >= s->height)
+        return;
+    x2  = ((s->xshift + bx * 8) / 8) % s->wm_w;
+    y2  = ((s->yshift + by * 8) / 8) % s->wm_w;
+    bit = s->wm[y2 * s->wm_w + x2] > 128;
+
+    memset(coef_ac, 0, 64 * sizeof(*coef_ac));
+    for (i = 0; i < (transform_8x8 ? 4 : 1); i++)
+        for (k = !i; k < 16; k++)
+            if (level[i][k]) {
+                int pos = transform_8x8 ? s->scan8x8[i][k] : s->scan4[k];
+                int mul = transform_8x8 ? s->dequant8[qp][pos] : s->dequant4[qp][pos];
+                coef_ac[pos] = (int)(level[i][k] * mul + 32) >> 6;
+            }
+
+    /* The idct rounding and the pixel clipping make the step inexact, and
+     * coarse at high qp, so try the levels around the estimate and keep the
+     * smallest change decoding to the right bit. */
+    memcpy(coef, coef_ac, size * sizeof(*coef));
+    coef[0]   = (level[0][0] * qmul + 32) >> 6;
+    dc        = block_dc(s, ptr, coef, transform_8x8);
+    best_cost = embed_cost(dc, bit, q, 0);
+    d         = binary_dm(dc, bit, q) - dc;
+    k0        = (scale * d + (d < 0 ? -qmul : qmul) / 2) / qmul;
+
+    for (k = k0 - EMBED_SEARCH; k <= k0 + EMBED_SEARCH; k++) {
+        int l = level[0][0] + k, cost;
+
+        if (!k || FFABS(l) * qmul >= 1 << 21)
+            continue;
+        memcpy(coef, coef_ac, size * sizeof(*coef));
+        coef[0] = (l * qmul + 32) >> 6;
+        dc      = block_dc(s, ptr, coef, transform_8x8);
+        cost    = embed_cost(dc, bit, q, k);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_k    = k;
+        }
+    }
+    level[0][0] += best_k;
+}
+
+static int reconstruct_mb(H264DrmEmbContext *s, int mb_x, int mb_y, int qp)
+{
+    static const int8_t top4[12]  = { -1, 0, LEFT_DC_PRED, -1, -1, -1, -1, -1, 0 };
+    static const int8_t left4[12] = { 0, -1, TOP_DC_PRED, 0, -1, -1, -1, 0, -1, DC_128_PRED };
+    static const int8_t top16[4]  = { LEFT_DC_PRED8x8, 1, -1, -1 };
+    static const int8_t left16[5] = { TOP_DC_PRED8x8, -1, 2, -1, DC_128_PRED8x8 };
+    LOCAL_ALIGNED_16(int16_t, coef, [256]);
+    DrmMB *mb = &s->mb;
+    const int left = mb_available(s, mb_x - 1, mb_y);
+    const int top  = mb_available(s, mb_x, mb_y - 1);
+    const int stride  = s->recon_stride;
+    const int stride4 = 4 * s->mb_width;
+    uint8_t *dst  = s->recon + 16 * (mb_y * stride + mb_x);
+    int8_t *modes = s->pred_mode + 4 * (mb_y * stride4 + mb_x);
+    int i, k, y;
+
+    if (mb->mb_type) {
+        for (y = 0; y < 4; y++)
+            memset(modes + y * stride4, DC_PRED, 4);
+    }
+
+    if (mb->mb_type == I_PCM_MB_TYPE) {
+        for (y = 0; y < 16; y++)
+            memcpy(dst + y * stride, mb->pcm + 16 * y, 16);
+        return 0;
+    }
+
+    if (mb->mb_type) {
+        LOCAL_ALIGNED_16(int16_t, dc, [16]);
+        int mode = i_mb_type_info[mb->mb_type].pred_mode;
+
+        if (!top)
+            mode = top16[mode];
+        if (mode >= 0 && !left)
+            mode = left16[mode];
+        if (mode < 0)
+            return AVERROR_INVALIDDATA;
+        s->hpc.pred16x16[mode](dst, stride);
+
+        memset(coef, 0, 256 * sizeof(*coef));
+        for (k = 0; k < 16; k++)
+            dc[s->scan4[k]] = mb->luma_dc[k];
+        s->h264dsp.h264_luma_dc_dequant_idct(coef, dc, s->dequant4[qp][0]);
+        for (i = 0; i < 16; i++) {
+            uint8_t *ptr = dst + 4 * (blk_y[i] * stride + blk_x[i]);
+            int nz = 0;
+            for (k = 1; k < 16; k++)
+                if (mb->luma[i][k]) {
+                    int pos = s->scan4[k];
+                    coef[16 * i + pos] = (int)(mb->luma[i][k] * s->dequant4[qp][pos] + 32) >> 6;
+                    nz = 1;
+                }
+            if (nz)
+                s->h264dsp.h264_idct_add(ptr, coef + 16 * i, stride);
+            else if (coef[16 * i])
+                s->h264dsp.h264_idct_dc_add(ptr, coef + 16 * i, stride);
+        }
+        return 0;
+    }
+
+    for (i = 0; i < (mb->transform_8x8 ? 4 : 16); i++) {
+        int blk = mb->transform_8x8 ? 4 * i : i;
+        int x = blk_x[blk], y = blk_y[blk];
+        int avail_a = x || left, avail_b = y || top;
+        int pred = DC_PRED, mode, status, nz = 0;
+        uint8_t *ptr = dst + 4 * (y * stride + x);
+
+        if (avail_a && avail_b)
+            pred = FFMIN(modes[y * stride4 + x - 1], modes[(y - 1) * stride4 + x]);
+        mode = mb->prev_pred_flag[i] ? pred :
+               mb->rem_pred_mode[i] + (mb->rem_pred_mode[i] >= pred);
+        modes[y * stride4 + x] = mode;
+        if (mb->transform_8x8) {
+            modes[y * stride4 + x + 1]       = mode;
+            modes[(y + 1) * stride4 + x]     = mode;
+            modes[(y + 1) * stride4 + x + 1] = mode;
+        }
+
+        /* fall back to the modes only using the available neighbours */
+        if (!avail_b) {
+            if ((status = top4[mode]) < 0)
+                return AVERROR_INVALIDDATA;
+            mode = status ? status : mode;
+        }
+        if (!avail_a) {
+            if ((status = left4[mode]) < 0)
+                return AVERROR_INVALIDDATA;
+            mode = status ? status : mode;
+        }
+
+        if (mb->transform_8x8) {
+            int tl = sample_available(s, mb_x, mb_y, 4 * x - 1, 4 * y - 1, blk);
+            int tr = sample_available(s, mb_x, mb_y, 4 * x + 8, 4 * y - 1, blk);
+
+            s->hpc.pred8x8l[mode](ptr, tl, tr, stride);
+            embed_block(s, ptr, mb->luma + blk, qp,
+                        2 * mb_x + (i & 1), 2 * mb_y + (i >> 1), 1);
+            if (mb->luma[blk][0])
+                mb->cbp |= 1 << i;
+
+            memset(coef, 0, 64 * sizeof(*coef));
+            for (k = 0; k < 64; k++)
+                if (mb->luma[blk + (k & 3)][k >> 2]) {
+                    int pos = s->scan8x8[k & 3][k >> 2];
+                    coef[pos] = (int)(mb->luma[blk + (k & 3)][k >> 2] * s->dequant8[qp][pos] + 32) >> 6;
+                    nz = 1;
+                }
+            if (nz)
+                s->h264dsp.h264_idct8_add(ptr, coef, stride);
+        } else {
+            const uint8_t *topright = NULL;
+            uint32_t tr;
+
+            if (mode == DIAG_DOWN_LEFT_PRED || mode == VERT_LEFT_PRED) {
+                if (sample_available(s, mb_x, mb_y, 4 * x + 4, 4 * y - 1, blk)) {
+                    topright = ptr + 4 - stride;
+                } else {
+                    tr = ptr[3 - stride] * 0x01010101u;
+                    topright = (const uint8_t *)&tr;
+                }
+            }
+            s->hpc.pred4x4[mode](ptr, topright, stride);
+            if ((blk & 3) == 3) {
+                embed_block(s, ptr - 4 * stride - 4, mb->luma + blk, qp,
+                            2 * mb_x + (blk >> 2 & 1), 2 * mb_y + (blk >> 3), 0);
+                if (mb->luma[blk][0])
+                    mb->cbp |= 1 << (blk >> 2);
+            }
+
+            memset(coef, 0, 16 * sizeof(*coef));
+            for (k = 0; k < 16; k++)
+                if (mb->luma[blk][k]) {
+                    int pos = s->scan4[k];
+                    coef[pos] = (int)(mb->luma[blk][k] * s->dequant4[qp][pos] + 32) >> 6;
+                    nz = 1;
+                }
+            if (nz)
+                s->h264dsp.h264_idct_add(ptr, coef, stride);
+        }
+    }
+    return 0;
+}
+
+/****************************************************************************
+ * NAL units
+ ****************************************************************************/
+
+static int rewrite_slice(H264DrmEmbContext *s, PutBitContext *pb,
+                         const uint8_t *rbsp, int size)
+{
+    GetBitContext gb;
+    const DrmSPS *sps;
+    const DrmPPS *pps;
+    int size_in_bits = rbsp_size_in_bits(rbsp, size);
+    int nal_ref_idc  = rbsp[0] >> 5 & 3;
+    int nal_type     = rbsp[0] & 0x1f;
+    int first_mb, slice_type, pps_id, qp, header_bits, mb_xy, ret;
+
+    init_get_bits(&gb, rbsp, 8 * size);
+    skip_bits(&gb, 8);
+    first_mb   = get_ue_golomb_long(&gb);
+    slice_type = get_ue_golomb_31(&gb);
+    pps_id     = get_ue_golomb(&gb);
+    if (slice_type > 9 || slice_type % 5 != 2 || pps_id >= MAX_PPS_COUNT)
+        return 0;
+    pps = &s->pps[pps_id];
+    sps = &s->sps[pps->sps_id];
+    if (!pps->valid || !sps->valid)
+        return 0;
+    if (!pps->supported || !sps->supported) {
+        if (!s->warned++)
+            av_log(s, AV_LOG_WARNING, "Only progressive 8-bit 4:2:0 CAVLC streams "
+                   "without scaling matrices are watermarked, passing through\n");
+        return 0;
+    }
+
+    skip_bits(&gb, sps->log2_max_frame_num);
+    if (nal_type == 5)
+        get_ue_golomb_long(&gb);            // idr_pic_id
+    if (sps->poc_type == 0) {
+        skip_bits(&gb, sps->log2_max_poc_lsb);
+        if (pps->pic_order_present)
+            get_se_golomb_long(&gb);
+    } else if (sps->poc_type == 1 && !sps->delta_pic_order_always_zero) {
+        get_se_golomb_long(&gb);
+        if (pps->pic_order_present)
+            get_se_golomb_long(&gb);
+    }
+    if (pps->redundant_pic_cnt_present)
+        get_ue_golomb(&gb);
+    if (nal_ref_idc) {
+        if (nal_type == 5) {
+            skip_bits(&gb, 2);
+        } else if (get_bits1(&gb)) {        // adaptive_ref_pic_marking_mode_flag
+            int op, n = 0;
+            while ((op = get_ue_golomb_31(&gb))) {
+                if (op > 6 || ++n > MAX_MMCO_COUNT)
+                    return AVERROR_INVALIDDATA;
+                if (op != 5)
+                    get_ue_golomb_long(&gb);
+                if (op == 3)
+                    get_ue_golomb_long(&gb);
+            }
+        }
+    }
+    qp = pps->init_qp + get_se_golomb(&gb);
+    if (qp < 0 || qp > 51)
+        return AVERROR_INVALIDDATA;
+    if (pps->deblocking_filter_params_present && get_ue_golomb_31(&gb) != 1) {
+        get_se_golomb(&gb);
+        get_se_golomb(&gb);
+    }
+    header_bits = get_bits_count(&gb);
+    if (header_bits >= size_in_bits || first_mb >= sps->mb_width * sps->mb_height)
+        return AVERROR_INVALIDDATA;
+
+    if ((ret = alloc_picture_state(s, sps)) < 0)
+        return ret;
+    s->slice_num++;
+
+    avpriv_copy_bits(pb, rbsp, header_bits);
+    for (mb_xy = first_mb; ; mb_xy++) {
+        int mb_x = mb_xy % s->mb_width;
+        int mb_y = mb_xy / s->mb_width;
+
+        if (mb_xy >= s->mb_width * s->mb_height)
+            return AVERROR_INVALIDDATA;
+        s->slice_table[mb_xy] = s->slice_num;
+
+        if ((ret = decode_mb(s, &gb, pps, mb_x, mb_y, &qp)) < 0 ||
+            (ret = reconstruct_mb(s, mb_x, mb_y, qp)) < 0)
+            return ret;
+        if (get_bits_count(&gb) > size_in_bits)
+            return AVERROR_INVALIDDATA;
+        encode_mb(s, pb, pps, mb_x, mb_y);
+
+        if (!more_rbsp_data(&gb, size_in_bits))
+            break;
+    }
+    put_bits(pb, 1, 1);
+    flush_put_bits(pb);
+    return 1;
+}
+
+static int unescape_nal(H264DrmEmbContext *s, const uint8_t *src, int size)
+{
+    int i, di = 0;
+
+    av_fast_padded_malloc(&s->rbsp, &s->rbsp_size, size);
+    if (!s->rbsp)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < size; i++) {
+        if (i + 2 < size && !src[i] && !src[i + 1] && src[i + 2] == 3) {
+            s->rbsp[di++] = 0;
+            s->rbsp[di++] = 0;
+            i += 2;
+        } else
+            s->rbsp[di++] = src[i];
+    }
+    return di;
+}
+
+static int append_output(H264DrmEmbContext *s, int *pos, const uint8_t *data, int size)
+{
+    uint8_t *out = av_fast_realloc(s->out, &s->out_size,
+                                   *pos + size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!out)
+        return AVERROR(ENOMEM);
+    s->out = out;
+    memcpy(s->out + *pos, data, size);
+    *pos += size;
+    return 0;
+}
+
+/**
+ * Parse one NAL unit and append it, watermarked if possible, to the output.
+ * @param pos output position, NULL to only parse the parameter sets
+ * @return 1 if the NAL unit was rewritten
+ */
+static int process_nal(H264DrmEmbContext *s, const uint8_t *nal, int size, int *pos)
+{
+    GetBitContext gb;
+    PutBitContext pb;
+    int type = nal[0] & 0x1f;
+    int rbsp_size, i, ret, zeros;
+    uint8_t *out;
+
+    if (type == 7 || type == 8 || (pos && (type == 1 || type == 5))) {
+        if ((rbsp_size = unescape_nal(s, nal, size)) < 0)
+            return rbsp_size;
+        init_get_bits(&gb, s->rbsp + 1, 8 * (rbsp_size - 1));
+        if (type == 7)
+            ret = decode_sps(s, &gb);
+        else if (type == 8)
+            ret = decode_pps(s, &gb, rbsp_size_in_bits(s->rbsp, rbsp_size) - 8);
+        if (type == 7 || type == 8) {
+            if (ret < 0)
+                av_log(s, AV_LOG_WARNING, "Invalid parameter set ignored\n");
+        } else {
+            int mb_count = 0;
+
+            /* the levels only move slightly, but the coeff_tokens follow
+             * the new neighbour counts, leave room for that */
+            for (i = 0; i < MAX_SPS_COUNT; i++)
+                if (s->sps[i].valid)
+                    mb_count = FFMAX(mb_count, s->sps[i].mb_width * s->sps[i].mb_height);
+            av_fast_padded_malloc(&s->nal, &s->nal_size, 2 * rbsp_size + 64 * mb_count + 64);
+            if (!s->nal)
+                return AVERROR(ENOMEM);
+            init_put_bits(&pb, s->nal, s->nal_size);
+            ret = rewrite_slice(s, &pb, s->rbsp, rbsp_size);
+            if (ret < 0)
+                av_log(s, AV_LOG_WARNING, "Error rewriting a slice, passing it through\n");
+            if (ret > 0) {
+                /* escape back into the output */
+                int nal_bytes = put_bits_count(&pb) >> 3;
+                uint8_t *end;
+
+                out = av_fast_realloc(s->out, &s->out_size,
+                                      *pos + nal_bytes * 3 / 2 + 8 + AV_INPUT_BUFFER_PADDING_SIZE);
+                if (!out)
+                    return AVERROR(ENOMEM);
+                s->out = out;
+                out += *pos + s->nal_length_size;
+                end  = out;
+                for (i = 0, zeros = 0; i < nal_bytes; i++) {
+                    if (zeros >= 2 && s->nal[i] <= 3) {
+                        *end++ = 3;
+                        zeros  = 0;
+                    }
+                    zeros = s->nal[i] ? 0 : zeros + 1;
+                    *end++ = s->nal[i];
+                }
+                for (i = 0; i < s->nal_length_size; i++)
+                    out[i - s->nal_length_size] = (end - out) >> (8 * (s->nal_length_size - 1 - i));
+                *pos = end - s->out;
+                return 1;
+            }
+        }
+    }
+
+    if (!pos)
+        return 0;
+    if (s->nal_length_size) {
+        uint8_t len[4];
+        for (i = 0; i < s->nal_length_size; i++)
+            len[i] = size >> (8 * (s->nal_length_size - 1 - i));
+        if ((ret = append_output(s, pos, len, s->nal_length_size)) < 0)
+            return ret;
+    }
+    if ((ret = append_output(s, pos, nal, size)) < 0)
+        return ret;
+    return 0;
+}
+
+/**
+ * Walk the NAL units of an Annex B or length prefixed buffer.
+ * @param pos output position, NULL to only parse the parameter sets
+ * @return number of rewritten NAL units, or <0 on error
+ */
+static int process_buffer(H264DrmEmbContext *s, const uint8_t *buf, int size,
+                          int nal_length_size, int *pos)
+{
+    const uint8_t *end = buf + size;
+    int rewritten = 0, ret;
+
+    if (nal_length_size) {
+        while (end - buf > nal_length_size) {
+            int i, len = 0;
+            for (i = 0; i < nal_length_size; i++)
+                len = (len << 8) | buf[i];
+            buf += nal_length_size;
+            if (len <= 0 || len > end - buf)
+                return AVERROR_INVALIDDATA;
+            if ((ret = process_nal(s, buf, len, pos)) < 0)
+                return ret;
+            rewritten += ret;
+            buf += len;
+        }
+        return rewritten;
+    }
+
+    while (buf < end) {
+        uint32_t state = -1;
+        const uint8_t *nal = avpriv_find_start_code(buf, end, &state), *next;
+        int len;
+
+        if ((state & 0xFFFFFF00) != 0x100) {
+            if (pos && (ret = append_output(s, pos, buf, end - buf)) < 0)
+                return ret;
+            break;
+        }
+        /* copy up to and including the start code */
+        nal--;
+        if (pos && (ret = append_output(s, pos, buf, nal - buf)) < 0)
+            return ret;
+
+        state = -1;
+        next  = avpriv_find_start_code(nal, end, &state);
+        if ((state & 0xFFFFFF00) == 0x100)
+            next -= 4;
+        for (len = next - nal; len > 0 && !nal[len - 1]; len--)
+            ;
+        if ((ret = process_nal(s, nal, len, pos)) < 0)
+            return ret;
+        rewritten += ret;
+        buf = nal + len;
+    }
+    return rewritten;
+}
+
+static int h264_drmemb_filter(AVBitStreamFilterContext *bsfc,
+                              AVCodecContext *avctx, const char *args,
+                              uint8_t **poutbuf, int *poutbuf_size,
+                              const uint8_t *buf, int buf_size,
+                              int keyframe)
+{
+    H264DrmEmbContext *s = bsfc->priv_data;
+    int pos = 0, ret;
+
+    *poutbuf      = (uint8_t *)buf;
+    *poutbuf_size = buf_size;
+
+    if (!s->initialized) {
+        if ((ret = drmemb_init(s, avctx, args)) < 0)
+            return ret;
+        s->initialized = 1;
+        if (avctx->extradata_size > 6 && s->nal_length_size) {
+            const uint8_t *p = avctx->extradata + 5, *end = avctx->extradata + avctx->extradata_size;
+            int i, n, count = *p++ & 0x1f;
+
+            for (n = 0; n < 2; n++) {
+                for (i = 0; i < count && end - p > 2; i++) {
+                    int len = AV_RB16(p);
+                    if (len > end - p - 2)
+                        break;
+                    process_nal(s, p + 2, len, NULL);
+                    p += 2 + len;
+                }
+                if (p >= end)
+                    break;
+                count = *p++;
+            }
+        } else if (avctx->extradata_size) {
+            process_buffer(s, avctx->extradata, avctx->extradata_size, 0, NULL);
+        }
+    }
+
+    ret = process_buffer(s, buf, buf_size, s->nal_length_size, &pos);
+    if (ret <= 0)
+        return ret;
+
+    if (!(*poutbuf = av_malloc(pos + AV_INPUT_BUFFER_PADDING_SIZE)))
+        return AVERROR(ENOMEM);
+    memcpy(*poutbuf, s->out, pos);
+    memset(*poutbuf + pos, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    *poutbuf_size = pos;
+    return 1;
+}
+
+static void h264_drmemb_close(AVBitStreamFilterContext *bsfc)
+{
+    H264DrmEmbContext *s = bsfc->priv_data;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        ff_free_vlc(&s->coeff_token_vlc[i]);
+    for (i = 0; i < 3; i++)
+        ff_free_vlc(&s->chroma_dc_total_zeros_vlc[i]);
+    for (i = 0; i < 15; i++)
+        ff_free_vlc(&s->total_zeros_vlc[i]);
+    for (i = 0; i < 6; i++)
+        ff_free_vlc(&s->run_vlc[i]);
+    ff_free_vlc(&s->chroma_dc_coeff_token_vlc);
+    ff_free_vlc(&s->run7_vlc);
+
+    av_freep(&s->slice_table);
+    av_freep(&s->pred_mode);
+    av_freep(&s->recon_base);
+    for (i = 0; i < 3; i++) {
+        av_freep(&s->nnz_in[i]);
+        av_freep(&s->nnz_out[i]);
+    }
+    av_freep(&s->wm);
+    av_freep(&s->rbsp);
+    av_freep(&s->nal);
+    av_freep(&s->out);
+    if (s->class)
+        av_opt_free(s);
+}
+
+AVBitStreamFilter ff_h264_drmemb_bsf = {
+    .name           = "h264_drmemb",
+    .priv_data_size = sizeof(H264DrmEmbContext),
+    .filter         = h264_drmemb_filter,
+    .close          = h264_drmemb_close,
+};
@@ -186,6 +186,15 @@ int ff_h264_field_end(H264Context *h, H264SliceContext *sl, int in_setup)
         ff_vdpau_h264_picture_complete(h);
 #endif
 
+    if (h->deblock_postpass_active && h->current_slice) {
+        int ret = ff_h264_deblock_picture(h);
+        if (ret < 0) {
+            av_log(avctx, AV_LOG_ERROR, "deblocking the picture failed\n");
+            err = ret;
+        } else
+            ff_h264_draw_horiz_band(h, sl, 0, 16 * h->mb_height);
+    }
+
 #if CONFIG_ERROR_RESILIENCE
     av_assert0(sl == h->slice_ctx);
     /*
@@ -125,28 +125,6 @@ static const uint8_t zigzag_scan8x8_cavlc[64+1] = {
     5 + 5 * 8, 6 + 5 * 8, 6 + 6 * 8, 7 + 7 * 8,
 };
 
-static const uint8_t dequant4_coeff_init[6][3] = {
-    { 10, 13, 16 },
-    { 11, 14, 18 },
-    { 13, 16, 20 },
-    { 14, 18, 23 },
-    { 16, 20, 25 },
-    { 18, 23, 29 },
-};
-
-static const uint8_t dequant8_coeff_init_scan[16] = {
-    0, 3, 4, 3, 3, 1, 5, 1, 4, 5, 2, 5, 3, 1, 5, 1
-};
-
-static const uint8_t dequant8_coeff_init[6][6] = {
-    { 20, 18, 32, 19, 25, 24 },
-    { 22, 19, 35, 21, 28, 26 },
-    { 26, 23, 42, 24, 33, 31 },
-    { 28, 25, 45, 26, 35, 33 },
-    { 32, 28, 51, 30, 40, 38 },
-    { 36, 32, 58, 34, 46, 43 },
-};
-
 
 static void release_unused_pictures(H264Context *h, int remove_current)
 {
@@ -332,7 +310,7 @@ static void init_dequant8_coeff_table(H264Context *h)
             int idx   = rem6[q];
             for (x = 0; x < 64; x++)
                 h->dequant8_coeff[i][q][(x >> 3) | ((x & 7) << 3)] =
-                    ((uint32_t)dequant8_coeff_init[idx][dequant8_coeff_init_scan[((x >> 1) & 12) | (x & 3)]] *
+                    ((uint32_t)ff_h264_dequant8_coeff_init[idx][ff_h264_dequant8_coeff_init_scan[((x >> 1) & 12) | (x & 3)]] *
                      h->pps.scaling_matrix8[i][x]) << shift;
         }
     }
@@ -358,7 +336,7 @@ static void init_dequant4_coeff_table(H264Context *h)
             int idx   = rem6[q];
             for (x = 0; x < 16; x++)
                 h->dequant4_coeff[i][q][(x >> 2) | ((x << 2) & 0xF)] =
-                    ((uint32_t)dequant4_coeff_init[idx][(x & 1) + ((x >> 2) & 1)] *
+                    ((uint32_t)ff_h264_dequant4_coeff_init[idx][(x & 1) + ((x >> 2) & 1)] *
                      h->pps.scaling_matrix4[i][x]) << shift;
         }
     }
@@ -662,6 +640,14 @@ static int h264_frame_start(H264Context *h)
 
     assert(h->cur_pic_ptr->long_ref == 0);
 
+    /* the post pass filters rows in slice threads, using one slice
+     * context per thread */
+    h->deblock_postpass_active = HAVE_THREADS && h->deblock_postpass &&
+                                 (h->avctx->active_thread_type & FF_THREAD_SLICE) &&
+                                 h->avctx->thread_count <= H264_MAX_THREADS &&
+                                 h->picture_structure == PICT_FRAME &&
+                                 !FRAME_MBAFF(h) && !h->avctx->hwaccel;
+
     return 0;
 }
 
@@ -1846,7 +1832,13 @@ int ff_h264_decode_slice_header(H264Context *h, H264SliceContext *sl)
          h->nal_ref_idc == 0))
         sl->deblocking_filter = 0;
 
-    if (sl->deblocking_filter == 1 && h->max_contexts > 1) {
+    /* deblock_slice[] cannot tell more slices apart, the picture is
+     * deblocked inline from here on after filtering the decoded slices */
+    if (h->deblock_postpass_active && h->current_slice >= MAX_SLICES - 1)
+        return SLICE_SINGLETHREAD;
+
+    if (sl->deblocking_filter == 1 && h->max_contexts > 1 &&
+        !h->deblock_postpass_active) {
         if (h->avctx->flags2 & AV_CODEC_FLAG2_FAST) {
             /* Cheat slightly for speed:
              * Do not bother to deblock across slices. */
@@ -1947,6 +1939,21 @@ int ff_h264_decode_slice_header(H264Context *h, H264SliceContext *sl)
                sl->slice_type == AV_PICTURE_TYPE_B ? (sl->direct_spatial_mv_pred ? "SPAT" : "TEMP") : "");
     }
 
+    if (h->deblock_postpass_active) {
+        const int idx = sl->slice_num & (MAX_SLICES - 1);
+        H264SliceDeblock *d = &h->deblock_slice[idx];
+
+        d->deblocking_filter     = sl->deblocking_filter;
+        d->slice_alpha_c0_offset = sl->slice_alpha_c0_offset;
+        d->slice_beta_offset     = sl->slice_beta_offset;
+        d->qp_thresh             = sl->qp_thresh;
+        memcpy(h->deblock_ref2frm[idx], sl->ref2frm[idx], sizeof(h->deblock_ref2frm[idx]));
+
+        /* reconstruct from the unfiltered picture, ff_h264_deblock_picture()
+         * filters it once all slices are decoded */
+        sl->deblocking_filter = 0;
+    }
+
     return 0;
 }
 
@@ -2287,6 +2294,10 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
     int height         =  16      << FRAME_MBAFF(h);
     int deblock_border = (16 + 4) << FRAME_MBAFF(h);
 
+    /* rows are only final after ff_h264_deblock_picture() */
+    if (h->deblock_postpass_active)
+        return;
+
     if (sl->deblocking_filter) {
         if ((top + height) >= pic_height)
             height += deblock_border;
@@ -2325,11 +2336,11 @@ static void er_add_slice(H264SliceContext *sl,
     }
 }
 
-static int decode_slice(struct AVCodecContext *avctx, void *arg)
+/**
+ * Set up the per picture state of a slice context used for reconstruction.
+ */
+static int init_slice_decode(const H264Context *h, H264SliceContext *sl)
 {
-    H264SliceContext *sl = arg;
-    const H264Context *h = sl->h264;
-    int lf_x_start = sl->mb_x;
     int ret;
 
     sl->linesize   = h->cur_pic_ptr->f->linesize[0];
@@ -2339,14 +2350,273 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
     if (ret < 0)
         return ret;
 
+    sl->is_complex = FRAME_MBAFF(h) || h->picture_structure != PICT_FRAME ||
+                     h->avctx->codec_id != AV_CODEC_ID_H264 ||
+                     (CONFIG_GRAY && (h->flags & AV_CODEC_FLAG_GRAY));
+
+    return 0;
+}
+
+/* ff_thread_report_progress2() entries used by the slice pipeline;
+ * the entropy decoder reports as thread 0, the reconstruction as thread 1 */
+enum {
+    PIPELINE_DECODED,       ///< macroblocks handed to the reconstruction
+    PIPELINE_RECONSTRUCTED, ///< macroblocks released by the reconstruction
+    PIPELINE_FREE,          ///< PIPELINE_RECONSTRUCTED + ring size
+    PIPELINE_QUEUED,        ///< PIPELINE_DECODED, for the entropy decoder
+};
+
+/**
+ * Return ring entry n once the reconstruction thread no longer uses it.
+ */
+static H264PipelineMB *pipeline_get_mb(const H264Context *h, int n, int published)
+{
+    ff_thread_await_progress2(h->avctx, PIPELINE_QUEUED, 2, n - published + 1);
+    return &h->pipeline_mb[n % h->pipeline_mb_count];
+}
+
+static void pipeline_publish(const H264Context *h, int queued, int *published)
+{
+    ff_thread_report_progress2(h->avctx, PIPELINE_QUEUED,  0, queued - *published);
+    ff_thread_report_progress2(h->avctx, PIPELINE_DECODED, 0, queued - *published);
+    *published = queued;
+}
+
+static void pipeline_release(const H264Context *h, int consumed, int *released)
+{
+    ff_thread_report_progress2(h->avctx, PIPELINE_RECONSTRUCTED, 1, consumed - *released);
+    ff_thread_report_progress2(h->avctx, PIPELINE_FREE,          1, consumed - *released);
+    *released = consumed;
+}
+
+/**
+ * Queue the entry ending the slice, which the reconstruction waits for
+ * whether the entropy decoding succeeded or not.
+ */
+static void pipeline_end_slice(const H264Context *h, int queued, int published,
+                               int filter_end)
+{
+    H264PipelineMB *pm = pipeline_get_mb(h, queued++, published);
+
+    pm->end_of_slice = 1;
+    pm->filter_end   = filter_end;
+    pipeline_publish(h, queued, &published);
+}
+
+static void pipeline_save_mb(const H264Context *h, H264SliceContext *sl,
+                             H264PipelineMB *pm)
+{
+    const int mb_type = h->cur_pic.mb_type[sl->mb_xy];
+
+    pm->mb_x  = sl->mb_x;
+    pm->mb_y  = sl->mb_y;
+    pm->mb_xy = sl->mb_xy;
+    pm->qscale       = sl->qscale;
+    pm->chroma_qp[0] = sl->chroma_qp[0];
+    pm->chroma_qp[1] = sl->chroma_qp[1];
+    pm->cbp          = sl->cbp;
+    pm->top_type     = sl->top_type;
+    pm->end_of_row   = 0;
+    pm->end_of_slice = 0;
+
+    /* the CABAC decoder only writes nonzero coefficients, so the
+     * block has to be cleared here instead of by the idct */
+    pm->has_coeffs = !IS_INTRA_PCM(mb_type) &&
+                     (h->cbp_table[sl->mb_xy] || IS_INTRA16x16(mb_type));
+    if (pm->has_coeffs) {
+        const int size = 16 * 48 * sizeof(int16_t) << h->pixel_shift;
+
+        memcpy(pm->mb, sl->mb, size);
+        memset(sl->mb, 0, size);
+        if (IS_INTRA16x16(mb_type))
+            memcpy(pm->mb_luma_dc, sl->mb_luma_dc, sizeof(pm->mb_luma_dc));
+    }
+    memcpy(pm->non_zero_count_cache, sl->non_zero_count_cache,
+           sizeof(pm->non_zero_count_cache));
+
+    if (IS_INTRA(mb_type)) {
+        memcpy(pm->intra4x4_pred_mode_cache, sl->intra4x4_pred_mode_cache,
+               sizeof(pm->intra4x4_pred_mode_cache));
+        pm->intra16x16_pred_mode       = sl->intra16x16_pred_mode;
+        pm->chroma_pred_mode           = sl->chroma_pred_mode;
+        pm->topleft_samples_available  = sl->topleft_samples_available;
+        pm->topright_samples_available = sl->topright_samples_available;
+        pm->intra_pcm_ptr              = sl->intra_pcm_ptr;
+    } else {
+        memcpy(pm->mv_cache,    sl->mv_cache,    sizeof(pm->mv_cache));
+        memcpy(pm->ref_cache,   sl->ref_cache,   sizeof(pm->ref_cache));
+        memcpy(pm->sub_mb_type, sl->sub_mb_type, sizeof(pm->sub_mb_type));
+    }
+}
+
+static void pipeline_load_mb(const H264Context *h, H264SliceContext *sl,
+                             const H264PipelineMB *pm)
+{
+    const int mb_type = h->cur_pic.mb_type[pm->mb_xy];
+
+    sl->mb_x  = pm->mb_x;
+    sl->mb_y  = pm->mb_y;
+    sl->mb_xy = pm->mb_xy;
+    sl->qscale       = pm->qscale;
+    sl->chroma_qp[0] = pm->chroma_qp[0];
+    sl->chroma_qp[1] = pm->chroma_qp[1];
+    sl->cbp          = pm->cbp;
+    sl->top_type     = pm->top_type;
+
+    if (pm->has_coeffs) {
+        memcpy(sl->mb, pm->mb, 16 * 48 * sizeof(int16_t) << h->pixel_shift);
+        if (IS_INTRA16x16(mb_type))
+            memcpy(sl->mb_luma_dc, pm->mb_luma_dc, sizeof(sl->mb_luma_dc));
+    }
+    memcpy(sl->non_zero_count_cache, pm->non_zero_count_cache,
+           sizeof(sl->non_zero_count_cache));
+
+    if (IS_INTRA(mb_type)) {
+        memcpy(sl->intra4x4_pred_mode_cache, pm->intra4x4_pred_mode_cache,
+               sizeof(sl->intra4x4_pred_mode_cache));
+        sl->intra16x16_pred_mode       = pm->intra16x16_pred_mode;
+        sl->chroma_pred_mode           = pm->chroma_pred_mode;
+        sl->topleft_samples_available  = pm->topleft_samples_available;
+        sl->topright_samples_available = pm->topright_samples_available;
+        sl->intra_pcm_ptr              = pm->intra_pcm_ptr;
+    } else {
+        memcpy(sl->mv_cache,    pm->mv_cache,    sizeof(sl->mv_cache));
+        memcpy(sl->ref_cache,   pm->ref_cache,   sizeof(sl->ref_cache));
+        memcpy(sl->sub_mb_type, pm->sub_mb_type, sizeof(sl->sub_mb_type));
+    }
+}
+
+/**
+ * Entropy stage of the slice pipeline: the CABAC loop of decode_slice()
+ * with reconstruction and deblocking left to pipeline_reconstruct().
+ */
+static int decode_slice_entropy(const H264Context *h, H264SliceContext *sl)
+{
+    H264PipelineMB *pm = NULL;
+    int lf_x_start = sl->mb_x;
+    int filter_end = -1;
+    int queued = 0, published = 0;
+    int ret;
+
+    for (;;) {
+        int eos;
+
+        if (sl->mb_x + sl->mb_y * h->mb_width >= sl->next_slice_idx) {
+            av_log(h->avctx, AV_LOG_ERROR, "Slice overlaps with next at %d\n",
+                   sl->next_slice_idx);
+            er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x,
+                         sl->mb_y, ER_MB_ERROR);
+            ret = AVERROR_INVALIDDATA;
+            break;
+        }
+
+        ret = ff_h264_decode_mb_cabac(h, sl);
+
+        if (ret >= 0) {
+            pm = pipeline_get_mb(h, queued++, published);
+            pipeline_save_mb(h, sl, pm);
+        }
+        eos = get_cabac_terminate(&sl->cabac);
+
+        if ((h->workaround_bugs & FF_BUG_TRUNCATED) &&
+            sl->cabac.bytestream > sl->cabac.bytestream_end + 2) {
+            er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x - 1,
+                         sl->mb_y, ER_MB_END);
+            if (sl->mb_x >= lf_x_start)
+                filter_end = sl->mb_x + 1;
+            ret = 0;
+            break;
+        }
+        if (sl->cabac.bytestream > sl->cabac.bytestream_end + 2 )
+            av_log(h->avctx, AV_LOG_DEBUG, "bytestream overread %"PTRDIFF_SPECIFIER"\n", sl->cabac.bytestream_end - sl->cabac.bytestream);
+        if (ret < 0 || sl->cabac.bytestream > sl->cabac.bytestream_end + 4) {
+            av_log(h->avctx, AV_LOG_ERROR,
+                   "error while decoding MB %d %d, bytestream %"PTRDIFF_SPECIFIER"\n",
+                   sl->mb_x, sl->mb_y,
+                   sl->cabac.bytestream_end - sl->cabac.bytestream);
+            er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x,
+                         sl->mb_y, ER_MB_ERROR);
+            ret = AVERROR_INVALIDDATA;
+            break;
+        }
+
+        if (++sl->mb_x >= h->mb_width) {
+            pm->end_of_row = 1;
+            sl->mb_x = lf_x_start = 0;
+            ++sl->mb_y;
+            pipeline_publish(h, queued, &published);
+        }
+
+        if (eos || sl->mb_y >= h->mb_height) {
+            ff_tlog(h->avctx, "slice end %d %d\n",
+                    get_bits_count(&sl->gb), sl->gb.size_in_bits);
+            er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x - 1,
+                         sl->mb_y, ER_MB_END);
+            if (sl->mb_x > lf_x_start)
+                filter_end = sl->mb_x;
+            ret = 0;
+            break;
+        }
+    }
+
+    pipeline_end_slice(h, queued, published, filter_end);
+
+    return ret;
+}
+
+/**
+ * Reconstruction stage of the slice pipeline: run ff_h264_hl_decode_mb()
+ * and the loop filter on the macroblocks queued by decode_slice_entropy(),
+ * in the order decode_slice() would.
+ */
+static int pipeline_reconstruct(const H264Context *h, H264SliceContext *sl)
+{
+    int lf_x_start = sl->mb_x;
+    int consumed = 0, released = 0;
+
+    for (;;) {
+        const H264PipelineMB *pm;
+
+        ff_thread_await_progress2(h->avctx, PIPELINE_RECONSTRUCTED, 1,
+                                  consumed - released + 1);
+        pm = &h->pipeline_mb[consumed++ % h->pipeline_mb_count];
+
+        if (pm->end_of_slice) {
+            if (pm->filter_end >= 0)
+                loop_filter(h, sl, lf_x_start, pm->filter_end);
+            return 0;
+        }
+
+        pipeline_load_mb(h, sl, pm);
+        ff_h264_hl_decode_mb(h, sl);
+
+        if (pm->end_of_row) {
+            loop_filter(h, sl, lf_x_start, h->mb_width);
+            lf_x_start = 0;
+            decode_finish_row(h, sl);
+            pipeline_release(h, consumed, &released);
+        }
+    }
+}
+
+static int decode_slice(struct AVCodecContext *avctx, void *arg)
+{
+    H264SliceContext *sl = arg;
+    const H264Context *h = sl->h264;
+    int lf_x_start = sl->mb_x;
+    int ret;
+
+    ret = init_slice_decode(h, sl);
+    if (ret < 0) {
+        if (h->pipeline_active)
+            pipeline_end_slice(h, 0, 0, -1);
+        return ret;
+    }
+
     sl->mb_skip_run = -1;
 
     av_assert0(h->block_offset[15] == (4 * ((scan8[15] - scan8[0]) & 7) << h->pixel_shift) + 4 * sl->linesize * ((scan8[15] - scan8[0]) >> 3));
 
-    sl->is_complex = FRAME_MBAFF(h) || h->picture_structure != PICT_FRAME ||
-                     avctx->codec_id != AV_CODEC_ID_H264 ||
-                     (CONFIG_GRAY && (h->flags & AV_CODEC_FLAG_GRAY));
-
     if (!(h->avctx->active_thread_type & FF_THREAD_SLICE) && h->picture_structure == PICT_FRAME && h->slice_ctx[0].er.error_status_table) {
         const int start_i  = av_clip(sl->resync_mb_x + sl->resync_mb_y * h->mb_width, 0, h->mb_num - 1);
         if (start_i) {
@@ -2368,6 +2638,9 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
         ff_h264_init_cabac_states(h, sl);
 
+        if (h->pipeline_active)
+            return decode_slice_entropy(h, sl);
+
         for (;;) {
             // START_TIMER
             int ret, eos;
@@ -2525,6 +2798,153 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
     }
 }
 
+static int deblock_row(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    H264Context *h        = avctx->priv_data;
+    H264SliceContext *sl  = &h->slice_ctx[threadnr];
+    const int mb_y        = jobnr;
+    const int thread      = mb_y % avctx->thread_count;
+    const int pixel_shift = h->pixel_shift;
+    const int block_h     = 16 >> h->chroma_y_shift;
+    int mb_x;
+
+    sl->mb_y                   = mb_y;
+    sl->mb_field_decoding_flag = 0;
+    sl->mb_mbaff               = 0;
+    sl->mb_linesize            = sl->linesize;
+    sl->mb_uvlinesize          = sl->uvlinesize;
+
+    for (mb_x = 0; mb_x < h->mb_width; mb_x++) {
+        const int mb_xy     = mb_x + mb_y * h->mb_stride;
+        const int slice_num = h->slice_table[mb_xy];
+
+        /* the top edge changes the bottom rows of the macroblock above,
+         * which the left edge of the one to its right filters as well */
+        ff_thread_await_progress2(avctx, mb_y, thread, 2);
+
+        if (slice_num != 0xFFFF) {
+            const H264SliceDeblock *d = &h->deblock_slice[slice_num & (MAX_SLICES - 1)];
+            const int mb_type = h->cur_pic.mb_type[mb_xy];
+            uint8_t *dest_y, *dest_cb, *dest_cr;
+
+            sl->slice_num             = slice_num;
+            sl->deblocking_filter     = d->deblocking_filter;
+            sl->slice_alpha_c0_offset = d->slice_alpha_c0_offset;
+            sl->slice_beta_offset     = d->slice_beta_offset;
+            sl->qp_thresh             = d->qp_thresh;
+            sl->list_count            = h->list_counts[mb_xy];
+            sl->mb_x                  = mb_x;
+            sl->mb_xy                 = mb_xy;
+
+            dest_y  = h->cur_pic.f->data[0] +
+                      ((mb_x << pixel_shift) + mb_y * sl->linesize) * 16;
+            dest_cb = h->cur_pic.f->data[1] +
+                      (mb_x << pixel_shift) * (8 << CHROMA444(h)) +
+                      mb_y * sl->uvlinesize * block_h;
+            dest_cr = h->cur_pic.f->data[2] +
+                      (mb_x << pixel_shift) * (8 << CHROMA444(h)) +
+                      mb_y * sl->uvlinesize * block_h;
+
+            if (sl->deblocking_filter && !fill_filter_caches(h, sl, mb_type)) {
+                sl->chroma_qp[0] = get_chroma_qp(h, 0, h->cur_pic.qscale_table[mb_xy]);
+                sl->chroma_qp[1] = get_chroma_qp(h, 1, h->cur_pic.qscale_table[mb_xy]);
+                ff_h264_filter_mb_fast(h, sl, mb_x, mb_y, dest_y, dest_cb,
+                                       dest_cr, sl->linesize, sl->uvlinesize);
+            }
+        }
+
+        ff_thread_report_progress2(avctx, mb_y, thread, 1);
+    }
+    ff_thread_report_progress2(avctx, mb_y, thread, 2);
+
+    return 0;
+}
+
+/**
+ * Deblock the current picture after all of its slices have been decoded,
+ * one macroblock row per job with each row two macroblocks behind the
+ * one above it.
+ */
+int ff_h264_deblock_picture(H264Context *h)
+{
+    AVCodecContext *const avctx = h->avctx;
+    int i, ret;
+
+    ret = ff_alloc_entries(avctx, h->mb_height);
+    if (ret < 0)
+        return ret;
+    ff_reset_entries(avctx);
+
+    for (i = 0; i < FFMIN(avctx->thread_count, h->mb_height); i++)
+        memcpy(h->slice_ctx[i].ref2frm, h->deblock_ref2frm,
+               sizeof(h->slice_ctx[i].ref2frm));
+
+    avctx->execute2(avctx, deblock_row, NULL, NULL, h->mb_height);
+
+    return 0;
+}
+
+static int decode_slice_pipeline(AVCodecContext *avctx, void *arg,
+                                 int jobnr, int threadnr)
+{
+    H264Context *h = avctx->priv_data;
+
+    if (!jobnr)
+        return decode_slice(avctx, &h->slice_ctx[0]);
+    return pipeline_reconstruct(h, &h->slice_ctx[1]);
+}
+
+/**
+ * Decode the slice in h->slice_ctx[0] with CABAC parsing in one slice
+ * thread and reconstruction plus deblocking in another, using
+ * h->slice_ctx[1] as the reconstruction context.
+ */
+static int execute_slice_pipeline(H264Context *h)
+{
+    AVCodecContext *const avctx = h->avctx;
+    H264SliceContext *sl  = &h->slice_ctx[0];
+    H264SliceContext *rsl = &h->slice_ctx[1];
+    int8_t *intra4x4_pred_mode = rsl->intra4x4_pred_mode;
+    /* three rows let the entropy decoder run ahead of deblocking */
+    int count = 3 * h->mb_width + 1;
+    int ret[2] = { 0 };
+    int err;
+
+    av_fast_malloc(&h->pipeline_mb, &h->pipeline_mb_size,
+                   count * sizeof(*h->pipeline_mb));
+    if (!h->pipeline_mb)
+        return AVERROR(ENOMEM);
+    h->pipeline_mb_count = count;
+
+    err = ff_alloc_entries(avctx, PIPELINE_QUEUED + 1);
+    if (err < 0)
+        return err;
+    ff_reset_entries(avctx);
+    ff_thread_report_progress2(avctx, PIPELINE_FREE, 1, count);
+
+    /* slice header state; the buffers of rsl stay its own */
+    copy_fields(rsl, sl, slice_num, intra_pcm_ptr);
+    rsl->intra4x4_pred_mode = intra4x4_pred_mode;
+
+    err = init_slice_decode(h, rsl);
+    if (err < 0)
+        return err;
+
+    h->pipeline_active = 1;
+    avctx->execute2(avctx, decode_slice_pipeline, NULL, ret, 2);
+    h->pipeline_active = 0;
+
+    return ret[0];
+}
+
+static int use_slice_pipeline(const H264Context *h)
+{
+    return HAVE_THREADS && h->slice_pipeline &&
+           (h->avctx->active_thread_type & FF_THREAD_SLICE) &&
+           h->slice_context_count > 1 && h->pps.cabac &&
+           h->picture_structure == PICT_FRAME && !FRAME_MBAFF(h);
+}
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2552,7 +2972,10 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
 
         h->slice_ctx[0].next_slice_idx = h->mb_width * h->mb_height;
 
-        ret = decode_slice(avctx, &h->slice_ctx[0]);
+        if (use_slice_pipeline(h))
+            ret = execute_slice_pipeline(h);
+        else
+            ret = decode_slice(avctx, &h->slice_ctx[0]);
         h->mb_y = h->slice_ctx[0].mb_y;
         return ret;
     } else {
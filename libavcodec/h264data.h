@@ -186,4 +186,22 @@ static const AVRational ff_h264_pixel_aspect[17] = {
     {   3,  2 },
     {   2,  1 },
 };
+
+/* CAVLC residual VLCs */
+extern const uint8_t ff_h264_chroma_dc_coeff_token_len[4*5];
+extern const uint8_t ff_h264_chroma_dc_coeff_token_bits[4*5];
+extern const uint8_t ff_h264_coeff_token_len[4][4*17];
+extern const uint8_t ff_h264_coeff_token_bits[4][4*17];
+extern const uint8_t ff_h264_total_zeros_len[16][16];
+extern const uint8_t ff_h264_total_zeros_bits[16][16];
+extern const uint8_t ff_h264_chroma_dc_total_zeros_len[3][4];
+extern const uint8_t ff_h264_chroma_dc_total_zeros_bits[3][4];
+extern const uint8_t ff_h264_run_len[7][16];
+extern const uint8_t ff_h264_run_bits[7][16];
+
+/* dequantization scales, indexed by qp % 6 */
+extern const uint8_t ff_h264_dequant4_coeff_init[6][3];
+extern const uint8_t ff_h264_dequant8_coeff_init_scan[16];
+extern const uint8_t ff_h264_dequant8_coeff_init[6][6];
+
 #endif /* AVCODEC_H264DATA_H */
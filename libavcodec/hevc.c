@@ -756,13 +756,10 @@ static int hls_slice_header(HEVCContext *s)
                 unsigned val = get_bits_long(gb, offset_len);
                 sh->entry_point_offset[i] = val + 1; // +1; // +1 to get the size
             }
-            if (s->threads_number > 1 && (s->ps.pps->num_tile_rows > 1 || s->ps.pps->num_tile_columns > 1)) {
-                s->enable_parallel_tiles = 0; // TODO: you can enable tiles in parallel here
-                s->threads_number = 1;
-            } else
-                s->enable_parallel_tiles = 0;
-        } else
-            s->enable_parallel_tiles = 0;
+            if (s->threads_number > 1 && s->ps.pps->entropy_coding_sync_enabled_flag &&
+                (s->ps.pps->num_tile_rows > 1 || s->ps.pps->num_tile_columns > 1))
+                s->threads_number = 1; // tiles combined with WPP are decoded serially
+        }
     }
 
     if (s->ps.pps->slice_header_extension_present_flag) {
@@ -2337,11 +2334,12 @@ static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
 
         ctb_addr_ts++;
         ff_hevc_save_states(s, ctb_addr_ts);
-        ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        if (!s->enable_parallel_tiles)
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
     }
 
     if (x_ctb + ctb_size >= s->ps.sps->width &&
-        y_ctb + ctb_size >= s->ps.sps->height)
+        y_ctb + ctb_size >= s->ps.sps->height && !s->enable_parallel_tiles)
         ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
 
     return ctb_addr_ts;
@@ -2433,35 +2431,45 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
     return 0;
 }
 
-static int hls_slice_data_wpp(HEVCContext *s, const HEVCNAL *nal)
+static int alloc_slice_thread_contexts(HEVCContext *s)
 {
-    const uint8_t *data = nal->data;
-    int length          = nal->size;
-    HEVCLocalContext *lc = s->HEVClc;
-    int *ret = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
-    int *arg = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
-    int offset;
-    int startheader, cmpt = 0;
-    int i, j, res = 0;
+    int i;
 
-    if (!ret || !arg) {
-        av_free(ret);
-        av_free(arg);
-        return AVERROR(ENOMEM);
+    for (i = 1; i < s->threads_number; i++) {
+        if (s->sList[i])
+            continue;
+        s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
+        if (!s->HEVClcList[i])
+            return AVERROR(ENOMEM);
+        s->sList[i] = av_malloc(sizeof(HEVCContext));
+        if (!s->sList[i])
+            return AVERROR(ENOMEM);
+        memcpy(s->sList[i], s, sizeof(HEVCContext));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
     }
+    return 0;
+}
 
+static void update_slice_thread_contexts(HEVCContext *s)
+{
+    int i;
 
-    if (!s->sList[1]) {
-        ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
-
-
-        for (i = 1; i < s->threads_number; i++) {
-            s->sList[i] = av_malloc(sizeof(HEVCContext));
-            memcpy(s->sList[i], s, sizeof(HEVCContext));
-            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
-            s->sList[i]->HEVClc = s->HEVClcList[i];
-        }
+    for (i = 1; i < s->threads_number; i++) {
+        memcpy(s->sList[i], s, sizeof(HEVCContext));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
     }
+}
+
+/**
+ * Locate the substreams of the slice data in the unescaped NAL payload.
+ */
+static void set_entry_points(HEVCContext *s, const HEVCNAL *nal)
+{
+    HEVCLocalContext *lc = s->HEVClc;
+    int length           = nal->size;
+    int offset;
+    int startheader, cmpt = 0;
+    int i, j;
 
     offset = (lc->gb.index >> 3);
 
@@ -2491,14 +2499,36 @@ static int hls_slice_data_wpp(HEVCContext *s, const HEVCNAL *nal)
         s->sh.offset[s->sh.num_entry_point_offsets - 1] = offset;
 
     }
-    s->data = data;
+    s->data = nal->data;
+}
+
+static int hls_slice_data_wpp(HEVCContext *s, const HEVCNAL *nal)
+{
+    int *ret, *arg;
+    int i, res = 0;
+
+    res = ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
+    if (res < 0)
+        return res;
+    res = alloc_slice_thread_contexts(s);
+    if (res < 0)
+        return res;
+
+    ret = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
+    arg = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
+    if (!ret || !arg) {
+        av_free(ret);
+        av_free(arg);
+        return AVERROR(ENOMEM);
+    }
+
+    set_entry_points(s, nal);
 
     for (i = 1; i < s->threads_number; i++) {
         s->sList[i]->HEVClc->first_qp_group = 1;
         s->sList[i]->HEVClc->qp_y = s->sList[0]->HEVClc->qp_y;
-        memcpy(s->sList[i], s, sizeof(HEVCContext));
-        s->sList[i]->HEVClc = s->HEVClcList[i];
     }
+    update_slice_thread_contexts(s);
 
     avpriv_atomic_int_set(&s->wpp_err, 0);
     ff_reset_entries(s->avctx);
@@ -2518,6 +2548,247 @@ static int hls_slice_data_wpp(HEVCContext *s, const HEVCNAL *nal)
     return res;
 }
 
+static int hls_decode_entry_tile(AVCodecContext *avctxt, void *input_ctb_addr_ts, int job, int self_id)
+{
+    HEVCContext *s1  = avctxt->priv_data, *s;
+    HEVCLocalContext *lc;
+    int more_data   = 1;
+    int *ctb_addr_ts_p = input_ctb_addr_ts;
+    int ctb_addr_ts = ctb_addr_ts_p[job];
+    int tile_id     = s1->ps.pps->tile_id[ctb_addr_ts];
+    int ret;
+
+    s  = s1->sList[self_id];
+    lc = s->HEVClc;
+
+    if (job) {
+        ret = init_get_bits8(&lc->gb, s->data + s->sh.offset[job - 1], s->sh.size[job - 1]);
+        if (ret < 0)
+            return ret;
+        ff_init_cabac_decoder(&lc->cc, s->data + s->sh.offset[job - 1], s->sh.size[job - 1]);
+    }
+
+    while (more_data && ctb_addr_ts < s->ps.sps->ctb_size &&
+           s->ps.pps->tile_id[ctb_addr_ts] == tile_id) {
+        int ctb_addr_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+        int x_ctb = (ctb_addr_rs % s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+        int y_ctb = (ctb_addr_rs / s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+
+        hls_decode_neighbour(s, x_ctb, y_ctb, ctb_addr_ts);
+
+        ff_hevc_cabac_init(s, ctb_addr_ts);
+
+        hls_sao_param(s, x_ctb >> s->ps.sps->log2_ctb_size, y_ctb >> s->ps.sps->log2_ctb_size);
+
+        s->deblock[ctb_addr_rs].beta_offset = s->sh.beta_offset;
+        s->deblock[ctb_addr_rs].tc_offset   = s->sh.tc_offset;
+        s->filter_slice_edges[ctb_addr_rs]  = s->sh.slice_loop_filter_across_slices_enabled_flag;
+
+        more_data = hls_coding_quadtree(s, x_ctb, y_ctb, s->ps.sps->log2_ctb_size, 0);
+        if (more_data < 0) {
+            s->tab_slice_address[ctb_addr_rs] = -1;
+            return more_data;
+        }
+
+        ctb_addr_ts++;
+    }
+
+    if (job == s->sh.num_entry_point_offsets)
+        s1->last_tile_thread = self_id;
+
+    return ctb_addr_ts;
+}
+
+/**
+ * Decode each tile of the slice segment in its own thread. The in-loop
+ * filters are left to hls_filter_picture(), and the deblocking edges
+ * between tiles are computed once all of them are decoded.
+ */
+static int hls_slice_data_tiles(HEVCContext *s, const HEVCNAL *nal)
+{
+    int nb_tiles    = s->sh.num_entry_point_offsets + 1;
+    int ctb_addr_ts = s->ps.pps->ctb_addr_rs_to_ts[s->sh.slice_ctb_addr_rs];
+    int start       = ctb_addr_ts;
+    int *ret, *arg;
+    int i, end, res;
+
+    if (!ctb_addr_ts && s->sh.dependent_slice_segment_flag) {
+        av_log(s->avctx, AV_LOG_ERROR, "Impossible initial tile.\n");
+        return AVERROR_INVALIDDATA;
+    }
+
+    if (s->sh.dependent_slice_segment_flag) {
+        int prev_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts - 1];
+        if (s->tab_slice_address[prev_rs] != s->sh.slice_addr) {
+            av_log(s->avctx, AV_LOG_ERROR, "Previous slice segment missing\n");
+            return AVERROR_INVALIDDATA;
+        }
+    }
+
+    res = alloc_slice_thread_contexts(s);
+    if (res < 0)
+        return res;
+
+    ret = av_malloc_array(nb_tiles, sizeof(int));
+    arg = av_malloc_array(nb_tiles, sizeof(int));
+    if (!ret || !arg) {
+        av_free(ret);
+        av_free(arg);
+        return AVERROR(ENOMEM);
+    }
+
+    /* every tile of a multi-tile slice segment belongs to it as a whole, so
+     * the slice address of all its CTBs is known before they are decoded */
+    arg[0] = ctb_addr_ts;
+    for (i = 1; ctb_addr_ts < s->ps.sps->ctb_size; ctb_addr_ts++) {
+        if (ctb_addr_ts > start &&
+            s->ps.pps->tile_id[ctb_addr_ts] != s->ps.pps->tile_id[ctb_addr_ts - 1]) {
+            if (i == nb_tiles)
+                break;
+            arg[i++] = ctb_addr_ts;
+        }
+        s->tab_slice_address[s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts]] = s->sh.slice_addr;
+    }
+    end = ctb_addr_ts;
+    if (i < nb_tiles) {
+        av_log(s->avctx, AV_LOG_ERROR, "More entry points than tiles in the slice.\n");
+        res = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    set_entry_points(s, nal);
+
+    /* the first tile may be picked up by any thread, and continues the
+     * CABAC state of the previous segment if it starts inside a tile */
+    for (i = 1; i < s->threads_number; i++) {
+        HEVCLocalContext *lc = s->HEVClcList[i];
+        lc->gb                 = s->HEVClc->gb;
+        memcpy(lc->cabac_state, s->HEVClc->cabac_state, HEVC_CONTEXTS);
+        memcpy(lc->stat_coeff,  s->HEVClc->stat_coeff,  sizeof(lc->stat_coeff));
+        lc->qp_y               = s->HEVClc->qp_y;
+        lc->qPy_pred           = s->HEVClc->qPy_pred;
+        lc->first_qp_group     = s->HEVClc->first_qp_group;
+        lc->end_of_tiles_x     = s->HEVClc->end_of_tiles_x;
+        lc->tu.cu_qp_offset_cb = s->HEVClc->tu.cu_qp_offset_cb;
+        lc->tu.cu_qp_offset_cr = s->HEVClc->tu.cu_qp_offset_cr;
+    }
+    update_slice_thread_contexts(s);
+
+    for (i = 0; i < nb_tiles; i++)
+        ret[i] = 0;
+
+    s->last_tile_thread = 0;
+    s->avctx->execute2(s->avctx, hls_decode_entry_tile, arg, ret, nb_tiles);
+
+    res = ret[nb_tiles - 1];
+    for (i = 0; i < nb_tiles; i++) {
+        if (ret[i] < 0) {
+            res = ret[i];
+            goto end;
+        }
+    }
+
+    /* a following dependent slice segment continues from the last tile */
+    if (s->last_tile_thread) {
+        HEVCLocalContext *lc = s->HEVClcList[s->last_tile_thread];
+        memcpy(s->HEVClc->cabac_state, lc->cabac_state, HEVC_CONTEXTS);
+        memcpy(s->HEVClc->stat_coeff,  lc->stat_coeff,  sizeof(lc->stat_coeff));
+        s->HEVClc->qp_y     = lc->qp_y;
+        s->HEVClc->qPy_pred = lc->qPy_pred;
+    }
+
+    if (!s->sh.disable_deblocking_filter_flag) {
+        for (ctb_addr_ts = start; ctb_addr_ts < end; ctb_addr_ts++) {
+            int ctb_addr_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+            ff_hevc_tile_boundary_strengths(s,
+                (ctb_addr_rs % s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size,
+                (ctb_addr_rs / s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size);
+        }
+    }
+
+end:
+    av_free(ret);
+    av_free(arg);
+    return res;
+}
+
+static int hls_filter_ctb_row(AVCodecContext *avctxt, void *arg, int ctb_row, int self_id)
+{
+    HEVCContext *s1 = avctxt->priv_data;
+    HEVCContext *s  = s1->sList[self_id];
+    int ctb_size    = 1 << s->ps.sps->log2_ctb_size;
+    int thread      = ctb_row % s->threads_number;
+    int x_ctb;
+
+    for (x_ctb = 0; x_ctb < s->ps.sps->ctb_width; x_ctb++) {
+        ff_thread_await_progress2(s->avctx, ctb_row, thread, SHIFT_CTB_WPP);
+        ff_hevc_hls_filter(s, x_ctb << s->ps.sps->log2_ctb_size,
+                           ctb_row << s->ps.sps->log2_ctb_size, ctb_size);
+        ff_thread_report_progress2(s->avctx, ctb_row, thread, 1);
+    }
+    ff_thread_report_progress2(s->avctx, ctb_row, thread, SHIFT_CTB_WPP);
+
+    return 0;
+}
+
+/**
+ * Check whether the in-loop filters give the same result in any order which
+ * filters every CTB after its left and upper neighbours.
+ *
+ * The horizontal chroma edges of a CTB are deblocked along with the CTB to
+ * its right, 8 chroma samples late. With 16x16 CTBs and subsampled chroma,
+ * the chroma column to the right of a CTB is therefore not final before the
+ * CTB two columns to the right is deblocked, and the SAO edge offset of the
+ * CTB reads it earlier than that.
+ */
+static int filter_order_independent(const HEVCContext *s)
+{
+    const HEVCSPS *sps = s->ps.sps;
+
+    return !sps->sao_enabled || !sps->chroma_format_idc ||
+           (1 << sps->log2_ctb_size) > (8 << sps->hshift[1]);
+}
+
+/**
+ * Run deblocking and SAO over the decoded picture.
+ *
+ * When the result does not depend on the filtering order, the CTB rows are
+ * filtered as a wavefront, CTB x of a row waiting for CTB x + 1 of the row
+ * above. Otherwise the CTBs are filtered in tile scan order, which is what
+ * the serial decoder does, so that the output stays identical to it.
+ */
+static int hls_filter_picture(HEVCContext *s)
+{
+    int ctb_size = 1 << s->ps.sps->log2_ctb_size;
+    int ret;
+
+    if (!filter_order_independent(s)) {
+        int ctb_addr_ts, x_ctb = 0, y_ctb = 0;
+
+        for (ctb_addr_ts = 0; ctb_addr_ts < s->ps.sps->ctb_size; ctb_addr_ts++) {
+            int ctb_addr_rs = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+            x_ctb = (ctb_addr_rs % s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+            y_ctb = (ctb_addr_rs / s->ps.sps->ctb_width) << s->ps.sps->log2_ctb_size;
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        }
+        ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+        return 0;
+    }
+
+    ret = alloc_slice_thread_contexts(s);
+    if (ret < 0)
+        return ret;
+    ret = ff_alloc_entries(s->avctx, s->ps.sps->ctb_height);
+    if (ret < 0)
+        return ret;
+
+    update_slice_thread_contexts(s);
+    ff_reset_entries(s->avctx);
+
+    s->avctx->execute2(s->avctx, hls_filter_ctb_row, NULL, NULL, s->ps.sps->ctb_height);
+    return 0;
+}
+
 static int set_side_data(HEVCContext *s)
 {
     AVFrame *out = s->ref->frame;
@@ -2586,6 +2857,10 @@ static int hevc_frame_start(HEVCContext *s)
     if (s->ps.pps->tiles_enabled_flag)
         lc->end_of_tiles_x = s->ps.pps->column_width[0] << s->ps.sps->log2_ctb_size;
 
+    s->enable_parallel_tiles = s->threads_number > 1 && !s->avctx->hwaccel &&
+                               s->ps.pps->tiles_enabled_flag &&
+                               !s->ps.pps->entropy_coding_sync_enabled_flag;
+
     ret = ff_hevc_set_new_ref(s, &s->frame, s->poc);
     if (ret < 0)
         goto fail;
@@ -2732,7 +3007,9 @@ static int decode_nal_unit(HEVCContext *s, const HEVCNAL *nal)
             if (ret < 0)
                 goto fail;
         } else {
-            if (s->threads_number > 1 && s->sh.num_entry_point_offsets > 0)
+            if (s->enable_parallel_tiles && s->sh.num_entry_point_offsets > 0)
+                ctb_addr_ts = hls_slice_data_tiles(s, nal);
+            else if (s->threads_number > 1 && s->sh.num_entry_point_offsets > 0)
                 ctb_addr_ts = hls_slice_data_wpp(s, nal);
             else
                 ctb_addr_ts = hls_slice_data(s);
@@ -2801,6 +3078,12 @@ static int decode_nal_units(HEVCContext *s, const uint8_t *buf, int length)
     }
 
 fail:
+    if (s->ref && s->enable_parallel_tiles) {
+        int err = hls_filter_picture(s);
+        if (err < 0 && ret >= 0)
+            ret = err;
+    }
+
     if (s->ref && s->threads_type == FF_THREAD_FRAME)
         ff_thread_report_progress(&s->ref->tf, INT_MAX, 0);
 
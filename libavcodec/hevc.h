@@ -827,6 +827,7 @@ typedef struct HEVCContext {
 
     uint8_t             threads_type;
     uint8_t             threads_number;
+    int                 last_tile_thread; ///< thread which decoded the last tile of the slice segment
 
     int                 width;
     int                 height;
@@ -901,6 +902,10 @@ typedef struct HEVCContext {
     uint16_t seq_decode;
     uint16_t seq_output;
 
+    /**
+     * The tiles of a slice are decoded in parallel and the in-loop filters
+     * run over the whole picture once it is decoded.
+     */
     int enable_parallel_tiles;
     int wpp_err;
 
@@ -1053,6 +1058,11 @@ void ff_hevc_set_qPy(HEVCContext *s, int xBase, int yBase,
                      int log2_cb_size);
 void ff_hevc_deblocking_boundary_strengths(HEVCContext *s, int x0, int y0,
                                            int log2_trafo_size);
+/**
+ * Compute the deblocking boundary strengths of the edges the CTB at x0, y0
+ * shares with another tile, once both tiles are decoded.
+ */
+void ff_hevc_tile_boundary_strengths(HEVCContext *s, int x0, int y0);
 int ff_hevc_cu_qp_delta_sign_flag(HEVCContext *s);
 int ff_hevc_cu_qp_delta_abs(HEVCContext *s);
 int ff_hevc_cu_chroma_qp_offset_flag(HEVCContext *s);
@@ -58,7 +58,8 @@ void ff_hevc_pred_init(HEVCPredContext *hpc, int bit_depth)
     hpc->pred_angular[0] = FUNC(pred_angular_0, depth); \
     hpc->pred_angular[1] = FUNC(pred_angular_1, depth); \
     hpc->pred_angular[2] = FUNC(pred_angular_2, depth); \
-    hpc->pred_angular[3] = FUNC(pred_angular_3, depth);
+    hpc->pred_angular[3] = FUNC(pred_angular_3, depth); \
+    hpc->filter_ref      = FUNC(filter_ref, depth);
 
     switch (bit_depth) {
     case 9:
@@ -77,4 +78,6 @@ void ff_hevc_pred_init(HEVCPredContext *hpc, int bit_depth)
 
     if (ARCH_MIPS)
         ff_hevc_pred_init_mips(hpc, bit_depth);
+    if (ARCH_X86)
+        ff_hevc_pred_init_x86(hpc, bit_depth);
 }
@@ -38,9 +38,17 @@ typedef struct HEVCPredContext {
     void (*pred_angular[4])(uint8_t *src, const uint8_t *top,
                             const uint8_t *left, ptrdiff_t stride,
                             int c_idx, int mode);
+    /**
+     * [1 2 1] filter of the reference samples: dst[i] = (src[i - 1] +
+     * 2 * src[i] + src[i + 1] + 2) >> 2 for 0 <= i < len.
+     * SIMD versions process len rounded up to a multiple of 32 bytes and
+     * read one more pixel past that from src.
+     */
+    void (*filter_ref)(uint8_t *dst, const uint8_t *src, int len);
 } HEVCPredContext;
 
 void ff_hevc_pred_init(HEVCPredContext *hpc, int bit_depth);
 void ff_hevc_pred_init_mips(HEVCPredContext *hpc, int bit_depth);
+void ff_hevc_pred_init_x86(HEVCPredContext *hpc, int bit_depth);
 
 #endif /* AVCODEC_HEVCPRED_H */
@@ -94,10 +94,10 @@ do {                                  \
     enum IntraPredMode mode = c_idx ? lc->tu.intra_pred_mode_c :
                               lc->tu.intra_pred_mode;
     pixel4 a;
-    pixel  left_array[2 * MAX_TB_SIZE + 1];
-    pixel  filtered_left_array[2 * MAX_TB_SIZE + 1];
-    pixel  top_array[2 * MAX_TB_SIZE + 1];
-    pixel  filtered_top_array[2 * MAX_TB_SIZE + 1];
+    pixel  left_array[2 * MAX_TB_SIZE + 2];
+    pixel  filtered_left_array[2 * MAX_TB_SIZE + 2];
+    pixel  top_array[2 * MAX_TB_SIZE + 2];
+    pixel  filtered_top_array[2 * MAX_TB_SIZE + 2];
 
     pixel  *left          = left_array + 1;
     pixel  *top           = top_array  + 1;
@@ -310,16 +310,14 @@ do {                                  \
                                    (i + 1)  * left[63] + 32) >> 6;
                     top = filtered_top;
                 } else {
+                    s->hpc.filter_ref((uint8_t *)filtered_left, (uint8_t *)left,
+                                      2 * size - 1);
+                    s->hpc.filter_ref((uint8_t *)filtered_top, (uint8_t *)top,
+                                      2 * size - 1);
                     filtered_left[2 * size - 1] = left[2 * size - 1];
                     filtered_top[2 * size - 1]  = top[2 * size - 1];
-                    for (i = 2 * size - 2; i >= 0; i--)
-                        filtered_left[i] = (left[i + 1] + 2 * left[i] +
-                                            left[i - 1] + 2) >> 2;
                     filtered_top[-1]  =
                     filtered_left[-1] = (left[0] + 2 * left[-1] + top[0] + 2) >> 2;
-                    for (i = 2 * size - 2; i >= 0; i--)
-                        filtered_top[i] = (top[i + 1] + 2 * top[i] +
-                                           top[i - 1] + 2) >> 2;
                     left = filtered_left;
                     top  = filtered_top;
                 }
@@ -386,6 +384,16 @@ PRED_PLANAR(3)
 
 #undef PRED_PLANAR
 
+static void FUNC(filter_ref)(uint8_t *_dst, const uint8_t *_src, int len)
+{
+    pixel *dst       = (pixel *)_dst;
+    const pixel *src = (const pixel *)_src;
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = (src[i - 1] + 2 * src[i] + src[i + 1] + 2) >> 2;
+}
+
 static void FUNC(pred_dc)(uint8_t *_src, const uint8_t *_top,
                           const uint8_t *_left,
                           ptrdiff_t stride, int log2_size, int c_idx)
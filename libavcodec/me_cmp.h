@@ -50,6 +50,12 @@ typedef int (*me_cmp_func)(struct MpegEncContext *c,
                            uint8_t *blk2 /* align 1 */, ptrdiff_t stride,
                            int h);
 
+/* SAD of blk1 against 4 candidate blocks, scores[i] is what sad[] would
+ * return for blk2[i]. */
+typedef void (*me_cmp_x4_func)(uint8_t *blk1 /* align width (8 or 16) */,
+                               uint8_t *const blk2[4] /* align 1 */,
+                               ptrdiff_t stride, int h, int scores[4]);
+
 typedef struct MECmpContext {
     int (*sum_abs_dctelem)(int16_t *block /* align 16 */);
 
@@ -76,6 +82,12 @@ typedef struct MECmpContext {
     me_cmp_func frame_skip_cmp[6]; // only width 8 used
 
     me_cmp_func pix_abs[2][4];
+
+    /**
+     * Multi candidate version of sad[0..1] for the full-pel ME searches.
+     * Only set where it is faster than 4 sad[] calls, NULL otherwise.
+     */
+    me_cmp_x4_func sad_x4[2];
 } MECmpContext;
 
 void ff_me_cmp_init_static(void);
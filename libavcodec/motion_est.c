@@ -901,6 +901,15 @@ static inline int get_penalty_factor(int lambda, int lambda2, int type){
     }
 }
 
+void ff_me_init_penalty_factors(MpegEncContext *s)
+{
+    MotionEstContext * const c = &s->me;
+
+    c->penalty_factor    = get_penalty_factor(s->lambda, s->lambda2, c->avctx->me_cmp);
+    c->sub_penalty_factor= get_penalty_factor(s->lambda, s->lambda2, c->avctx->me_sub_cmp);
+    c->mb_penalty_factor = get_penalty_factor(s->lambda, s->lambda2, c->avctx->mb_cmp);
+}
+
 void ff_estimate_p_frame_motion(MpegEncContext * s,
                                 int mb_x, int mb_y)
 {
@@ -104,6 +104,13 @@ static inline int ff_h263_round_chroma(int x)
 
 int ff_init_me(struct MpegEncContext *s);
 
+/**
+ * Set the penalty factors for the current lambda.
+ * The B-frame ME starts from the ones left behind by the previous MB, so a
+ * context that does not begin at the first MB of the picture needs this.
+ */
+void ff_me_init_penalty_factors(struct MpegEncContext *s);
+
 void ff_estimate_p_frame_motion(struct MpegEncContext *s, int mb_x, int mb_y);
 void ff_estimate_b_frame_motion(struct MpegEncContext *s, int mb_x, int mb_y);
 
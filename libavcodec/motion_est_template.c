@@ -411,12 +411,87 @@ if( (y)>(ymax<<(S)) ) av_log(NULL, AV_LOG_ERROR, "%d %d %d %d %d ymax" #v, ymax,
     const int qpel= flags&FLAG_QPEL;\
     const int shift= 1+qpel;\
 
+/**
+ * Return the multi candidate SAD to use for the full-pel searches, or NULL if
+ * the candidates have to be checked one by one with cmpf.
+ */
+static av_always_inline me_cmp_x4_func get_sad_x4(MpegEncContext *s, me_cmp_func cmpf,
+                                                  int size, int flags)
+{
+    if (flags & (FLAG_CHROMA | FLAG_DIRECT) || cmpf != s->mecc.sad[size])
+        return NULL;
+    return s->mecc.sad_x4[size];
+}
+
+/**
+ * Check n (at most 4) full-pel candidates with a single sad_x4() call.
+ * The map, score_map and best vector are updated in candidate order, so the
+ * outcome is identical to running CHECK_MV on each of them in turn.
+ * @return index of the last candidate that improved dmin, -1 if none did
+ */
+static av_always_inline int check_mv_x4(MpegEncContext *s, me_cmp_x4_func sad_x4,
+                                        me_cmp_func cmpf, int cand[][2], int n,
+                                        int *best, int *dmin, int src_index, int ref_index,
+                                        int penalty_factor, int size, int h, int shift)
+{
+    MotionEstContext * const c= &s->me;
+    uint32_t * const map= c->map;
+    uint32_t * const score_map= c->score_map;
+    uint8_t * const mv_penalty= c->current_mv_penalty;
+    const unsigned map_generation = c->map_generation;
+    const int stride= c->stride;
+    uint8_t * const ref= c->ref[ref_index][0];
+    uint8_t * const src= c->src[src_index][0];
+    uint8_t *blk[4];
+    int idx[4], scores[4];
+    int i, k = 0, ret = -1;
+
+    for (i = 0; i < n; i++) {
+        const int x= cand[i][0];
+        const int y= cand[i][1];
+        const unsigned key = ((unsigned)y<<ME_MAP_MV_BITS) + x + map_generation;
+        const int index= (((unsigned)y<<ME_MAP_SHIFT) + x)&(ME_MAP_SIZE-1);
+        av_assert2(x >= c->xmin && x <= c->xmax && y >= c->ymin && y <= c->ymax);
+        if (map[index] != key) {
+            map[index] = key;
+            blk[k]     = ref + x + y*stride;
+            idx[k++]   = i;
+        }
+    }
+
+    if (k == 1) {
+        scores[0] = cmpf(s, src, blk[0], stride, h);
+    } else if (k > 1) {
+        for (i = k; i < 4; i++)
+            blk[i] = blk[0];
+        sad_x4(src, blk, stride, h, scores);
+    }
+
+    for (i = 0; i < k; i++) {
+        const int x= cand[idx[i]][0];
+        const int y= cand[idx[i]][1];
+        const int index= (((unsigned)y<<ME_MAP_SHIFT) + x)&(ME_MAP_SIZE-1);
+        int d = scores[i];
+
+        score_map[index]= d;
+        d += (mv_penalty[x*(1<<shift) - c->pred_x] + mv_penalty[y*(1<<shift) - c->pred_y])*penalty_factor;
+        if (d < *dmin) {
+            best[0]= x;
+            best[1]= y;
+            *dmin  = d;
+            ret    = idx[i];
+        }
+    }
+    return ret;
+}
+
 static av_always_inline int small_diamond_search(MpegEncContext * s, int *best, int dmin,
                                        int src_index, int ref_index, int const penalty_factor,
                                        int size, int h, int flags)
 {
     MotionEstContext * const c= &s->me;
     me_cmp_func cmpf, chroma_cmpf;
+    me_cmp_x4_func sad_x4;
     int next_dir=-1;
     LOAD_COMMON
     LOAD_COMMON2
@@ -434,6 +509,30 @@ static av_always_inline int small_diamond_search(MpegEncContext * s, int *best,
         }
     }
 
+    sad_x4 = get_sad_x4(s, cmpf, size, flags);
+    if (sad_x4) {
+        for(;;){
+            int cand[4][2], dirs[4];
+            int n = 0, i;
+            const int dir= next_dir;
+            const int x= best[0];
+            const int y= best[1];
+
+#define ADD_CAND(cx, cy, new_dir) cand[n][0] = cx; cand[n][1] = cy; dirs[n++] = new_dir;
+            if(dir!=2 && x>xmin) { ADD_CAND(x-1, y  , 0) }
+            if(dir!=3 && y>ymin) { ADD_CAND(x  , y-1, 1) }
+            if(dir!=0 && x<xmax) { ADD_CAND(x+1, y  , 2) }
+            if(dir!=1 && y<ymax) { ADD_CAND(x  , y+1, 3) }
+#undef ADD_CAND
+
+            i = check_mv_x4(s, sad_x4, cmpf, cand, n, best, &dmin, src_index, ref_index,
+                            penalty_factor, size, h, shift);
+            if (i < 0)
+                return dmin;
+            next_dir = dirs[i];
+        }
+    }
+
     for(;;){
         int d;
         const int dir= next_dir;
@@ -500,6 +599,7 @@ static int hex_search(MpegEncContext * s, int *best, int dmin,
 {
     MotionEstContext * const c= &s->me;
     me_cmp_func cmpf, chroma_cmpf;
+    me_cmp_x4_func sad_x4;
     LOAD_COMMON
     LOAD_COMMON2
     unsigned map_generation = c->map_generation;
@@ -509,6 +609,32 @@ static int hex_search(MpegEncContext * s, int *best, int dmin,
     cmpf        = s->mecc.me_cmp[size];
     chroma_cmpf = s->mecc.me_cmp[size + 1];
 
+    sad_x4 = get_sad_x4(s, cmpf, size, flags);
+    if (sad_x4) {
+        for(;dia_size; dia_size= dec ? dia_size-1 : dia_size>>1){
+            do{
+                int cand[6][2];
+                x= best[0];
+                y= best[1];
+
+#define SET_CAND(i, ax, ay) cand[i][0] = FFMAX(xmin, FFMIN(ax, xmax)); cand[i][1] = FFMAX(ymin, FFMIN(ay, ymax));
+                SET_CAND(0, x  -dia_size    , y);
+                SET_CAND(1, x+  dia_size    , y);
+                SET_CAND(2, x+( dia_size>>1), y+dia_size);
+                SET_CAND(3, x+( dia_size>>1), y-dia_size);
+                SET_CAND(4, x+(-dia_size>>1), y+dia_size);
+                SET_CAND(5, x+(-dia_size>>1), y-dia_size);
+#undef SET_CAND
+                check_mv_x4(s, sad_x4, cmpf, cand, 4, best, &dmin, src_index, ref_index,
+                            penalty_factor, size, h, shift);
+                if(dia_size>1)
+                    check_mv_x4(s, sad_x4, cmpf, cand + 4, 2, best, &dmin, src_index, ref_index,
+                                penalty_factor, size, h, shift);
+            }while(best[0] != x || best[1] != y);
+        }
+        return dmin;
+    }
+
     for(;dia_size; dia_size= dec ? dia_size-1 : dia_size>>1){
         do{
             x= best[0];
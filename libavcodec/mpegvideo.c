@@ -638,6 +638,7 @@ void ff_mpv_common_defaults(MpegEncContext *s)
     s->b_code                = 1;
 
     s->slice_context_count   = 1;
+    s->me_context_count      = 1;
 }
 
 /**
@@ -868,9 +869,10 @@ static void clear_context(MpegEncContext *s)
 av_cold int ff_mpv_common_init(MpegEncContext *s)
 {
     int i;
-    int nb_slices = (HAVE_THREADS &&
-                     s->avctx->active_thread_type & FF_THREAD_SLICE) ?
-                    s->avctx->thread_count : 1;
+    int nb_threads = (HAVE_THREADS &&
+                      s->avctx->active_thread_type & FF_THREAD_SLICE) ?
+                     s->avctx->thread_count : 1;
+    int nb_slices = nb_threads, nb_contexts;
 
     clear_context(s);
 
@@ -899,6 +901,14 @@ av_cold int ff_mpv_common_init(MpegEncContext *s)
         nb_slices = max_slices;
     }
 
+    /* The wavefront motion estimation needs one context per slice thread
+     * but codes the picture as a single slice. */
+    nb_contexts = nb_slices;
+    if (s->encoding && s->me_wavefront && nb_threads > 1) {
+        nb_slices   = 1;
+        nb_contexts = FFMIN(nb_threads, s->mb_height);
+    }
+
     if ((s->width || s->height) &&
         av_image_check_size(s->width, s->height, 0, s->avctx))
         return -1;
@@ -941,8 +951,8 @@ av_cold int ff_mpv_common_init(MpegEncContext *s)
         s->thread_context[0]   = s;
 
 //     if (s->width && s->height) {
-        if (nb_slices > 1) {
-            for (i = 0; i < nb_slices; i++) {
+        if (nb_contexts > 1) {
+            for (i = 0; i < nb_contexts; i++) {
                 if (i) {
                     s->thread_context[i] = av_memdup(s, sizeof(MpegEncContext));
                     if (!s->thread_context[i])
@@ -950,10 +960,15 @@ av_cold int ff_mpv_common_init(MpegEncContext *s)
                 }
                 if (init_duplicate_context(s->thread_context[i]) < 0)
                     goto fail;
+                if (i < nb_slices) {
                     s->thread_context[i]->start_mb_y =
                         (s->mb_height * (i) + nb_slices / 2) / nb_slices;
                     s->thread_context[i]->end_mb_y   =
                         (s->mb_height * (i + 1) + nb_slices / 2) / nb_slices;
+                } else {
+                    s->thread_context[i]->start_mb_y = 0;
+                    s->thread_context[i]->end_mb_y   = s->mb_height;
+                }
             }
         } else {
             if (init_duplicate_context(s) < 0)
@@ -962,6 +977,7 @@ av_cold int ff_mpv_common_init(MpegEncContext *s)
             s->end_mb_y   = s->mb_height;
         }
         s->slice_context_count = nb_slices;
+        s->me_context_count    = nb_contexts;
 //     }
 
     return 0;
@@ -1110,14 +1126,15 @@ void ff_mpv_common_end(MpegEncContext *s)
     if (!s)
         return ;
 
-    if (s->slice_context_count > 1) {
-        for (i = 0; i < s->slice_context_count; i++) {
+    if (s->me_context_count > 1) {
+        for (i = 0; i < s->me_context_count; i++) {
             free_duplicate_context(s->thread_context[i]);
         }
-        for (i = 1; i < s->slice_context_count; i++) {
+        for (i = 1; i < s->me_context_count; i++) {
             av_freep(&s->thread_context[i]);
         }
         s->slice_context_count = 1;
+        s->me_context_count    = 1;
     } else free_duplicate_context(s);
 
     av_freep(&s->parse_context.buffer);
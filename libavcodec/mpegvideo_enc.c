@@ -664,10 +664,21 @@ FF_ENABLE_DEPRECATION_WARNINGS
         return -1;
     }
 
-    if (s->avctx->slices > 1 || s->avctx->thread_count > 1)
+    if (s->me_wavefront &&
+        (s->avctx->slices > 1 || s->avctx->thread_count > MAX_THREADS)) {
+        av_log(avctx, AV_LOG_WARNING,
+               "me_wavefront requires a single slice and at most %d threads, "
+               "disabling it\n", MAX_THREADS);
+        s->me_wavefront = 0;
+    }
+    if (s->avctx->thread_count <= 1)
+        s->me_wavefront = 0;
+
+    if (s->avctx->slices > 1 || (s->avctx->thread_count > 1 && !s->me_wavefront))
         s->rtp_mode = 1;
 
-    if (s->avctx->thread_count > 1 && s->codec_id == AV_CODEC_ID_H263P)
+    if (s->avctx->thread_count > 1 && !s->me_wavefront &&
+        s->codec_id == AV_CODEC_ID_H263P)
         s->h263_slice_structured = 1;
 
     if (!avctx->time_base.den || !avctx->time_base.num) {
@@ -2685,6 +2696,105 @@ static int estimate_motion_thread(AVCodecContext *c, void *arg){
     return 0;
 }
 
+/**
+ * Pre-pass ME of one MB row in wavefront order; the pre-pass scans the
+ * picture bottom-up, so job n handles row mb_height - 1 - n and waits on
+ * the row below it.
+ */
+static int pre_estimate_motion_row(AVCodecContext *c, void *arg,
+                                   int jobnr, int threadnr)
+{
+    MpegEncContext *s = ((MpegEncContext **)arg)[threadnr];
+    const int thread  = jobnr % c->thread_count;
+
+    s->me.pre_pass      = 1;
+    s->me.dia_size      = s->avctx->pre_dia_size;
+    s->first_slice_line = !jobnr;
+    s->mb_y             = s->mb_height - 1 - jobnr;
+    for (s->mb_x = s->mb_width - 1; s->mb_x >= 0; s->mb_x--) {
+        /* the predictors are the right, below and below left neighbours */
+        ff_thread_await_progress2(c, jobnr, thread, 2);
+        ff_pre_estimate_p_frame_motion(s, s->mb_x, s->mb_y);
+        ff_thread_report_progress2(c, jobnr, thread, 1);
+    }
+    ff_thread_report_progress2(c, jobnr, thread, 1);
+
+    s->me.pre_pass = 0;
+
+    return 0;
+}
+
+/**
+ * ME of one MB row in wavefront order, the row above has to be done up to
+ * the top right neighbour of the current MB.
+ * Reading the not yet updated MVs of the row below, as the EPZS
+ * predictors do, is safe as it is always at least 2 MBs behind.
+ */
+static int estimate_motion_row(AVCodecContext *c, void *arg,
+                               int jobnr, int threadnr)
+{
+    MpegEncContext *s = ((MpegEncContext **)arg)[threadnr];
+    const int thread  = jobnr % c->thread_count;
+
+    ff_check_alignment();
+
+    s->me.dia_size      = s->avctx->dia_size;
+    s->first_slice_line = !jobnr;
+    s->mb_y             = jobnr;
+    s->mb_x             = 0; //for block init below
+    ff_init_block_index(s);
+    for (s->mb_x = 0; s->mb_x < s->mb_width; s->mb_x++) {
+        s->block_index[0] += 2;
+        s->block_index[1] += 2;
+        s->block_index[2] += 2;
+        s->block_index[3] += 2;
+
+        ff_thread_await_progress2(c, jobnr, thread, 2);
+        if (s->pict_type == AV_PICTURE_TYPE_B)
+            ff_estimate_b_frame_motion(s, s->mb_x, s->mb_y);
+        else
+            ff_estimate_p_frame_motion(s, s->mb_x, s->mb_y);
+        ff_thread_report_progress2(c, jobnr, thread, 1);
+    }
+    ff_thread_report_progress2(c, jobnr, thread, 1);
+
+    return 0;
+}
+
+/**
+ * Run the motion estimation of the whole picture over all ME contexts,
+ * one MB row per job, while the picture is still coded as a single slice.
+ * The MVs are identical to single threaded ME.
+ */
+static int estimate_motion_wavefront(MpegEncContext *s, int pre_pass)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, ret;
+
+    for (i = 1; i < s->me_context_count; i++) {
+        ret = ff_update_duplicate_context(s->thread_context[i], s);
+        if (ret < 0)
+            return ret;
+        ff_me_init_penalty_factors(s->thread_context[i]);
+    }
+
+    ret = ff_alloc_entries(avctx, s->mb_height);
+    if (ret < 0)
+        return ret;
+
+    if (pre_pass) {
+        ff_reset_entries(avctx);
+        avctx->execute2(avctx, pre_estimate_motion_row, s->thread_context,
+                        NULL, s->mb_height);
+    }
+
+    ff_reset_entries(avctx);
+    avctx->execute2(avctx, estimate_motion_row, s->thread_context,
+                    NULL, s->mb_height);
+
+    return 0;
+}
+
 static int mb_var_thread(AVCodecContext *c, void *arg){
     MpegEncContext *s= *(void**)arg;
     int mb_x, mb_y;
@@ -3536,6 +3646,7 @@ static int encode_picture(MpegEncContext *s, int picture_number)
     int i, ret;
     int bits;
     int context_count = s->slice_context_count;
+    int me_context_count = context_count;
 
     s->picture_number = picture_number;
 
@@ -3595,13 +3706,25 @@ static int encode_picture(MpegEncContext *s, int picture_number)
     if(s->pict_type != AV_PICTURE_TYPE_I){
         s->lambda = (s->lambda * s->avctx->me_penalty_compensation + 128)>>8;
         s->lambda2= (s->lambda2* (int64_t)s->avctx->me_penalty_compensation + 128)>>8;
-        if (s->pict_type != AV_PICTURE_TYPE_B) {
-            if((s->avctx->pre_me && s->last_non_b_pict_type==AV_PICTURE_TYPE_I) || s->avctx->pre_me==2){
-                s->avctx->execute(s->avctx, pre_estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+        /* the last frame predictors reach further than the wavefront */
+        if (s->me_context_count > context_count && !s->avctx->last_predictor_count) {
+            int pre_pass = s->pict_type != AV_PICTURE_TYPE_B &&
+                           ((s->avctx->pre_me && s->last_non_b_pict_type == AV_PICTURE_TYPE_I) ||
+                            s->avctx->pre_me == 2);
+
+            me_context_count = s->me_context_count;
+            ret = estimate_motion_wavefront(s, pre_pass);
+            if (ret < 0)
+                return ret;
+        } else {
+            if (s->pict_type != AV_PICTURE_TYPE_B) {
+                if((s->avctx->pre_me && s->last_non_b_pict_type==AV_PICTURE_TYPE_I) || s->avctx->pre_me==2){
+                    s->avctx->execute(s->avctx, pre_estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+                }
             }
-        }
 
-        s->avctx->execute(s->avctx, estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+            s->avctx->execute(s->avctx, estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
+        }
     }else /* if(s->pict_type == AV_PICTURE_TYPE_I) */{
         /* I-Frame */
         for(i=0; i<s->mb_stride*s->mb_height; i++)
@@ -3612,7 +3735,7 @@ static int encode_picture(MpegEncContext *s, int picture_number)
             s->avctx->execute(s->avctx, mb_var_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
         }
     }
-    for(i=1; i<context_count; i++){
+    for(i=1; i<me_context_count; i++){
         merge_context_after_me(s, s->thread_context[i]);
     }
     s->current_picture.mc_mb_var_sum= s->current_picture_ptr->mc_mb_var_sum= s->me.mc_mb_var_sum_temp;
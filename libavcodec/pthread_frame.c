@@ -118,6 +118,7 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+    int nb_in_flight;              ///< Packets whose frame was not returned yet, with low_delay_threads.
 
     int die;                       ///< Set when threads should exit.
 } FrameThreadContext;
@@ -428,16 +429,37 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
     if (err) return err;
 
     /*
-     * If we're still receiving the initial packets, don't return a frame.
+     * In low delay mode, return the oldest frame as soon as its thread is
+     * done, and only wait for it when every thread holds a frame that was
+     * not returned yet. Otherwise, if we're still receiving the initial
+     * packets, don't return a frame.
      */
 
-    if (fctx->next_decoding > (avctx->thread_count-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
-        fctx->delaying = 0;
+    if (avctx->flags2 & AV_CODEC_FLAG2_LOW_DELAY_THREADS && avpkt->size) {
+        if (++fctx->nb_in_flight < avctx->thread_count) {
+            int done;
 
-    if (fctx->delaying) {
-        *got_picture_ptr=0;
-        if (avpkt->size)
-            return avpkt->size;
+            p = &fctx->threads[finished];
+            pthread_mutex_lock(&p->progress_mutex);
+            done = p->state == STATE_INPUT_READY;
+            pthread_mutex_unlock(&p->progress_mutex);
+
+            if (!done) {
+                *got_picture_ptr = 0;
+                if (fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
+                return avpkt->size;
+            }
+        }
+        fctx->nb_in_flight--;
+    } else {
+        if (fctx->next_decoding > (avctx->thread_count-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
+            fctx->delaying = 0;
+
+        if (fctx->delaying) {
+            *got_picture_ptr=0;
+            if (avpkt->size)
+                return avpkt->size;
+        }
     }
 
     /*
@@ -756,6 +778,7 @@ void ff_thread_flush(AVCodecContext *avctx)
 
     fctx->next_decoding = fctx->next_finished = 0;
     fctx->delaying = 1;
+    fctx->nb_in_flight = 0;
     fctx->prev_thread = NULL;
     for (i = 0; i < avctx->thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
@@ -277,23 +277,38 @@ int ff_alloc_entries(AVCodecContext *avctx, int count)
 
     if (avctx->active_thread_type & FF_THREAD_SLICE)  {
         SliceThreadContext *p = avctx->internal->thread_ctx;
-        p->thread_count  = avctx->thread_count;
-        p->entries       = av_mallocz_array(count, sizeof(int));
 
-        p->progress_mutex = av_malloc_array(p->thread_count, sizeof(pthread_mutex_t));
-        p->progress_cond  = av_malloc_array(p->thread_count, sizeof(pthread_cond_t));
-
-        if (!p->entries || !p->progress_mutex || !p->progress_cond) {
+        /* the progress locks are kept across calls, only the entries
+         * are reallocated */
+        if (p->entries) {
+            if (count <= p->entries_count)
+                return 0;
             av_freep(&p->entries);
-            av_freep(&p->progress_mutex);
-            av_freep(&p->progress_cond);
-            return AVERROR(ENOMEM);
+            p->entries_count = 0;
         }
-        p->entries_count  = count;
+        p->entries = av_mallocz_array(count, sizeof(int));
+        if (!p->entries)
+            return AVERROR(ENOMEM);
+        p->entries_count = count;
+
+        if (!p->progress_mutex) {
+            p->thread_count   = avctx->thread_count;
+            p->progress_mutex = av_malloc_array(p->thread_count, sizeof(pthread_mutex_t));
+            p->progress_cond  = av_malloc_array(p->thread_count, sizeof(pthread_cond_t));
+
+            if (!p->progress_mutex || !p->progress_cond) {
+                av_freep(&p->entries);
+                av_freep(&p->progress_mutex);
+                av_freep(&p->progress_cond);
+                p->entries_count = 0;
+                p->thread_count  = 0;
+                return AVERROR(ENOMEM);
+            }
 
-        for (i = 0; i < p->thread_count; i++) {
-            pthread_mutex_init(&p->progress_mutex[i], NULL);
-            pthread_cond_init(&p->progress_cond[i], NULL);
+            for (i = 0; i < p->thread_count; i++) {
+                pthread_mutex_init(&p->progress_mutex[i], NULL);
+                pthread_cond_init(&p->progress_cond[i], NULL);
+            }
         }
     }
 
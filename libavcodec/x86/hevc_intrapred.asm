@@ -0,0 +1,992 @@
+;******************************************************************************
+;* SIMD optimized intra prediction functions for HEVC decoding
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_planar_dec:    dw 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16
+                  dw 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0
+pw_planar_inc:    dw  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16
+                  dw 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32
+pw_m1_1:          times 16 dw -1, 1
+pw_4095:          times 16 dw 4095
+pd_4:             times 4 dd 4
+pd_8:             times 4 dd 8
+pd_16:            times 4 dd 16
+pd_32:            times 4 dd 32
+pb_transpose4x4:  db 0, 4,  8, 12, 1, 5,  9, 13, 2,  6, 10, 14, 3,  7, 11, 15
+pb_transpose4x4w: db 0, 1,  8,  9, 2, 3, 10, 11, 4,  5, 12, 13, 6,  7, 14, 15
+
+; intraPredAngle and invAngle of the vertical modes 18..34
+pb_angle:         db -32, -26, -21, -17, -13,  -9,  -5,  -2,   0,   2,   5,   9,  13,  17,  21,  26,  32
+pw_inv_angle:     dw -256, -315, -390, -482, -630, -910, -1638, -4096
+
+cextern pb_1
+cextern pw_1
+cextern pw_2
+cextern pw_3
+cextern pw_512
+cextern pw_1023
+cextern pw_1024
+cextern pw_2048
+cextern pw_4096
+
+SECTION .text
+
+%if ARCH_X86_64
+
+;------------------------------------------------------------------------------
+; void ff_hevc_filter_ref(uint8_t *dst, const uint8_t *src, int len)
+;
+; [1 2 1] smoothing of the reference samples: dst[i] = (src[i - 1] +
+; 2 * src[i] + src[i + 1] + 2) >> 2 for 0 <= i < len. The length is rounded
+; up to a multiple of mmsize bytes.
+;------------------------------------------------------------------------------
+
+; dst, left, right, center, tmp; exact (l + 2 * c + r + 2) >> 2 on bytes
+%macro LOWPASS 5
+    pavgb              %5, %2, %3
+    pxor               %3, %2
+    pand               %3, [pb_1]
+    psubusb            %5, %3
+    pavgb              %1, %4, %5
+%endmacro
+
+%macro FILTER_REF_8 0
+cglobal hevc_filter_ref_8, 3, 4, 5, dst, src, len, x
+    movsxd           lenq, lend
+    xor                xq, xq
+.loop:
+    movu               m0, [srcq+xq-1]
+    movu               m1, [srcq+xq+1]
+    movu               m2, [srcq+xq]
+    LOWPASS            m3, m0, m1, m2, m4
+    movu       [dstq+xq], m3
+    add                xq, mmsize
+    cmp                xq, lenq
+    jl .loop
+    RET
+%endmacro
+
+%macro FILTER_REF_16 0
+cglobal hevc_filter_ref_16, 3, 4, 4, dst, src, len, x
+    movsxd           lenq, lend
+    add              lenq, lenq
+    xor                xq, xq
+    mova               m3, [pw_2]
+.loop:
+    movu               m0, [srcq+xq-2]
+    movu               m1, [srcq+xq+2]
+    movu               m2, [srcq+xq]
+    paddw              m0, m1
+    paddw              m2, m2
+    paddw              m0, m3
+    paddw              m0, m2
+    psrlw              m0, 2
+    movu       [dstq+xq], m0
+    add                xq, mmsize
+    cmp                xq, lenq
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+FILTER_REF_8
+FILTER_REF_16
+INIT_YMM avx2
+FILTER_REF_8
+FILTER_REF_16
+
+;------------------------------------------------------------------------------
+; void ff_hevc_pred_planar_NxN(uint8_t *src, const uint8_t *top,
+;                              const uint8_t *left, ptrdiff_t stride)
+;------------------------------------------------------------------------------
+
+; The 8-bit version works on words: every row adds (size - 1 - x) * left[y]
+; to a per column sum that steps by left[size] - top[x] from row to row.
+%macro PRED_PLANAR_8 2 ; size, log2 size
+%if %1 * 2 < mmsize
+    %assign cw %1
+%else
+    %assign cw mmsize / 2
+%endif
+%assign chunks %1 / cw
+cglobal hevc_pred_planar_%1x%1_8, 4, 6, 16, src, top, left, stride, y, tmp
+    movzx            tmpd, byte [topq+%1]
+    movd             xm12, tmpd
+    SPLATW           m12, xm12                       ; top[size]
+    movzx            tmpd, byte [leftq+%1]
+    movd             xm13, tmpd
+    SPLATW           m13, xm13                       ; left[size]
+    add              tmpd, %1
+    movd             xm14, tmpd
+    SPLATW           m14, xm14                       ; left[size] + size
+%assign c 0
+%rep chunks
+    %assign r c + 4
+    %assign w c + 8
+    pmovzxbw         m15, [topq+c*cw]
+    psubw          m %+ r, m13, m15                  ; left[size] - top[x]
+    psllw          m %+ w, m15, %2
+    psubw          m %+ w, m15                       ; (size - 1) * top[x]
+    movu           m %+ c, [pw_planar_inc+c*cw*2]
+    pmullw         m %+ c, m12
+    paddw          m %+ c, m %+ w
+    paddw          m %+ c, m14
+    movu           m %+ w, [pw_planar_dec+(32-%1)*2+c*cw*2]
+    %assign c c+1
+%endrep
+    xor                yq, yq
+.loop:
+    movzx            tmpd, byte [leftq+yq]
+    movd             xm15, tmpd
+    SPLATW           m15, xm15
+%assign c 0
+%rep chunks
+    %assign r c + 4
+    %assign w c + 8
+    %assign o c + 12
+    pmullw         m %+ o, m15, m %+ w
+    paddw          m %+ o, m %+ c
+    psrlw          m %+ o, %2 + 1
+    paddw          m %+ c, m %+ r
+    %assign c c+1
+%endrep
+%if chunks == 1
+    packuswb         m12, m12
+%if mmsize == 32
+    vpermq           m12, m12, q3120
+%endif
+%if %1 == 4
+    movd           [srcq], xm12
+%elif %1 == 8
+    movq           [srcq], xm12
+%else
+    movu           [srcq], xm12
+%endif
+%elif mmsize == 32
+    packuswb         m12, m13
+    vpermq           m12, m12, q3120
+    movu           [srcq], m12
+%else
+    packuswb         m12, m13
+    movu           [srcq], m12
+%if chunks == 4
+    packuswb         m14, m15
+    movu        [srcq+16], m14
+%endif
+%endif
+    add              srcq, strideq
+    inc                yd
+    cmp                yd, %1
+    jl .loop
+    RET
+%endmacro
+
+; The high bit depth version needs dwords: for 4 or 8 pixels at a time, it
+; takes pmaddwd of ((size - 1 - x), (x + 1)) with (left[y], top[size]) and of
+; (top[x], left[size]) with ((size - 1 - y), (y + 1)). The per column pairs
+; are stored on the stack.
+%macro PRED_PLANAR_16 2 ; size, log2 size
+%if %1 * 2 < mmsize
+    %assign cw %1
+%else
+    %assign cw mmsize / 2
+%endif
+%assign chunks %1 / cw
+cglobal hevc_pred_planar_%1x%1_16, 4, 7, 8, chunks * 4 * mmsize, src, top, left, stride, y, tmp, tn
+    add           strideq, strideq
+    movzx            tmpd, word [leftq+%1*2]
+    movd              xm7, tmpd
+    SPLATW            m7, xm7                        ; left[size]
+%assign c 0
+%rep chunks
+%if cw == 4
+    movq              xm0, [topq]
+    movq              xm2, [pw_planar_dec+(32-%1)*2]
+    movq              xm3, [pw_planar_inc]
+%else
+    movu               m0, [topq+c*cw*2]
+    movu               m2, [pw_planar_dec+(32-%1)*2+c*cw*2]
+    movu               m3, [pw_planar_inc+c*cw*2]
+%endif
+    punpckhwd          m1, m0, m7
+    punpcklwd          m0, m7
+    punpckhwd          m4, m2, m3
+    punpcklwd          m2, m3
+    mova  [rsp+(c*4+0)*mmsize], m0
+    mova  [rsp+(c*4+1)*mmsize], m1
+    mova  [rsp+(c*4+2)*mmsize], m2
+    mova  [rsp+(c*4+3)*mmsize], m4
+    %assign c c+1
+%endrep
+    movzx             tnd, word [topq+%1*2]
+    shl               tnd, 16                        ; top[size] << 16
+    mov              tmpd, 0x10000 + %1 - 1
+    movd              xm6, tmpd
+%if cpuflag(avx2)
+    vpbroadcastd       m6, xm6                       ; (size - 1 - y), (y + 1)
+%else
+    pshufd             m6, m6, 0
+%endif
+    mova               m5, [pw_m1_1]
+    mov              tmpd, %1
+    movd              xm7, tmpd
+%if cpuflag(avx2)
+    vpbroadcastd       m7, xm7
+%else
+    pshufd             m7, m7, 0
+%endif
+    xor                yq, yq
+.loop:
+    movzx            tmpd, word [leftq+yq*2]
+    or               tmpd, tnd
+    movd              xm4, tmpd
+%if cpuflag(avx2)
+    vpbroadcastd       m4, xm4                       ; left[y], top[size]
+%else
+    pshufd             m4, m4, 0
+%endif
+%assign c 0
+%rep chunks
+    pmaddwd            m0, m6, [rsp+(c*4+0)*mmsize]
+    pmaddwd            m2, m4, [rsp+(c*4+2)*mmsize]
+    paddd              m0, m7
+    paddd              m0, m2
+    psrld              m0, %2 + 1
+%if cw == 4
+    packusdw           m0, m0
+    movq    [srcq], xm0
+%else
+    pmaddwd            m1, m6, [rsp+(c*4+1)*mmsize]
+    pmaddwd            m3, m4, [rsp+(c*4+3)*mmsize]
+    paddd              m1, m7
+    paddd              m1, m3
+    psrld              m1, %2 + 1
+    packusdw           m0, m1
+    movu  [srcq+c*mmsize], m0
+%endif
+    %assign c c+1
+%endrep
+    paddw              m6, m5
+    add              srcq, strideq
+    inc                yd
+    cmp                yd, %1
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+PRED_PLANAR_8   4, 2
+PRED_PLANAR_8   8, 3
+PRED_PLANAR_8  16, 4
+PRED_PLANAR_8  32, 5
+PRED_PLANAR_16  4, 2
+PRED_PLANAR_16  8, 3
+PRED_PLANAR_16 16, 4
+PRED_PLANAR_16 32, 5
+INIT_YMM avx2
+PRED_PLANAR_8  16, 4
+PRED_PLANAR_8  32, 5
+
+;------------------------------------------------------------------------------
+; void ff_hevc_pred_dc(uint8_t *src, const uint8_t *top, const uint8_t *left,
+;                      ptrdiff_t stride, int log2_size, int c_idx)
+;------------------------------------------------------------------------------
+
+; Luma blocks smaller than 32x32 get their first row and column filtered:
+; (top[x] + 3 * dc + 2) >> 2 and (left[y] + 3 * dc + 2) >> 2, with
+; (left[0] + 2 * dc + top[0] + 2) >> 2 in the corner. m0 holds dc as words.
+%macro DC_EDGES_8 1 ; size
+    pmullw             m1, m0, [pw_3]
+    paddw              m1, [pw_2]
+    pmovzxbw           m2, [topq]
+    pmovzxbw           m3, [leftq]
+    paddw              m2, m1
+    paddw              m3, m1
+    psrlw              m2, 2
+    psrlw              m3, 2
+%if %1 == 16
+    pmovzxbw           m4, [topq+8]
+    pmovzxbw           m5, [leftq+8]
+    paddw              m4, m1
+    paddw              m5, m1
+    psrlw              m4, 2
+    psrlw              m5, 2
+    packuswb           m2, m4
+    packuswb           m3, m5
+    movu           [srcq], m2
+%else
+    packuswb           m2, m2
+    packuswb           m3, m3
+%if %1 == 4
+    movd           [srcq], m2
+%else
+    movq           [srcq], m2
+%endif
+%endif
+    mov              tmpq, srcq
+%assign y 1
+%rep %1 - 1
+    add              tmpq, strideq
+    pextrb         [tmpq], m3, y
+    %assign y y+1
+%endrep
+    pextrw           tmpd, m0, 0
+    movzx          log2d, byte [topq]
+    lea              tmpd, [tmpq*2+log2q+2]
+    movzx          log2d, byte [leftq]
+    add              tmpd, log2d
+    shr              tmpd, 2
+    mov            [srcq], tmpb
+%endmacro
+
+%macro DC_EDGES_16 1 ; size
+    pmullw             m1, m0, [pw_3]
+    paddw              m1, [pw_2]
+%if %1 == 4
+    movq               m2, [topq]
+    movq               m3, [leftq]
+%else
+    movu               m2, [topq]
+    movu               m3, [leftq]
+%endif
+    paddw              m2, m1
+    paddw              m3, m1
+    psrlw              m2, 2
+    psrlw              m3, 2
+%if %1 == 16
+    movu               m4, [topq+16]
+    movu               m5, [leftq+16]
+    paddw              m4, m1
+    paddw              m5, m1
+    psrlw              m4, 2
+    psrlw              m5, 2
+    movu        [srcq+16], m4
+%endif
+%if %1 == 4
+    movq           [srcq], m2
+%else
+    movu           [srcq], m2
+%endif
+    mov              tmpq, srcq
+%assign y 1
+%rep %1 - 1
+    add              tmpq, strideq
+%if y < 8
+    pextrw         [tmpq], m3, y
+%else
+    pextrw         [tmpq], m5, y - 8
+%endif
+    %assign y y+1
+%endrep
+    pextrw           tmpd, m0, 0
+    movzx          log2d, word [topq]
+    lea              tmpd, [tmpq*2+log2q+2]
+    movzx          log2d, word [leftq]
+    add              tmpd, log2d
+    shr              tmpd, 2
+    mov            [srcq], tmpw
+%endmacro
+
+; dc in the low word of m0, broadcast to all words
+%macro DC_STORE 4 ; size, pixel bytes, dc splat, stride3
+    mov              tmpq, srcq
+%rep %1 / 4
+%assign x 0
+%rep (%1 * %2 + 15) / 16
+%if %1 * %2 == 4
+    movd     [tmpq+x],             %3
+    movd     [tmpq+x+strideq],     %3
+    movd     [tmpq+x+strideq*2],   %3
+    movd     [tmpq+x+%4],          %3
+%elif %1 * %2 == 8
+    movq     [tmpq+x],             %3
+    movq     [tmpq+x+strideq],     %3
+    movq     [tmpq+x+strideq*2],   %3
+    movq     [tmpq+x+%4],          %3
+%else
+    movu     [tmpq+x],             %3
+    movu     [tmpq+x+strideq],     %3
+    movu     [tmpq+x+strideq*2],   %3
+    movu     [tmpq+x+%4],          %3
+%endif
+    %assign x x+16
+%endrep
+    lea              tmpq, [tmpq+strideq*4]
+%endrep
+%endmacro
+
+INIT_XMM sse4
+cglobal hevc_pred_dc_8, 6, 8, 6, src, top, left, stride, log2, c_idx, tmp, stride3
+    lea          stride3q, [strideq*3]
+    pxor               m5, m5
+    cmp             log2d, 3
+    jl .dc4
+    je .dc8
+    cmp             log2d, 4
+    je .dc16
+
+    movu               m0, [topq]
+    movu               m1, [topq+16]
+    movu               m2, [leftq]
+    movu               m3, [leftq+16]
+    psadbw             m0, m5
+    psadbw             m1, m5
+    psadbw             m2, m5
+    psadbw             m3, m5
+    paddw              m0, m1
+    paddw              m2, m3
+    paddw              m0, m2
+    movhlps            m1, m0
+    paddw              m0, m1
+    pmulhrsw           m0, [pw_512]
+    pshufb             m1, m0, m5
+    DC_STORE          32, 1, m1, stride3q
+    RET
+
+.dc16:
+    movu               m0, [topq]
+    movu               m2, [leftq]
+    psadbw             m0, m5
+    psadbw             m2, m5
+    paddw              m0, m2
+    movhlps            m1, m0
+    paddw              m0, m1
+    pmulhrsw           m0, [pw_1024]
+    pshufb             m1, m0, m5
+    DC_STORE          16, 1, m1, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    SPLATW             m0, m0
+    DC_EDGES_8        16
+    RET
+
+.dc8:
+    movq               m0, [topq]
+    movq               m2, [leftq]
+    punpcklqdq         m0, m2
+    psadbw             m0, m5
+    movhlps            m1, m0
+    paddw              m0, m1
+    pmulhrsw           m0, [pw_2048]
+    pshufb             m1, m0, m5
+    DC_STORE           8, 1, m1, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    SPLATW             m0, m0
+    DC_EDGES_8         8
+    RET
+
+.dc4:
+    movd               m0, [topq]
+    movd               m2, [leftq]
+    punpckldq          m0, m2
+    psadbw             m0, m5
+    pmulhrsw           m0, [pw_4096]
+    pshufb             m1, m0, m5
+    DC_STORE           4, 1, m1, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    SPLATW             m0, m0
+    DC_EDGES_8         4
+.end:
+    RET
+
+; the sums of up to 64 12-bit samples need dwords
+%macro DC_SUM_16 1 ; number of registers of 8 samples per edge
+    pmaddwd            m0, [pw_1]
+%assign i 1
+%rep %1 - 1
+    movu               m1, [topq+i*16]
+    pmaddwd            m1, [pw_1]
+    paddd              m0, m1
+    %assign i i+1
+%endrep
+%assign i 0
+%rep %1
+    movu               m1, [leftq+i*16]
+    pmaddwd            m1, [pw_1]
+    paddd              m0, m1
+    %assign i i+1
+%endrep
+%endmacro
+
+cglobal hevc_pred_dc_16, 6, 8, 6, src, top, left, stride, log2, c_idx, tmp, stride3
+    add           strideq, strideq
+    lea          stride3q, [strideq*3]
+    cmp             log2d, 3
+    jl .dc4
+    je .dc8
+    cmp             log2d, 4
+    je .dc16
+
+    movu               m0, [topq]
+    DC_SUM_16          4
+    movhlps            m1, m0
+    paddd              m0, m1
+    pshuflw            m1, m0, q1032
+    paddd              m0, m1
+    paddd              m0, [pd_32]
+    psrld              m0, 6
+    SPLATW             m1, m0
+    DC_STORE          32, 2, m1, stride3q
+    RET
+
+.dc16:
+    movu               m0, [topq]
+    DC_SUM_16          2
+    movhlps            m1, m0
+    paddd              m0, m1
+    pshuflw            m1, m0, q1032
+    paddd              m0, m1
+    paddd              m0, [pd_16]
+    psrld              m0, 5
+    SPLATW             m0, m0
+    DC_STORE          16, 2, m0, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    DC_EDGES_16       16
+    RET
+
+.dc8:
+    movu               m0, [topq]
+    DC_SUM_16          1
+    movhlps            m1, m0
+    paddd              m0, m1
+    pshuflw            m1, m0, q1032
+    paddd              m0, m1
+    paddd              m0, [pd_8]
+    psrld              m0, 4
+    SPLATW             m0, m0
+    DC_STORE           8, 2, m0, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    DC_EDGES_16        8
+    RET
+
+.dc4:
+    movq               m0, [topq]
+    movhps             m0, [leftq]
+    pmaddwd            m0, [pw_1]
+    movhlps            m1, m0
+    paddd              m0, m1
+    pshuflw            m1, m0, q1032
+    paddd              m0, m1
+    paddd              m0, [pd_4]
+    psrld              m0, 3
+    SPLATW             m0, m0
+    DC_STORE           4, 2, m0, stride3q
+    test           c_idxd, c_idxd
+    jnz .end
+    DC_EDGES_16        4
+.end:
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_hevc_pred_angular_NxN(uint8_t *src, const uint8_t *top,
+;                               const uint8_t *left, ptrdiff_t stride,
+;                               int c_idx, int mode)
+;
+; The horizontal modes 2..17 are predicted as the vertical modes 34..19 with
+; top and left swapped, into a buffer on the stack that is then transposed.
+;------------------------------------------------------------------------------
+
+; src, src stride (constant), dst, dst stride, dst stride * 3, tmp
+%macro TRANSPOSE_8x8B 6
+    movq              xm0, [%1+0*%2]
+    movq              xm1, [%1+1*%2]
+    movq              xm2, [%1+2*%2]
+    movq              xm3, [%1+3*%2]
+    movq              xm4, [%1+4*%2]
+    movq              xm5, [%1+5*%2]
+    movq              xm6, [%1+6*%2]
+    movq              xm7, [%1+7*%2]
+    punpcklbw         xm0, xm1
+    punpcklbw         xm2, xm3
+    punpcklbw         xm4, xm5
+    punpcklbw         xm6, xm7
+    punpckhwd         xm1, xm0, xm2
+    punpcklwd         xm0, xm2
+    punpckhwd         xm3, xm4, xm6
+    punpcklwd         xm4, xm6
+    punpckhdq         xm2, xm0, xm4
+    punpckldq         xm0, xm4
+    punpckhdq         xm5, xm1, xm3
+    punpckldq         xm1, xm3
+    movq            [%3], xm0
+    movhps       [%3+%4], xm0
+    movq       [%3+%4*2], xm2
+    movhps       [%3+%5], xm2
+    lea                %6, [%3+%4*4]
+    movq            [%6], xm1
+    movhps       [%6+%4], xm1
+    movq       [%6+%4*2], xm5
+    movhps       [%6+%5], xm5
+%endmacro
+
+%macro TRANSPOSE_8x8W 6
+    movu              xm0, [%1+0*%2]
+    movu              xm1, [%1+1*%2]
+    movu              xm2, [%1+2*%2]
+    movu              xm3, [%1+3*%2]
+    movu              xm4, [%1+4*%2]
+    movu              xm5, [%1+5*%2]
+    movu              xm6, [%1+6*%2]
+    movu              xm7, [%1+7*%2]
+    punpcklwd         xm8, xm0, xm1
+    punpckhwd         xm0, xm1
+    punpcklwd         xm1, xm2, xm3
+    punpckhwd         xm2, xm3
+    punpcklwd         xm3, xm4, xm5
+    punpckhwd         xm4, xm5
+    punpcklwd         xm5, xm6, xm7
+    punpckhwd         xm6, xm7
+    punpckldq         xm7, xm8, xm1
+    punpckhdq         xm8, xm1
+    punpckldq         xm1, xm3, xm5
+    punpckhdq         xm3, xm5
+    punpcklqdq        xm5, xm7, xm1
+    punpckhqdq        xm7, xm1
+    punpcklqdq        xm1, xm8, xm3
+    punpckhqdq        xm8, xm3
+    movu            [%3], xm5
+    movu         [%3+%4], xm7
+    movu       [%3+%4*2], xm1
+    movu         [%3+%5], xm8
+    punpckldq         xm3, xm0, xm2
+    punpckhdq         xm0, xm2
+    punpckldq         xm2, xm4, xm6
+    punpckhdq         xm4, xm6
+    punpcklqdq        xm6, xm3, xm2
+    punpckhqdq        xm3, xm2
+    punpcklqdq        xm2, xm0, xm4
+    punpckhqdq        xm0, xm4
+    lea                %6, [%3+%4*4]
+    movu            [%6], xm6
+    movu         [%6+%4], xm3
+    movu       [%6+%4*2], xm2
+    movu         [%6+%5], xm0
+%endmacro
+
+; load or store one row of %1 bytes from/to memory
+%macro MOV_ROW 3 ; bytes, dst, src
+%if %1 == 4
+    movd               %2, %3
+%elif %1 == 8
+    movq               %2, %3
+%else
+    movu               %2, %3
+%endif
+%endmacro
+
+%macro PRED_ANGULAR 2 ; size, bit depth
+%if %2 == 8
+    %assign ps 1
+%else
+    %assign ps 2
+%endif
+%assign rowbytes %1 * ps
+%if rowbytes < mmsize
+    %assign cw rowbytes
+%else
+    %assign cw mmsize
+%endif
+%assign chunks rowbytes / cw
+%assign tmpsize %1 * rowbytes
+%assign refoff tmpsize + rowbytes
+cglobal hevc_pred_angular_%1x%1_%2, 6, 12, 9, tmpsize + 2 * rowbytes + 2 * mmsize, src, top, left, stride, c_idx, mode, dst, dstride, ref, angle, pos, tmp
+%if ps == 2
+    add           strideq, strideq
+%endif
+    xor              dstq, dstq
+    movsxd          modeq, moded
+    cmp             moded, 18
+    jge .vertical
+    mov              dstq, srcq
+    mov          dstrideq, strideq
+    mov              srcq, rsp
+    mov           strideq, rowbytes
+    xchg             topq, leftq
+    neg             modeq
+    add             modeq, 36
+.vertical:
+    lea              tmpq, [pb_angle]
+    movsx         angled, byte [tmpq+modeq-18]
+    test          angled, angled
+    jz .pure
+    lea              refq, [topq-ps]
+    jg .rows
+    imul             posd, angled, %1
+    sar              posd, 5                         ; last
+    cmp              posd, -1
+    jge .rows
+
+    ; extend the main reference to the left with the projection of the other
+    lea              refq, [rsp+refoff]
+%assign x 0
+%rep (rowbytes + ps + mmsize - 1) / mmsize
+    movu               m0, [topq-ps+x]
+    movu       [refq+x], m0
+    %assign x x+mmsize
+%endrep
+    lea              tmpq, [pw_inv_angle]
+    movsx            tmpd, word [tmpq+modeq*2-36]
+    movsxd           posq, posd
+.project:
+    mov            c_idxd, posd
+    imul           c_idxd, tmpd
+    add            c_idxd, 128
+    sar            c_idxd, 8
+    movsxd         c_idxq, c_idxd
+%if ps == 1
+    movzx          c_idxd, byte [leftq+c_idxq-1]
+    mov     [refq+posq], c_idxb
+%else
+    movzx          c_idxd, word [leftq+c_idxq*2-2]
+    mov   [refq+posq*2], c_idxw
+%endif
+    inc              posq
+    jnz .project
+
+.rows:
+    mov              posd, angled
+    mov            c_idxd, %1
+%if ps == 1
+    mova               m8, [pw_1024]
+%endif
+.row:
+    mov              tmpd, posd
+    sar              tmpd, 5
+    movsxd           tmpq, tmpd                      ; idx
+%if ps == 2
+    add              tmpq, tmpq
+%endif
+    mov             moded, posd
+    and             moded, 31                        ; fact
+    jz .copy
+%if ps == 1
+    imul            moded, 255
+    add             moded, 32                        ; fact << 8 | (32 - fact)
+%else
+    shl             moded, 10
+%endif
+    movd              xm7, moded
+    SPLATW             m7, xm7
+%assign x 0
+%rep chunks
+%if ps == 1
+    MOV_ROW           cw, m0, [refq+tmpq+x+1]
+    MOV_ROW           cw, m1, [refq+tmpq+x+2]
+%if cw < 16
+    punpcklbw          m0, m1
+    pmaddubsw          m0, m7
+    pmulhrsw           m0, m8
+    packuswb           m0, m0
+%else
+    punpckhbw          m2, m0, m1
+    punpcklbw          m0, m1
+    pmaddubsw          m0, m7
+    pmaddubsw          m2, m7
+    pmulhrsw           m0, m8
+    pmulhrsw           m2, m8
+    packuswb           m0, m2
+%endif
+%else
+    MOV_ROW           cw, m0, [refq+tmpq+x+2]
+    MOV_ROW           cw, m1, [refq+tmpq+x+4]
+    psubw              m1, m0
+    pmulhrsw           m1, m7
+    paddw              m0, m1
+%endif
+    MOV_ROW           cw, [srcq+x], m0
+    %assign x x+cw
+%endrep
+    jmp .next
+.copy:
+%assign x 0
+%rep chunks
+    MOV_ROW           cw, m0, [refq+tmpq+x+ps]
+    MOV_ROW           cw, [srcq+x], m0
+    %assign x x+cw
+%endrep
+.next:
+    add              srcq, strideq
+    add              posd, angled
+    dec            c_idxd
+    jnz .row
+    jmp .transpose
+
+    ; pure vertical prediction, with the edge filter for small luma blocks
+.pure:
+%assign x 0
+%rep chunks
+    MOV_ROW           cw, m %+ x, [topq+x*cw]
+    %assign x x+1
+%endrep
+    mov              tmpq, srcq
+    mov              posd, %1
+.pure_row:
+%assign x 0
+%rep chunks
+    MOV_ROW           cw, [tmpq+x*cw], m %+ x
+    %assign x x+1
+%endrep
+    add              tmpq, strideq
+    dec              posd
+    jnz .pure_row
+%if %1 < 32
+    test           c_idxd, c_idxd
+    jnz .transpose
+%if ps == 1
+    movzx            tmpd, byte [leftq-1]
+    movd              xm2, tmpd
+    SPLATW            xm2, xm2
+    movzx            tmpd, byte [topq]
+    movd              xm3, tmpd
+    SPLATW            xm3, xm3
+    pmovzxbw          xm0, [leftq]
+    psubw             xm0, xm2
+    psraw             xm0, 1
+    paddw             xm0, xm3
+%if %1 == 16
+    pmovzxbw          xm1, [leftq+8]
+    psubw             xm1, xm2
+    psraw             xm1, 1
+    paddw             xm1, xm3
+    packuswb          xm0, xm1
+%else
+    packuswb          xm0, xm0
+%endif
+%assign y 0
+%rep %1
+    pextrb         [srcq], xm0, y
+    add              srcq, strideq
+    %assign y y+1
+%endrep
+%else
+    movzx            tmpd, word [leftq-2]
+    movd              xm2, tmpd
+    SPLATW            xm2, xm2
+    movzx            tmpd, word [topq]
+    movd              xm3, tmpd
+    SPLATW            xm3, xm3
+    pxor              xm4, xm4
+%if %2 == 10
+    mova              xm5, [pw_1023]
+%else
+    mova              xm5, [pw_4095]
+%endif
+%assign x 0
+%rep (%1 + 7) / 8
+    movu           xm %+ x, [leftq+x*16]
+    psubw          xm %+ x, xm2
+    psraw          xm %+ x, 1
+    paddw          xm %+ x, xm3
+    CLIPW          xm %+ x, xm4, xm5
+    %assign x x+1
+%endrep
+%assign y 0
+%rep %1
+%if y < 8
+    pextrw         [srcq], xm0, y
+%else
+    pextrw         [srcq], xm1, y - 8
+%endif
+    add              srcq, strideq
+    %assign y y+1
+%endrep
+%endif
+%endif
+
+.transpose:
+    test             dstq, dstq
+    jz .end
+%if %1 == 4
+    movu              xm0, [rsp]
+%if ps == 1
+    pshufb            xm0, [pb_transpose4x4]
+    movd           [dstq], xm0
+    pextrd [dstq+dstrideq], xm0, 1
+    lea              dstq, [dstq+dstrideq*2]
+    pextrd         [dstq], xm0, 2
+    pextrd [dstq+dstrideq], xm0, 3
+%else
+    movu              xm1, [rsp+16]
+    mova              xm2, [pb_transpose4x4w]
+    pshufb            xm0, xm2
+    pshufb            xm1, xm2
+    punpckhdq         xm2, xm0, xm1
+    punpckldq         xm0, xm1
+    movq           [dstq], xm0
+    movhps [dstq+dstrideq], xm0
+    lea              dstq, [dstq+dstrideq*2]
+    movq           [dstq], xm2
+    movhps [dstq+dstrideq], xm2
+%endif
+%else
+    lea             modeq, [dstrideq*3]
+    mov              tmpq, rsp
+    mov            c_idxd, %1 / 8
+.transpose_col:
+    mov              refq, tmpq
+    mov              posq, dstq
+    mov            angled, %1 / 8
+.transpose_block:
+%if ps == 1
+    TRANSPOSE_8x8B   refq, rowbytes, posq, dstrideq, modeq, srcq
+%else
+    TRANSPOSE_8x8W   refq, rowbytes, posq, dstrideq, modeq, srcq
+%endif
+    add              refq, 8 * ps
+    lea              posq, [posq+dstrideq*8]
+    dec           angled
+    jnz .transpose_block
+    add              tmpq, 8 * rowbytes
+    add              dstq, 8 * ps
+    dec            c_idxd
+    jnz .transpose_col
+%endif
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse4
+PRED_ANGULAR  4, 8
+PRED_ANGULAR  8, 8
+PRED_ANGULAR 16, 8
+PRED_ANGULAR 32, 8
+PRED_ANGULAR  4, 10
+PRED_ANGULAR  8, 10
+PRED_ANGULAR 16, 10
+PRED_ANGULAR 32, 10
+PRED_ANGULAR  4, 12
+PRED_ANGULAR  8, 12
+PRED_ANGULAR 16, 12
+PRED_ANGULAR 32, 12
+INIT_YMM avx2
+PRED_ANGULAR 32, 8
+PRED_ANGULAR 16, 10
+PRED_ANGULAR 32, 10
+PRED_ANGULAR 16, 12
+PRED_ANGULAR 32, 12
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,125 @@
+/*
+ * HEVC intra prediction
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/hevcpred.h"
+
+#define PRED_PLANAR(size, depth, opt)                                           \
+void ff_hevc_pred_planar_ ## size ## x ## size ## _ ## depth ## _ ## opt(uint8_t *src, \
+                                          const uint8_t *top,                   \
+                                          const uint8_t *left,                  \
+                                          ptrdiff_t stride);
+
+#define PRED_ANGULAR(size, depth, opt)                                          \
+void ff_hevc_pred_angular_ ## size ## x ## size ## _ ## depth ## _ ## opt(uint8_t *src, \
+                                          const uint8_t *top,                   \
+                                          const uint8_t *left,                  \
+                                          ptrdiff_t stride, int c_idx,          \
+                                          int mode);
+
+#define PRED_FUNCS(depth, opt)                                                  \
+    PRED_PLANAR(4, depth, opt)                                                  \
+    PRED_PLANAR(8, depth, opt)                                                  \
+    PRED_PLANAR(16, depth, opt)                                                 \
+    PRED_PLANAR(32, depth, opt)                                                 \
+    void ff_hevc_pred_dc_ ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,\
+                                               const uint8_t *left,             \
+                                               ptrdiff_t stride, int log2_size, \
+                                               int c_idx);                      \
+    void ff_hevc_filter_ref_ ## depth ## _ ## opt(uint8_t *dst,                 \
+                                                  const uint8_t *src, int len);
+
+#define ANGULAR_FUNCS(depth, opt)                                               \
+    PRED_ANGULAR(4, depth, opt)                                                 \
+    PRED_ANGULAR(8, depth, opt)                                                 \
+    PRED_ANGULAR(16, depth, opt)                                                \
+    PRED_ANGULAR(32, depth, opt)
+
+PRED_FUNCS(8, sse4)
+PRED_FUNCS(16, sse4)
+ANGULAR_FUNCS(8, sse4)
+ANGULAR_FUNCS(10, sse4)
+ANGULAR_FUNCS(12, sse4)
+
+PRED_PLANAR(16, 8, avx2)
+PRED_PLANAR(32, 8, avx2)
+PRED_ANGULAR(32, 8, avx2)
+PRED_ANGULAR(16, 10, avx2)
+PRED_ANGULAR(32, 10, avx2)
+PRED_ANGULAR(16, 12, avx2)
+PRED_ANGULAR(32, 12, avx2)
+void ff_hevc_filter_ref_8_avx2(uint8_t *dst, const uint8_t *src, int len);
+void ff_hevc_filter_ref_16_avx2(uint8_t *dst, const uint8_t *src, int len);
+
+#define SET_PLANAR(depth, opt)                                                  \
+    hpc->pred_planar[0] = ff_hevc_pred_planar_4x4_   ## depth ## _ ## opt;      \
+    hpc->pred_planar[1] = ff_hevc_pred_planar_8x8_   ## depth ## _ ## opt;      \
+    hpc->pred_planar[2] = ff_hevc_pred_planar_16x16_ ## depth ## _ ## opt;      \
+    hpc->pred_planar[3] = ff_hevc_pred_planar_32x32_ ## depth ## _ ## opt;      \
+    hpc->pred_dc        = ff_hevc_pred_dc_           ## depth ## _ ## opt;      \
+    hpc->filter_ref     = ff_hevc_filter_ref_        ## depth ## _ ## opt
+
+#define SET_ANGULAR(depth, opt)                                                 \
+    hpc->pred_angular[0] = ff_hevc_pred_angular_4x4_   ## depth ## _ ## opt;    \
+    hpc->pred_angular[1] = ff_hevc_pred_angular_8x8_   ## depth ## _ ## opt;    \
+    hpc->pred_angular[2] = ff_hevc_pred_angular_16x16_ ## depth ## _ ## opt;    \
+    hpc->pred_angular[3] = ff_hevc_pred_angular_32x32_ ## depth ## _ ## opt
+
+av_cold void ff_hevc_pred_init_x86(HEVCPredContext *hpc, int bit_depth)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (bit_depth == 8) {
+        if (EXTERNAL_SSE4(cpu_flags) && ARCH_X86_64) {
+            SET_PLANAR(8, sse4);
+            SET_ANGULAR(8, sse4);
+        }
+        if (EXTERNAL_AVX2(cpu_flags) && ARCH_X86_64) {
+            hpc->pred_planar[2]  = ff_hevc_pred_planar_16x16_8_avx2;
+            hpc->pred_planar[3]  = ff_hevc_pred_planar_32x32_8_avx2;
+            hpc->pred_angular[3] = ff_hevc_pred_angular_32x32_8_avx2;
+            hpc->filter_ref      = ff_hevc_filter_ref_8_avx2;
+        }
+    } else if (bit_depth <= 12) {
+        /* planar, DC and the reference filter do not clip and serve
+         * 9, 10 and 12 bits alike */
+        if (EXTERNAL_SSE4(cpu_flags) && ARCH_X86_64) {
+            SET_PLANAR(16, sse4);
+            if (bit_depth == 10) {
+                SET_ANGULAR(10, sse4);
+            } else if (bit_depth == 12) {
+                SET_ANGULAR(12, sse4);
+            }
+        }
+        if (EXTERNAL_AVX2(cpu_flags) && ARCH_X86_64) {
+            hpc->filter_ref = ff_hevc_filter_ref_16_avx2;
+            if (bit_depth == 10) {
+                hpc->pred_angular[2] = ff_hevc_pred_angular_16x16_10_avx2;
+                hpc->pred_angular[3] = ff_hevc_pred_angular_32x32_10_avx2;
+            } else if (bit_depth == 12) {
+                hpc->pred_angular[2] = ff_hevc_pred_angular_16x16_12_avx2;
+                hpc->pred_angular[3] = ff_hevc_pred_angular_32x32_12_avx2;
+            }
+        }
+    }
+}
@@ -279,6 +279,57 @@ INIT_XMM ssse3
 %define ABS_SUM_8x8 ABS_SUM_8x8_64
 HADAMARD8_DIFF 9
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; Each ymm register holds a row of the left 8x8 block in its low lane and the
+; same row of the right 8x8 block in its high lane, so a whole 16x8 strip goes
+; through the transform at once. The two block sums saturate separately, as
+; they do in the xmm versions.
+%macro DIFF_PIXELS_16x1 2
+    pmovzxbw        %1, [pix1q+%2]
+    pmovzxbw        m8, [pix2q+%2]
+    psubw           %1, m8
+%endmacro
+
+INIT_YMM avx2
+cglobal hadamard8_diff16, 5, 8, 10, v, pix1, pix2, stride, h, stride3, sum, tmp
+    lea       stride3q, [strideq*3]
+    xor           sumd, sumd
+.loop:
+    DIFF_PIXELS_16x1 m0, 0
+    DIFF_PIXELS_16x1 m1, strideq
+    DIFF_PIXELS_16x1 m2, strideq*2
+    DIFF_PIXELS_16x1 m3, stride3q
+    lea          pix1q, [pix1q+strideq*4]
+    lea          pix2q, [pix2q+strideq*4]
+    DIFF_PIXELS_16x1 m4, 0
+    DIFF_PIXELS_16x1 m5, strideq
+    DIFF_PIXELS_16x1 m6, strideq*2
+    DIFF_PIXELS_16x1 m7, stride3q
+    lea          pix1q, [pix1q+strideq*4]
+    lea          pix2q, [pix2q+strideq*4]
+    HADAMARD8
+    TRANSPOSE8x8W    0, 1, 2, 3, 4, 5, 6, 7, 8
+    HADAMARD8
+    ABS_SUM_8x8_64   0
+    pshufd          m1, m0, q1032
+    paddusw         m0, m1
+    pshuflw         m1, m0, q0032
+    paddusw         m0, m1
+    pshuflw         m1, m0, q0001
+    paddusw         m0, m1
+    vextracti128   xm1, m0, 1
+    movd          tmpd, xm0
+    movzx         tmpd, tmpw
+    add           sumd, tmpd
+    movd          tmpd, xm1
+    movzx         tmpd, tmpw
+    add           sumd, tmpd
+    sub             hd, 8
+    jg .loop
+    mov            eax, sumd
+    RET
+%endif
+
 ; int ff_sse*_*(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
 ;               ptrdiff_t line_size, int h)
 
@@ -357,6 +408,38 @@ SUM_SQUARED_ERRORS 16
 INIT_XMM sse2
 SUM_SQUARED_ERRORS 16
 
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal sse16, 5, 5, 6, v, pix1, pix2, lsize, h
+    pxor      m4, m4
+    pxor      m5, m5
+.next2lines:
+    pmovzxbw  m0, [pix1q]
+    pmovzxbw  m1, [pix2q]
+    pmovzxbw  m2, [pix1q+lsizeq]
+    pmovzxbw  m3, [pix2q+lsizeq]
+    psubw     m0, m1
+    psubw     m2, m3
+    pmaddwd   m0, m0
+    pmaddwd   m2, m2
+    paddd     m4, m0
+    paddd     m5, m2
+    lea    pix1q, [pix1q+2*lsizeq]
+    lea    pix2q, [pix2q+2*lsizeq]
+    sub       hd, 2
+    jg .next2lines
+
+    paddd     m4, m5
+    vextracti128 xm5, m4, 1
+    paddd    xm4, xm5
+    pshufd   xm5, xm4, q1032
+    paddd    xm4, xm5
+    pshufd   xm5, xm4, q0001
+    paddd    xm4, xm5
+    movd     eax, xm4
+    RET
+%endif
+
 ;-----------------------------------------------
 ;int ff_sum_abs_dctelem(int16_t *block)
 ;-----------------------------------------------
@@ -525,6 +608,118 @@ SAD 16
 INIT_XMM sse2
 SAD 16
 
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal sad16, 5, 5, 3, v, pix1, pix2, stride, h
+    pxor      m2, m2
+.loop:
+    movu     xm0, [pix2q]
+    vinserti128 m0, m0, [pix2q+strideq], 1
+    movu     xm1, [pix1q]
+    vinserti128 m1, m1, [pix1q+strideq], 1
+    psadbw    m0, m1
+    paddw     m2, m0
+    lea    pix1q, [pix1q+strideq*2]
+    lea    pix2q, [pix2q+strideq*2]
+    sub       hd, 2
+    jg .loop
+    vextracti128 xm0, m2, 1
+    paddw    xm2, xm0
+    movhlps  xm0, xm2
+    paddw    xm2, xm0
+    movd     eax, xm2
+    RET
+%endif
+
+%if ARCH_X86_64
+;------------------------------------------------------------------------------------------
+;void ff_sad16_x4_<opt>(uint8_t *pix1, uint8_t *const ref[4], ptrdiff_t stride, int h,
+;                       int scores[4]);
+;------------------------------------------------------------------------------------------
+; %1 = dst register number, %2 = reference pointer, %3 = row offset (xmm only)
+%macro SAD16_X4_LOAD 3
+%if mmsize == 32
+    movu        xm%1, [%2]
+    vinserti128  m%1, m%1, [%2+strideq], 1
+%else
+    movu         m%1, [%2+%3]
+%endif
+%endmacro
+
+; one row (xmm) or two rows (ymm) of all four candidates
+%macro SAD16_X4_ROWS 1
+%if mmsize == 32
+    SAD16_X4_LOAD  0, pix1q, 0
+%else
+    mova           m0, [pix1q+%1]
+%endif
+    SAD16_X4_LOAD  1, ref0q, %1
+    SAD16_X4_LOAD  2, ref1q, %1
+    SAD16_X4_LOAD  3, ref2q, %1
+    psadbw         m1, m0
+    psadbw         m2, m0
+    psadbw         m3, m0
+    paddw          m4, m1
+    paddw          m5, m2
+    paddw          m6, m3
+    SAD16_X4_LOAD  1, ref3q, %1
+    psadbw         m1, m0
+    paddw          m7, m1
+%endmacro
+
+%macro SAD16_X4 0
+cglobal sad16_x4, 5, 8, 8, pix1, ref0, stride, h, scores, ref1, ref2, ref3
+    mov         ref1q, [ref0q+gprsize*1]
+    mov         ref2q, [ref0q+gprsize*2]
+    mov         ref3q, [ref0q+gprsize*3]
+    mov         ref0q, [ref0q]
+    pxor           m4, m4
+    pxor           m5, m5
+    pxor           m6, m6
+    pxor           m7, m7
+.loop:
+    SAD16_X4_ROWS  0
+%if mmsize == 16
+    SAD16_X4_ROWS  strideq
+%endif
+    lea         pix1q, [pix1q+strideq*2]
+    lea         ref0q, [ref0q+strideq*2]
+    lea         ref1q, [ref1q+strideq*2]
+    lea         ref2q, [ref2q+strideq*2]
+    lea         ref3q, [ref3q+strideq*2]
+    sub            hd, 2
+    jg .loop
+
+%if mmsize == 32
+    vextracti128  xm0, m4, 1
+    vextracti128  xm1, m5, 1
+    vextracti128  xm2, m6, 1
+    vextracti128  xm3, m7, 1
+    paddw         xm4, xm0
+    paddw         xm5, xm1
+    paddw         xm6, xm2
+    paddw         xm7, xm3
+%endif
+    ; each accumulator holds two partial sums in the low dword of each qword
+    psllq         xm5, 32
+    psllq         xm7, 32
+    por           xm4, xm5
+    por           xm6, xm7
+    punpckhqdq    xm0, xm4, xm6
+    punpcklqdq    xm4, xm6
+    paddd         xm4, xm0
+    movu   [scoresq], xm4
+    RET
+%endmacro
+
+INIT_XMM sse2
+SAD16_X4
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SAD16_X4
+%endif
+%endif ; ARCH_X86_64
+
 ;------------------------------------------------------------------------------------------
 ;int ff_sad_x2_<opt>(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2, ptrdiff_t stride, int h);
 ;------------------------------------------------------------------------------------------
@@ -39,6 +39,8 @@ int ff_sse16_mmx(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                  ptrdiff_t stride, int h);
 int ff_sse16_sse2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                   ptrdiff_t stride, int h);
+int ff_sse16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+                  ptrdiff_t stride, int h);
 int ff_hf_noise8_mmx(uint8_t *pix1, ptrdiff_t stride, int h);
 int ff_hf_noise16_mmx(uint8_t *pix1, ptrdiff_t stride, int h);
 int ff_sad8_mmxext(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
@@ -47,6 +49,12 @@ int ff_sad16_mmxext(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                     ptrdiff_t stride, int h);
 int ff_sad16_sse2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                   ptrdiff_t stride, int h);
+int ff_sad16_avx2(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
+                  ptrdiff_t stride, int h);
+void ff_sad16_x4_sse2(uint8_t *pix1, uint8_t *const ref[4], ptrdiff_t stride,
+                      int h, int scores[4]);
+void ff_sad16_x4_avx2(uint8_t *pix1, uint8_t *const ref[4], ptrdiff_t stride,
+                      int h, int scores[4]);
 int ff_sad8_x2_mmxext(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
                       ptrdiff_t stride, int h);
 int ff_sad16_x2_mmxext(MpegEncContext *v, uint8_t *pix1, uint8_t *pix2,
@@ -88,6 +96,8 @@ hadamard_func(mmx)
 hadamard_func(mmxext)
 hadamard_func(sse2)
 hadamard_func(ssse3)
+int ff_hadamard8_diff16_avx2(MpegEncContext *s, uint8_t *src1,
+                              uint8_t *src2, ptrdiff_t stride, int h);
 
 #if HAVE_YASM
 static int nsse16_mmx(MpegEncContext *c, uint8_t *pix1, uint8_t *pix2,
@@ -638,6 +648,8 @@ av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
                 c->pix_abs[0][3] = ff_sad16_approx_xy2_sse2;
                 c->vsad[0]       = ff_vsad16_approx_sse2;
             }
+            if (ARCH_X86_64)
+                c->sad_x4[0] = ff_sad16_x4_sse2;
         }
     }
 
@@ -648,4 +660,15 @@ av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
         c->hadamard8_diff[1] = ff_hadamard8_diff_ssse3;
 #endif
     }
+
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        /* unaligned VEX loads, so these are fine for snow as well */
+        c->sse[0]        = ff_sse16_avx2;
+        c->sad[0]        = ff_sad16_avx2;
+        c->pix_abs[0][0] = ff_sad16_avx2;
+        if (ARCH_X86_64) {
+            c->hadamard8_diff[0] = ff_hadamard8_diff16_avx2;
+            c->sad_x4[0]         = ff_sad16_x4_avx2;
+        }
+    }
 }
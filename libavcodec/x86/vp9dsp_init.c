@@ -26,6 +26,7 @@
 #include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libavcodec/vp9dsp.h"
+#include "vp9dsp_init.h"
 
 #if HAVE_YASM
 
@@ -311,7 +312,11 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp, int bpp)
 {
 #if HAVE_YASM
     int cpu_flags;
-    if (bpp != 8) return;
+
+    if (bpp != 8) {
+        ff_vp9dsp_init_16bpp_x86(dsp, bpp);
+        return;
+    }
 
     cpu_flags = av_get_cpu_flags();
 
@@ -0,0 +1,455 @@
+/*
+ * VP9 SIMD optimizations for 10 and 12 bits per pixel
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/vp9dsp.h"
+#include "vp9dsp_init.h"
+
+#if HAVE_YASM
+
+/* full-pel MC does not care about the bit depth; the put functions are the
+ * 8 bpp ones at twice the width, avg uses pavgw */
+#define fpel_func(avg, sz, opt) \
+void ff_vp9_##avg##sz##_##opt(uint8_t *dst, ptrdiff_t dst_stride, \
+                              const uint8_t *src, ptrdiff_t src_stride, \
+                              int h, int mx, int my)
+fpel_func(put,    8, mmx);
+fpel_func(put,   16, sse);
+fpel_func(put,   32, sse);
+fpel_func(put,   64, sse);
+fpel_func(put,  128, sse);
+fpel_func(put,   32, avx);
+fpel_func(put,   64, avx);
+fpel_func(put,  128, avx);
+fpel_func(avg,  8_16, mmxext);
+fpel_func(avg, 16_16, sse2);
+fpel_func(avg, 32_16, sse2);
+fpel_func(avg, 64_16, sse2);
+fpel_func(avg, 128_16, sse2);
+fpel_func(avg, 32_16, avx2);
+fpel_func(avg, 64_16, avx2);
+fpel_func(avg, 128_16, avx2);
+#undef fpel_func
+
+#define ipred_func(size, type, bpp, opt) \
+void ff_vp9_ipred_##type##_##size##x##size##_##bpp##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                           const uint8_t *l, const uint8_t *a)
+#define ipred_funcs(size, opt) \
+ipred_func(size, v,       16, opt); \
+ipred_func(size, h,       16, opt); \
+ipred_func(size, tm,      10, opt); \
+ipred_func(size, tm,      12, opt)
+#define ipred_dc_funcs(size, opt) \
+ipred_func(size, dc,      16, opt); \
+ipred_func(size, dc_left, 16, opt); \
+ipred_func(size, dc_top,  16, opt)
+
+ipred_funcs(4,  sse2);
+ipred_funcs(8,  sse2);
+ipred_funcs(16, sse2);
+ipred_funcs(32, sse2);
+ipred_dc_funcs(8,  sse2);
+ipred_dc_funcs(16, sse2);
+ipred_dc_funcs(32, sse2);
+
+#undef ipred_dc_funcs
+#undef ipred_funcs
+#undef ipred_func
+
+#if ARCH_X86_64
+/* ff_filters_16bpp[3] holds the bilinear filter as 8-tap coefficients */
+extern const int16_t ff_filters_16bpp[4][15][4][16];
+
+#define mc_func(avg, sz, dir, bpp, opt) \
+void ff_vp9_##avg##_8tap_1d_##dir##_##sz##_##bpp##_##opt(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                         const uint8_t *src, ptrdiff_t src_stride, \
+                                                         int h, const int16_t (*filter)[16])
+#define mc_funcs(sz, bpp, opt) \
+mc_func(put, sz, h, bpp, opt); \
+mc_func(avg, sz, h, bpp, opt); \
+mc_func(put, sz, v, bpp, opt); \
+mc_func(avg, sz, v, bpp, opt)
+
+mc_funcs(4,  10, sse2);
+mc_funcs(8,  10, sse2);
+mc_funcs(4,  12, sse2);
+mc_funcs(8,  12, sse2);
+mc_funcs(16, 10, avx2);
+mc_funcs(16, 12, avx2);
+
+#undef mc_funcs
+#undef mc_func
+
+#define mc_rep_func(avg, sz, hsz, dir, bpp, opt) \
+static av_always_inline void \
+ff_vp9_##avg##_8tap_1d_##dir##_##sz##_##bpp##_##opt(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                    const uint8_t *src, ptrdiff_t src_stride, \
+                                                    int h, const int16_t (*filter)[16]) \
+{ \
+    ff_vp9_##avg##_8tap_1d_##dir##_##hsz##_##bpp##_##opt(dst, dst_stride, src, \
+                                                         src_stride, h, filter); \
+    ff_vp9_##avg##_8tap_1d_##dir##_##hsz##_##bpp##_##opt(dst + hsz * 2, dst_stride, \
+                                                         src + hsz * 2, \
+                                                         src_stride, h, filter); \
+}
+
+#define mc_rep_funcs(sz, hsz, bpp, opt) \
+mc_rep_func(put, sz, hsz, h, bpp, opt); \
+mc_rep_func(avg, sz, hsz, h, bpp, opt); \
+mc_rep_func(put, sz, hsz, v, bpp, opt); \
+mc_rep_func(avg, sz, hsz, v, bpp, opt)
+
+#define mc_rep_funcs_bpp(sz, hsz, opt) \
+mc_rep_funcs(sz, hsz, 10, opt); \
+mc_rep_funcs(sz, hsz, 12, opt)
+
+mc_rep_funcs_bpp(16,  8, sse2);
+mc_rep_funcs_bpp(32, 16, sse2);
+mc_rep_funcs_bpp(64, 32, sse2);
+#if HAVE_AVX2_EXTERNAL
+mc_rep_funcs_bpp(32, 16, avx2);
+mc_rep_funcs_bpp(64, 32, avx2);
+#endif
+
+#undef mc_rep_funcs_bpp
+#undef mc_rep_funcs
+#undef mc_rep_func
+
+#define filter_8tap_2d_fn(op, sz, f, fname, bpp, opt) \
+static void op##_8tap_##fname##_##sz##hv_##bpp##_##opt(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                       const uint8_t *src, ptrdiff_t src_stride, \
+                                                       int h, int mx, int my) \
+{ \
+    LOCAL_ALIGNED_32(uint16_t, temp, [71 * 64]); \
+    ff_vp9_put_8tap_1d_h_##sz##_##bpp##_##opt((uint8_t *) temp, 128, \
+                                              src - 3 * src_stride, src_stride, \
+                                              h + 7, ff_filters_16bpp[f][mx - 1]); \
+    ff_vp9_##op##_8tap_1d_v_##sz##_##bpp##_##opt(dst, dst_stride, \
+                                                 (const uint8_t *) (temp + 3 * 64), 128, \
+                                                 h, ff_filters_16bpp[f][my - 1]); \
+}
+
+#define filter_8tap_1d_fn(op, sz, f, fname, dir, dvar, bpp, opt) \
+static void op##_8tap_##fname##_##sz##dir##_##bpp##_##opt(uint8_t *dst, ptrdiff_t dst_stride, \
+                                                          const uint8_t *src, ptrdiff_t src_stride, \
+                                                          int h, int mx, int my) \
+{ \
+    ff_vp9_##op##_8tap_1d_##dir##_##sz##_##bpp##_##opt(dst, dst_stride, src, src_stride, \
+                                                       h, ff_filters_16bpp[f][dvar - 1]); \
+}
+
+#define filters_8tap_fn(op, sz, f, fname, bpp, opt) \
+filter_8tap_2d_fn(op, sz, f, fname, bpp, opt) \
+filter_8tap_1d_fn(op, sz, f, fname, h, mx, bpp, opt) \
+filter_8tap_1d_fn(op, sz, f, fname, v, my, bpp, opt)
+
+#define filters_8tap_fn2(op, sz, bpp, opt) \
+filters_8tap_fn(op, sz, FILTER_8TAP_REGULAR, regular, bpp, opt) \
+filters_8tap_fn(op, sz, FILTER_8TAP_SHARP,   sharp,   bpp, opt) \
+filters_8tap_fn(op, sz, FILTER_8TAP_SMOOTH,  smooth,  bpp, opt)
+
+#define filters_8tap_fn3(sz, bpp, opt) \
+filters_8tap_fn2(put, sz, bpp, opt) \
+filters_8tap_fn2(avg, sz, bpp, opt)
+
+#define filters_8tap_fn4(sz, opt) \
+filters_8tap_fn3(sz, 10, opt) \
+filters_8tap_fn3(sz, 12, opt)
+
+/* running the bilinear filter through the 8-tap kernels only pays off from
+ * 16 pixels up, the 4 and 8 pixel blocks keep the C version */
+#define filters_bilin_fn4(sz, opt) \
+filters_8tap_fn(put, sz, FILTER_BILINEAR, bilin, 10, opt) \
+filters_8tap_fn(avg, sz, FILTER_BILINEAR, bilin, 10, opt) \
+filters_8tap_fn(put, sz, FILTER_BILINEAR, bilin, 12, opt) \
+filters_8tap_fn(avg, sz, FILTER_BILINEAR, bilin, 12, opt)
+
+filters_8tap_fn4(64, sse2)
+filters_8tap_fn4(32, sse2)
+filters_8tap_fn4(16, sse2)
+filters_8tap_fn4(8,  sse2)
+filters_8tap_fn4(4,  sse2)
+filters_bilin_fn4(64, sse2)
+filters_bilin_fn4(32, sse2)
+filters_bilin_fn4(16, sse2)
+#if HAVE_AVX2_EXTERNAL
+filters_8tap_fn4(64, avx2)
+filters_8tap_fn4(32, avx2)
+filters_8tap_fn4(16, avx2)
+filters_bilin_fn4(64, avx2)
+filters_bilin_fn4(32, avx2)
+filters_bilin_fn4(16, avx2)
+#endif
+
+#undef filters_bilin_fn4
+#undef filters_8tap_fn4
+#undef filters_8tap_fn3
+#undef filters_8tap_fn2
+#undef filters_8tap_fn
+#undef filter_8tap_1d_fn
+#undef filter_8tap_2d_fn
+
+#define itxfm_func(typea, typeb, size, bpp, opt) \
+void ff_vp9_##typea##_##typeb##_##size##x##size##_add_##bpp##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                                   int16_t *block, int eob)
+#define itxfm_funcs(size, bpp, opt) \
+itxfm_func(idct,  idct,  size, bpp, opt); \
+itxfm_func(iadst, idct,  size, bpp, opt); \
+itxfm_func(idct,  iadst, size, bpp, opt); \
+itxfm_func(iadst, iadst, size, bpp, opt)
+
+itxfm_funcs(4, 10, sse2);
+itxfm_funcs(8, 10, sse2);
+itxfm_funcs(4, 12, sse2);
+itxfm_funcs(8, 12, sse2);
+itxfm_func(iwht, iwht, 4, 10, sse2);
+itxfm_func(iwht, iwht, 4, 12, sse2);
+
+#undef itxfm_funcs
+#undef itxfm_func
+
+#define lpf_func(dir, wd, bpp, opt) \
+void ff_vp9_loop_filter_##dir##_##wd##_8_##bpp##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                     int E, int I, int H)
+#define lpf_funcs(bpp, opt) \
+lpf_func(h,  4, bpp, opt); \
+lpf_func(v,  4, bpp, opt); \
+lpf_func(h,  8, bpp, opt); \
+lpf_func(v,  8, bpp, opt); \
+lpf_func(h, 16, bpp, opt); \
+lpf_func(v, 16, bpp, opt)
+
+lpf_funcs(10, sse2);
+lpf_funcs(12, sse2);
+
+#undef lpf_funcs
+#undef lpf_func
+
+/* the 16-pixel edges are filtered as two halves of 8 pixels */
+#define lpf_16_wrapper(dir, off, bpp, opt) \
+static void loop_filter_##dir##_16_16_##bpp##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                  int E, int I, int H) \
+{ \
+    ff_vp9_loop_filter_##dir##_16_8_##bpp##_##opt(dst,       stride, E, I, H); \
+    ff_vp9_loop_filter_##dir##_16_8_##bpp##_##opt(dst + off, stride, E, I, H); \
+}
+
+#define lpf_mix2_wrapper(dir, off, wd1, wd2, bpp, opt) \
+static void loop_filter_##dir##_##wd1##wd2##_16_##bpp##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                            int E, int I, int H) \
+{ \
+    ff_vp9_loop_filter_##dir##_##wd1##_8_##bpp##_##opt(dst,       stride, \
+                                                     E & 0xff, I & 0xff, H & 0xff); \
+    ff_vp9_loop_filter_##dir##_##wd2##_8_##bpp##_##opt(dst + off, stride, \
+                                                     E >> 8, I >> 8, H >> 8); \
+}
+
+#define lpf_wrappers_dir(dir, off, bpp, opt) \
+lpf_16_wrapper(dir, off, bpp, opt) \
+lpf_mix2_wrapper(dir, off, 4, 4, bpp, opt) \
+lpf_mix2_wrapper(dir, off, 4, 8, bpp, opt) \
+lpf_mix2_wrapper(dir, off, 8, 4, bpp, opt) \
+lpf_mix2_wrapper(dir, off, 8, 8, bpp, opt)
+
+#define lpf_wrappers(bpp, opt) \
+lpf_wrappers_dir(h, 8 * stride, bpp, opt) \
+lpf_wrappers_dir(v, 16,         bpp, opt)
+
+lpf_wrappers(10, sse2)
+lpf_wrappers(12, sse2)
+
+#undef lpf_wrappers
+#undef lpf_wrappers_dir
+#undef lpf_mix2_wrapper
+#undef lpf_16_wrapper
+#endif /* ARCH_X86_64 */
+
+#endif /* HAVE_YASM */
+
+av_cold void ff_vp9dsp_init_16bpp_x86(VP9DSPContext *dsp, int bpp)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+#define init_fpel(idx1, idx2, sz, type, opt) \
+    dsp->mc[idx1][FILTER_8TAP_SMOOTH ][idx2][0][0] = \
+    dsp->mc[idx1][FILTER_8TAP_REGULAR][idx2][0][0] = \
+    dsp->mc[idx1][FILTER_8TAP_SHARP  ][idx2][0][0] = \
+    dsp->mc[idx1][FILTER_BILINEAR    ][idx2][0][0] = ff_vp9_##type##sz##_##opt
+
+#define init_subpel1(idx1, idx2, idxh, idxv, sz, dir, type, bpp, opt) \
+    dsp->mc[idx1][FILTER_8TAP_SMOOTH ][idx2][idxh][idxv] = type##_8tap_smooth_##sz##dir##_##bpp##_##opt; \
+    dsp->mc[idx1][FILTER_8TAP_REGULAR][idx2][idxh][idxv] = type##_8tap_regular_##sz##dir##_##bpp##_##opt; \
+    dsp->mc[idx1][FILTER_8TAP_SHARP  ][idx2][idxh][idxv] = type##_8tap_sharp_##sz##dir##_##bpp##_##opt
+
+#define init_subpel1_bilin(idx1, idx2, idxh, idxv, sz, dir, type, bpp, opt) \
+    init_subpel1(idx1, idx2, idxh, idxv, sz, dir, type, bpp, opt); \
+    dsp->mc[idx1][FILTER_BILINEAR    ][idx2][idxh][idxv] = type##_8tap_bilin_##sz##dir##_##bpp##_##opt
+
+#define init_subpel2(idx1, idx2, sz, type, bpp, opt, init) \
+    init(idx1, idx2, 1, 1, sz, hv, type, bpp, opt); \
+    init(idx1, idx2, 0, 1, sz, v,  type, bpp, opt); \
+    init(idx1, idx2, 1, 0, sz, h,  type, bpp, opt)
+
+#define init_subpel3_16to64(idx, type, bpp, opt) \
+    init_subpel2(0, idx, 64, type, bpp, opt, init_subpel1_bilin); \
+    init_subpel2(1, idx, 32, type, bpp, opt, init_subpel1_bilin); \
+    init_subpel2(2, idx, 16, type, bpp, opt, init_subpel1_bilin)
+
+#define init_subpel3(idx, type, bpp, opt) \
+    init_subpel3_16to64(idx, type, bpp, opt); \
+    init_subpel2(3, idx,  8, type, bpp, opt, init_subpel1); \
+    init_subpel2(4, idx,  4, type, bpp, opt, init_subpel1)
+
+#define init_subpel_bpp(type, opt) do { \
+    if (bpp == 10) { \
+        type(0, put, 10, opt); \
+        type(1, avg, 10, opt); \
+    } else { \
+        type(0, put, 12, opt); \
+        type(1, avg, 12, opt); \
+    } \
+} while (0)
+
+#define init_ipred_dc(tx, sz, opt) do { \
+    dsp->intra_pred[tx][DC_PRED]      = ff_vp9_ipred_dc_##sz##x##sz##_16_##opt; \
+    dsp->intra_pred[tx][LEFT_DC_PRED] = ff_vp9_ipred_dc_left_##sz##x##sz##_16_##opt; \
+    dsp->intra_pred[tx][TOP_DC_PRED]  = ff_vp9_ipred_dc_top_##sz##x##sz##_16_##opt; \
+} while (0)
+
+#define init_ipred(tx, sz, opt) do { \
+    dsp->intra_pred[tx][VERT_PRED]    = ff_vp9_ipred_v_##sz##x##sz##_16_##opt; \
+    dsp->intra_pred[tx][HOR_PRED]     = ff_vp9_ipred_h_##sz##x##sz##_16_##opt; \
+    if (bpp == 10) \
+        dsp->intra_pred[tx][TM_VP8_PRED] = ff_vp9_ipred_tm_##sz##x##sz##_10_##opt; \
+    else \
+        dsp->intra_pred[tx][TM_VP8_PRED] = ff_vp9_ipred_tm_##sz##x##sz##_12_##opt; \
+} while (0)
+
+#define init_itx(tx, sz, bpp, opt) do { \
+    dsp->itxfm_add[tx][DCT_DCT]   = ff_vp9_idct_idct_##sz##_add_##bpp##_##opt; \
+    dsp->itxfm_add[tx][DCT_ADST]  = ff_vp9_iadst_idct_##sz##_add_##bpp##_##opt; \
+    dsp->itxfm_add[tx][ADST_DCT]  = ff_vp9_idct_iadst_##sz##_add_##bpp##_##opt; \
+    dsp->itxfm_add[tx][ADST_ADST] = ff_vp9_iadst_iadst_##sz##_add_##bpp##_##opt; \
+} while (0)
+
+/* the 16x16 and 32x32 transforms keep using the C code */
+#define init_itx_bpp(bpp, opt) do { \
+    init_itx(TX_4X4, 4x4, bpp, opt); \
+    init_itx(TX_8X8, 8x8, bpp, opt); \
+    dsp->itxfm_add[4 /* lossless */][DCT_DCT] = \
+    dsp->itxfm_add[4 /* lossless */][ADST_DCT] = \
+    dsp->itxfm_add[4 /* lossless */][DCT_ADST] = \
+    dsp->itxfm_add[4 /* lossless */][ADST_ADST] = ff_vp9_iwht_iwht_4x4_add_##bpp##_##opt; \
+} while (0)
+
+#define init_lpf(bpp, opt) do { \
+    dsp->loop_filter_8[0][0] = ff_vp9_loop_filter_h_4_8_##bpp##_##opt; \
+    dsp->loop_filter_8[0][1] = ff_vp9_loop_filter_v_4_8_##bpp##_##opt; \
+    dsp->loop_filter_8[1][0] = ff_vp9_loop_filter_h_8_8_##bpp##_##opt; \
+    dsp->loop_filter_8[1][1] = ff_vp9_loop_filter_v_8_8_##bpp##_##opt; \
+    dsp->loop_filter_8[2][0] = ff_vp9_loop_filter_h_16_8_##bpp##_##opt; \
+    dsp->loop_filter_8[2][1] = ff_vp9_loop_filter_v_16_8_##bpp##_##opt; \
+    dsp->loop_filter_16[0] = loop_filter_h_16_16_##bpp##_##opt; \
+    dsp->loop_filter_16[1] = loop_filter_v_16_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[0][0][0] = loop_filter_h_44_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[0][0][1] = loop_filter_v_44_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[0][1][0] = loop_filter_h_48_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[0][1][1] = loop_filter_v_48_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[1][0][0] = loop_filter_h_84_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[1][0][1] = loop_filter_v_84_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[1][1][0] = loop_filter_h_88_16_##bpp##_##opt; \
+    dsp->loop_filter_mix2[1][1][1] = loop_filter_v_88_16_##bpp##_##opt; \
+} while (0)
+
+    if (EXTERNAL_MMX(cpu_flags)) {
+        init_fpel(4, 0,   8, put, mmx);
+    }
+
+    if (EXTERNAL_MMXEXT(cpu_flags)) {
+        init_fpel(4, 1,  8_16, avg, mmxext);
+    }
+
+    if (EXTERNAL_SSE(cpu_flags)) {
+        init_fpel(3, 0,  16, put, sse);
+        init_fpel(2, 0,  32, put, sse);
+        init_fpel(1, 0,  64, put, sse);
+        init_fpel(0, 0, 128, put, sse);
+    }
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        init_fpel(3, 1,  16_16, avg, sse2);
+        init_fpel(2, 1,  32_16, avg, sse2);
+        init_fpel(1, 1,  64_16, avg, sse2);
+        init_fpel(0, 1, 128_16, avg, sse2);
+        init_ipred(TX_4X4,    4, sse2);
+        init_ipred(TX_8X8,    8, sse2);
+        init_ipred(TX_16X16, 16, sse2);
+        init_ipred(TX_32X32, 32, sse2);
+        init_ipred_dc(TX_8X8,    8, sse2);
+        init_ipred_dc(TX_16X16, 16, sse2);
+        init_ipred_dc(TX_32X32, 32, sse2);
+#if ARCH_X86_64
+        init_subpel_bpp(init_subpel3, sse2);
+        if (bpp == 10) {
+            init_itx_bpp(10, sse2);
+            init_lpf(10, sse2);
+        } else {
+            init_itx_bpp(12, sse2);
+            init_lpf(12, sse2);
+        }
+#endif
+    }
+
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        init_fpel(2, 0,  32, put, avx);
+        init_fpel(1, 0,  64, put, avx);
+        init_fpel(0, 0, 128, put, avx);
+    }
+
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        init_fpel(2, 1,  32_16, avg, avx2);
+        init_fpel(1, 1,  64_16, avg, avx2);
+        init_fpel(0, 1, 128_16, avg, avx2);
+#if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+        init_subpel_bpp(init_subpel3_16to64, avx2);
+#endif
+    }
+
+#undef init_lpf
+#undef init_itx_bpp
+#undef init_itx
+#undef init_ipred
+#undef init_ipred_dc
+#undef init_subpel_bpp
+#undef init_subpel3
+#undef init_subpel3_16to64
+#undef init_subpel2
+#undef init_subpel1_bilin
+#undef init_subpel1
+#undef init_fpel
+
+#endif /* HAVE_YASM */
+}
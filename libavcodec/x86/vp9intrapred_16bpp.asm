@@ -0,0 +1,288 @@
+;******************************************************************************
+;* VP9 Intra prediction SIMD optimizations for high bit depths
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+cextern pw_1
+cextern pw_1023
+cextern pw_4095
+
+SECTION .text
+
+; The edges are not guaranteed to be aligned for the smaller block sizes, so
+; they are always loaded with movh/movu. The left edge is stored bottom-up.
+
+; %1=row address, %2=block size in pixels, %3=source register
+%macro STORE_ROW 3
+%if %2 == 4
+    movh                  [%1], %3
+%else
+%assign %%c 0
+%rep %2 / 8
+    mova          [%1+%%c*16], %3
+%assign %%c %%c+1
+%endrep
+%endif
+%endmacro
+
+; fill a %1x%1 block with the splatted value in m0
+%macro FILL_BLOCK 1
+    mov                   cntd, %1 / 4
+.fill_loop:
+    STORE_ROW  dstq,            %1, m0
+    STORE_ROW  dstq+strideq,    %1, m0
+    STORE_ROW  dstq+strideq*2,  %1, m0
+    STORE_ROW  dstq+stride3q,   %1, m0
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .fill_loop
+%endmacro
+
+; accumulate the %1 edge pixels at %2 into the words of m0
+%macro SUM_EDGE 2
+%if %1 == 4
+    movh                    m1, [%2]
+    paddw                   m0, m1
+%else
+%assign %%c 0
+%rep %1 / 8
+    movu                    m1, [%2+%%c*16]
+    paddw                   m0, m1
+%assign %%c %%c+1
+%endrep
+%endif
+%endmacro
+
+; m0 = splat((sum of the dwords of pmaddwd(m0, pw_1) + %1) >> %2)
+%macro DC_ROUND_SPLAT 2
+    pmaddwd                 m0, [pw_1]
+    pshufd                  m1, m0, q1032
+    paddd                   m0, m1
+    pshufd                  m1, m0, q2301
+    paddd                   m0, m1
+    movd                  cntd, m0
+    add                   cntd, %1
+    shr                   cntd, %2
+    movd                    m0, cntd
+    pshuflw                 m0, m0, q0000
+    punpcklqdq              m0, m0
+%endmacro
+
+; the sum of up to 64 12-bit pixels does not fit in a word, but at most 8 are
+; added up per word lane before widening
+%macro IPRED_DC_FUNCS 2 ; size, log2(size)
+cglobal vp9_ipred_dc_%1x%1_16, 4, 6, 2, dst, stride, l, a, stride3, cnt
+    lea               stride3q, [strideq*3]
+    pxor                    m0, m0
+    SUM_EDGE               %1, lq
+    SUM_EDGE               %1, aq
+    DC_ROUND_SPLAT         %1, %2 + 1
+    FILL_BLOCK             %1
+    RET
+
+cglobal vp9_ipred_dc_left_%1x%1_16, 3, 5, 2, dst, stride, l, stride3, cnt
+    lea               stride3q, [strideq*3]
+    pxor                    m0, m0
+    SUM_EDGE               %1, lq
+    DC_ROUND_SPLAT         %1 / 2, %2
+    FILL_BLOCK             %1
+    RET
+
+cglobal vp9_ipred_dc_top_%1x%1_16, 4, 6, 2, dst, stride, l, a, stride3, cnt
+    lea               stride3q, [strideq*3]
+    pxor                    m0, m0
+    SUM_EDGE               %1, aq
+    DC_ROUND_SPLAT         %1 / 2, %2
+    FILL_BLOCK             %1
+    RET
+%endmacro
+
+%macro IPRED_V_FUNC 1
+cglobal vp9_ipred_v_%1x%1_16, 4, 6, 4, dst, stride, l, a, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, %1 / 4
+%if %1 == 4
+    movh                    m0, [aq]
+%else
+    movu                    m0, [aq]
+%endif
+%if %1 >= 16
+    movu                    m1, [aq+16]
+%endif
+%if %1 == 32
+    movu                    m2, [aq+32]
+    movu                    m3, [aq+48]
+%endif
+.loop:
+%assign %%r 0
+%rep 4
+%if %%r == 0
+%define %%row dstq
+%elif %%r == 1
+%define %%row dstq+strideq
+%elif %%r == 2
+%define %%row dstq+strideq*2
+%else
+%define %%row dstq+stride3q
+%endif
+%if %1 == 4
+    movh                [%%row], m0
+%else
+    mova                [%%row], m0
+%endif
+%if %1 >= 16
+    mova             [%%row+16], m1
+%endif
+%if %1 == 32
+    mova             [%%row+32], m2
+    mova             [%%row+48], m3
+%endif
+%assign %%r %%r+1
+%endrep
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+%endmacro
+
+; the rows are predicted four at a time from four left pixels in m1
+%macro IPRED_H_FUNC 1
+cglobal vp9_ipred_h_%1x%1_16, 3, 5, 2, dst, stride, l, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, %1 / 4
+    add                     lq, %1 * 2 - 8
+.loop:
+    movh                    m1, [lq]
+    pshuflw                 m0, m1, q3333
+    punpcklqdq              m0, m0
+    STORE_ROW  dstq,            %1, m0
+    pshuflw                 m0, m1, q2222
+    punpcklqdq              m0, m0
+    STORE_ROW  dstq+strideq,    %1, m0
+    pshuflw                 m0, m1, q1111
+    punpcklqdq              m0, m0
+    STORE_ROW  dstq+strideq*2,  %1, m0
+    pshuflw                 m0, m1, q0000
+    punpcklqdq              m0, m0
+    STORE_ROW  dstq+stride3q,   %1, m0
+    lea                   dstq, [dstq+strideq*4]
+    sub                     lq, 8
+    dec                   cntd
+    jg .loop
+    RET
+%endmacro
+
+; %1=row address, %2=block size, %3=shuffle selecting the left pixel,
+; %4=pixel max; m4-m7 hold top - topleft, m2 is zero
+%macro TM_ROW 4
+    pshuflw                 m0, m1, %3
+    punpcklqdq              m0, m0
+    paddw                   m3, m0, m4
+    pmaxsw                  m3, m2
+    pminsw                  m3, [%4]
+%if %2 == 4
+    movh                  [%1], m3
+%else
+    mova                  [%1], m3
+%endif
+%if %2 >= 16
+    paddw                   m3, m0, m5
+    pmaxsw                  m3, m2
+    pminsw                  m3, [%4]
+    mova               [%1+16], m3
+%endif
+%if %2 == 32
+    paddw                   m3, m0, m6
+    pmaxsw                  m3, m2
+    pminsw                  m3, [%4]
+    mova               [%1+32], m3
+    paddw                   m3, m0, m7
+    pmaxsw                  m3, m2
+    pminsw                  m3, [%4]
+    mova               [%1+48], m3
+%endif
+%endmacro
+
+%macro IPRED_TM_FUNC 2 ; size, bit depth
+%if %2 == 10
+%define %%max pw_1023
+%else
+%define %%max pw_4095
+%endif
+cglobal vp9_ipred_tm_%1x%1_%2, 4, 6, 8, dst, stride, l, a, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, %1 / 4
+    movd                    m0, [aq-4]
+    pshuflw                 m0, m0, q1111
+    punpcklqdq              m0, m0
+%if %1 == 4
+    movh                    m4, [aq]
+%else
+    movu                    m4, [aq]
+%endif
+    psubw                   m4, m0
+%if %1 >= 16
+    movu                    m5, [aq+16]
+    psubw                   m5, m0
+%endif
+%if %1 == 32
+    movu                    m6, [aq+32]
+    movu                    m7, [aq+48]
+    psubw                   m6, m0
+    psubw                   m7, m0
+%endif
+    pxor                    m2, m2
+    add                     lq, %1 * 2 - 8
+.loop:
+    movh                    m1, [lq]
+    TM_ROW     dstq,            %1, q3333, %%max
+    TM_ROW     dstq+strideq,    %1, q2222, %%max
+    TM_ROW     dstq+strideq*2,  %1, q1111, %%max
+    TM_ROW     dstq+stride3q,   %1, q0000, %%max
+    lea                   dstq, [dstq+strideq*4]
+    sub                     lq, 8
+    dec                   cntd
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+; the 4x4 dc predictors are no faster than the C code
+IPRED_DC_FUNCS  8, 3
+IPRED_DC_FUNCS 16, 4
+IPRED_DC_FUNCS 32, 5
+IPRED_V_FUNC    4
+IPRED_V_FUNC    8
+IPRED_V_FUNC   16
+IPRED_V_FUNC   32
+IPRED_H_FUNC    4
+IPRED_H_FUNC    8
+IPRED_H_FUNC   16
+IPRED_H_FUNC   32
+IPRED_TM_FUNC   4, 10
+IPRED_TM_FUNC   8, 10
+IPRED_TM_FUNC  16, 10
+IPRED_TM_FUNC  32, 10
+IPRED_TM_FUNC   4, 12
+IPRED_TM_FUNC   8, 12
+IPRED_TM_FUNC  16, 12
+IPRED_TM_FUNC  32, 12
@@ -0,0 +1,460 @@
+;******************************************************************************
+;* VP9 inverse transform x86 SIMD optimizations for high bit depths
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pd_8:     times 4 dd 8
+pd_16:    times 4 dd 16
+pd_8192:  times 4 dd 8192
+pd_16383: times 4 dd 16383
+
+pw_11585_11585:   times 4 dw  11585,  11585
+pw_11585_m11585:  times 4 dw  11585, -11585
+pw_6270_m15137:   times 4 dw   6270, -15137
+pw_15137_6270:    times 4 dw  15137,   6270
+pw_3196_m16069:   times 4 dw   3196, -16069
+pw_16069_3196:    times 4 dw  16069,   3196
+pw_13623_m9102:   times 4 dw  13623,  -9102
+pw_9102_13623:    times 4 dw   9102,  13623
+
+pw_5283_15212:    times 4 dw   5283,  15212
+pw_9929_13377:    times 4 dw   9929,  13377
+pw_9929_m5283:    times 4 dw   9929,  -5283
+pw_m15212_13377:  times 4 dw -15212,  13377
+pw_15212_9929:    times 4 dw  15212,   9929
+pw_m5283_m13377:  times 4 dw  -5283, -13377
+pw_13377_0:       times 4 dw  13377,      0
+
+pw_16305_1606:    times 4 dw  16305,   1606
+pw_1606_m16305:   times 4 dw   1606, -16305
+pw_10394_12665:   times 4 dw  10394,  12665
+pw_m10394_m12665: times 4 dw -10394, -12665
+pw_12665_m10394:  times 4 dw  12665, -10394
+pw_m12665_10394:  times 4 dw -12665,  10394
+pw_14449_7723:    times 4 dw  14449,   7723
+pw_7723_m14449:   times 4 dw   7723, -14449
+pw_4756_15679:    times 4 dw   4756,  15679
+pw_m4756_m15679:  times 4 dw  -4756, -15679
+pw_15679_m4756:   times 4 dw  15679,  -4756
+pw_m15679_4756:   times 4 dw -15679,   4756
+pw_15137_m6270:   times 4 dw  15137,  -6270
+pw_m15137_6270:   times 4 dw -15137,   6270
+pw_6270_15137:    times 4 dw   6270,  15137
+pw_m6270_m15137:  times 4 dw  -6270, -15137
+
+cextern pw_1023
+cextern pw_4095
+
+SECTION .text
+
+; The coefficients are 32 bits wide at high bit depths, and the products with
+; the 14-bit cosine constants need up to 50 bits, which is why the C code uses
+; 64-bit intermediates. Each coefficient a is split into a = ah * 2^14 + al,
+; with 0 <= al < 2^14, so that
+;   (a * c + b * d + 2^13) >> 14 == ah * c + bh * d + ((al * c + bl * d + 2^13) >> 14)
+; holds exactly and both halves can be evaluated with pmaddwd on interleaved
+; (a, b) word pairs. Four columns are transformed per register.
+
+; %1=lo out, %2=hi out, %3=a, %4=b, %5=tmp
+%macro SPLIT_14 5
+    mova                %1, %3
+    mova                %2, %1
+    pand                %1, [pd_16383]
+    psrad               %2, 14
+    pslld               %2, 16
+    psrld               %2, 16
+    mova                %5, %4
+    pslld               %5, 18
+    psrld               %5, 2
+    por                 %1, %5
+    mova                %5, %4
+    psrad               %5, 14
+    pslld               %5, 16
+    por                 %2, %5
+%endmacro
+
+; %1 = (a * c + b * d + 2^13) >> 14, with %2/%3 the split (a, b) pair and %4
+; the (c, d) constant; %5=tmp
+%macro DOT2_14 5
+    pmaddwd             %5, %2, [%4]
+    paddd               %5, [pd_8192]
+    psrad               %5, 14
+    pmaddwd             %1, %3, [%4]
+    paddd               %1, %5
+%endmacro
+
+; the same with the sum of two pairs; %8, %9=tmp
+%macro DOT4_14 9
+    pmaddwd             %8, %2, [%4]
+    pmaddwd             %9, %5, [%7]
+    paddd               %8, %9
+    paddd               %8, [pd_8192]
+    psrad               %8, 14
+    pmaddwd             %1, %3, [%4]
+    pmaddwd             %9, %6, [%7]
+    paddd               %1, %9
+    paddd               %1, %8
+%endmacro
+
+%macro NEGD 2 ; dst/src, tmp
+    pxor                %2, %2
+    psubd               %2, %1
+    mova                %1, %2
+%endmacro
+
+; 1D transforms of four columns of 32-bit coefficients; the inputs are read
+; from %1 + n * %2, the outputs are written to %3 + n * %4, which must not
+; overlap the inputs
+
+%macro IDCT4_1D 4
+    SPLIT_14            m0, m1, [%1+0*%2], [%1+2*%2], m8
+    SPLIT_14            m2, m3, [%1+1*%2], [%1+3*%2], m8
+    DOT2_14             m4, m0, m1, pw_11585_11585,  m8     ; t0
+    DOT2_14             m5, m0, m1, pw_11585_m11585, m8     ; t1
+    DOT2_14             m6, m2, m3, pw_6270_m15137,  m8     ; t2
+    DOT2_14             m7, m2, m3, pw_15137_6270,   m8     ; t3
+    paddd               m0, m4, m7
+    psubd               m4, m7
+    paddd               m1, m5, m6
+    psubd               m5, m6
+    mova        [%3+0*%4], m0
+    mova        [%3+1*%4], m1
+    mova        [%3+2*%4], m5
+    mova        [%3+3*%4], m4
+%endmacro
+
+%macro IADST4_1D 4
+    SPLIT_14            m0, m1, [%1+0*%2], [%1+2*%2], m8
+    SPLIT_14            m2, m3, [%1+3*%2], [%1+1*%2], m8
+    DOT4_14             m4, m0, m1, pw_5283_15212, m2, m3, pw_9929_13377,   m8, m9
+    DOT4_14             m5, m0, m1, pw_9929_m5283, m2, m3, pw_m15212_13377, m8, m9
+    DOT4_14             m6, m0, m1, pw_15212_9929, m2, m3, pw_m5283_m13377, m8, m9
+    mova                m7, [%1+0*%2]
+    psubd               m7, [%1+2*%2]
+    paddd               m7, [%1+3*%2]
+    SPLIT_14            m0, m1, m7, [%1+1*%2], m8
+    DOT2_14             m7, m0, m1, pw_13377_0, m8
+    mova        [%3+0*%4], m4
+    mova        [%3+1*%4], m5
+    mova        [%3+2*%4], m7
+    mova        [%3+3*%4], m6
+%endmacro
+
+%macro IDCT8_1D 4
+    SPLIT_14            m0, m1, [%1+0*%2], [%1+4*%2], m8
+    SPLIT_14            m2, m3, [%1+2*%2], [%1+6*%2], m8
+    SPLIT_14            m4, m5, [%1+1*%2], [%1+7*%2], m8
+    SPLIT_14            m6, m7, [%1+5*%2], [%1+3*%2], m8
+    DOT2_14             m8, m0, m1, pw_11585_11585,  m12    ; t0a
+    DOT2_14             m9, m0, m1, pw_11585_m11585, m12    ; t1a
+    DOT2_14            m10, m2, m3, pw_6270_m15137,  m12    ; t2a
+    DOT2_14            m11, m2, m3, pw_15137_6270,   m12    ; t3a
+    paddd               m0, m8, m11                         ; t0
+    psubd               m8, m11                             ; t3
+    paddd               m1, m9, m10                         ; t1
+    psubd               m9, m10                             ; t2
+    mova        [%3+0*%4], m0
+    mova        [%3+1*%4], m1
+    mova        [%3+2*%4], m9
+    mova        [%3+3*%4], m8
+    DOT2_14             m0, m4, m5, pw_3196_m16069,  m12    ; t4a
+    DOT2_14             m1, m4, m5, pw_16069_3196,   m12    ; t7a
+    DOT2_14             m2, m6, m7, pw_13623_m9102,  m12    ; t5a
+    DOT2_14             m3, m6, m7, pw_9102_13623,   m12    ; t6a
+    paddd               m8, m0, m2                          ; t4
+    psubd               m0, m2                              ; t5a
+    paddd               m9, m1, m3                          ; t7
+    psubd               m1, m3                              ; t6a
+    SPLIT_14            m2, m3, m1, m0, m12
+    DOT2_14             m4, m2, m3, pw_11585_m11585, m12    ; t5
+    DOT2_14             m5, m2, m3, pw_11585_11585,  m12    ; t6
+    mova                m0, [%3+0*%4]
+    mova                m1, [%3+1*%4]
+    mova                m2, [%3+2*%4]
+    mova                m3, [%3+3*%4]
+    paddd               m6, m0, m9
+    psubd               m0, m9
+    mova        [%3+0*%4], m6
+    mova        [%3+7*%4], m0
+    paddd               m6, m1, m5
+    psubd               m1, m5
+    mova        [%3+1*%4], m6
+    mova        [%3+6*%4], m1
+    paddd               m6, m2, m4
+    psubd               m2, m4
+    mova        [%3+2*%4], m6
+    mova        [%3+5*%4], m2
+    paddd               m6, m3, m8
+    psubd               m3, m8
+    mova        [%3+3*%4], m6
+    mova        [%3+4*%4], m3
+%endmacro
+
+%macro IADST8_1D 4
+    SPLIT_14            m0, m1, [%1+7*%2], [%1+0*%2], m12
+    SPLIT_14            m2, m3, [%1+3*%2], [%1+4*%2], m12
+    SPLIT_14            m4, m5, [%1+5*%2], [%1+2*%2], m12
+    SPLIT_14            m6, m7, [%1+1*%2], [%1+6*%2], m12
+    DOT4_14             m8, m0, m1, pw_16305_1606,  m2, m3, pw_10394_12665,   m12, m13 ; t0
+    DOT4_14             m9, m0, m1, pw_16305_1606,  m2, m3, pw_m10394_m12665, m12, m13 ; t4
+    DOT4_14            m10, m0, m1, pw_1606_m16305, m2, m3, pw_12665_m10394,  m12, m13 ; t1
+    DOT4_14            m11, m0, m1, pw_1606_m16305, m2, m3, pw_m12665_10394,  m12, m13 ; t5
+    DOT4_14             m0, m4, m5, pw_14449_7723,  m6, m7, pw_4756_15679,    m12, m13 ; t2
+    DOT4_14             m1, m4, m5, pw_14449_7723,  m6, m7, pw_m4756_m15679,  m12, m13 ; t6
+    DOT4_14             m2, m4, m5, pw_7723_m14449, m6, m7, pw_15679_m4756,   m12, m13 ; t3
+    DOT4_14             m3, m4, m5, pw_7723_m14449, m6, m7, pw_m15679_4756,   m12, m13 ; t7
+    paddd               m4, m8, m0
+    psubd               m8, m0                              ; t2
+    mova        [%3+0*%4], m4
+    paddd               m5, m10, m2
+    psubd              m10, m2                              ; t3
+    NEGD                m5, m12
+    mova        [%3+7*%4], m5
+    SPLIT_14            m4, m5, m9, m11, m12
+    SPLIT_14            m6, m7, m3, m1, m12
+    DOT4_14             m0, m4, m5, pw_15137_6270,  m6, m7, pw_15137_m6270,   m12, m13
+    NEGD                m0, m12
+    mova        [%3+1*%4], m0
+    DOT4_14             m0, m4, m5, pw_6270_m15137, m6, m7, pw_6270_15137,    m12, m13
+    mova        [%3+6*%4], m0
+    DOT4_14             m9, m4, m5, pw_15137_6270,  m6, m7, pw_m15137_6270,   m12, m13 ; t6
+    DOT4_14            m11, m4, m5, pw_6270_m15137, m6, m7, pw_m6270_m15137,  m12, m13 ; t7
+    SPLIT_14            m4, m5, m8, m10, m12
+    DOT2_14             m0, m4, m5, pw_11585_11585,  m12
+    NEGD                m0, m12
+    mova        [%3+3*%4], m0
+    DOT2_14             m0, m4, m5, pw_11585_m11585, m12
+    mova        [%3+4*%4], m0
+    SPLIT_14            m4, m5, m9, m11, m12
+    DOT2_14             m0, m4, m5, pw_11585_11585,  m12
+    mova        [%3+2*%4], m0
+    DOT2_14             m0, m4, m5, pw_11585_m11585, m12
+    NEGD                m0, m12
+    mova        [%3+5*%4], m0
+%endmacro
+
+; lossless Walsh-Hadamard transform; %5=1 for the first pass
+%macro IWHT4_1D 5
+    mova                m0, [%1+0*%2]
+    mova                m1, [%1+3*%2]
+    mova                m2, [%1+1*%2]
+    mova                m3, [%1+2*%2]
+%if %5
+    psrad               m0, 2
+    psrad               m1, 2
+    psrad               m2, 2
+    psrad               m3, 2
+%endif
+    paddd               m0, m2
+    psubd               m3, m1
+    psubd               m4, m0, m3
+    psrad               m4, 1
+    psubd               m5, m4, m1
+    psubd               m4, m2
+    psubd               m0, m5
+    paddd               m3, m4
+    mova        [%3+0*%4], m0
+    mova        [%3+1*%4], m5
+    mova        [%3+2*%4], m4
+    mova        [%3+3*%4], m3
+%endmacro
+
+; transpose the 4x4 dwords at %1 + n * %2 into %3 + n * %4
+%macro TRANSPOSE4x4D_MEM 4
+    mova                m0, [%1+0*%2]
+    mova                m1, [%1+1*%2]
+    mova                m2, [%1+2*%2]
+    mova                m3, [%1+3*%2]
+    punpckldq           m4, m0, m1
+    punpckhdq           m0, m1
+    punpckldq           m5, m2, m3
+    punpckhdq           m2, m3
+    punpcklqdq          m1, m4, m5
+    punpckhqdq          m4, m5
+    punpcklqdq          m3, m0, m2
+    punpckhqdq          m0, m2
+    mova        [%3+0*%4], m1
+    mova        [%3+1*%4], m4
+    mova        [%3+2*%4], m3
+    mova        [%3+3*%4], m0
+%endmacro
+
+; add the row of four 32-bit residuals in m0 to the pixels at %1 and clip
+; them; m6 is zero and m7 holds the pixel max
+%macro ADD_RES_ROW 1
+    movh                m1, [%1]
+    punpcklwd           m1, m6
+    paddd               m0, m1
+    packssdw            m0, m0
+    pmaxsw              m0, m6
+    pminsw              m0, m7
+    movh              [%1], m0
+%endmacro
+
+; %1=block size, %2=rounding shift, %3=pixel max
+%macro ITXFM_DC_ONLY 3
+    cmp               eobd, 1
+    jg .full
+    mov               eobd, [blockq]
+    imul              eobd, 11585
+    add               eobd, 8192
+    sar               eobd, 14
+    imul              eobd, 11585
+    add               eobd, 8192
+    sar               eobd, 14
+    add               eobd, 1 << (%2 - 1)
+    sar               eobd, %2
+    mov       dword [blockq], 0
+    movd                m2, eobd
+    pshufd              m2, m2, q0000
+    pxor                m6, m6
+    mova                m7, [%3]
+    mov               eobd, %1
+.dc_loop:
+%assign %%x 0
+%rep %1 / 4
+    mova                m0, m2
+    ADD_RES_ROW dstq+%%x*8
+%assign %%x %%x+1
+%endrep
+    add               dstq, strideq
+    dec               eobd
+    jg .dc_loop
+    RET
+.full:
+%endmacro
+
+; %1=first pass (column) transform, %2=second pass (row) transform,
+; %3=bit depth
+%macro ITXFM_4x4_FN 3
+%if %3 == 10
+%define %%max pw_1023
+%else
+%define %%max pw_4095
+%endif
+cglobal vp9_%1_%2_4x4_add_%3, 4, 4, 10, 12 * 16, dst, stride, block, eob
+%ifidn %1_%2, idct_idct
+    ITXFM_DC_ONLY        4, 4, %%max
+%endif
+%ifidn %1, iwht
+    IWHT4_1D        blockq, 16, rsp, 16, 1
+%elifidn %1, idct
+    IDCT4_1D        blockq, 16, rsp, 16
+%else
+    IADST4_1D       blockq, 16, rsp, 16
+%endif
+    TRANSPOSE4x4D_MEM  rsp, 16, rsp+64, 16
+%ifidn %2, iwht
+    IWHT4_1D        rsp+64, 16, rsp+128, 16, 0
+%elifidn %2, idct
+    IDCT4_1D        rsp+64, 16, rsp+128, 16
+%else
+    IADST4_1D       rsp+64, 16, rsp+128, 16
+%endif
+    pxor                m6, m6
+    mova                m7, [%%max]
+    mova   [blockq+ 0], m6
+    mova   [blockq+16], m6
+    mova   [blockq+32], m6
+    mova   [blockq+48], m6
+%assign %%y 0
+%rep 4
+    mova                m0, [rsp+128+%%y*16]
+%ifnidn %1, iwht
+    paddd               m0, [pd_8]
+    psrad               m0, 4
+%endif
+    ADD_RES_ROW       dstq
+    add               dstq, strideq
+%assign %%y %%y+1
+%endrep
+    RET
+%endmacro
+
+; the first pass writes row n of both column halves to rsp + n * 32, which
+; is transposed one 4x4 quarter at a time into the second pass input
+%macro ITXFM_8x8_FN 3
+%if %3 == 10
+%define %%max pw_1023
+%else
+%define %%max pw_4095
+%endif
+cglobal vp9_%1_%2_8x8_add_%3, 4, 5, 14, 32 * 16, dst, stride, block, eob, dst2
+%ifidn %1_%2, idct_idct
+    ITXFM_DC_ONLY        8, 5, %%max
+%endif
+%ifidn %1, idct
+    IDCT8_1D        blockq,    32, rsp,    32
+    IDCT8_1D        blockq+16, 32, rsp+16, 32
+%else
+    IADST8_1D       blockq,    32, rsp,    32
+    IADST8_1D       blockq+16, 32, rsp+16, 32
+%endif
+    pxor                m0, m0
+%assign %%n 0
+%rep 16
+    mova [blockq+%%n*16], m0
+%assign %%n %%n+1
+%endrep
+%assign %%h 0
+%rep 2
+    TRANSPOSE4x4D_MEM  rsp+%%h*128,    32, rsp+256,    16
+    TRANSPOSE4x4D_MEM  rsp+%%h*128+16, 32, rsp+256+64, 16
+%ifidn %2, idct
+    IDCT8_1D        rsp+256, 16, rsp+384, 16
+%else
+    IADST8_1D       rsp+256, 16, rsp+384, 16
+%endif
+    pxor                m6, m6
+    mova                m7, [%%max]
+    lea              dst2q, [dstq+%%h*8]
+%assign %%y 0
+%rep 8
+    mova                m0, [rsp+384+%%y*16]
+    paddd               m0, [pd_16]
+    psrad               m0, 5
+    ADD_RES_ROW      dst2q
+    add              dst2q, strideq
+%assign %%y %%y+1
+%endrep
+%assign %%h %%h+1
+%endrep
+    RET
+%endmacro
+
+%macro ITXFM_FUNCS 1
+ITXFM_4x4_FN iwht,  iwht,  %1
+ITXFM_4x4_FN idct,  idct,  %1
+ITXFM_4x4_FN iadst, idct,  %1
+ITXFM_4x4_FN idct,  iadst, %1
+ITXFM_4x4_FN iadst, iadst, %1
+ITXFM_8x8_FN idct,  idct,  %1
+ITXFM_8x8_FN iadst, idct,  %1
+ITXFM_8x8_FN idct,  iadst, %1
+ITXFM_8x8_FN iadst, iadst, %1
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+ITXFM_FUNCS 10
+ITXFM_FUNCS 12
+%endif
@@ -0,0 +1,549 @@
+;******************************************************************************
+;* VP9 loop filter SIMD optimizations for high bit depths
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_m512:  times 8 dw -512
+pw_511:   times 8 dw 511
+pw_m2048: times 8 dw -2048
+pw_2047:  times 8 dw 2047
+
+cextern pw_1
+cextern pw_3
+cextern pw_4
+cextern pw_8
+cextern pw_16
+cextern pw_1023
+cextern pw_4095
+
+SECTION .text
+
+; The pixels on both sides of the edge are first gathered (and transposed for
+; the horizontal filters) into a stack buffer of 16 rows p7..q7 of 8 pixels.
+; The filters read the unmodified pixels from there and write their results
+; into a second buffer of 16 rows, which is then written back to the frame.
+%define P7  rsp+ 0*16
+%define P6  rsp+ 1*16
+%define P5  rsp+ 2*16
+%define P4  rsp+ 3*16
+%define P3  rsp+ 4*16
+%define P2  rsp+ 5*16
+%define P1  rsp+ 6*16
+%define P0  rsp+ 7*16
+%define Q0  rsp+ 8*16
+%define Q1  rsp+ 9*16
+%define Q2  rsp+10*16
+%define Q3  rsp+11*16
+%define Q4  rsp+12*16
+%define Q5  rsp+13*16
+%define Q6  rsp+14*16
+%define Q7  rsp+15*16
+%define OUT rsp+16*16
+%define M8  rsp+32*16
+%define M16 rsp+33*16
+%define LPF_STACK 34*16
+
+%macro ABSSUB_W 4 ; dst, src1, src2, tmp
+    psubusw             %1, %2, %3
+    psubusw             %4, %3, %2
+    por                 %1, %4
+%endmacro
+
+; %1=new_data/dst %2=old_data %3=mask
+%macro MASK_APPLY_W 3
+    pxor                %1, %2
+    pand                %1, %3
+    pxor                %1, %2
+%endmacro
+
+%macro SPLAT_THRESH 2 ; dst, gpr
+    movd                %1, %2
+    pshuflw             %1, %1, q0000
+    punpcklqdq          %1, %1
+%endmacro
+
+; 8x8 word transpose of m0-m7; the result rows end up in
+; m1, m2, m3, m5, m6, m7, m9 and m11
+%macro TRANSPOSE8x8W_LPF 0
+    punpcklwd           m8, m0, m1
+    punpckhwd           m0, m1
+    punpcklwd           m9, m2, m3
+    punpckhwd           m2, m3
+    punpcklwd          m10, m4, m5
+    punpckhwd           m4, m5
+    punpcklwd          m11, m6, m7
+    punpckhwd           m6, m7
+    punpckldq          m12, m8, m9
+    punpckhdq           m8, m9
+    punpckldq          m13, m10, m11
+    punpckhdq          m10, m11
+    punpckldq          m14, m0, m2
+    punpckhdq           m0, m2
+    punpckldq          m15, m4, m6
+    punpckhdq           m4, m6
+    punpcklqdq          m1, m12, m13
+    punpckhqdq          m2, m12, m13
+    punpcklqdq          m3, m8, m10
+    punpckhqdq          m5, m8, m10
+    punpcklqdq          m6, m14, m15
+    punpckhqdq          m7, m14, m15
+    punpcklqdq          m9, m0, m4
+    punpckhqdq         m11, m0, m4
+%endmacro
+
+%macro LOAD_8ROWS 1 ; byte offset of the first column
+    movu                m0, [dstq +%1]
+    movu                m1, [dstq +strideq  +%1]
+    movu                m2, [dstq +strideq*2+%1]
+    movu                m3, [dstq +stride3q +%1]
+    movu                m4, [dst4q+%1]
+    movu                m5, [dst4q+strideq  +%1]
+    movu                m6, [dst4q+strideq*2+%1]
+    movu                m7, [dst4q+stride3q +%1]
+%endmacro
+
+%macro STORE_8ROWS 1 ; byte offset of the first column
+    movu   [dstq +%1], m1
+    movu   [dstq +strideq  +%1], m2
+    movu   [dstq +strideq*2+%1], m3
+    movu   [dstq +stride3q +%1], m5
+    movu   [dst4q+%1], m6
+    movu   [dst4q+strideq  +%1], m7
+    movu   [dst4q+strideq*2+%1], m9
+    movu   [dst4q+stride3q +%1], m11
+%endmacro
+
+; store the transposed rows into both stack buffers, starting at row %1
+%macro STORE_TRANSPOSED 1
+    mova  [rsp+(%1+0)*16], m1
+    mova  [OUT+(%1+0)*16], m1
+    mova  [rsp+(%1+1)*16], m2
+    mova  [OUT+(%1+1)*16], m2
+    mova  [rsp+(%1+2)*16], m3
+    mova  [OUT+(%1+2)*16], m3
+    mova  [rsp+(%1+3)*16], m5
+    mova  [OUT+(%1+3)*16], m5
+    mova  [rsp+(%1+4)*16], m6
+    mova  [OUT+(%1+4)*16], m6
+    mova  [rsp+(%1+5)*16], m7
+    mova  [OUT+(%1+5)*16], m7
+    mova  [rsp+(%1+6)*16], m9
+    mova  [OUT+(%1+6)*16], m9
+    mova  [rsp+(%1+7)*16], m11
+    mova  [OUT+(%1+7)*16], m11
+%endmacro
+
+%macro LOAD_OUT 1 ; first row
+    mova                m0, [OUT+(%1+0)*16]
+    mova                m1, [OUT+(%1+1)*16]
+    mova                m2, [OUT+(%1+2)*16]
+    mova                m3, [OUT+(%1+3)*16]
+    mova                m4, [OUT+(%1+4)*16]
+    mova                m5, [OUT+(%1+5)*16]
+    mova                m6, [OUT+(%1+6)*16]
+    mova                m7, [OUT+(%1+7)*16]
+%endmacro
+
+; %1=v/h %2=filter width (4, 8 or 16) %3=bit depth (10 or 12)
+%macro LOOPFILTER_16 3
+%if %3 == 10
+%define %%max   pw_1023
+%define %%flat  pw_4
+%define %%fmin  pw_m512
+%define %%fmax  pw_511
+%define %%shift 2
+%else
+%define %%max   pw_4095
+%define %%flat  pw_16
+%define %%fmin  pw_m2048
+%define %%fmax  pw_2047
+%define %%shift 4
+%endif
+%if %2 == 16
+%define %%first 0
+%define %%rows  16
+%else
+%define %%first 4
+%define %%rows  8
+%endif
+
+cglobal vp9_loop_filter_%1_%2_8_%3, 5, 8, 16, LPF_STACK, dst, stride, E, I, H, dst4, stride3, tmp
+    lea           stride3q, [strideq*3]
+    shl                 Ed, %%shift
+    shl                 Id, %%shift
+    shl                 Hd, %%shift
+    SPLAT_THRESH       m13, Id
+    SPLAT_THRESH       m14, Ed
+    SPLAT_THRESH       m15, Hd
+
+    ; gather the pixels p7/p3..q3/q7 into the stack buffers
+%ifidn %1, v
+%if %2 == 16
+    lea               tmpq, [strideq*8]
+%else
+    lea               tmpq, [strideq*4]
+%endif
+    mov              dst4q, dstq
+    sub              dst4q, tmpq
+    mov               tmpq, dst4q
+%assign %%n %%first
+%rep %%rows
+    movu                m0, [tmpq]
+    mova  [rsp+%%n*16], m0
+    mova  [OUT+%%n*16], m0
+    add               tmpq, strideq
+%assign %%n %%n+1
+%endrep
+%else
+    mova             [M8], m13 ; the transposes clobber m8-m15
+    mova            [M16], m14
+    lea              dst4q, [dstq+strideq*4]
+%if %2 == 16
+    LOAD_8ROWS         -16
+    TRANSPOSE8x8W_LPF
+    STORE_TRANSPOSED     0
+    LOAD_8ROWS           0
+    TRANSPOSE8x8W_LPF
+    STORE_TRANSPOSED     8
+%else
+    LOAD_8ROWS          -8
+    TRANSPOSE8x8W_LPF
+    STORE_TRANSPOSED     4
+%endif
+    mova               m13, [M8]
+    mova               m14, [M16]
+    SPLAT_THRESH       m15, Hd
+%endif
+
+    ; filter mask (m10), hev mask (m11)
+    mova                m0, [P3]
+    mova                m1, [P2]
+    mova                m2, [P1]
+    mova                m3, [P0]
+    mova                m4, [Q0]
+    mova                m5, [Q1]
+    mova                m6, [Q2]
+    mova                m7, [Q3]
+    ABSSUB_W           m10, m0, m1, m9
+    pcmpgtw            m10, m13
+    ABSSUB_W            m8, m1, m2, m9
+    pcmpgtw             m8, m13
+    por                m10, m8
+    ABSSUB_W            m8, m2, m3, m9
+    mova               m11, m8
+    pcmpgtw            m11, m15
+    pcmpgtw             m8, m13
+    por                m10, m8
+    ABSSUB_W            m8, m5, m4, m9
+    mova               m12, m8
+    pcmpgtw            m12, m15
+    por                m11, m12
+    pcmpgtw             m8, m13
+    por                m10, m8
+    ABSSUB_W            m8, m6, m5, m9
+    pcmpgtw             m8, m13
+    por                m10, m8
+    ABSSUB_W            m8, m7, m6, m9
+    pcmpgtw             m8, m13
+    por                m10, m8
+    ABSSUB_W            m8, m3, m4, m9
+    paddw               m8, m8
+    ABSSUB_W           m12, m2, m5, m9
+    psrlw              m12, 1
+    paddw               m8, m12
+    pcmpgtw             m8, m14
+    por                m10, m8
+    pmovmskb          tmpd, m10
+    cmp               tmpd, 0xffff
+    je .end
+    pcmpeqw             m9, m9
+    pxor               m10, m9
+
+%if %2 >= 8
+    ; flat8in mask (m12)
+    mova               m13, [%%flat]
+    ABSSUB_W           m12, m0, m3, m9
+    pcmpgtw            m12, m13
+    ABSSUB_W            m8, m1, m3, m9
+    pcmpgtw             m8, m13
+    por                m12, m8
+    ABSSUB_W            m8, m2, m3, m9
+    pcmpgtw             m8, m13
+    por                m12, m8
+    ABSSUB_W            m8, m5, m4, m9
+    pcmpgtw             m8, m13
+    por                m12, m8
+    ABSSUB_W            m8, m6, m4, m9
+    pcmpgtw             m8, m13
+    por                m12, m8
+    ABSSUB_W            m8, m7, m4, m9
+    pcmpgtw             m8, m13
+    por                m12, m8
+    pandn              m12, m10
+    mova             [M8], m12
+%endif
+
+%if %2 == 16
+    ; flat8out mask (m14)
+    mova               m15, [P7]
+    ABSSUB_W           m14, m15, m3, m9
+    pcmpgtw            m14, m13
+    mova               m15, [P6]
+    ABSSUB_W            m8, m15, m3, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [P5]
+    ABSSUB_W            m8, m15, m3, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [P4]
+    ABSSUB_W            m8, m15, m3, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [Q4]
+    ABSSUB_W            m8, m15, m4, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [Q5]
+    ABSSUB_W            m8, m15, m4, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [Q6]
+    ABSSUB_W            m8, m15, m4, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    mova               m15, [Q7]
+    ABSSUB_W            m8, m15, m4, m9
+    pcmpgtw             m8, m13
+    por                m14, m8
+    pandn              m14, m12
+    mova            [M16], m14
+%endif
+
+    ; filter4: f = clip(3 * (q0 - p0) + (hev ? clip(p1 - q1) : 0))
+    pxor               m14, m14
+    mova               m15, [%%max]
+    psubw               m8, m2, m5
+    pmaxsw              m8, [%%fmin]
+    pminsw              m8, [%%fmax]
+    pand                m8, m11
+    psubw               m9, m4, m3
+    paddw               m8, m9
+    paddw               m8, m9
+    paddw               m8, m9
+    pmaxsw              m8, [%%fmin]
+    pminsw              m8, [%%fmax]
+    paddw               m9, m8, [pw_4]
+    pminsw              m9, [%%fmax]
+    psraw               m9, 3                   ; f1
+    paddw               m8, [pw_3]
+    pminsw              m8, [%%fmax]
+    psraw               m8, 3                   ; f2
+    paddw              m12, m3, m8
+    pmaxsw             m12, m14
+    pminsw             m12, m15
+    MASK_APPLY_W       m12, m3, m10
+    mova        [OUT+7*16], m12
+    psubw              m12, m4, m9
+    pmaxsw             m12, m14
+    pminsw             m12, m15
+    MASK_APPLY_W       m12, m4, m10
+    mova        [OUT+8*16], m12
+    paddw               m9, [pw_1]
+    psraw               m9, 1
+    pandn              m11, m9                  ; !hev ? (f1 + 1) >> 1 : 0
+    paddw              m12, m2, m11
+    pmaxsw             m12, m14
+    pminsw             m12, m15
+    MASK_APPLY_W       m12, m2, m10
+    mova        [OUT+6*16], m12
+    psubw              m12, m5, m11
+    pmaxsw             m12, m14
+    pminsw             m12, m15
+    MASK_APPLY_W       m12, m5, m10
+    mova        [OUT+9*16], m12
+
+%if %2 >= 8
+    ; filter8, as a running sum over p3..q3
+    mova               m12, [M8]
+    pmovmskb          tmpd, m12
+    test              tmpd, tmpd
+    jz .store
+    paddw               m8, m0, m0
+    paddw               m8, m0
+    paddw               m8, m1
+    paddw               m8, m1
+    paddw               m8, m2
+    paddw               m8, m3
+    paddw               m8, m4
+    paddw               m8, [pw_4]
+    psrlw               m9, m8, 3
+    MASK_APPLY_W        m9, m1, m12
+    mova        [OUT+5*16], m9
+    psubw               m8, m0
+    psubw               m8, m1
+    paddw               m8, m2
+    paddw               m8, m5
+    psrlw               m9, m8, 3
+    mova               m10, [OUT+6*16]
+    MASK_APPLY_W        m9, m10, m12
+    mova        [OUT+6*16], m9
+    psubw               m8, m0
+    psubw               m8, m2
+    paddw               m8, m3
+    paddw               m8, m6
+    psrlw               m9, m8, 3
+    mova               m10, [OUT+7*16]
+    MASK_APPLY_W        m9, m10, m12
+    mova        [OUT+7*16], m9
+    psubw               m8, m0
+    psubw               m8, m3
+    paddw               m8, m4
+    paddw               m8, m7
+    psrlw               m9, m8, 3
+    mova               m10, [OUT+8*16]
+    MASK_APPLY_W        m9, m10, m12
+    mova        [OUT+8*16], m9
+    psubw               m8, m1
+    psubw               m8, m4
+    paddw               m8, m5
+    paddw               m8, m7
+    psrlw               m9, m8, 3
+    mova               m10, [OUT+9*16]
+    MASK_APPLY_W        m9, m10, m12
+    mova        [OUT+9*16], m9
+    psubw               m8, m2
+    psubw               m8, m5
+    paddw               m8, m6
+    paddw               m8, m7
+    psrlw               m9, m8, 3
+    MASK_APPLY_W        m9, m6, m12
+    mova       [OUT+10*16], m9
+%endif
+
+%if %2 == 16
+    ; filter16, as a running sum over p7..q7; the sum of 16 12-bit pixels
+    ; does not fit in a signed word, so it is treated as unsigned
+    mova               m12, [M16]
+    pmovmskb          tmpd, m12
+    test              tmpd, tmpd
+    jz .store
+    mova                m8, [P7]
+    psllw               m8, 3
+    psubw               m8, [P7]
+    paddw               m8, [P6]
+    paddw               m8, [P6]
+    paddw               m8, [P5]
+    paddw               m8, [P4]
+    paddw               m8, [P3]
+    paddw               m8, [P2]
+    paddw               m8, [P1]
+    paddw               m8, [P0]
+    paddw               m8, [Q0]
+    paddw               m8, [pw_8]
+%assign %%n 1
+%rep 14
+    psrlw               m9, m8, 4
+%if %%n >= 5 && %%n <= 10
+    mova               m10, [OUT+%%n*16]
+%else
+    mova               m10, [rsp+%%n*16]
+%endif
+    MASK_APPLY_W        m9, m10, m12
+    mova     [OUT+%%n*16], m9
+%if %%n < 14
+%if %%n + 8 > 15
+    paddw               m8, [Q7]
+%else
+    paddw               m8, [rsp+(%%n+8)*16]
+%endif
+%if %%n - 7 < 0
+    psubw               m8, [P7]
+%else
+    psubw               m8, [rsp+(%%n-7)*16]
+%endif
+    paddw               m8, [rsp+(%%n+1)*16]
+    psubw               m8, [rsp+%%n*16]
+%endif
+%assign %%n %%n+1
+%endrep
+%endif
+
+.store:
+%ifidn %1, v
+%if %2 == 4
+    mova                m0, [OUT+6*16]
+    mova                m1, [OUT+7*16]
+    mova                m2, [OUT+8*16]
+    mova                m3, [OUT+9*16]
+    movu [dst4q+strideq*2], m0
+    movu  [dst4q+stride3q], m1
+    movu            [dstq], m2
+    movu    [dstq+strideq], m3
+%else
+%if %2 == 8
+%assign %%n 5
+%define %%last 10
+%else
+%assign %%n 1
+%define %%last 14
+%endif
+    lea               tmpq, [dst4q+strideq]
+%rep %%last - %%n + 1
+    mova                m0, [OUT+%%n*16]
+    movu            [tmpq], m0
+    add               tmpq, strideq
+%assign %%n %%n+1
+%endrep
+%endif
+%else
+%if %2 == 16
+    LOAD_OUT             0
+    TRANSPOSE8x8W_LPF
+    STORE_8ROWS        -16
+    LOAD_OUT             8
+    TRANSPOSE8x8W_LPF
+    STORE_8ROWS          0
+%else
+    LOAD_OUT             4
+    TRANSPOSE8x8W_LPF
+    STORE_8ROWS         -8
+%endif
+%endif
+.end:
+    RET
+%endmacro
+
+%macro LOOPFILTER_16_BPP 1
+LOOPFILTER_16 h,  4, %1
+LOOPFILTER_16 v,  4, %1
+LOOPFILTER_16 h,  8, %1
+LOOPFILTER_16 v,  8, %1
+LOOPFILTER_16 h, 16, %1
+LOOPFILTER_16 v, 16, %1
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+LOOPFILTER_16_BPP 10
+LOOPFILTER_16_BPP 12
+%endif
@@ -45,6 +45,13 @@ times 8 dw %7
 times 8 dw %8
 %endmacro
 
+%macro F8_16BPP_TAPS 8
+times 8 dw %1, %2
+times 8 dw %3, %4
+times 8 dw %5, %6
+times 8 dw %7, %8
+%endmacro
+
 %macro FILTER 1
 const filters_%1 ; smooth
                     F8_TAPS -3, -1,  32,  64,  38,   1, -3,  0
@@ -102,6 +109,26 @@ FILTER ssse3
 %define F8_TAPS F8_SSE2_TAPS
 ; int16_t ff_filters_sse2[3][15][8][8]
 FILTER sse2
+%define F8_TAPS F8_16BPP_TAPS
+; int16_t ff_filters_16bpp[4][15][4][16]
+FILTER 16bpp
+                    ; bilinear, expressed as an 8-tap filter; this is exact
+                    ; since (16 * a + m * (b - a) + 8) >> 4 never needs clipping
+                    F8_TAPS  0,  0,   0, 120,   8,   0,  0,  0
+                    F8_TAPS  0,  0,   0, 112,  16,   0,  0,  0
+                    F8_TAPS  0,  0,   0, 104,  24,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  96,  32,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  88,  40,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  80,  48,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  72,  56,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  64,  64,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  56,  72,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  48,  80,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  40,  88,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  32,  96,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  24, 104,   0,  0,  0
+                    F8_TAPS  0,  0,   0,  16, 112,   0,  0,  0
+                    F8_TAPS  0,  0,   0,   8, 120,   0,  0,  0
 
 SECTION .text
 
@@ -553,7 +580,7 @@ filter_vx2_fn avg
 
 %endif ; ARCH_X86_64
 
-%macro fpel_fn 6
+%macro fpel_fn 6-8 0, 4
 %if %2 == 4
 %define %%srcfn movh
 %define %%dstfn movh
@@ -562,29 +589,55 @@ filter_vx2_fn avg
 %define %%dstfn mova
 %endif
 
+%if %7 == 16
+%define %%pavg pavgw
+%define %%szsuf _16
+%else
+%define %%pavg pavgb
+%define %%szsuf
+%endif
+
 %if %2 <= mmsize
-cglobal vp9_%1%2, 5, 7, 4, dst, dstride, src, sstride, h, dstride3, sstride3
+cglobal vp9_%1%2 %+ %%szsuf, 5, 7, 4, dst, dstride, src, sstride, h, dstride3, sstride3
     lea  sstride3q, [sstrideq*3]
     lea  dstride3q, [dstrideq*3]
 %else
-cglobal vp9_%1%2, 5, 5, 4, dst, dstride, src, sstride, h
+cglobal vp9_%1%2 %+ %%szsuf, 5, 5, %8, dst, dstride, src, sstride, h
 %endif
 .loop:
     %%srcfn     m0, [srcq]
     %%srcfn     m1, [srcq+s%3]
     %%srcfn     m2, [srcq+s%4]
     %%srcfn     m3, [srcq+s%5]
+%if %2/mmsize == 8
+    %%srcfn     m4, [srcq+mmsize*4]
+    %%srcfn     m5, [srcq+mmsize*5]
+    %%srcfn     m6, [srcq+mmsize*6]
+    %%srcfn     m7, [srcq+mmsize*7]
+%endif
     lea       srcq, [srcq+sstrideq*%6]
 %ifidn %1, avg
-    pavgb       m0, [dstq]
-    pavgb       m1, [dstq+d%3]
-    pavgb       m2, [dstq+d%4]
-    pavgb       m3, [dstq+d%5]
+    %%pavg      m0, [dstq]
+    %%pavg      m1, [dstq+d%3]
+    %%pavg      m2, [dstq+d%4]
+    %%pavg      m3, [dstq+d%5]
+%if %2/mmsize == 8
+    %%pavg      m4, [dstq+mmsize*4]
+    %%pavg      m5, [dstq+mmsize*5]
+    %%pavg      m6, [dstq+mmsize*6]
+    %%pavg      m7, [dstq+mmsize*7]
+%endif
 %endif
     %%dstfn [dstq], m0
     %%dstfn [dstq+d%3], m1
     %%dstfn [dstq+d%4], m2
     %%dstfn [dstq+d%5], m3
+%if %2/mmsize == 8
+    %%dstfn [dstq+mmsize*4], m4
+    %%dstfn [dstq+mmsize*5], m5
+    %%dstfn [dstq+mmsize*6], m6
+    %%dstfn [dstq+mmsize*7], m7
+%endif
     lea       dstq, [dstq+dstrideq*%6]
     sub         hd, %6
     jnz .loop
@@ -601,21 +654,31 @@ fpel_fn put, 8,  strideq, strideq*2, stride3q, 4
 INIT_MMX mmxext
 fpel_fn avg, 4,  strideq, strideq*2, stride3q, 4
 fpel_fn avg, 8,  strideq, strideq*2, stride3q, 4
+fpel_fn avg, 8,  strideq, strideq*2, stride3q, 4, 16
 INIT_XMM sse
 fpel_fn put, 16, strideq, strideq*2, stride3q, 4
 fpel_fn put, 32, mmsize,  strideq,   strideq+mmsize, 2
 fpel_fn put, 64, mmsize,  mmsize*2,  mmsize*3, 1
+fpel_fn put, 128, mmsize, mmsize*2,  mmsize*3, 1, 0, 8
 INIT_XMM sse2
 fpel_fn avg, 16, strideq, strideq*2, stride3q, 4
 fpel_fn avg, 32, mmsize,  strideq,   strideq+mmsize, 2
 fpel_fn avg, 64, mmsize,  mmsize*2,  mmsize*3, 1
+fpel_fn avg, 16, strideq, strideq*2, stride3q, 4, 16
+fpel_fn avg, 32, mmsize,  strideq,   strideq+mmsize, 2, 16
+fpel_fn avg, 64, mmsize,  mmsize*2,  mmsize*3, 1, 16
+fpel_fn avg, 128, mmsize, mmsize*2,  mmsize*3, 1, 16, 8
 INIT_YMM avx
 fpel_fn put, 32, strideq, strideq*2, stride3q, 4
 fpel_fn put, 64, mmsize,  strideq,   strideq+mmsize, 2
+fpel_fn put, 128, mmsize, mmsize*2,  mmsize*3, 1
 %if HAVE_AVX2_EXTERNAL
 INIT_YMM avx2
 fpel_fn avg, 32, strideq, strideq*2, stride3q, 4
 fpel_fn avg, 64, mmsize,  strideq,   strideq+mmsize, 2
+fpel_fn avg, 32, strideq, strideq*2, stride3q, 4, 16
+fpel_fn avg, 64, mmsize,  strideq,   strideq+mmsize, 2, 16
+fpel_fn avg, 128, mmsize, mmsize*2,  mmsize*3, 1, 16
 %endif
 %undef s16
 %undef d16
@@ -0,0 +1,196 @@
+;******************************************************************************
+;* VP9 MC SIMD optimizations for high bit depths
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_64: times 8 dd 64
+
+cextern pw_1023
+cextern pw_4095
+
+SECTION .text
+
+; The filter taps are stored as interleaved pairs (ff_filters_16bpp), so that
+; a single pmaddwd on two interleaved source vectors applies two taps at once
+; and accumulates in 32 bits, which is wide enough for 12-bit input.
+
+; %1: 1 if only the low half of the registers is used
+; in: the eight source vectors in m0-m7, tap pairs in m8-m11, pd_64 in m12,
+; the pixel max in m13 and zero in m14; out: the clipped pixels in m0
+%macro FILTER_8TAP_16 1
+%if %1
+    punpcklwd           m0, m1
+    punpcklwd           m2, m3
+    punpcklwd           m4, m5
+    punpcklwd           m6, m7
+    pmaddwd             m0, m8
+    pmaddwd             m2, m9
+    pmaddwd             m4, m10
+    pmaddwd             m6, m11
+    paddd               m0, m2
+    paddd               m4, m6
+    paddd               m0, m12
+    paddd               m0, m4
+    psrad               m0, 7
+    packssdw            m0, m0
+%else
+    punpckhwd          m15, m0, m1
+    punpcklwd           m0, m1
+    pmaddwd            m15, m8
+    pmaddwd             m0, m8
+    punpckhwd           m1, m2, m3
+    punpcklwd           m2, m3
+    pmaddwd             m1, m9
+    pmaddwd             m2, m9
+    paddd              m15, m1
+    paddd               m0, m2
+    punpckhwd           m1, m4, m5
+    punpcklwd           m4, m5
+    pmaddwd             m1, m10
+    pmaddwd             m4, m10
+    paddd              m15, m1
+    paddd               m0, m4
+    punpckhwd           m1, m6, m7
+    punpcklwd           m6, m7
+    pmaddwd             m1, m11
+    pmaddwd             m6, m11
+    paddd              m15, m1
+    paddd               m0, m6
+    paddd              m15, m12
+    paddd               m0, m12
+    psrad              m15, 7
+    psrad               m0, 7
+    packssdw            m0, m15
+%endif
+    pmaxsw              m0, m14
+    pminsw              m0, m13
+%endmacro
+
+%macro FILTER_INIT_16 1
+    mova                m8, [filteryq+ 0]
+    mova                m9, [filteryq+32]
+    mova               m10, [filteryq+64]
+    mova               m11, [filteryq+96]
+    mova               m12, [pd_64]
+    mova               m13, [pw_%1]
+    pxor               m14, m14
+%endmacro
+
+; %1: put/avg, %2: block width in pixels, %3: pixel max (1023 or 4095)
+%macro filter_h_fn_16 3
+%if %2 * 4 == mmsize
+%define %%loadfn movh
+%define %%half 1
+%else
+%define %%loadfn movu
+%define %%half 0
+%endif
+%if %3 == 1023
+%define %%bpp 10
+%else
+%define %%bpp 12
+%endif
+cglobal vp9_%1_8tap_1d_h_%2_ %+ %%bpp, 6, 6, 16, dst, dstride, src, sstride, h, filtery
+    FILTER_INIT_16      %3
+.loop:
+    %%loadfn            m0, [srcq-6]
+    %%loadfn            m1, [srcq-4]
+    %%loadfn            m2, [srcq-2]
+    %%loadfn            m3, [srcq+0]
+    %%loadfn            m4, [srcq+2]
+    %%loadfn            m5, [srcq+4]
+    %%loadfn            m6, [srcq+6]
+    %%loadfn            m7, [srcq+8]
+    add               srcq, sstrideq
+    FILTER_8TAP_16      %%half
+%ifidn %1, avg
+    %%loadfn            m1, [dstq]
+    pavgw               m0, m1
+%endif
+    %%loadfn        [dstq], m0
+    add               dstq, dstrideq
+    dec                 hd
+    jg .loop
+    RET
+%endmacro
+
+; the vertical filter uses the same register layout, but reads eight rows
+%macro filter_v_fn_16 3
+%if %2 * 4 == mmsize
+%define %%loadfn movh
+%define %%half 1
+%else
+%define %%loadfn movu
+%define %%half 0
+%endif
+%if %3 == 1023
+%define %%bpp 10
+%else
+%define %%bpp 12
+%endif
+cglobal vp9_%1_8tap_1d_v_%2_ %+ %%bpp, 6, 8, 16, dst, dstride, src, sstride, h, filtery, src4, sstride3
+    FILTER_INIT_16      %3
+    lea          sstride3q, [sstrideq*3]
+    sub               srcq, sstride3q
+.loop:
+    lea              src4q, [srcq+sstrideq*4]
+    %%loadfn            m0, [srcq]
+    %%loadfn            m1, [srcq+sstrideq]
+    %%loadfn            m2, [srcq+sstrideq*2]
+    %%loadfn            m3, [srcq+sstride3q]
+    %%loadfn            m4, [src4q]
+    %%loadfn            m5, [src4q+sstrideq]
+    %%loadfn            m6, [src4q+sstrideq*2]
+    %%loadfn            m7, [src4q+sstride3q]
+    add               srcq, sstrideq
+    FILTER_8TAP_16      %%half
+%ifidn %1, avg
+    %%loadfn            m1, [dstq]
+    pavgw               m0, m1
+%endif
+    %%loadfn        [dstq], m0
+    add               dstq, dstrideq
+    dec                 hd
+    jg .loop
+    RET
+%endmacro
+
+%macro filter_fn_16 2
+filter_h_fn_16 put, %1, %2
+filter_h_fn_16 avg, %1, %2
+filter_v_fn_16 put, %1, %2
+filter_v_fn_16 avg, %1, %2
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+filter_fn_16 4, 1023
+filter_fn_16 8, 1023
+filter_fn_16 4, 4095
+filter_fn_16 8, 4095
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+filter_fn_16 16, 1023
+filter_fn_16 16, 4095
+%endif
+%endif ; ARCH_X86_64
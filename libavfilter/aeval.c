@@ -53,7 +53,18 @@ enum var_name {
     VAR_VARS_NB
 };
 
-typedef struct {
+typedef struct EvalContext EvalContext;
+
+/**
+ * Opaque passed to the expression functions when evaluating the
+ * expressions for one sample.
+ */
+typedef struct EvalSample {
+    EvalContext *eval;
+    int index;                  ///< sample index in the input frame
+} EvalSample;
+
+struct EvalContext {
     const AVClass *class;
     char *sample_rate_str;
     int sample_rate;
@@ -69,14 +80,47 @@ typedef struct {
     int64_t duration;
     uint64_t n;
     double var_values[VAR_VARS_NB];
-    double *channel_values;
     int64_t out_channel_layout;
-} EvalContext;
+
+    AVFrame *in;                ///< input frame being filtered by aeval
+    int nb_lanes;               ///< number of allocated entries in the arrays below
+    double *n_values;           ///< per sample values of n
+    double *t_values;           ///< per sample values of t
+    EvalSample *samples;
+    void **sample_opaques;      ///< pointers to samples, for av_expr_eval_batch()
+};
 
 static double val(void *priv, double ch)
 {
-    EvalContext *eval = priv;
-    return eval->channel_values[FFMIN((int)ch, eval->nb_in_channels-1)];
+    EvalSample *sample = priv;
+    EvalContext *eval = sample->eval;
+    return *((double *)eval->in->extended_data[FFMIN((int)ch, eval->nb_in_channels-1)] + sample->index);
+}
+
+/**
+ * Make sure the per sample arrays can hold nb_samples entries.
+ */
+static int alloc_lanes(EvalContext *eval, int nb_samples)
+{
+    int i;
+
+    if (nb_samples <= eval->nb_lanes)
+        return 0;
+
+    eval->nb_lanes = 0;
+    if (!(eval->n_values       = av_realloc_f(eval->n_values,       nb_samples, sizeof(*eval->n_values)))       ||
+        !(eval->t_values       = av_realloc_f(eval->t_values,       nb_samples, sizeof(*eval->t_values)))       ||
+        !(eval->samples        = av_realloc_f(eval->samples,        nb_samples, sizeof(*eval->samples)))        ||
+        !(eval->sample_opaques = av_realloc_f(eval->sample_opaques, nb_samples, sizeof(*eval->sample_opaques))))
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < nb_samples; i++) {
+        eval->samples[i].eval  = eval;
+        eval->samples[i].index = i;
+        eval->sample_opaques[i] = &eval->samples[i];
+    }
+    eval->nb_lanes = nb_samples;
+    return 0;
 }
 
 static double (* const aeval_func1[])(void *, double) = { val, NULL };
@@ -217,7 +261,10 @@ static av_cold void uninit(AVFilterContext *ctx)
         eval->expr[i] = NULL;
     }
     av_freep(&eval->expr);
-    av_freep(&eval->channel_values);
+    av_freep(&eval->n_values);
+    av_freep(&eval->t_values);
+    av_freep(&eval->samples);
+    av_freep(&eval->sample_opaques);
 }
 
 static int config_props(AVFilterLink *outlink)
@@ -275,24 +322,35 @@ static int request_frame(AVFilterLink *outlink)
 {
     EvalContext *eval = outlink->src->priv;
     AVFrame *samplesref;
-    int i, j;
+    const double *const_arrays[VAR_VARS_NB] = { NULL };
+    int i, j, ret;
     int64_t t = av_rescale(eval->n, AV_TIME_BASE, eval->sample_rate);
 
     if (eval->duration >= 0 && t >= eval->duration)
         return AVERROR_EOF;
 
+    if ((ret = alloc_lanes(eval, eval->nb_samples)) < 0)
+        return ret;
+    const_arrays[VAR_N] = eval->n_values;
+    const_arrays[VAR_T] = eval->t_values;
+
     samplesref = ff_get_audio_buffer(outlink, eval->nb_samples);
     if (!samplesref)
         return AVERROR(ENOMEM);
 
-    /* evaluate expression for each single sample and for each channel */
     for (i = 0; i < eval->nb_samples; i++, eval->n++) {
-        eval->var_values[VAR_N] = eval->n;
-        eval->var_values[VAR_T] = eval->var_values[VAR_N] * (double)1/eval->sample_rate;
+        eval->n_values[i] = eval->n;
+        eval->t_values[i] = eval->n_values[i] * (double)1/eval->sample_rate;
+    }
 
-        for (j = 0; j < eval->nb_channels; j++) {
-            *((double *) samplesref->extended_data[j] + i) =
-                av_expr_eval(eval->expr[j], eval->var_values, NULL);
+    /* evaluate expression for all the samples of each channel */
+    for (j = 0; j < eval->nb_channels; j++) {
+        ret = av_expr_eval_batch(eval->expr[j], (double *)samplesref->extended_data[j],
+                                 eval->nb_samples, eval->var_values, const_arrays,
+                                 NULL, NULL);
+        if (ret < 0) {
+            av_frame_free(&samplesref);
+            return ret;
         }
     }
 
@@ -402,11 +460,6 @@ static int aeval_config_output(AVFilterLink *outlink)
     eval->var_values[VAR_S] = inlink->sample_rate;
     eval->var_values[VAR_T] = NAN;
 
-    eval->channel_values = av_realloc_f(eval->channel_values,
-                                        inlink->channels, sizeof(*eval->channel_values));
-    if (!eval->channel_values)
-        return AVERROR(ENOMEM);
-
     return 0;
 }
 
@@ -418,33 +471,49 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterLink *outlink = inlink->dst->outputs[0];
     int nb_samples        = in->nb_samples;
     AVFrame *out;
+    const double *const_arrays[VAR_VARS_NB] = { NULL };
     double t0;
-    int i, j;
+    int i, j, ret;
+
+    if ((ret = alloc_lanes(eval, nb_samples)) < 0) {
+        av_frame_free(&in);
+        return ret;
+    }
+    const_arrays[VAR_N] = eval->n_values;
+    const_arrays[VAR_T] = eval->t_values;
 
     /* do volume scaling in-place if input buffer is writable */
     out = ff_get_audio_buffer(outlink, nb_samples);
-    if (!out)
+    if (!out) {
+        av_frame_free(&in);
         return AVERROR(ENOMEM);
+    }
     av_frame_copy_props(out, in);
 
     t0 = TS2T(in->pts, inlink->time_base);
 
-    /* evaluate expression for each single sample and for each channel */
     for (i = 0; i < nb_samples; i++, eval->n++) {
-        eval->var_values[VAR_N] = eval->n;
-        eval->var_values[VAR_T] = t0 + i * (double)1/inlink->sample_rate;
-
-        for (j = 0; j < inlink->channels; j++)
-            eval->channel_values[j] = *((double *) in->extended_data[j] + i);
+        eval->n_values[i] = eval->n;
+        eval->t_values[i] = t0 + i * (double)1/inlink->sample_rate;
+    }
 
-        for (j = 0; j < outlink->channels; j++) {
-            eval->var_values[VAR_CH] = j;
-            *((double *) out->extended_data[j] + i) =
-                av_expr_eval(eval->expr[j], eval->var_values, eval);
-        }
+    /* evaluate expression for all the samples of each channel */
+    eval->in = in;
+    for (j = 0; j < outlink->channels; j++) {
+        eval->var_values[VAR_CH] = j;
+        ret = av_expr_eval_batch(eval->expr[j], (double *)out->extended_data[j],
+                                 nb_samples, eval->var_values, const_arrays,
+                                 NULL, eval->sample_opaques);
+        if (ret < 0)
+            break;
     }
+    eval->in = NULL;
 
     av_frame_free(&in);
+    if (ret < 0) {
+        av_frame_free(&out);
+        return ret;
+    }
     return ff_filter_frame(outlink, out);
 }
 
@@ -88,6 +88,7 @@ typedef struct VolumeContext {
     int samples_align;
 } VolumeContext;
 
+void ff_volume_init(VolumeContext *vol);
 void ff_volume_init_x86(VolumeContext *vol);
 
 #endif /* AVFILTER_AF_VOLUME_H */
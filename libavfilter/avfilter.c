@@ -36,6 +36,7 @@
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
+#include "thread.h"
 
 #include "libavutil/ffversion.h"
 const char av_filter_ffversion[] = "FFmpeg version " FFMPEG_VERSION;
@@ -340,7 +341,7 @@ void ff_tlog_link(void *ctx, AVFilterLink *link, int end)
     }
 }
 
-int ff_request_frame(AVFilterLink *link)
+static int request_frame_link(AVFilterLink *link)
 {
     int ret = -1;
     FF_TPRINTF_START(NULL, request_frame); ff_tlog_link(NULL, link, 1);
@@ -371,6 +372,19 @@ int ff_request_frame(AVFilterLink *link)
     return ret;
 }
 
+int ff_request_frame(AVFilterLink *link)
+{
+    int ret, state;
+
+    if (!link->src->internal->pipeline_stage)
+        return request_frame_link(link);
+
+    state = ff_pipeline_enter(link);
+    ret   = request_frame_link(link);
+    ff_pipeline_leave(link, state, ret);
+    return ret;
+}
+
 int ff_poll_frame(AVFilterLink *link)
 {
     int i, min = INT_MAX;
@@ -1016,67 +1030,68 @@ static int default_filter_frame(AVFilterLink *link, AVFrame *frame)
     return ff_filter_frame(link->dst->outputs[0], frame);
 }
 
-static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
+static int make_frame_writable(AVFilterLink *link, AVFrame **frame)
+{
+    AVFrame *in = *frame, *out;
+    int ret;
+
+    if (!link->dstpad->needs_writable || av_frame_is_writable(in))
+        return 0;
+
+    av_log(link->dst, AV_LOG_DEBUG, "Copying data in avfilter.\n");
+
+    switch (link->type) {
+    case AVMEDIA_TYPE_VIDEO:
+        out = ff_get_video_buffer(link, link->w, link->h);
+        break;
+    case AVMEDIA_TYPE_AUDIO:
+        out = ff_get_audio_buffer(link, in->nb_samples);
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+    if (!out)
+        return AVERROR(ENOMEM);
+
+    ret = av_frame_copy_props(out, in);
+    if (ret < 0) {
+        av_frame_free(&out);
+        return ret;
+    }
+
+    if (link->type == AVMEDIA_TYPE_VIDEO)
+        av_image_copy(out->data, out->linesize, (const uint8_t **)in->data, in->linesize,
+                      in->format, in->width, in->height);
+    else
+        av_samples_copy(out->extended_data, in->extended_data,
+                        0, 0, in->nb_samples,
+                        av_get_channel_layout_nb_channels(in->channel_layout),
+                        in->format);
+
+    av_frame_free(frame);
+    *frame = out;
+    return 0;
+}
+
+int ff_filter_frame_deliver(AVFilterLink *link, AVFrame *frame)
 {
     int (*filter_frame)(AVFilterLink *, AVFrame *);
     AVFilterContext *dstctx = link->dst;
     AVFilterPad *dst = link->dstpad;
-    AVFrame *out = NULL;
+    AVFrame *out;
     int ret;
     AVFilterCommand *cmd= link->dst->command_queue;
     int64_t pts;
 
-    if (link->closed) {
-        av_frame_free(&frame);
-        return AVERROR_EOF;
-    }
-
     if (!(filter_frame = dst->filter_frame))
         filter_frame = default_filter_frame;
 
     /* copy the frame if needed */
-    if (dst->needs_writable && !av_frame_is_writable(frame)) {
-        av_log(link->dst, AV_LOG_DEBUG, "Copying data in avfilter.\n");
-
-        switch (link->type) {
-        case AVMEDIA_TYPE_VIDEO:
-            out = ff_get_video_buffer(link, link->w, link->h);
-            break;
-        case AVMEDIA_TYPE_AUDIO:
-            out = ff_get_audio_buffer(link, frame->nb_samples);
-            break;
-        default:
-            ret = AVERROR(EINVAL);
-            goto fail;
-        }
-        if (!out) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
-        }
-
-        ret = av_frame_copy_props(out, frame);
-        if (ret < 0)
-            goto fail;
-
-        switch (link->type) {
-        case AVMEDIA_TYPE_VIDEO:
-            av_image_copy(out->data, out->linesize, (const uint8_t **)frame->data, frame->linesize,
-                          frame->format, frame->width, frame->height);
-            break;
-        case AVMEDIA_TYPE_AUDIO:
-            av_samples_copy(out->extended_data, frame->extended_data,
-                            0, 0, frame->nb_samples,
-                            av_get_channel_layout_nb_channels(frame->channel_layout),
-                            frame->format);
-            break;
-        default:
-            ret = AVERROR(EINVAL);
-            goto fail;
-        }
-
+    if ((ret = make_frame_writable(link, &frame)) < 0) {
         av_frame_free(&frame);
-    } else
-        out = frame;
+        return ret;
+    }
+    out = frame;
 
     while(cmd && cmd->time <= out->pts * av_q2d(link->time_base)){
         av_log(link->dst, AV_LOG_DEBUG,
@@ -1103,14 +1118,29 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
     }
     ret = filter_frame(link, out);
     link->frame_count++;
-    link->frame_requested = 0;
+    if (!link->pipe)
+        link->frame_requested = 0;
     ff_update_link_current_pts(link, pts);
     return ret;
+}
 
-fail:
-    av_frame_free(&out);
-    av_frame_free(&frame);
-    return ret;
+static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
+{
+    if (link->closed) {
+        av_frame_free(&frame);
+        return AVERROR_EOF;
+    }
+
+    if (link->pipe) {
+        /* the source stage owns the buffer pool of the link, so copy here */
+        int ret = make_frame_writable(link, &frame);
+        if (ret < 0) {
+            av_frame_free(&frame);
+            return ret;
+        }
+        return ff_pipeline_send_frame(link, frame);
+    }
+    return ff_filter_frame_deliver(link, frame);
 }
 
 static int ff_filter_frame_needs_framing(AVFilterLink *link, AVFrame *frame)
@@ -864,6 +864,13 @@ struct AVFilterLink {
      * Number of past frames sent through the link.
      */
     int64_t frame_count;
+
+    /**
+     * Frame queue used when the source and destination filters run in
+     * different pipeline stages, NULL otherwise.
+     * Used internally by the framework.
+     */
+    struct FFPipelineLink *pipe;
 };
 
 /**
@@ -1234,6 +1241,17 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Number of worker threads used to run the filters of this graph as a
+     * pipeline. When greater than zero, avfilter_graph_config() splits the
+     * graph into up to pipeline_threads + 1 stages connected by bounded
+     * frame queues; the first stage runs in the calling thread and each
+     * following one in its own thread. Zero (the default) disables it.
+     *
+     * Must be set before avfilter_graph_config().
+     */
+    int pipeline_threads;
+
     /**
      * Private fields
      *
@@ -49,6 +49,8 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, FLAGS },
+    { "pipeline_threads", "Number of threads running filters as a pipeline", OFFSET(pipeline_threads),
+        AV_OPT_TYPE_INT,   { .i64 = 0 }, 0, INT_MAX, FLAGS },
     { NULL },
 };
 
@@ -71,6 +73,42 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_pipeline_init(AVFilterGraph *graph)
+{
+    graph->pipeline_threads = 0;
+    return 0;
+}
+
+void ff_graph_pipeline_free(AVFilterGraph *graph)
+{
+}
+
+int ff_pipeline_send_frame(AVFilterLink *link, AVFrame *frame)
+{
+    return ff_filter_frame_deliver(link, frame);
+}
+
+int ff_pipeline_enter(AVFilterLink *link)
+{
+    return 0;
+}
+
+void ff_pipeline_leave(AVFilterLink *link, int state, int ret)
+{
+}
+
+void ff_pipeline_throttle(AVFilterContext *ctx)
+{
+}
+
+void ff_filter_lock(AVFilterContext *ctx)
+{
+}
+
+void ff_filter_unlock(AVFilterContext *ctx)
+{
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -109,6 +147,8 @@ void avfilter_graph_free(AVFilterGraph **graph)
     if (!*graph)
         return;
 
+    ff_graph_pipeline_free(*graph);
+
     while ((*graph)->nb_filters)
         avfilter_free((*graph)->filters[0]);
 
@@ -1260,6 +1300,8 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    if ((ret = ff_graph_pipeline_init(graphctx)) < 0)
+        return ret;
 
     return 0;
 }
@@ -1283,7 +1325,9 @@ int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const
     for (i = 0; i < graph->nb_filters; i++) {
         AVFilterContext *filter = graph->filters[i];
         if (!strcmp(target, "all") || (filter->name && !strcmp(target, filter->name)) || !strcmp(target, filter->filter->name)) {
+            ff_filter_lock(filter);
             r = avfilter_process_command(filter, cmd, arg, res, res_len, flags);
+            ff_filter_unlock(filter);
             if (r != AVERROR(ENOSYS)) {
                 if ((flags & AVFILTER_CMD_FLAG_ONE) || r < 0)
                     return r;
@@ -1305,6 +1349,7 @@ int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const
         AVFilterContext *filter = graph->filters[i];
         if(filter && (!strcmp(target, "all") || !strcmp(target, filter->name) || !strcmp(target, filter->filter->name))){
             AVFilterCommand **queue = &filter->command_queue, *next;
+            ff_filter_lock(filter);
             while (*queue && (*queue)->time <= ts)
                 queue = &(*queue)->next;
             next = *queue;
@@ -1314,6 +1359,7 @@ int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const
             (*queue)->time    = ts;
             (*queue)->flags   = flags;
             (*queue)->next    = next;
+            ff_filter_unlock(filter);
             if(flags & AVFILTER_CMD_FLAG_ONE)
                 return 0;
         }
@@ -1375,10 +1421,18 @@ void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link)
 int avfilter_graph_request_oldest(AVFilterGraph *graph)
 {
     while (graph->sink_links_count) {
-        AVFilterLink *oldest = graph->sink_links[0];
-        int r = ff_request_frame(oldest);
-        if (r != AVERROR_EOF)
+        /* all the sinks share the last pipeline stage */
+        AVFilterContext *sink = graph->sink_links[0]->dst;
+        AVFilterLink *oldest;
+        int r;
+
+        ff_filter_lock(sink);
+        oldest = graph->sink_links[0];
+        r = ff_request_frame(oldest);
+        if (r != AVERROR_EOF) {
+            ff_filter_unlock(sink);
             return r;
+        }
         av_log(oldest->dst, AV_LOG_DEBUG, "EOF on sink link %s:%s.\n",
                oldest->dst ? oldest->dst->name : "unknown",
                oldest->dstpad ? oldest->dstpad->name : "unknown");
@@ -1387,6 +1441,7 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
             heap_bubble_down(graph, graph->sink_links[graph->sink_links_count],
                              oldest->age_index);
         oldest->age_index = -1;
+        ff_filter_unlock(sink);
     }
     return AVERROR_EOF;
 }
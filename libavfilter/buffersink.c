@@ -35,6 +35,7 @@
 #include "avfilter.h"
 #include "buffersink.h"
 #include "internal.h"
+#include "thread.h"
 
 typedef struct BufferSinkContext {
     const AVClass *class;
@@ -125,7 +126,7 @@ int attribute_align_arg av_buffersink_get_frame(AVFilterContext *ctx, AVFrame *f
     return av_buffersink_get_frame_flags(ctx, frame, 0);
 }
 
-int attribute_align_arg av_buffersink_get_frame_flags(AVFilterContext *ctx, AVFrame *frame, int flags)
+static int get_frame_internal(AVFilterContext *ctx, AVFrame *frame, int flags)
 {
     BufferSinkContext *buf = ctx->priv;
     AVFilterLink *inlink = ctx->inputs[0];
@@ -158,6 +159,16 @@ int attribute_align_arg av_buffersink_get_frame_flags(AVFilterContext *ctx, AVFr
     return 0;
 }
 
+int attribute_align_arg av_buffersink_get_frame_flags(AVFilterContext *ctx, AVFrame *frame, int flags)
+{
+    int ret;
+
+    ff_filter_lock(ctx);
+    ret = get_frame_internal(ctx, frame, flags);
+    ff_filter_unlock(ctx);
+    return ret;
+}
+
 static int read_from_fifo(AVFilterContext *ctx, AVFrame *frame,
                           int nb_samples)
 {
@@ -180,8 +191,8 @@ static int read_from_fifo(AVFilterContext *ctx, AVFrame *frame,
     return 0;
 }
 
-int attribute_align_arg av_buffersink_get_samples(AVFilterContext *ctx,
-                                                  AVFrame *frame, int nb_samples)
+static int get_samples_internal(AVFilterContext *ctx,
+                                AVFrame *frame, int nb_samples)
 {
     BufferSinkContext *s = ctx->priv;
     AVFilterLink   *link = ctx->inputs[0];
@@ -200,7 +211,7 @@ int attribute_align_arg av_buffersink_get_samples(AVFilterContext *ctx,
 
         if (!(cur_frame = av_frame_alloc()))
             return AVERROR(ENOMEM);
-        ret = av_buffersink_get_frame_flags(ctx, cur_frame, 0);
+        ret = get_frame_internal(ctx, cur_frame, 0);
         if (ret == AVERROR_EOF && av_audio_fifo_size(s->audio_fifo)) {
             av_frame_free(&cur_frame);
             return read_from_fifo(ctx, frame, av_audio_fifo_size(s->audio_fifo));
@@ -224,6 +235,17 @@ int attribute_align_arg av_buffersink_get_samples(AVFilterContext *ctx,
     return ret;
 }
 
+int attribute_align_arg av_buffersink_get_samples(AVFilterContext *ctx,
+                                                  AVFrame *frame, int nb_samples)
+{
+    int ret;
+
+    ff_filter_lock(ctx);
+    ret = get_samples_internal(ctx, frame, nb_samples);
+    ff_filter_unlock(ctx);
+    return ret;
+}
+
 AVBufferSinkParams *av_buffersink_params_alloc(void)
 {
     static const int pixel_fmts[] = { AV_PIX_FMT_NONE };
@@ -38,6 +38,7 @@
 #include "buffersrc.h"
 #include "formats.h"
 #include "internal.h"
+#include "thread.h"
 #include "video.h"
 #include "avcodec.h"
 
@@ -102,14 +103,23 @@ int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFra
         return AVERROR(EINVAL);
     }
 
-    if (!(flags & AV_BUFFERSRC_FLAG_KEEP_REF) || !frame)
-        return av_buffersrc_add_frame_internal(ctx, frame, flags);
+    if (!(flags & AV_BUFFERSRC_FLAG_KEEP_REF) || !frame) {
+        ff_filter_lock(ctx);
+        ret = av_buffersrc_add_frame_internal(ctx, frame, flags);
+        ff_filter_unlock(ctx);
+        ff_pipeline_throttle(ctx);
+        return ret;
+    }
 
     if (!(copy = av_frame_alloc()))
         return AVERROR(ENOMEM);
     ret = av_frame_ref(copy, frame);
-    if (ret >= 0)
+    if (ret >= 0) {
+        ff_filter_lock(ctx);
         ret = av_buffersrc_add_frame_internal(ctx, copy, flags);
+        ff_filter_unlock(ctx);
+        ff_pipeline_throttle(ctx);
+    }
 
     av_frame_free(&copy);
     return ret;
@@ -327,7 +337,12 @@ static av_cold int init_video(AVFilterContext *ctx)
 
 unsigned av_buffersrc_get_nb_failed_requests(AVFilterContext *buffer_src)
 {
-    return ((BufferSourceContext *)buffer_src->priv)->nb_failed_requests;
+    unsigned ret;
+
+    ff_filter_lock(buffer_src);
+    ret = ((BufferSourceContext *)buffer_src->priv)->nb_failed_requests;
+    ff_filter_unlock(buffer_src);
+    return ret;
 }
 
 #define OFFSET(x) offsetof(BufferSourceContext, x)
@@ -53,6 +53,7 @@ typedef struct InterlaceContext {
                          const uint8_t *srcp_above, const uint8_t *srcp_below);
 } InterlaceContext;
 
+void ff_interlace_init(InterlaceContext *interlace);
 void ff_interlace_init_x86(InterlaceContext *interlace);
 
 #endif /* AVFILTER_INTERLACE_H */
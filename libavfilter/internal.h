@@ -158,10 +158,12 @@ struct AVFilterPad {
 struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
+    void *pipeline;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    struct FFPipelineStage *pipeline_stage;
 };
 
 #if FF_API_AVFILTERBUFFER
@@ -361,6 +363,12 @@ int ff_request_frame(AVFilterLink *link);
  */
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame);
 
+/**
+ * Deliver an already framed frame to the destination filter of link,
+ * bypassing the pipeline queues. Used by the pipeline stage threads.
+ */
+int ff_filter_frame_deliver(AVFilterLink *link, AVFrame *frame);
+
 /**
  * Flags for AVFilterLink.flags.
  */
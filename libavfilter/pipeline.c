@@ -0,0 +1,600 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Pipelined filtergraph execution
+ *
+ * The filters of a configured graph are sorted topologically and split into
+ * contiguous stages. Links crossing a stage boundary get a bounded frame
+ * queue; every stage but the first has a thread which pops the queued frames
+ * and feeds them to the destination filters, while the first stage is run by
+ * the threads calling into the graph.
+ *
+ * Each stage is protected by a recursive lock, which is only released in the
+ * middle of a call when a filter requests a frame across a boundary: the
+ * downstream stage is released before locking the upstream one, exactly where
+ * an unthreaded graph could deliver frames back reentrantly. Pushing a frame
+ * never blocks; instead a stage thread does not pick up new work while the
+ * queue of the next stage is full, and the buffer sources wait outside of any
+ * lock. When a stage thread ends up producing frames for itself (through a
+ * request upstream), it delivers them immediately as a direct call would.
+ *
+ * Cuts are only placed where every frame crossing them comes from the stage
+ * immediately before and only flows through single input filters up to the
+ * next cut, so every filter sees its input frames in the same order as
+ * without pipelining, and filters combining several inputs get them in the
+ * same pattern. Nor are they placed in front of a filter providing its own
+ * frame allocator (e.g. pad), which the upstream stage would call into.
+ */
+
+#include "config.h"
+
+#include "libavutil/avassert.h"
+#include "libavutil/fifo.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+
+#include "avfilter.h"
+#include "internal.h"
+#include "thread.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_OS2THREADS
+#include "compat/os2threads.h"
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#endif
+
+/* maximum number of frames queued in front of a stage */
+#define PIPELINE_QUEUE_SIZE 4
+
+typedef struct PipelineItem {
+    AVFilterLink *link;
+    AVFrame *frame;
+} PipelineItem;
+
+typedef struct PipelineContext PipelineContext;
+typedef struct FFPipelineStage FFPipelineStage;
+typedef struct FFPipelineLink  FFPipelineLink;
+
+struct FFPipelineStage {
+    PipelineContext *pc;
+    int index;
+
+    pthread_t owner;
+    int depth;
+
+    AVFifoBuffer *queue;
+    int busy;
+
+    pthread_t worker;
+    int has_worker;
+};
+
+struct FFPipelineLink {
+    AVFilterLink *link;
+    FFPipelineStage *dst;
+    int status;
+};
+
+struct PipelineContext {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    FFPipelineStage *stages;
+    int nb_stages;
+    FFPipelineLink *links;
+    int nb_links;
+
+    int done;
+};
+
+#define QUEUED(st) (av_fifo_size((st)->queue) / (int)sizeof(PipelineItem))
+
+/* All the functions below up to the public API expect pc->mutex held. */
+
+static FFPipelineStage *find_worker(PipelineContext *pc)
+{
+    pthread_t self = pthread_self();
+    int i;
+
+    for (i = 0; i < pc->nb_stages; i++)
+        if (pc->stages[i].has_worker && pthread_equal(pc->stages[i].worker, self))
+            return &pc->stages[i];
+    return NULL;
+}
+
+static void stage_acquire(PipelineContext *pc, FFPipelineStage *st, int depth)
+{
+    pthread_t self = pthread_self();
+
+    if (!st || !depth)
+        return;
+    if (st->depth && pthread_equal(st->owner, self)) {
+        st->depth += depth;
+        return;
+    }
+    while (st->depth)
+        pthread_cond_wait(&pc->cond, &pc->mutex);
+    st->owner = self;
+    st->depth = depth;
+}
+
+/* Fully release st if held by the calling thread, return the lock depth. */
+static int stage_release(PipelineContext *pc, FFPipelineStage *st)
+{
+    int depth;
+
+    if (!st || !st->depth || !pthread_equal(st->owner, pthread_self()))
+        return 0;
+    depth     = st->depth;
+    st->depth = 0;
+    pthread_cond_broadcast(&pc->cond);
+    return depth;
+}
+
+static void stage_unlock(PipelineContext *pc, FFPipelineStage *st)
+{
+    av_assert1(st->depth > 0 && pthread_equal(st->owner, pthread_self()));
+    if (!--st->depth)
+        pthread_cond_broadcast(&pc->cond);
+}
+
+/* Pop the oldest frame queued in front of st and deliver it. Only ever
+ * called from the thread of st, so frames are delivered in queue order. */
+static void deliver_one(PipelineContext *pc, FFPipelineStage *st)
+{
+    PipelineItem item;
+    int ret;
+
+    av_fifo_generic_read(st->queue, &item, sizeof(item), NULL);
+    st->busy++;
+    pthread_cond_broadcast(&pc->cond);
+
+    stage_acquire(pc, st, 1);
+    pthread_mutex_unlock(&pc->mutex);
+    ret = ff_filter_frame_deliver(item.link, item.frame);
+    pthread_mutex_lock(&pc->mutex);
+    stage_unlock(pc, st);
+
+    if (ret < 0 && !item.link->pipe->status)
+        item.link->pipe->status = ret;
+    st->busy--;
+    pthread_cond_broadcast(&pc->cond);
+}
+
+/* Wait for a state change; a stage thread serves its own queue instead. */
+static void pipeline_wait(PipelineContext *pc)
+{
+    FFPipelineStage *self = find_worker(pc);
+
+    if (self && QUEUED(self) && !self->depth)
+        deliver_one(pc, self);
+    else
+        pthread_cond_wait(&pc->cond, &pc->mutex);
+}
+
+/* Wait until all the frames queued in front of st have been filtered. */
+static void drain(PipelineContext *pc, FFPipelineStage *st)
+{
+    if (find_worker(pc) == st) {
+        while (QUEUED(st))
+            deliver_one(pc, st);
+    } else {
+        while ((QUEUED(st) || st->busy) && !pc->done)
+            pipeline_wait(pc);
+    }
+}
+
+static int queue_full(PipelineContext *pc, int index)
+{
+    return index < pc->nb_stages &&
+           QUEUED(&pc->stages[index]) > PIPELINE_QUEUE_SIZE;
+}
+
+static void *attribute_align_arg pipeline_worker(void *arg)
+{
+    FFPipelineStage *st = arg;
+    PipelineContext *pc = st->pc;
+
+    pthread_mutex_lock(&pc->mutex);
+    while (!pc->done) {
+        if (!QUEUED(st) || queue_full(pc, st->index + 1)) {
+            pthread_cond_wait(&pc->cond, &pc->mutex);
+            continue;
+        }
+        deliver_one(pc, st);
+    }
+    pthread_mutex_unlock(&pc->mutex);
+
+    return NULL;
+}
+
+int ff_pipeline_send_frame(AVFilterLink *link, AVFrame *frame)
+{
+    FFPipelineLink *pl  = link->pipe;
+    FFPipelineStage *st = pl->dst;
+    PipelineContext *pc = st->pc;
+    PipelineItem item   = { link, frame };
+    int ret;
+
+    pthread_mutex_lock(&pc->mutex);
+
+    if (pl->status < 0) {
+        ret = pl->status;
+        goto end;
+    }
+
+    if (!av_fifo_space(st->queue) &&
+        (ret = av_fifo_realloc2(st->queue, av_fifo_size(st->queue) +
+                                           sizeof(item))) < 0)
+        goto end;
+    av_fifo_generic_write(st->queue, &item, sizeof(item), NULL);
+    frame = NULL;
+    link->frame_requested = 0;
+    pthread_cond_broadcast(&pc->cond);
+
+    /* Requested by the destination stage itself: deliver now, keeping the
+     * source stage locked so that it is not reentered from elsewhere. */
+    if (find_worker(pc) == st)
+        drain(pc, st);
+    ret = pl->status;
+
+end:
+    pthread_mutex_unlock(&pc->mutex);
+    av_frame_free(&frame);
+    return ret;
+}
+
+int ff_pipeline_enter(AVFilterLink *link)
+{
+    FFPipelineStage *src = link->src->internal->pipeline_stage;
+    PipelineContext *pc  = src->pc;
+    int depth = 0;
+
+    pthread_mutex_lock(&pc->mutex);
+    if (link->pipe)
+        depth = stage_release(pc, link->pipe->dst);
+    stage_acquire(pc, src, 1);
+    pthread_mutex_unlock(&pc->mutex);
+
+    return depth;
+}
+
+void ff_pipeline_leave(AVFilterLink *link, int state, int ret)
+{
+    FFPipelineStage *src = link->src->internal->pipeline_stage;
+    PipelineContext *pc  = src->pc;
+
+    pthread_mutex_lock(&pc->mutex);
+    stage_unlock(pc, src);
+    if (link->pipe) {
+        FFPipelineStage *dst = link->pipe->dst;
+        if (ret == AVERROR_EOF)
+            drain(pc, dst);
+        else if (find_worker(pc) != dst)
+            while (queue_full(pc, dst->index) && !pc->done)
+                pipeline_wait(pc);
+        stage_acquire(pc, dst, state);
+    }
+    pthread_mutex_unlock(&pc->mutex);
+}
+
+void ff_pipeline_throttle(AVFilterContext *ctx)
+{
+    FFPipelineStage *st = ctx->internal->pipeline_stage;
+    PipelineContext *pc;
+
+    if (!st)
+        return;
+    pc = st->pc;
+    pthread_mutex_lock(&pc->mutex);
+    while (queue_full(pc, st->index + 1) && !pc->done)
+        pipeline_wait(pc);
+    pthread_mutex_unlock(&pc->mutex);
+}
+
+void ff_filter_lock(AVFilterContext *ctx)
+{
+    FFPipelineStage *st = ctx->internal->pipeline_stage;
+
+    if (!st)
+        return;
+    pthread_mutex_lock(&st->pc->mutex);
+    stage_acquire(st->pc, st, 1);
+    pthread_mutex_unlock(&st->pc->mutex);
+}
+
+void ff_filter_unlock(AVFilterContext *ctx)
+{
+    FFPipelineStage *st = ctx->internal->pipeline_stage;
+
+    if (!st)
+        return;
+    pthread_mutex_lock(&st->pc->mutex);
+    stage_unlock(st->pc, st);
+    pthread_mutex_unlock(&st->pc->mutex);
+}
+
+static int filter_index(AVFilterGraph *graph, AVFilterContext *ctx)
+{
+    int i;
+
+    for (i = 0; i < graph->nb_filters; i++)
+        if (graph->filters[i] == ctx)
+            return i;
+    return -1;
+}
+
+/* Sources and sinks cost nothing worth a thread. */
+static int filter_weight(AVFilterContext *ctx)
+{
+    return ctx->nb_inputs && ctx->nb_outputs;
+}
+
+/**
+ * Sort the filters so that sources come first and sinks last.
+ *
+ * @return 0 on success, -1 if the graph has a cycle
+ */
+static int sort_filters(AVFilterGraph *graph, int *order, int *pending,
+                        int *sinks)
+{
+    int i, j, n = graph->nb_filters, nb_order = 0, nb_sinks = 0;
+
+    for (i = 0; i < n; i++) {
+        pending[i] = graph->filters[i]->nb_inputs;
+        if (!pending[i])
+            order[nb_order++] = i;
+    }
+
+    for (i = 0; i < nb_order; i++) {
+        AVFilterContext *f = graph->filters[order[i]];
+        for (j = 0; j < f->nb_outputs; j++) {
+            AVFilterContext *dst = f->outputs[j]->dst;
+            int idx = filter_index(graph, dst);
+            if (idx < 0 || --pending[idx])
+                continue;
+            if (dst->nb_outputs)
+                order[nb_order++] = idx;
+            else
+                sinks[nb_sinks++] = idx;
+        }
+    }
+
+    if (nb_order + nb_sinks != n)
+        return -1;
+    memcpy(order + nb_order, sinks, nb_sinks * sizeof(*sinks));
+    return 0;
+}
+
+/**
+ * Check whether a stage starting at position start of the sorted filters
+ * may be ended before position p. The frames crossing the cut must come
+ * from that stage only, must not go directly into a sink, must not be
+ * allocated by a filter after the cut and must not reach a filter with
+ * several inputs, whose output could depend on the timing of its inputs.
+ *
+ * @param reach scratch array, set to whether a filter is fed across the cut
+ */
+static int can_cut(AVFilterGraph *graph, const int *order, const int *pos,
+                   int *reach, int start, int p)
+{
+    int q, i;
+
+    for (q = p; q < graph->nb_filters; q++) {
+        AVFilterContext *f = graph->filters[order[q]];
+        reach[q] = 0;
+        for (i = 0; i < f->nb_inputs; i++) {
+            const AVFilterPad *pad = &f->input_pads[i];
+            int src = pos[filter_index(graph, f->inputs[i]->src)];
+            if (src < start || (src < p && !f->nb_outputs))
+                return 0;
+            /* the upstream filter would run this allocator, and whatever it
+             * calls further down, without holding the lock of this stage */
+            if (src < p && (pad->get_video_buffer || pad->get_audio_buffer))
+                return 0;
+            if (src < p || reach[src])
+                reach[q] = 1;
+        }
+        if (reach[q] && f->nb_inputs > 1)
+            return 0;
+    }
+    return 1;
+}
+
+static int pipeline_split(AVFilterGraph *graph, int *stage_of)
+{
+    int n = graph->nb_filters, i, p, total = 0, acc = 0;
+    int nb_stages, cur = 0, start = 0, ret = -1;
+    int *order, *pos, *pending, *sinks;
+
+    order   = av_malloc_array(n, sizeof(*order));
+    pos     = av_malloc_array(n, sizeof(*pos));
+    pending = av_malloc_array(n, sizeof(*pending));
+    sinks   = av_malloc_array(n, sizeof(*sinks));
+    if (!order || !pos || !pending || !sinks) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if (sort_filters(graph, order, pending, sinks) < 0) {
+        av_log(graph, AV_LOG_WARNING, "Cycle in the graph, not pipelining.\n");
+        ret = 0;
+        goto end;
+    }
+    for (i = 0; i < n; i++) {
+        pos[order[i]] = i;
+        total += filter_weight(graph->filters[i]);
+    }
+
+    nb_stages = FFMIN(graph->pipeline_threads + 1, total);
+    stage_of[order[0]] = 0;
+    for (p = 1; p < n; p++) {
+        acc += filter_weight(graph->filters[order[p - 1]]);
+        if (cur + 1 < nb_stages && acc * nb_stages >= total * (cur + 1) &&
+            can_cut(graph, order, pos, pending, start, p)) {
+            cur++;
+            start = p;
+        }
+        stage_of[order[p]] = cur;
+    }
+    ret = cur + 1;
+
+end:
+    av_freep(&order);
+    av_freep(&pos);
+    av_freep(&pending);
+    av_freep(&sinks);
+    return ret;
+}
+
+int ff_graph_pipeline_init(AVFilterGraph *graph)
+{
+    PipelineContext *pc;
+    int *stage_of, nb_stages, i, j, k, ret;
+
+    ff_graph_pipeline_free(graph);
+
+    if (graph->pipeline_threads <= 0 || graph->nb_filters < 2)
+        return 0;
+
+    stage_of = av_malloc_array(graph->nb_filters, sizeof(*stage_of));
+    if (!stage_of)
+        return AVERROR(ENOMEM);
+    nb_stages = pipeline_split(graph, stage_of);
+    if (nb_stages < 2) {
+        av_free(stage_of);
+        return FFMIN(nb_stages, 0);
+    }
+
+    pc = av_mallocz(sizeof(*pc));
+    if (!pc) {
+        av_free(stage_of);
+        return AVERROR(ENOMEM);
+    }
+    graph->internal->pipeline = pc;
+    pthread_mutex_init(&pc->mutex, NULL);
+    pthread_cond_init(&pc->cond, NULL);
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        for (j = 0; j < f->nb_inputs; j++)
+            if (stage_of[filter_index(graph, f->inputs[j]->src)] != stage_of[i])
+                pc->nb_links++;
+    }
+
+    pc->stages = av_mallocz_array(nb_stages, sizeof(*pc->stages));
+    pc->links  = av_mallocz_array(pc->nb_links, sizeof(*pc->links));
+    if (!pc->stages || !pc->links) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    pc->nb_stages = nb_stages;
+    for (i = 0; i < nb_stages; i++) {
+        pc->stages[i].pc    = pc;
+        pc->stages[i].index = i;
+        pc->stages[i].queue = av_fifo_alloc((PIPELINE_QUEUE_SIZE + 1) *
+                                            sizeof(PipelineItem));
+        if (!pc->stages[i].queue) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    for (i = 0, k = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        f->internal->pipeline_stage = &pc->stages[stage_of[i]];
+        for (j = 0; j < f->nb_inputs; j++) {
+            AVFilterLink *link = f->inputs[j];
+            int src = stage_of[filter_index(graph, link->src)];
+            /* a request may now be served by queueing a frame upstream */
+            if (src)
+                link->flags |= FF_LINK_FLAG_REQUEST_LOOP;
+            if (src == stage_of[i])
+                continue;
+            pc->links[k].link = link;
+            pc->links[k].dst  = &pc->stages[stage_of[i]];
+            link->pipe        = &pc->links[k++];
+        }
+        av_log(f, AV_LOG_DEBUG, "Pipeline stage %d\n", stage_of[i]);
+    }
+
+    pthread_mutex_lock(&pc->mutex);
+    for (i = 1; i < nb_stages; i++) {
+        FFPipelineStage *st = &pc->stages[i];
+        ret = pthread_create(&st->worker, NULL, pipeline_worker, st);
+        if (ret) {
+            pthread_mutex_unlock(&pc->mutex);
+            ret = AVERROR(ret);
+            goto fail;
+        }
+        st->has_worker = 1;
+    }
+    pthread_mutex_unlock(&pc->mutex);
+
+    av_log(graph, AV_LOG_VERBOSE, "Running %d filters in %d pipeline stages.\n",
+           graph->nb_filters, nb_stages);
+    av_free(stage_of);
+    return 0;
+
+fail:
+    av_free(stage_of);
+    ff_graph_pipeline_free(graph);
+    return ret;
+}
+
+void ff_graph_pipeline_free(AVFilterGraph *graph)
+{
+    PipelineContext *pc = graph->internal->pipeline;
+    PipelineItem item;
+    int i;
+
+    if (!pc)
+        return;
+
+    pthread_mutex_lock(&pc->mutex);
+    pc->done = 1;
+    pthread_cond_broadcast(&pc->cond);
+    pthread_mutex_unlock(&pc->mutex);
+
+    for (i = 0; i < pc->nb_stages; i++) {
+        FFPipelineStage *st = &pc->stages[i];
+        if (st->has_worker)
+            pthread_join(st->worker, NULL);
+        while (st->queue && av_fifo_size(st->queue)) {
+            av_fifo_generic_read(st->queue, &item, sizeof(item), NULL);
+            av_frame_free(&item.frame);
+        }
+        av_fifo_freep(&st->queue);
+    }
+    for (i = 0; pc->links && i < pc->nb_links; i++)
+        if (pc->links[i].link)
+            pc->links[i].link->pipe = NULL;
+    for (i = 0; i < graph->nb_filters; i++)
+        graph->filters[i]->internal->pipeline_stage = NULL;
+
+    pthread_mutex_destroy(&pc->mutex);
+    pthread_cond_destroy(&pc->cond);
+    av_freep(&pc->stages);
+    av_freep(&pc->links);
+    av_freep(&graph->internal->pipeline);
+}
@@ -26,4 +26,48 @@ int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Split a configured graph into pipeline stages according to
+ * AVFilterGraph.pipeline_threads and start the stage threads.
+ */
+int ff_graph_pipeline_init(AVFilterGraph *graph);
+
+/**
+ * Stop the stage threads and drop the frames still queued between stages.
+ */
+void ff_graph_pipeline_free(AVFilterGraph *graph);
+
+/**
+ * Queue a frame on a link crossing a stage boundary. Must be called with
+ * the source stage locked. Never blocks.
+ */
+int ff_pipeline_send_frame(AVFilterLink *link, AVFrame *frame);
+
+/**
+ * Lock the source stage of link before requesting a frame on it, releasing
+ * the destination stage first if the link crosses a stage boundary.
+ *
+ * @return state to pass to ff_pipeline_leave()
+ */
+int ff_pipeline_enter(AVFilterLink *link);
+
+/**
+ * Undo ff_pipeline_enter(). If the request returned AVERROR_EOF, the
+ * frames queued on the link are delivered before returning.
+ */
+void ff_pipeline_leave(AVFilterLink *link, int state, int ret);
+
+/**
+ * Wait until the stage following the one of ctx has room for more frames.
+ * Must be called without any stage locked.
+ */
+void ff_pipeline_throttle(AVFilterContext *ctx);
+
+/**
+ * Lock/unlock the pipeline stage of a filter around entry points called
+ * from outside the graph. No-op if the graph is not pipelined.
+ */
+void ff_filter_lock(AVFilterContext *ctx);
+void ff_filter_unlock(AVFilterContext *ctx);
+
 #endif /* AVFILTER_THREAD_H */
@@ -56,6 +56,7 @@ typedef struct {
                          const uint8_t *srcp_above, const uint8_t *srcp_below);
 } TInterlaceContext;
 
+void ff_tinterlace_init(TInterlaceContext *interlace);
 void ff_tinterlace_init_x86(TInterlaceContext *interlace);
 
 #endif /* AVFILTER_TINTERLACE_H */
@@ -65,7 +65,7 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
+    uint32_t **sc;                           ///< finite state machine storage, 2 * steps_y rows per slice job
 } UnsharpFilterParam;
 
 typedef struct UnsharpContext {
@@ -75,6 +75,7 @@ typedef struct UnsharpContext {
     UnsharpFilterParam luma;   ///< luma parameters (width, height, amount)
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
+    int nb_threads;
     int opencl;
 #if CONFIG_OPENCL
     UnsharpOpenclContext opencl_ctx;
@@ -36,6 +36,7 @@
 #include "internal.h"
 #include "dualinput.h"
 #include "drawutils.h"
+#include "vf_guidefilter.h"
 #include "video.h"
 
 #ifndef MIN
@@ -92,6 +93,7 @@ typedef struct DefogContext {
     AVFrame *gray_tmp;
     AVFrame *gray;      // for dark channel or transmission map
     AVFrame *gf[GF_COUNT];
+    BoxFilterContext box;
 } DefogContext;
 
 #define OFFSET(x) offsetof(DefogContext, x)
@@ -137,6 +139,7 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (int i=0; i<GF_COUNT; i++) {
         av_frame_free(&s->gf[i]);
     }
+    ff_boxfilter_uninit(&s->box);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -267,7 +270,7 @@ static int config_output(AVFilterLink *outlink)
         }        
     }
 
-    return 0;
+    return ff_boxfilter_init(&s->box, outlink->w, outlink->h, s->gf_radius);
 }
 
 static uint8_t get_block_minimal(uint8_t *base, int stride, int l, int u, int r, int d)
@@ -569,20 +572,10 @@ static void convframe_f2b(AVFrame *flt, AVFrame *byt)
     }  
 }
 
-void boxfilter(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-               int w, int h, int radius, int power, uint8_t *temp[2], int pixsize);
-
-static void guidedfilter(DefogContext *s, AVFrame *guider /*gray input*/, AVFrame *guidee /*tmap*/)
+static int guidedfilter(AVFilterContext *ctx, AVFrame *guider /*gray input*/, AVFrame *guidee /*tmap*/)
 {
-    int w = guidee->width;
-    int h = guidee->height;
-    int radius = s->gf_radius;
-    float temp_buf[2][4096];
-    uint8_t *temp[2] = { (uint8_t*)(temp_buf[0]), (uint8_t*)(temp_buf[1]) };
-    //int pixsize = 4;
-    int power = 1;
-
-    av_assert0(sizeof(float)==4);
+    DefogContext *s = ctx->priv;
+    int ret;
 
     AVFrame *i      = s->gf[IMG_I];
     AVFrame *p      = s->gf[IMG_P];
@@ -602,19 +595,23 @@ static void guidedfilter(DefogContext *s, AVFrame *guider /*gray input*/, AVFram
     convframe_rgb2f(guider, i);
     convframe_b2f(guidee, p);
 
-#define BOXFILTER(dst, src, pixsize) \
-    boxfilter((uint8_t*)dst->data[0], dst->linesize[0], \
-              (uint8_t*)src->data[0], src->linesize[0], \
-              w, h, radius, power, temp, pixsize);
-
-    BOXFILTER(mean_i, i, 4);                        // 0 ~ 255
-    BOXFILTER(mean_p, p, 4);                        // 0 ~ 255
+#define BOXFILTER(dst, src)                                                 \
+    do {                                                                    \
+        ret = ff_boxfilter(ctx, &s->box,                                    \
+                           (float *)dst->data[0], dst->linesize[0],         \
+                           (const float *)src->data[0], src->linesize[0]);  \
+        if (ret < 0)                                                        \
+            return ret;                                                     \
+    } while (0)
+
+    BOXFILTER(mean_i, i);                           // 0 ~ 255
+    BOXFILTER(mean_p, p);                           // 0 ~ 255
     
     mat_dot_mul(ip, i, p);      // ip = i .* p;     // 0 ~ 65535
     mat_dot_mul(ii, i, i);      // ii = i .* i;     // 0 ~ 65535
 
-    BOXFILTER(mean_ip, ip, 4);                      // 0 ~ 65535
-    BOXFILTER(mean_ii, ii, 4);                      // 0 ~ 65535
+    BOXFILTER(mean_ip, ip);                         // 0 ~ 65535
+    BOXFILTER(mean_ii, ii);                         // 0 ~ 65535
 
     // cov_ip = mean_ip - mean_i .* mean_p;
     // cov_ii = mean_ii - mean_i .* mean_i;   
@@ -626,13 +623,14 @@ static void guidedfilter(DefogContext *s, AVFrame *guider /*gray input*/, AVFram
     mat_dot_div(a, cov_ip, cov_ii);
     mat_dot_cov(b, mean_p, a, mean_i);
 
-    BOXFILTER(mean_a, a, 4);
-    BOXFILTER(mean_b, b, 4);
+    BOXFILTER(mean_a, a);
+    BOXFILTER(mean_b, b);
 
     // p = mean_a * i + mean_b;
     mat_dot_mul_add(p, mean_a, i, mean_b);
 
     convframe_f2b(p, guidee);
+    return 0;
 }
 
 /**
@@ -681,7 +679,13 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         transmission_map(s, in, gray, airlight);
     }
     if (s->dbgstep >= DEFOG_STEP_TMAP_REFINE) {
-        guidedfilter(s, in, gray);
+        int ret = guidedfilter(ctx, in, gray);
+        if (ret < 0) {
+            if (gray != s->gray)
+                av_frame_free(&gray);
+            av_frame_free(&in);
+            return ret;
+        }
     }
     if (s->dbgstep >= DEFOG_STEP_FINAL) {
         final_defog(s, in, gray, airlight);
@@ -724,5 +728,6 @@ AVFilter ff_vf_defog = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_defog_inputs,
     .outputs       = avfilter_vf_defog_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
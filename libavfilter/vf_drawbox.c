@@ -204,13 +204,22 @@ fail:
     return ret;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
+static int drawbox_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    DrawBoxContext *s = inlink->dst->priv;
+    DrawBoxContext *s = ctx->priv;
+    AVFrame *frame = arg;
     int plane, x, y, xb = s->x, yb = s->y;
+    const int y0 = FFMAX(yb, 0);
+    const int y1 = FFMIN(frame->height, yb + s->h);
+    /* split on chroma row boundaries, a chroma sample is blended once per
+     * covering luma row and that has to happen in order */
+    const int b0 = y0 >> s->vsub;
+    const int nb_blocks = ((y1 - 1) >> s->vsub) + 1 - b0;
+    const int slice_start = FFMAX(y0, (b0 + (nb_blocks *  jobnr   ) / nb_jobs) << s->vsub);
+    const int slice_end   = FFMIN(y1, (b0 + (nb_blocks * (jobnr+1)) / nb_jobs) << s->vsub);
     unsigned char *row[4];
 
-    for (y = FFMAX(yb, 0); y < frame->height && y < (yb + s->h); y++) {
+    for (y = slice_start; y < slice_end; y++) {
         row[0] = frame->data[0] + y * frame->linesize[0];
 
         for (plane = 1; plane < 3; plane++)
@@ -236,7 +245,20 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
         }
     }
 
-    return ff_filter_frame(inlink->dst->outputs[0], frame);
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
+{
+    AVFilterContext *ctx = inlink->dst;
+    DrawBoxContext *s = ctx->priv;
+    int h = FFMIN(frame->height, s->y + s->h) - FFMAX(s->y, 0);
+
+    if (h > 0)
+        ctx->internal->execute(ctx, drawbox_slice, frame, NULL,
+                               FFMIN(FF_CEIL_RSHIFT(h, s->vsub), ctx->graph->nb_threads));
+
+    return ff_filter_frame(ctx->outputs[0], frame);
 }
 
 #define OFFSET(x) offsetof(DrawBoxContext, x)
@@ -288,7 +310,7 @@ AVFilter ff_vf_drawbox = {
     .query_formats = query_formats,
     .inputs        = drawbox_inputs,
     .outputs       = drawbox_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_DRAWBOX_FILTER */
 
@@ -20,6 +20,13 @@
 
 #include <stdint.h>
 #include <string.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "avfilter.h"
+#include "internal.h"
 #include "vf_drm.h"
 
 #define bool int
@@ -27,44 +34,39 @@
 #define abs(x) ((x)<0 ? -(x) : (x))
 #endif
 
+/**
+ * Max number of 8x8 blocks handled by one call into the dsp functions.
+ * Keeps the per-thread coefficient scratch on the stack.
+ */
+#define DRM_CHUNK 16
 
 /****************************************************************************
- * 8x8 Quant matrix init
+ * 8x8 Quant matrix (qp = DRM_QP)
  ****************************************************************************/
 
-static int quant8_mf[6][8][8];
-static int dequant8_mf[6][8][8];
-
-static void x264m_8x8_cqm_init()
-{
-    static const int quant8_scan[16] = {
-        0,3,4,3, 3,1,5,1, 4,5,2,5, 3,1,5,1
-    };
-    static const int dequant8_scale[6][6] = {
-        { 20, 18, 32, 19, 25, 24 },
-        { 22, 19, 35, 21, 28, 26 },
-        { 26, 23, 42, 24, 33, 31 },
-        { 28, 25, 45, 26, 35, 33 },
-        { 32, 28, 51, 30, 40, 38 },
-        { 36, 32, 58, 34, 46, 43 },
-    };
-    static const int quant8_scale[6][6] = {
-        { 13107, 11428, 20972, 12222, 16777, 15481 },
-        { 11916, 10826, 19174, 11058, 14980, 14290 },
-        { 10082,  8943, 15978,  9675, 12710, 11985 },
-        {  9362,  8228, 14913,  8931, 11984, 11259 },
-        {  8192,  7346, 13159,  7740, 10486,  9777 },
-        {  7282,  6428, 11570,  6830,  9118,  8640 }
-    };
-
-    for( int q = 0; q < 6; q++ ) {
-        for( int i = 0; i < 64; i++ ) {
-            int j = quant8_scan[((i>>1)&12) | (i&3)];
-            dequant8_mf[q][0][i] = dequant8_scale[q][j];
-            quant8_mf[q][0][i] = quant8_scale[q][j];
-        }
-    }
-}
+#define DRM_QP 4
+
+static const int16_t quant8_mf[8][8] = {
+    {  8192,  7740, 10486,  7740,  8192,  7740, 10486,  7740 },
+    {  7740,  7346,  9777,  7346,  7740,  7346,  9777,  7346 },
+    { 10486,  9777, 13159,  9777, 10486,  9777, 13159,  9777 },
+    {  7740,  7346,  9777,  7346,  7740,  7346,  9777,  7346 },
+    {  8192,  7740, 10486,  7740,  8192,  7740, 10486,  7740 },
+    {  7740,  7346,  9777,  7346,  7740,  7346,  9777,  7346 },
+    { 10486,  9777, 13159,  9777, 10486,  9777, 13159,  9777 },
+    {  7740,  7346,  9777,  7346,  7740,  7346,  9777,  7346 },
+};
+
+static const int16_t dequant8_mf[8][8] = {
+    { 32, 30, 40, 30, 32, 30, 40, 30 },
+    { 30, 28, 38, 28, 30, 28, 38, 28 },
+    { 40, 38, 51, 38, 40, 38, 51, 38 },
+    { 30, 28, 38, 28, 30, 28, 38, 28 },
+    { 32, 30, 40, 30, 32, 30, 40, 30 },
+    { 30, 28, 38, 28, 30, 28, 38, 28 },
+    { 40, 38, 51, 38, 40, 38, 51, 38 },
+    { 30, 28, 38, 28, 30, 28, 38, 28 },
+};
 
 /****************************************************************************
  * 8x8 integer DCT transform:
@@ -128,64 +130,43 @@ static void x264m_8x8_dct( int16_t pix[8][8], int16_t dct[8][8] )
         (coef) = - ( ( f - (coef) * (mf) ) >> i_qbits ); \
 }
 
-static void quant_8x8_core( int16_t dct[8][8], int quant_mf[8][8], int i_qbits, int f )
+static void quant_8x8_core( int16_t dct[8][8], const int16_t quant_mf[8][8], int i_qbits, int f )
 {
     for(int i = 0; i < 64; i++ )
         QUANT_ONE( dct[0][i], quant_mf[0][i] );
 }
 
-static void x264m_8x8_quant( int16_t dct[8][8], int i_qp )
+static void x264m_8x8_quant( int16_t dct[8][8] )
 {
-    const int i_qbits = 16 + i_qp / 6;
-    const int i_mf = i_qp % 6;
-    const int f = ( 1 << i_qp ) / 6 ;
-    quant_8x8_core( dct, quant8_mf[i_mf], i_qbits, f );
+    const int i_qbits = 16 + DRM_QP / 6;
+    const int f = ( 1 << DRM_QP ) / 6 ;
+    quant_8x8_core( dct, quant8_mf, i_qbits, f );
 }
 
 /****************************************************************************
  * 8x8 dequant
  ****************************************************************************/
 
-#define DEQUANT_SHL( x ) \
-    dct[y][x] = ( dct[y][x] * dequant8_mf[i_mf][y][x] ) << i_qbits
-
 #define DEQUANT_SHR( x ) \
-    dct[y][x] = ( dct[y][x] * dequant8_mf[i_mf][y][x] + f ) >> (-i_qbits)
+    dct[y][x] = ( dct[y][x] * dequant8_mf[y][x] + f ) >> (-i_qbits)
 
-static void x264m_8x8_dequant( int16_t dct[8][8], int i_qp )
+/* DRM_QP < 12, so the dequant always shifts right */
+static void x264m_8x8_dequant( int16_t dct[8][8] )
 {
-    const int i_mf = i_qp%6;
-    const int i_qbits = i_qp/6-2;
+    const int i_qbits = DRM_QP/6-2;
+    const int f = 1 << (-i_qbits-1);
     int y;
 
-    if( i_qbits >= 0 )
+    for( y = 0; y < 8; y++ )
     {
-        for( y = 0; y < 8; y++ )
-        {
-            DEQUANT_SHL( 0 );
-            DEQUANT_SHL( 1 );
-            DEQUANT_SHL( 2 );
-            DEQUANT_SHL( 3 );
-            DEQUANT_SHL( 4 );
-            DEQUANT_SHL( 5 );
-            DEQUANT_SHL( 6 );
-            DEQUANT_SHL( 7 );
-        }
-    }
-    else
-    {
-        const int f = 1 << (-i_qbits-1);
-        for( y = 0; y < 8; y++ )
-        {
-            DEQUANT_SHR( 0 );
-            DEQUANT_SHR( 1 );
-            DEQUANT_SHR( 2 );
-            DEQUANT_SHR( 3 );
-            DEQUANT_SHR( 4 );
-            DEQUANT_SHR( 5 );
-            DEQUANT_SHR( 6 );
-            DEQUANT_SHR( 7 );
-        }
+        DEQUANT_SHR( 0 );
+        DEQUANT_SHR( 1 );
+        DEQUANT_SHR( 2 );
+        DEQUANT_SHR( 3 );
+        DEQUANT_SHR( 4 );
+        DEQUANT_SHR( 5 );
+        DEQUANT_SHR( 6 );
+        DEQUANT_SHR( 7 );
     }
 }
 
@@ -246,25 +227,55 @@ static void x264m_8x8_idct( int16_t dct[8][8], int16_t pix[8][8] )
 #undef DST
 }
 
+
 /****************************************************************************
  * x264 wrapper
  ****************************************************************************/
 
-static void dct_init()
+static void read_one_8x8(const uint8_t *ptr, int stride, int16_t pix[8][8])
 {
-    x264m_8x8_cqm_init();
+    for (int y=0; y<8; y++) {
+        int16_t *dst = pix[y];
+        const uint8_t *src = ptr + y * stride;
+        for (int x=0; x<8; x++) {
+            *dst++ = *src++;
+        }
+    }
 }
 
-static void dct8x8(int16_t pix[8][8], int16_t dct[8][8])
+static void write_one_8x8(uint8_t *ptr, int stride, int16_t pix[8][8])
 {
-    x264m_8x8_dct( pix, dct );
-    x264m_8x8_quant( dct, 4 );
+    for (int y=0; y<8; y++) {
+        int16_t *src = pix[y];
+        uint8_t *dst = ptr + y * stride;
+        for (int x=0; x<8; x++) {
+            *dst++ = *src++;
+        }
+    }
 }
 
-static void idct8x8(int16_t dct[8][8], int16_t pix[8][8])
+static void fdct8_quant_c(int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb)
 {
-    x264m_8x8_dequant( dct, 4 );
-    x264m_8x8_idct( dct, pix );
+    int16_t pix[8][8];
+
+    for (int b=0; b<nb; b++) {
+        int16_t (*dct)[8] = (int16_t (*)[8])(coef + 64 * b);
+        read_one_8x8(src + 8 * b, stride, pix);
+        x264m_8x8_dct( pix, dct );
+        x264m_8x8_quant( dct );
+    }
+}
+
+static void idct8_put_c(uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb)
+{
+    int16_t pix[8][8];
+
+    for (int b=0; b<nb; b++) {
+        int16_t (*dct)[8] = (int16_t (*)[8])(coef + 64 * b);
+        x264m_8x8_dequant( dct );
+        x264m_8x8_idct( dct, pix );
+        write_one_8x8(dst + 8 * b, stride, pix);
+    }
 }
 
 /****************************************************************************
@@ -275,97 +286,171 @@ static void idct8x8(int16_t dct[8][8], int16_t pix[8][8])
  * 设x为载体信号，m(0 or 1)为调制量（即嵌入信息），则
  *  x' = round( (x+d[m])/q ) * q - d[m]
  */
-inline int dither_modulate(int x, int q, int d)
+static inline int dither_modulate(int x, int q, int d)
 {
     return (x + d + q/2)/q * q - d;
 }
 
-inline int binary_dm(int x, bool emb_bit, int q /*dm_step*/)
+static inline int binary_dm(int x, bool emb_bit, int q /*dm_step*/)
 {
     int d = q / 4;
     return dither_modulate(x, q, emb_bit ? -d : d);
 }
 
-inline int binary_dm_decision(int x, int dm_step)
-{
-    int v_dm0 = binary_dm(x, 0, dm_step);
-    int v_dm1 = binary_dm(x, 1, dm_step);
-    return abs(v_dm1-x) < abs(v_dm0-x);
-}
-
-static void dct8_dcdm_emb(int16_t pix[8][8], bool emb_bit, int dm_step)
+static void dc_modulate_c(int16_t *dc, const uint8_t *bits, int n, int dm_step)
 {
-    int16_t dct[8][8];
-    dct8x8(pix, dct);
-    dct[0][0] = binary_dm(dct[0][0], emb_bit, dm_step);
-    idct8x8(dct, pix);
+    for (int i=0; i<n; i++)
+        dc[i] = binary_dm(dc[i], bits[i] > 128, dm_step);
 }
 
-static int dct8_dcdm_dec(int16_t pix[8][8], int dm_step)
+static void dc_demodulate_c(uint8_t *bits, const int16_t *dc, int n, int dm_step)
 {
-    int16_t dct[8][8];
-
-    dct8x8(pix, dct);
-    return binary_dm_decision(dct[0][0], dm_step);
+    for (int i=0; i<n; i++) {
+        int e0 = abs(binary_dm(dc[i], 0, dm_step) - dc[i]);
+        int e1 = abs(binary_dm(dc[i], 1, dm_step) - dc[i]);
+        bits[i] = e1 < e0 ? 255 : 0;
+    }
 }
 
-static void read_one_8x8(uint8_t *ptr, int stride, int16_t pix[8][8])
+/**
+ * The DC term of x264m_8x8_dct() is the plain sum of the 64 pixels, and
+ * quantizing it at DRM_QP gives (2 + sum * 8192) >> 16, i.e. sum >> 3.
+ */
+static void dc8x8_c(int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb)
 {
-    for (int y=0; y<8; y++) {
-        int16_t *dst = pix[y];
-        uint8_t *src = ptr + y * stride;
-        for (int x=0; x<8; x++) {
-            *dst++ = *src++;
+    for (int b=0; b<nb; b++) {
+        const uint8_t *ptr = src + 8 * b;
+        int sum = 0;
+        for (int y=0; y<8; y++) {
+            for (int x=0; x<8; x++)
+                sum += ptr[x];
+            ptr += stride;
         }
+        dc[b] = sum >> 3;
     }
 }
 
-static void write_one_8x8(uint8_t *ptr, int stride, int16_t pix[8][8])
+av_cold void ff_drm_dsp_init(DrmDSPContext *dsp)
 {
-    for (int y=0; y<8; y++) {
-        int16_t *src = pix[y];
-        uint8_t *dst = ptr + y * stride;
-        for (int x=0; x<8; x++) {
-            *dst++ = *src++;
-        }
-    }
+    dsp->fdct8_quant   = fdct8_quant_c;
+    dsp->idct8_put     = idct8_put_c;
+    dsp->dc_modulate   = dc_modulate_c;
+    dsp->dc8x8         = dc8x8_c;
+    dsp->dc_demodulate = dc_demodulate_c;
+
+    if (ARCH_X86)
+        ff_drm_dsp_init_x86(dsp);
 }
 
-void dcdm(int b_emb, int dm_step, int xshift, int yshift,
-        /*main*/    uint8_t *base1, int stride1, int w1, int h1,
-        /*drm */    uint8_t *base2, int stride2, int w2, int h2)
+/****************************************************************************
+ * slice threaded dc modulation
+ ****************************************************************************/
+
+typedef struct DcdmThreadData {
+    const DrmDSPContext *dsp;
+    drm_plane_t *mainpl, *drmpl;
+    int b_emb, dm_step, xshift, yshift;
+    int row_start, col_start;   ///< first block row/column to visit
+    DrmDetectStats stats[DRM_MAX_JOBS];
+} DcdmThreadData;
+
+static int dcdm_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     const int N = 8;
-    int16_t pix[N][N];
-
-    dct_init();
-
-    for (int y1=0; y1<h1; y1+=N) 
-    {    
-        for (int x1=0; x1<w1; x1+=N) 
-        {
-            int y2 = ((yshift + y1) / N) % w2;
-            int x2 = ((xshift + x1) / N) % w2;
-            uint8_t *ptr2 = base2 + y2 * stride2 + x2;
-            uint8_t *ptr1 = base1 + y1 * stride1 + x1;
-
-            read_one_8x8(ptr1, stride1, pix);
-            if (b_emb == DRM_EMBEDDING) {
-                bool emb_bit = (*ptr2) > 128;
-                dct8_dcdm_emb(pix, emb_bit, dm_step);
-                write_one_8x8(ptr1, stride1, pix);
-            } else {
-                bool emb_bit = dct8_dcdm_dec(pix, dm_step);
-                *ptr2 = emb_bit ? 255 : 0;
+    DcdmThreadData *td = arg;
+    const DrmDSPContext *dsp = td->dsp;
+    drm_plane_t *mainpl = td->mainpl, *drmpl = td->drmpl;
+    DrmDetectStats *stats = &td->stats[jobnr];
+    const int nbx = (mainpl->w + N - 1) / N;
+    const int nby = (mainpl->h + N - 1) / N;
+    const int rows = nby - td->row_start;
+    const int row_start = td->row_start + (rows *  jobnr   ) / nb_jobs;
+    const int row_end   = td->row_start + (rows * (jobnr+1)) / nb_jobs;
+    const int period    = td->dm_step / 2;
+    LOCAL_ALIGNED_32(int16_t, coef, [DRM_CHUNK * 64]);
+    LOCAL_ALIGNED_32(int16_t, dc,   [DRM_CHUNK]);
+    LOCAL_ALIGNED_32(uint8_t, bits, [DRM_CHUNK]);
+
+    for (int by=row_start; by<row_end; by++) {
+        int y1 = by * N;
+        uint8_t *ptr1 = mainpl->base + y1 * mainpl->stride;
+        uint8_t *ptr2 = NULL;
+
+        if (td->b_emb != DRM_DETECTING) {
+            int y2 = ((td->yshift + y1) / N) % drmpl->w;
+            ptr2 = drmpl->base + y2 * drmpl->stride;
+        }
+
+        for (int bx=td->col_start; bx<nbx; bx+=DRM_CHUNK) {
+            int n = FFMIN(DRM_CHUNK, nbx - bx);
+
+            if (td->b_emb == DRM_EMBEDDING) {
+                dsp->fdct8_quant(coef, ptr1 + bx * N, mainpl->stride, n);
+                for (int i=0; i<n; i++) {
+                    int x2 = ((td->xshift + (bx + i) * N) / N) % drmpl->w;
+                    dc[i]   = coef[64 * i];
+                    bits[i] = ptr2[x2];
+                }
+                dsp->dc_modulate(dc, bits, n, td->dm_step);
+                for (int i=0; i<n; i++)
+                    coef[64 * i] = dc[i];
+                dsp->idct8_put(ptr1 + bx * N, mainpl->stride, coef, n);
+                continue;
+            }
+
+            /* only the DC term carries the mark, no need for a full transform */
+            dsp->dc8x8(dc, ptr1 + bx * N, mainpl->stride, n);
+            dsp->dc_demodulate(bits, dc, n, td->dm_step);
+            if (td->b_emb == DRM_DECODING) {
+                for (int i=0; i<n; i++) {
+                    int x2 = ((td->xshift + (bx + i) * N) / N) % drmpl->w;
+                    ptr2[x2] = bits[i];
+                }
+            } else if (period) {
+                for (int i=0; i<n; i++) {
+                    stats->hist[dc[i] % period]++;
+                    stats->ones += !!bits[i];
+                }
+                stats->nb_blocks += n;
             }
         }
     }
+    return 0;
 }
 
-void dcdm2(int b_emb, drm_plane_t *main, drm_plane_t *drm,
-        int dm_step, int xshift, int yshift)
+void dcdm2(AVFilterContext *ctx, const DrmDSPContext *dsp, int b_emb,
+           drm_plane_t *mainpl, drm_plane_t *drmpl,
+           int dm_step, int xshift, int yshift, DrmDetectStats *stats)
 {
-   return dcdm(b_emb, dm_step, xshift, yshift,
-        main->base, main->stride, main->w, main->h,
-        drm->base, drm->stride, drm->w, drm->h);
+    const int N = 8;
+    const int nbx = (mainpl->w + N - 1) / N;
+    const int nby = (mainpl->h + N - 1) / N;
+    DcdmThreadData td = {
+        .dsp = dsp, .mainpl = mainpl, .drmpl = drmpl,
+        .b_emb = b_emb, .dm_step = dm_step, .xshift = xshift, .yshift = yshift,
+    };
+    int nb_jobs;
+
+    if (b_emb == DRM_DECODING) {
+        /* The watermark is tiled over the main picture, and every block
+         * overwrites the drm pixel it maps to in raster order. Only the
+         * last drm->w block rows and columns therefore decide the output,
+         * and within them each drm pixel is written exactly once, which
+         * also keeps the slices from racing on it. */
+        td.row_start = FFMAX(0, nby - drmpl->w);
+        td.col_start = FFMAX(0, nbx - drmpl->w);
+    }
+
+    nb_jobs = FFMIN3(nby - td.row_start, ctx->graph->nb_threads, DRM_MAX_JOBS);
+    ctx->internal->execute(ctx, dcdm_slice, &td, NULL, nb_jobs);
+
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+        for (int i=0; i<nb_jobs; i++) {
+            for (int k=0; k<DRM_MAX_STEP/2; k++)
+                stats->hist[k] += td.stats[i].hist[k];
+            stats->ones      += td.stats[i].ones;
+            stats->nb_blocks += td.stats[i].nb_blocks;
+        }
+    }
 }
@@ -27,9 +27,18 @@
  * > ffmpeg -i emb.mp4 -an -vf drmDec -f image2 -y 'drmOut-%d.jpg'
  */
 
+#ifndef AVFILTER_VF_DRM_H
+#define AVFILTER_VF_DRM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "avfilter.h"
+
 enum {
     DRM_DECODING,
     DRM_EMBEDDING,
+    DRM_DETECTING,      ///< blind detection, only gathers DrmDetectStats
 };
 
 typedef struct drm_plane_t {
@@ -43,9 +52,66 @@ void drm_plane_set(uint8_t *base, int linesize, int h, int val);
 
 #define DEFAULT_DCDM_STEP 32
 
-void dcdm(int b_emb, int dm_step, int xshift, int yshift,
-        /*main*/    uint8_t *base1, int stride1, int w1, int h1,
-        /*drm */    uint8_t *base2, int stride2, int w2, int h2);
+#define DRM_MAX_STEP 256
+#define DRM_MAX_JOBS 64
+
+typedef struct DrmDetectStats {
+    /**
+     * Histogram of the DC terms modulo step/2, the period of the union of
+     * both dither lattices.
+     */
+    int     hist[DRM_MAX_STEP / 2];
+    int64_t ones;       ///< number of blocks demodulated as 1
+    int     nb_blocks;
+} DrmDetectStats;
+
+typedef struct DrmDSPContext {
+    /**
+     * Forward transform and quantize nb horizontally adjacent 8x8 blocks.
+     * @param coef receives 64 coefficients per block, in raster order
+     */
+    void (*fdct8_quant)(int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb);
+
+    /**
+     * Dequantize, inverse transform and store nb horizontally adjacent
+     * 8x8 blocks. The content of coef is undefined afterwards.
+     */
+    void (*idct8_put)(uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb);
+
+    /**
+     * Dither modulate n DC coefficients, embedding (bits[i] > 128) into dc[i].
+     * dc (32-byte aligned) and bits must be readable and writable up to
+     * FFALIGN(n, 16) entries.
+     */
+    void (*dc_modulate)(int16_t *dc, const uint8_t *bits, int n, int dm_step);
+
+    /**
+     * Compute the quantized DC coefficient of nb horizontally adjacent 8x8
+     * blocks from the block sums, without the full transform.
+     * dc (32-byte aligned) must have room for FFALIGN(nb, 16) entries.
+     */
+    void (*dc8x8)(int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb);
+
+    /**
+     * Blind demodulation of n DC coefficients: bits[i] is set to 255 if
+     * dc[i] is closer to the lattice of bit 1 than to the one of bit 0,
+     * to 0 otherwise.
+     * dc (32-byte aligned) and bits must have room for FFALIGN(n, 16) entries.
+     */
+    void (*dc_demodulate)(uint8_t *bits, const int16_t *dc, int n, int dm_step);
+} DrmDSPContext;
+
+void ff_drm_dsp_init(DrmDSPContext *dsp);
+void ff_drm_dsp_init_x86(DrmDSPContext *dsp);
+
+/**
+ * Embed the drm plane into (or extract it from) the luma plane of the main
+ * picture, slice threaded over 8x8 block rows.
+ * With DRM_DETECTING, drmpl is unused and the detection statistics are
+ * returned in stats instead.
+ */
+void dcdm2(AVFilterContext *ctx, const DrmDSPContext *dsp, int b_emb,
+           drm_plane_t *mainpl, drm_plane_t *drmpl,
+           int dm_step, int xshift, int yshift, DrmDetectStats *stats);
 
-void dcdm2(int b_emb, drm_plane_t *mainpl, drm_plane_t *drmpl,
-        int dm_step, int xshift, int yshift);
+#endif /* AVFILTER_VF_DRM_H */
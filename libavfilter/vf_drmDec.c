@@ -39,25 +39,37 @@
 #include "video.h"
 #include "vf_drm.h"
 
+enum DrmDecMode {
+    DRMDEC_MODE_EXTRACT,
+    DRMDEC_MODE_DETECT,
+    DRMDEC_MODE_NB
+};
+
 typedef struct DrmDecContext {
     const AVClass *class;
 
+    int     mode;
     int     dm_step;
     int     xshift;
     int     yshift;
     int     drmw;
     int     drmh;
+
+    DrmDSPContext dsp;
 } DrmDecContext;
 
 
 #define OFFSET(x) offsetof(DrmDecContext, x)
 #define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
 static const AVOption drmDec_options[] = {
-    { "step",  "dither module step",  OFFSET(dm_step),  AV_OPT_TYPE_INT, {.i64=DEFAULT_DCDM_STEP}, 0, 256, FLAGS },
+    { "step",  "dither module step",  OFFSET(dm_step),  AV_OPT_TYPE_INT, {.i64=DEFAULT_DCDM_STEP}, 0, DRM_MAX_STEP, FLAGS },
     { "xshift", "where to embedding on the main pic", OFFSET(xshift), AV_OPT_TYPE_INT, {.i64=0}, 0, 4096, FLAGS },
     { "yshift", "where to embedding on the main pic", OFFSET(yshift), AV_OPT_TYPE_INT, {.i64=0}, 0, 4096, FLAGS },
     { "drmw", "drm watermark width",  OFFSET(drmw),  AV_OPT_TYPE_INT, {.i64=32}, 0, 8192, FLAGS },
     { "drmh", "drm watermark height", OFFSET(drmh),  AV_OPT_TYPE_INT, {.i64=32}, 0, 8192, FLAGS },
+    { "mode", "set operation mode", OFFSET(mode), AV_OPT_TYPE_INT, {.i64=DRMDEC_MODE_EXTRACT}, 0, DRMDEC_MODE_NB-1, FLAGS, "mode" },
+        { "extract", "output the extracted watermark", 0, AV_OPT_TYPE_CONST, {.i64=DRMDEC_MODE_EXTRACT}, .flags = FLAGS, .unit = "mode" },
+        { "detect",  "pass the input through, with detection metadata", 0, AV_OPT_TYPE_CONST, {.i64=DRMDEC_MODE_DETECT}, .flags = FLAGS, .unit = "mode" },
     { NULL }
 };
 AVFILTER_DEFINE_CLASS(drmDec);
@@ -65,8 +77,9 @@ AVFILTER_DEFINE_CLASS(drmDec);
 
 static av_cold int init(AVFilterContext *ctx)
 {
-    //DrmDecContext *s = ctx->priv;
+    DrmDecContext *s = ctx->priv;
 
+    ff_drm_dsp_init(&s->dsp);
     return 0;
 }
 
@@ -106,8 +119,13 @@ static int config_output(AVFilterLink *outlink)
     AVFilterContext *ctx = outlink->src;
     DrmDecContext *s   = ctx->priv;
 
-    outlink->w = s->drmw;
-    outlink->h = s->drmh;
+    if (s->mode == DRMDEC_MODE_DETECT) {
+        outlink->w = ctx->inputs[0]->w;
+        outlink->h = ctx->inputs[0]->h;
+    } else {
+        outlink->w = s->drmw;
+        outlink->h = s->drmh;
+    }
     outlink->time_base = ctx->inputs[0]->time_base;
 
     return 0;
@@ -147,18 +165,61 @@ static int do_extracting(AVFilterContext *ctx, AVFrame *in, AVFrame *drm)
         drm->data[0], drm->linesize[0], drm->width, drm->height
     };
 
-    dcdm2(DRM_DECODING, &mainpl, &drmpl, s->dm_step, s->xshift, s->yshift);
+    dcdm2(ctx, &s->dsp, DRM_DECODING, &mainpl, &drmpl,
+          s->dm_step, s->xshift, s->yshift, NULL);
 
     return 0;
 }
 
+/**
+ * Embedded DC terms sit on one of the two dither lattices, so modulo step/2
+ * they pile up around a single phase (shifted by the rounding of the
+ * embedder's inverse transform and by later coding noise), while the DCs of
+ * unmarked content are spread evenly. The mean resultant length of those
+ * phases, from 0 (uniform) to 1 (single phase), is the detection confidence.
+ */
+static void do_detecting(AVFilterContext *ctx, AVFrame *in)
+{
+    DrmDecContext *s = ctx->priv;
+    AVDictionary **metadata = avpriv_frame_get_metadatap(in);
+    DrmDetectStats stats;
+    const int period = s->dm_step / 2;
+    double c = 0, si = 0, confidence = 0;
+    char buf[32];
+
+    drm_plane_t mainpl = {
+        in->data[0], in->linesize[0], in->width, in->height
+    };
+
+    dcdm2(ctx, &s->dsp, DRM_DETECTING, &mainpl, NULL,
+          s->dm_step, s->xshift, s->yshift, &stats);
+
+    if (stats.nb_blocks && period > 1) {
+        for (int k = 0; k < period; k++) {
+            c  += stats.hist[k] * cos(2 * M_PI * k / period);
+            si += stats.hist[k] * sin(2 * M_PI * k / period);
+        }
+        confidence = hypot(c, si) / stats.nb_blocks;
+    }
+    snprintf(buf, sizeof(buf), "%f", confidence);
+    av_dict_set(metadata, "lavfi.drm.confidence", buf, 0);
+    av_dict_set_int(metadata, "lavfi.drm.blocks", stats.nb_blocks, 0);
+    av_dict_set_int(metadata, "lavfi.drm.ones",   stats.ones, 0);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     DrmDecContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
+    AVFrame *drm;
+
+    if (s->mode == DRMDEC_MODE_DETECT) {
+        do_detecting(ctx, in);
+        return ff_filter_frame(outlink, in);
+    }
 
-    AVFrame *drm = ff_get_video_buffer(outlink, s->drmw, s->drmh);
+    drm = ff_get_video_buffer(outlink, s->drmw, s->drmh);
 
     if (!drm) {
         av_frame_free(&in);
@@ -199,5 +260,6 @@ AVFilter ff_vf_drmDec = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_drmDec_inputs,
     .outputs       = avfilter_vf_drmDec_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
\ No newline at end of file
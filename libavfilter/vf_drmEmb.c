@@ -100,12 +100,14 @@ typedef struct DrmEmbContext {
     int dm_step;
     int xshift;
     int yshift;
+
+    DrmDSPContext dsp;
 } DrmEmbContext;
 
 #define OFFSET(x) offsetof(DrmEmbContext, x)
 #define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
 static const AVOption drmEmb_options[] = {
-    { "step",  "dither module step",  OFFSET(dm_step),  AV_OPT_TYPE_INT, {.i64=DEFAULT_DCDM_STEP}, 0, 256, FLAGS },
+    { "step",  "dither module step",  OFFSET(dm_step),  AV_OPT_TYPE_INT, {.i64=DEFAULT_DCDM_STEP}, 0, DRM_MAX_STEP, FLAGS },
     { "xshift", "where to embedding on the main pic", OFFSET(xshift), AV_OPT_TYPE_INT, {.i64=0}, 0, 4096, FLAGS },
     { "yshift", "where to embedding on the main pic", OFFSET(yshift), AV_OPT_TYPE_INT, {.i64=0}, 0, 4096, FLAGS },
     { "eof_action", "Action to take when encountering EOF from DRM input ",
@@ -143,6 +145,7 @@ static av_cold int init(AVFilterContext *ctx)
     }
 
     s->dinput.process = do_embedding;
+    ff_drm_dsp_init(&s->dsp);
     return 0;
 }
 
@@ -313,7 +316,8 @@ static AVFrame *do_embedding(AVFilterContext *ctx, AVFrame *in, AVFrame *drm)
         drm->data[0], drm->linesize[0], drm->width, drm->height
     };
 
-    dcdm2(DRM_EMBEDDING, &mainpl, &drmpl, s->dm_step, s->xshift, s->yshift);
+    dcdm2(ctx, &s->dsp, DRM_EMBEDDING, &mainpl, &drmpl,
+          s->dm_step, s->xshift, s->yshift, NULL);
 
     return in;
 }
@@ -373,5 +377,6 @@ AVFilter ff_vf_drmEmb = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_drmEmb_inputs,
     .outputs       = avfilter_vf_drmEmb_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
\ No newline at end of file
@@ -94,6 +94,14 @@ static void process_c(EQParameters *param, uint8_t *dst, int dst_stride,
     }
 }
 
+av_cold void ff_eq_init(EQContext *eq)
+{
+    eq->process = process_c;
+
+    if (ARCH_X86)
+        ff_eq_init_x86(eq);
+}
+
 static void check_values(EQParameters *param, EQContext *eq)
 {
     if (param->contrast == 1.0 && param->brightness == 0.0 && param->gamma == 1.0)
@@ -179,8 +187,6 @@ static int initialize(AVFilterContext *ctx)
     EQContext *eq = ctx->priv;
     int ret;
 
-    eq->process = process_c;
-
     if ((ret = set_expr(&eq->contrast_pexpr,     eq->contrast_expr,     "contrast",     ctx)) < 0 ||
         (ret = set_expr(&eq->brightness_pexpr,   eq->brightness_expr,   "brightness",   ctx)) < 0 ||
         (ret = set_expr(&eq->saturation_pexpr,   eq->saturation_expr,   "saturation",   ctx)) < 0 ||
@@ -191,8 +197,7 @@ static int initialize(AVFilterContext *ctx)
         (ret = set_expr(&eq->gamma_weight_pexpr, eq->gamma_weight_expr, "gamma_weight", ctx)) < 0 )
         return ret;
 
-    if (ARCH_X86)
-        ff_eq_init_x86(eq);
+    ff_eq_init(eq);
 
     if (eq->eval_mode == EVAL_MODE_INIT) {
         set_gamma(eq);
@@ -248,14 +253,54 @@ static int query_formats(AVFilterContext *ctx)
 
 #define TS2T(ts, tb) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts) * av_q2d(tb))
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const AVPixFmtDescriptor *desc;
+} ThreadData;
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EQContext *eq = ctx->priv;
+    const ThreadData *td = arg;
+    const AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    int i;
+
+    for (i = 0; i < td->desc->nb_components; i++) {
+        int w = in->width;
+        int h = in->height;
+        int slice_start, slice_end;
+        uint8_t       *dst;
+        const uint8_t *src;
+
+        if (i == 1 || i == 2) {
+            w = FF_CEIL_RSHIFT(w, td->desc->log2_chroma_w);
+            h = FF_CEIL_RSHIFT(h, td->desc->log2_chroma_h);
+        }
+        slice_start = (h *  jobnr   ) / nb_jobs;
+        slice_end   = (h * (jobnr+1)) / nb_jobs;
+        dst = out->data[i] + slice_start * out->linesize[i];
+        src = in ->data[i] + slice_start * in ->linesize[i];
+
+        if (eq->param[i].adjust)
+            eq->param[i].adjust(&eq->param[i], dst, out->linesize[i],
+                                 src, in->linesize[i], w, slice_end - slice_start);
+        else
+            av_image_copy_plane(dst, out->linesize[i],
+                                src, in->linesize[i], w, slice_end - slice_start);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     EQContext *eq = ctx->priv;
     AVFrame *out;
+    ThreadData td;
     int64_t pos = av_frame_get_pkt_pos(in);
-    const AVPixFmtDescriptor *desc;
     int i;
 
     out = ff_get_video_buffer(outlink, inlink->w, inlink->h);
@@ -263,7 +308,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         return AVERROR(ENOMEM);
 
     av_frame_copy_props(out, in);
-    desc = av_pix_fmt_desc_get(inlink->format);
 
     eq->var_values[VAR_N]   = inlink->frame_count;
     eq->var_values[VAR_POS] = pos == -1 ? NAN : pos;
@@ -276,22 +320,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         set_saturation(eq);
     }
 
-    for (i = 0; i < desc->nb_components; i++) {
-        int w = inlink->w;
-        int h = inlink->h;
-
-        if (i == 1 || i == 2) {
-            w = FF_CEIL_RSHIFT(w, desc->log2_chroma_w);
-            h = FF_CEIL_RSHIFT(h, desc->log2_chroma_h);
-        }
+    /* build the tables here, the slice jobs only read them */
+    for (i = 0; i < 3; i++)
+        if (eq->param[i].adjust == apply_lut && !eq->param[i].lut_clean)
+            create_lut(&eq->param[i]);
 
-        if (eq->param[i].adjust)
-            eq->param[i].adjust(&eq->param[i], out->data[i], out->linesize[i],
-                                 in->data[i], in->linesize[i], w, h);
-        else
-            av_image_copy_plane(out->data[i], out->linesize[i],
-                                in->data[i], in->linesize[i], w, h);
-    }
+    td.in   = in;
+    td.out  = out;
+    td.desc = av_pix_fmt_desc_get(inlink->format);
+    ctx->internal->execute(ctx, filter_slice, &td, NULL,
+                           FFMIN(inlink->h, ctx->graph->nb_threads));
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
@@ -385,4 +423,5 @@ AVFilter ff_vf_eq = {
     .query_formats   = query_formats,
     .init            = initialize,
     .uninit          = uninit,
+    .flags           = AVFILTER_FLAG_SLICE_THREADS,
 };
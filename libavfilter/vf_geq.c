@@ -41,6 +41,8 @@ typedef struct {
     int hsub, vsub;             ///< chroma subsampling
     int planes;                 ///< number of planes
     int is_rgb;
+    double *x_values;           ///< X of each pixel of a row, for av_expr_eval_batch()
+    double *row;                ///< evaluated values of a row
 } GEQContext;
 
 enum { Y = 0, U, V, A, G, B, R };
@@ -192,18 +194,28 @@ static int geq_config_props(AVFilterLink *inlink)
 {
     GEQContext *geq = inlink->dst->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    int i;
 
     av_assert0(desc);
 
     geq->hsub = desc->log2_chroma_w;
     geq->vsub = desc->log2_chroma_h;
     geq->planes = desc->nb_components;
+
+    av_freep(&geq->x_values);
+    av_freep(&geq->row);
+    geq->x_values = av_malloc_array(inlink->w, sizeof(*geq->x_values));
+    geq->row      = av_malloc_array(inlink->w, sizeof(*geq->row));
+    if (!geq->x_values || !geq->row)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < inlink->w; i++)
+        geq->x_values[i] = i;
     return 0;
 }
 
 static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    int plane;
+    int plane, ret;
     GEQContext *geq = inlink->dst->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
@@ -211,6 +223,7 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
         [VAR_N] = inlink->frame_count,
         [VAR_T] = in->pts == AV_NOPTS_VALUE ? NAN : in->pts * av_q2d(inlink->time_base),
     };
+    const double *const_arrays[VAR_VARS_NB] = { [VAR_X] = geq->x_values };
 
     geq->picref = in;
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
@@ -234,10 +247,15 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 
         for (y = 0; y < h; y++) {
             values[VAR_Y] = y;
-            for (x = 0; x < w; x++) {
-                values[VAR_X] = x;
-                dst[x] = av_expr_eval(geq->e[plane], values, geq);
+            ret = av_expr_eval_batch(geq->e[plane], geq->row, w, values,
+                                     const_arrays, geq, NULL);
+            if (ret < 0) {
+                av_frame_free(&geq->picref);
+                av_frame_free(&out);
+                return ret;
             }
+            for (x = 0; x < w; x++)
+                dst[x] = geq->row[x];
             dst += linesize;
         }
     }
@@ -253,6 +271,8 @@ static av_cold void geq_uninit(AVFilterContext *ctx)
 
     for (i = 0; i < FF_ARRAY_ELEMS(geq->e); i++)
         av_expr_free(geq->e[i]);
+    av_freep(&geq->x_values);
+    av_freep(&geq->row);
 }
 
 static const AVFilterPad geq_inputs[] = {
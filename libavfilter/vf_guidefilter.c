@@ -21,109 +21,263 @@
 
 /**
  * @file
- * Apply a boxblur filter to the input video.
- * Ported from MPlayer libmpcodecs/vf_boxblur.c.
+ * Box filter over float planes, used by the guided filter in defog.
+ * The running sum idea comes from MPlayer libmpcodecs/vf_boxblur.c.
  */
 
-#include "libavutil/avstring.h"
+#include <string.h>
+
+#include "libavutil/attributes.h"
 #include "libavutil/common.h"
-#include "libavutil/eval.h"
-#include "libavutil/opt.h"
-#include "libavutil/pixdesc.h"
-#include "avfilter.h"
-#include "formats.h"
+#include "libavutil/mem.h"
 #include "internal.h"
-#include "video.h"
+#include "vf_guidefilter.h"
+
+/* Rows handled together by the horizontal pass. They are transposed so
+ * that the window slides down HGROUP columns at once, with the same
+ * kernel as the vertical pass. */
+#define HGROUP 16
+
+#define MAX_JOBS 64
+
+/* Naive boxblur would sum source pixels from x-radius .. x+radius
+ * for destination pixel x. That would be O(radius*width).
+ * Two consecutive windows only differ by one pixel on each end, so the
+ * next sum is found by adding the entering line and subtracting the
+ * leaving one. */
+static void slide_c(float *dst, float *acc, const float *add, const float *sub,
+                    int w, float scale)
+{
+    int i;
 
-void boxfilter(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize);
+    for (i = 0; i < w; i++) {
+        acc[i] += add[i] - sub[i];
+        dst[i]  = acc[i] * scale;
+    }
+}
 
-static inline void blur8(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
-                        int len, int radius)
+static void accumulate_c(float *acc, const float *src, int w)
 {
-    /* Naive boxblur would sum source pixels from x-radius .. x+radius
-     * for destination pixel x. That would be O(radius*width).
-     * If you now look at what source pixels represent 2 consecutive
-     * output pixels, then you see they are almost identical and only
-     * differ by 2 pixels, like:
-     * src0       111111111
-     * dst0           1
-     * src1        111111111
-     * dst1            1
-     * src0-src1  1       -1
-     * so when you know one output pixel you can find the next by just adding
-     * and subtracting 1 input pixel.
-     * The following code adopts this faster variant.
-     */
-    const int length = radius*2 + 1;
-    const int inv = ((1<<16) + length/2)/length;
-    int x, sum = src[radius*src_step];
+    int i;
 
-    //av_log(0, AV_LOG_ERROR, "%s, dst_step=%d, src_step=%d\n", 
-    //    __FUNCTION__, dst_step, src_step);
+    for (i = 0; i < w; i++)
+        acc[i] += src[i];
+}
 
-    for (x = 0; x < radius; x++)
-        sum += src[x*src_step]<<1;
+av_cold void ff_guidefilter_dsp_init(GuideFilterDSPContext *dsp)
+{
+    dsp->slide      = slide_c;
+    dsp->accumulate = accumulate_c;
+
+    if (ARCH_X86)
+        ff_guidefilter_dsp_init_x86(dsp);
+}
 
-    sum = sum*inv + (1<<15);
+/* mirror around the borders with the border sample repeated */
+static inline int mirror(int x, int len)
+{
+    return x < 0 ? -x - 1 : x >= len ? 2 * len - x - 1 : x;
+}
 
-    for (x = 0; x <= radius; x++) {
-        sum += (src[(radius+x)*src_step] - src[(radius-x)*src_step])*inv;
-        dst[x*dst_step] = sum>>16;
-    }
+av_cold int ff_boxfilter_init(BoxFilterContext *s, int w, int h, int radius)
+{
+    int size;
 
-    for (; x < len-radius; x++) {
-        sum += (src[(radius+x)*src_step] - src[(x-radius-1)*src_step])*inv;
-        dst[x*dst_step] = sum >>16;
+    ff_boxfilter_uninit(s);
+
+    s->w          = w;
+    s->h          = h;
+    s->radius     = av_clip(radius, 0, FFMIN(w, h) - 1);
+    s->tmp_stride = FFALIGN(w, 8);
+
+    /* the padding columns stay zero so that the vertical pass can run
+     * the kernels over the whole aligned width */
+    s->tmp = av_mallocz_array(s->tmp_stride, h * sizeof(*s->tmp));
+
+    /* horizontal pass: the transposed group plus its window sums,
+     * vertical pass: one row of window sums */
+    size = FFMAX((w + 2 * s->radius + 2) * HGROUP, s->tmp_stride);
+    s->pool = av_buffer_pool_init(size * sizeof(float), NULL);
+
+    if (!s->tmp || !s->pool) {
+        ff_boxfilter_uninit(s);
+        return AVERROR(ENOMEM);
     }
 
-    for (; x < len; x++) {
-        sum += (src[(2*len-radius-x-1)*src_step] - src[(x-radius-1)*src_step])*inv;
-        dst[x*dst_step] = sum>>16;
+    ff_guidefilter_dsp_init(&s->dsp);
+    return 0;
+}
+
+av_cold void ff_boxfilter_uninit(BoxFilterContext *s)
+{
+    av_freep(&s->tmp);
+    av_buffer_pool_uninit(&s->pool);
+}
+
+typedef struct ThreadData {
+    BoxFilterContext *s;
+    float *dst;
+    const float *src;
+    ptrdiff_t dst_stride, src_stride;   ///< in floats
+} ThreadData;
+
+static int hblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ThreadData *td = arg;
+    BoxFilterContext *s = td->s;
+    const int w = s->w, r = s->radius;
+    const int nb_groups = (s->h + HGROUP - 1) / HGROUP;
+    const int g_start = (nb_groups *  jobnr   ) / nb_jobs;
+    const int g_end   = (nb_groups * (jobnr+1)) / nb_jobs;
+    const float scale = 1.0f / (2 * r + 1);
+    AVBufferRef *buf = av_buffer_pool_get(s->pool);
+    float *col, *acc;
+    int g, x, j;
+
+    if (!buf)
+        return AVERROR(ENOMEM);
+
+    /* column t holds source column mirror(t - r - 1), column 0 is zero so
+     * that priming and sliding can share one loop; the results overwrite
+     * the columns that left the window */
+    col = (float *)buf->data;
+    acc = col + (w + 2 * r + 1) * HGROUP;
+
+    for (g = g_start; g < g_end; g++) {
+        const int y0 = g * HGROUP;
+        const int n  = FFMIN(HGROUP, s->h - y0);
+
+        memset(col, 0, HGROUP * sizeof(*col));
+        for (j = 0; j < HGROUP; j++) {
+            const float *src = td->src + (y0 + j) * td->src_stride;
+            float *c = col + HGROUP + j;
+
+            if (j < n) {
+                for (x = -r; x < w + r; x++)
+                    c[(x + r) * HGROUP] = src[mirror(x, w)];
+            } else {
+                for (x = -r; x < w + r; x++)
+                    c[(x + r) * HGROUP] = 0;
+            }
+        }
+
+        memset(acc, 0, HGROUP * sizeof(*acc));
+        for (x = 0; x < 2 * r + 1; x++)
+            s->dsp.accumulate(acc, col + x * HGROUP, HGROUP);
+        for (x = 0; x < w; x++)
+            s->dsp.slide(col + x * HGROUP, acc, col + (x + 2 * r + 1) * HGROUP,
+                         col + x * HGROUP, HGROUP, scale);
+
+        for (j = 0; j < n; j++) {
+            float *dst = s->tmp + (y0 + j) * s->tmp_stride;
+            for (x = 0; x < w; x++)
+                dst[x] = col[x * HGROUP + j];
+        }
     }
+
+    av_buffer_unref(&buf);
+    return 0;
 }
 
-static inline void blur16(uint16_t *dst, int dst_step, const uint16_t *src, int src_step,
-                          int len, int radius)
+/* Split by columns rather than rows: the sums then always start from the
+ * top border, so the output does not depend on the number of threads. */
+static int vblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    const int length = radius*2 + 1;
-    const int inv = ((1<<16) + length/2)/length;
-    int x, sum = src[radius*src_step];
+    ThreadData *td = arg;
+    BoxFilterContext *s = td->s;
+    const int h = s->h, r = s->radius;
+    const int nb_blocks = (s->w + 7) >> 3;
+    const int x0 = (nb_blocks *  jobnr   ) / nb_jobs * 8;
+    const int x1 = FFMIN((nb_blocks * (jobnr+1)) / nb_jobs * 8, s->w);
+    const int w  = x1 - x0, w8 = w & ~7;
+    const float scale = 1.0f / (2 * r + 1);
+    const ptrdiff_t stride = s->tmp_stride;
+    const float *tmp = s->tmp + x0;
+    AVBufferRef *buf = av_buffer_pool_get(s->pool);
+    float *acc;
+    int y;
 
-    //av_log(0, AV_LOG_ERROR, "%s, dst_step=%d, src_step=%d\n", 
-    //    __FUNCTION__, dst_step, src_step);
+    if (!buf)
+        return AVERROR(ENOMEM);
 
-    for (x = 0; x < radius; x++)
-        sum += src[x*src_step]<<1;
+    acc = (float *)buf->data;
+    memset(acc, 0, FFALIGN(w, 8) * sizeof(*acc));
+    for (y = -r - 1; y < r; y++)
+        s->dsp.accumulate(acc, tmp + mirror(y, h) * stride, FFALIGN(w, 8));
 
-    sum = sum*inv + (1<<15);
+    for (y = 0; y < h; y++) {
+        const float *add = tmp + mirror(y + r,     h) * stride;
+        const float *sub = tmp + mirror(y - r - 1, h) * stride;
+        float *dst = td->dst + y * td->dst_stride + x0;
 
-    for (x = 0; x <= radius; x++) {
-        sum += (src[(radius+x)*src_step] - src[(radius-x)*src_step])*inv;
-        dst[x*dst_step] = sum>>16;
+        if (w8)
+            s->dsp.slide(dst, acc, add, sub, w8, scale);
+        if (w8 < w)
+            slide_c(dst + w8, acc + w8, add + w8, sub + w8, w - w8, scale);
     }
 
-    for (; x < len-radius; x++) {
-        sum += (src[(radius+x)*src_step] - src[(x-radius-1)*src_step])*inv;
-        dst[x*dst_step] = sum >>16;
-    }
+    av_buffer_unref(&buf);
+    return 0;
+}
 
-    for (; x < len; x++) {
-        sum += (src[(2*len-radius-x-1)*src_step] - src[(x-radius-1)*src_step])*inv;
-        dst[x*dst_step] = sum>>16;
+static int run_jobs(AVFilterContext *ctx, avfilter_action_func *func,
+                    ThreadData *td, int nb_lines)
+{
+    int ret[MAX_JOBS] = { 0 };
+    int nb_jobs, i;
+
+    if (!ctx)
+        return func(NULL, td, 0, 1);
+
+    nb_jobs = FFMIN3(nb_lines, ctx->graph->nb_threads, MAX_JOBS);
+    ctx->internal->execute(ctx, func, td, ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++)
+        if (ret[i] < 0)
+            return ret[i];
+    return 0;
+}
+
+int ff_boxfilter(AVFilterContext *ctx, BoxFilterContext *s,
+                 float *dst, ptrdiff_t dst_linesize,
+                 const float *src, ptrdiff_t src_linesize)
+{
+    ThreadData td;
+    int ret, y;
+
+    if (!s->radius) {
+        if (dst != src)
+            for (y = 0; y < s->h; y++)
+                memcpy(dst + y * (dst_linesize / sizeof(*dst)),
+                       src + y * (src_linesize / sizeof(*src)),
+                       s->w * sizeof(*dst));
+        return 0;
     }
+
+    td.s          = s;
+    td.dst        = dst;
+    td.src        = src;
+    td.dst_stride = dst_linesize / sizeof(*dst);
+    td.src_stride = src_linesize / sizeof(*src);
+
+    ret = run_jobs(ctx, hblur_slice, &td, (s->h + HGROUP - 1) / HGROUP);
+    if (ret < 0)
+        return ret;
+    return run_jobs(ctx, vblur_slice, &td, (s->w + 7) >> 3);
 }
 
-static inline void blur32f(float *dst, int dst_step, const float *src, int src_step,
-                          int len, int radius)
+#ifdef TEST
+
+#include "libavutil/lfg.h"
+#include "libavutil/time.h"
+
+/* the per line filter this replaced, kept as the reference */
+static void blur32f(float *dst, int dst_step, const float *src, int src_step,
+                    int len, int radius)
 {
     const int length = radius*2 + 1;
     int x;
     float sum = src[radius*src_step];
 
-    //av_log(0, AV_LOG_ERROR, "%s, dst_step=%d, src_step=%d, len=%d\n", 
-    //    __FUNCTION__, dst_step, src_step, len);
-
     for (x = 0; x < radius; x++)
         sum += src[x*src_step] * 2;
 
@@ -143,99 +297,79 @@ static inline void blur32f(float *dst, int dst_step, const float *src, int src_s
     }
 }
 
-static inline void blur(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
-                        int len, int radius, int pixsize)
+static void ref_boxfilter(float *dst, const float *src, ptrdiff_t stride,
+                          int w, int h, int radius, float *temp)
 {
-    if (pixsize == 1) 
-        blur8 (dst, dst_step, src, src_step   , len, radius);
-    else if (pixsize == 2) {
-        blur16((uint16_t*)dst, dst_step>>1, (const uint16_t*)src, src_step>>1, len, radius);
-    } else {
-        blur32f((float*)dst, dst_step>>2, (const float*)src, src_step>>2, len, radius);
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        blur32f(temp, 1, src + y * stride, 1, w, radius);
+        memcpy(dst + y * stride, temp, w * sizeof(*dst));
+    }
+    for (x = 0; x < w; x++) {
+        blur32f(temp, 1, dst + x, stride, h, radius);
+        for (y = 0; y < h; y++)
+            dst[y * stride + x] = temp[y];
     }
 }
 
-static inline void blur_power(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
-                              int len, int radius, int power, uint8_t *temp[2], int pixsize)
+int main(int argc, char **argv)
 {
-    uint8_t *a = temp[0], *b = temp[1];
-
-    //av_log(0, AV_LOG_ERROR, "%s, dst_step=%d, src_step=%d, pixsize=%d\n", 
-    //    __FUNCTION__, dst_step, src_step, pixsize);
-
-    if (radius && power) {
-        blur(a, pixsize, src, src_step, len, radius, pixsize);
-        for (; power > 2; power--) {
-            uint8_t *c;
-            blur(b, pixsize, a, pixsize, len, radius, pixsize);
-            c = a; a = b; b = c;
-        }
-        if (power > 1) {
-            blur(dst, dst_step, a, pixsize, len, radius, pixsize);
-        } else {
-            int i;
-            if (pixsize == 1) {
-                for (i = 0; i < len; i++)
-                    dst[i*dst_step] = a[i];
-            } else if (pixsize == 2) {
-                for (i = 0; i < len; i++)
-                    *(uint16_t*)(dst + i*dst_step) = ((uint16_t*)a)[i];
-            } else {
-                for (i = 0; i < len; i++)
-                    *(float*)(dst + i*dst_step) = ((float*)a)[i];
-            }
-        }
-    } else {
-        int i;
-        if (pixsize == 1) {
-            for (i = 0; i < len; i++)
-                dst[i*dst_step] = src[i*src_step];
-        } else if (pixsize == 2) {
-            for (i = 0; i < len; i++)
-                *(uint16_t*)(dst + i*dst_step) = *(uint16_t*)(src + i*src_step);
-        } else {
-            for (i = 0; i < len; i++)
-                *(float*)(dst + i*dst_step) = ((float*)a)[i];
+    static const struct { int w, h, radius; } tests[] = {
+        {    1,    1,  4 }, {   7,   3,  1 }, {  33,  17,  5 },
+        {  720,  576, 16 }, { 1920, 1080, 33 }, { 3840, 2160, 33 },
+    };
+    BoxFilterContext s = { 0 };
+    AVLFG lfg;
+    int i, k, ret = 0;
+
+    av_lfg_init(&lfg, 0xb0c5);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        const int w = tests[i].w, h = tests[i].h;
+        const ptrdiff_t stride = FFALIGN(w, 16);
+        float *src  = av_malloc_array(stride * h, sizeof(*src));
+        float *ref  = av_malloc_array(stride * h, sizeof(*ref));
+        float *out  = av_malloc_array(stride * h, sizeof(*out));
+        float *temp = av_malloc_array(FFMAX(w, h), sizeof(*temp));
+        int64_t t_ref, t_new;
+        float maxdiff = 0;
+        int x, y;
+
+        if (!src || !ref || !out || !temp ||
+            ff_boxfilter_init(&s, w, h, tests[i].radius) < 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
         }
-    }
-}
 
-static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
-{
-    int y;
+        for (k = 0; k < stride * h; k++)
+            src[k] = av_lfg_get(&lfg) / (float)UINT32_MAX;
 
-    if (radius == 0 && dst == src)
-        return;
+        t_ref = av_gettime_relative();
+        ref_boxfilter(ref, src, stride, w, h, s.radius, temp);
+        t_ref = av_gettime_relative() - t_ref;
 
-    for (y = 0; y < h; y++)
-        blur_power(dst + y*dst_linesize, pixsize, src + y*src_linesize, pixsize,
-                   w, radius, power, temp, pixsize);
-}
+        t_new = av_gettime_relative();
+        ff_boxfilter(NULL, &s, out, stride * sizeof(*out), src, stride * sizeof(*src));
+        t_new = av_gettime_relative() - t_new;
 
-/**
- * @param power [in] Specify how many times the boxblur filter is applied to the 
- *                   corresponding plane. A value of 0 will disable the effect.
- * @param temp [in] temporary buffer used in blur_power()
- *                      temp[i] = av_malloc(2*FFMAX(w, h))
- * @param pixsize [in] num of bytes each pixle used
- */
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
-{
-    int x;
+        for (y = 0; y < h; y++)
+            for (x = 0; x < w; x++)
+                maxdiff = FFMAX(maxdiff, fabsf(out[y * stride + x] - ref[y * stride + x]));
+
+        printf("%4dx%-4d r=%-2d  per line %7"PRId64" us  running sum %7"PRId64" us  max diff %g\n",
+               w, h, s.radius, t_ref, t_new, maxdiff);
+        if (maxdiff > 1e-4)
+            ret = 1;
 
-    if (radius == 0 && dst == src)
-        return;
+        av_free(src);
+        av_free(ref);
+        av_free(out);
+        av_free(temp);
+    }
 
-    for (x = 0; x < w; x++)
-        blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
-                   h, radius, power, temp, pixsize);
+    ff_boxfilter_uninit(&s);
+    return ret;
 }
 
-void boxfilter(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
-{
-    hblur(dst, dst_linesize, src, src_linesize, w, h, radius, power, temp, pixsize);
-    vblur(dst, dst_linesize, dst, dst_linesize, w, h, radius, power, temp, pixsize);
-}
\ No newline at end of file
+#endif /* TEST */
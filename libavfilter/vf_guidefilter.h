@@ -0,0 +1,73 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_VF_GUIDEFILTER_H
+#define AVFILTER_VF_GUIDEFILTER_H
+
+#include <stddef.h>
+
+#include "libavutil/buffer.h"
+#include "avfilter.h"
+
+typedef struct GuideFilterDSPContext {
+    /**
+     * Slide a box window by one line over w columns:
+     * acc[i] += add[i] - sub[i], then dst[i] = acc[i] * scale.
+     * w must be a multiple of 8, the buffers need not be aligned.
+     */
+    void (*slide)(float *dst, float *acc, const float *add, const float *sub,
+                  int w, float scale);
+
+    /**
+     * acc[i] += src[i] over w columns, to prime the window.
+     * w must be a multiple of 8, the buffers need not be aligned.
+     */
+    void (*accumulate)(float *acc, const float *src, int w);
+} GuideFilterDSPContext;
+
+/**
+ * Running sum box filter over float planes, with the borders mirrored.
+ * Both passes run slice threaded when given a filter context.
+ */
+typedef struct BoxFilterContext {
+    GuideFilterDSPContext dsp;
+    int w, h, radius;
+    float *tmp;                 ///< output of the horizontal pass
+    ptrdiff_t tmp_stride;       ///< in floats
+    AVBufferPool *pool;         ///< per job scratch, reused across frames
+} BoxFilterContext;
+
+/**
+ * @param radius half window size, clipped to fit in the plane
+ */
+int ff_boxfilter_init(BoxFilterContext *s, int w, int h, int radius);
+void ff_boxfilter_uninit(BoxFilterContext *s);
+
+/**
+ * Box filter the w x h float plane src into dst, which may be the same.
+ * @param ctx filter context whose threads to use, NULL to run in the caller
+ * @param linesize in bytes
+ */
+int ff_boxfilter(AVFilterContext *ctx, BoxFilterContext *s,
+                 float *dst, ptrdiff_t dst_linesize,
+                 const float *src, ptrdiff_t src_linesize);
+
+void ff_guidefilter_dsp_init(GuideFilterDSPContext *dsp);
+void ff_guidefilter_dsp_init_x86(GuideFilterDSPContext *dsp);
+
+#endif /* AVFILTER_VF_GUIDEFILTER_H */
@@ -67,6 +67,14 @@ static void lowpass_line_c(uint8_t *dstp, ptrdiff_t linesize,
     }
 }
 
+av_cold void ff_interlace_init(InterlaceContext *s)
+{
+    s->lowpass_line = lowpass_line_c;
+
+    if (ARCH_X86)
+        ff_interlace_init_x86(s);
+}
+
 static const enum AVPixelFormat formats_supported[] = {
     AV_PIX_FMT_YUV420P,  AV_PIX_FMT_YUV422P,  AV_PIX_FMT_YUV444P,
     AV_PIX_FMT_YUV444P,  AV_PIX_FMT_YUV410P,  AV_PIX_FMT_YUVA420P,
@@ -116,11 +124,8 @@ static int config_out_props(AVFilterLink *outlink)
     outlink->flags |= FF_LINK_FLAG_REQUEST_LOOP;
 
 
-    if (s->lowpass) {
-        s->lowpass_line = lowpass_line_c;
-        if (ARCH_X86)
-            ff_interlace_init_x86(s);
-    }
+    if (s->lowpass)
+        ff_interlace_init(s);
 
     av_log(ctx, AV_LOG_VERBOSE, "%s interlacing %s lowpass filter\n",
            s->scan == MODE_TFF ? "tff" : "bff", (s->lowpass) ? "with" : "without");
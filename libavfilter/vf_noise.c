@@ -279,6 +279,15 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *inpicref)
     return ff_filter_frame(outlink, out);
 }
 
+av_cold void ff_noise_init(NoiseContext *n)
+{
+    n->line_noise     = ff_line_noise_c;
+    n->line_noise_avg = ff_line_noise_avg_c;
+
+    if (ARCH_X86)
+        ff_noise_init_x86(n);
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     NoiseContext *n = ctx->priv;
@@ -300,11 +309,7 @@ static av_cold int init(AVFilterContext *ctx)
             return ret;
     }
 
-    n->line_noise     = ff_line_noise_c;
-    n->line_noise_avg = ff_line_noise_avg_c;
-
-    if (ARCH_X86)
-        ff_noise_init_x86(n);
+    ff_noise_init(n);
 
     return 0;
 }
@@ -59,6 +59,7 @@ typedef struct {
 void ff_line_noise_c(uint8_t *dst, const uint8_t *src, const int8_t *noise, int len, int shift);
 void ff_line_noise_avg_c(uint8_t *dst, const uint8_t *src, int len, const int8_t * const *shift);
 
+void ff_noise_init(NoiseContext *n);
 void ff_noise_init_x86(NoiseContext *n);
 
 #endif /* AVFILTER_NOISE_H */
@@ -288,10 +288,79 @@ static int frame_needs_copy(PadContext *s, AVFrame *frame)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int needs_copy;
+} ThreadData;
+
+/**
+ * Restrict the rows [*y, *y + *h) of a rectangle to [start, end).
+ * Return 0 if nothing is left.
+ */
+static int clip_rows(int *y, int *h, int start, int end)
+{
+    int y1 = FFMIN(*y + *h, end);
+
+    *y = FFMAX(*y, start);
+    *h = y1 - *y;
+    return *h > 0;
+}
+
+static int pad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PadContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in  = td->in;
+    AVFrame *out = td->out;
+    /* slices start on chroma row boundaries so that no two jobs touch the
+     * same subsampled row */
+    const int step = 1 << s->draw.vsub_max;
+    const int nb_rows = (s->h + step - 1) / step;
+    const int start = (nb_rows *  jobnr   ) / nb_jobs * step;
+    const int end   = FFMIN((nb_rows * (jobnr+1)) / nb_jobs * step, s->h);
+    int y, h;
+
+    /* top bar */
+    y = 0; h = s->y;
+    if (clip_rows(&y, &h, start, end))
+        ff_fill_rectangle(&s->draw, &s->color,
+                          out->data, out->linesize,
+                          0, y, s->w, h);
+
+    /* bottom bar */
+    y = s->y + s->in_h; h = s->h - s->y - s->in_h;
+    if (clip_rows(&y, &h, start, end))
+        ff_fill_rectangle(&s->draw, &s->color,
+                          out->data, out->linesize,
+                          0, y, s->w, h);
+
+    y = s->y; h = in->height;
+    if (!clip_rows(&y, &h, start, end))
+        return 0;
+
+    /* left border */
+    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                      0, y, s->x, h);
+
+    if (td->needs_copy) {
+        ff_copy_rectangle2(&s->draw,
+                          out->data, out->linesize, in->data, in->linesize,
+                          s->x, y, 0, y - s->y, in->width, h);
+    }
+
+    /* right border */
+    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                      s->x + s->in_w, y, s->w - s->x - s->in_w,
+                      h);
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    PadContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    PadContext *s = ctx->priv;
     AVFrame *out;
+    ThreadData td;
     int needs_copy = frame_needs_copy(s, in);
 
     if (needs_copy) {
@@ -317,34 +386,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         }
     }
 
-    /* top bar */
-    if (s->y) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, 0, s->w, s->y);
-    }
-
-    /* bottom bar */
-    if (s->h > s->y + s->in_h) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, s->y + s->in_h, s->w, s->h - s->y - s->in_h);
-    }
-
-    /* left border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      0, s->y, s->x, in->height);
-
-    if (needs_copy) {
-        ff_copy_rectangle2(&s->draw,
-                          out->data, out->linesize, in->data, in->linesize,
-                          s->x, s->y, 0, 0, in->width, in->height);
-    }
-
-    /* right border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      s->x + s->in_w, s->y, s->w - s->x - s->in_w,
-                      in->height);
+    td.in  = in;
+    td.out = out;
+    td.needs_copy = needs_copy;
+    ctx->internal->execute(ctx, pad_slice, &td, NULL,
+                           FFMIN(FF_CEIL_RSHIFT(s->h, s->draw.vsub_max),
+                                 ctx->graph->nb_threads));
 
     out->width  = s->w;
     out->height = s->h;
@@ -398,4 +445,5 @@ AVFilter ff_vf_pad = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_pad_inputs,
     .outputs       = avfilter_vf_pad_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -281,6 +281,21 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, fmts_list);
 }
 
+av_cold void ff_pp7_init(PP7Context *pp7)
+{
+    switch (pp7->mode) {
+        case 0: pp7->requantize = hardthresh_c; break;
+        case 1: pp7->requantize = softthresh_c; break;
+        default:
+        case 2: pp7->requantize = mediumthresh_c; break;
+    }
+
+    pp7->dctB = dctB_c;
+
+    if (ARCH_X86)
+        ff_pp7_init_x86(pp7);
+}
+
 static int config_input(AVFilterLink *inlink)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -299,17 +314,7 @@ static int config_input(AVFilterLink *inlink)
 
     init_thres2(pp7);
 
-    switch (pp7->mode) {
-        case 0: pp7->requantize = hardthresh_c; break;
-        case 1: pp7->requantize = softthresh_c; break;
-        default:
-        case 2: pp7->requantize = mediumthresh_c; break;
-    }
-
-    pp7->dctB = dctB_c;
-
-    if (ARCH_X86)
-        ff_pp7_init_x86(pp7);
+    ff_pp7_init(pp7);
 
     return 0;
 }
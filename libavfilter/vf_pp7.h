@@ -41,6 +41,7 @@ typedef struct PP7Context {
 
 } PP7Context;
 
+void ff_pp7_init(PP7Context *pp7);
 void ff_pp7_init_x86(PP7Context *pp7);
 
 #endif /* AVFILTER_PP7_H */
@@ -99,6 +99,14 @@ static uint64_t sse_line_16bit(const uint8_t *_main_line, const uint8_t *_ref_li
     return m2;
 }
 
+av_cold void ff_psnr_dsp_init(PSNRDSPContext *dsp, int bpp)
+{
+    dsp->sse_line = bpp > 8 ? sse_line_16bit : sse_line_8bit;
+
+    if (ARCH_X86)
+        ff_psnr_init_x86(dsp, bpp);
+}
+
 static inline
 void compute_images_mse(PSNRContext *s,
                         const uint8_t *main_data[4], const int main_linesizes[4],
@@ -274,9 +282,7 @@ static int config_input_ref(AVFilterLink *inlink)
         s->average_max += s->max[j] * s->planeweight[j];
     }
 
-    s->dsp.sse_line = desc->comp[0].depth_minus1 > 7 ? sse_line_16bit : sse_line_8bit;
-    if (ARCH_X86)
-        ff_psnr_init_x86(&s->dsp, desc->comp[0].depth_minus1 + 1);
+    ff_psnr_dsp_init(&s->dsp, desc->comp[0].depth_minus1 + 1);
 
     return 0;
 }
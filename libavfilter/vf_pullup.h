@@ -66,6 +66,7 @@ typedef struct PullupContext {
     int (*var )(const uint8_t *a, const uint8_t *b, ptrdiff_t s);
 } PullupContext;
 
+void ff_pullup_init(PullupContext *s);
 void ff_pullup_init_x86(PullupContext *s);
 
 #endif /* AVFILTER_PULLUP_H */
@@ -380,6 +380,7 @@ static int config_props(AVFilterLink *outlink)
             if (scale->out_range != AVCOL_RANGE_UNSPECIFIED)
                 av_opt_set_int(*s, "dst_range",
                                scale->out_range == AVCOL_RANGE_JPEG, 0);
+            av_opt_set_int(*s, "threads", ctx->graph->nb_threads, 0);
 
             if (scale->opts) {
                 AVDictionaryEntry *e = NULL;
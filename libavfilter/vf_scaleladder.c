@@ -0,0 +1,355 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * scale the input to several sizes at once
+ *
+ * Every rung is scaled from the smallest larger rung that is at least
+ * twice its size in both directions, or from the input if there is none,
+ * so only the biggest rungs read and unpack the source frame and the
+ * others are cascaded from already converted, smaller pictures.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+#include "avfilter.h"
+#include "formats.h"
+#include "internal.h"
+#include "video.h"
+
+#define MAX_RUNGS 16
+
+typedef struct Rung {
+    int w, h;
+    int src;                    ///< rung scaled from, -1 for the input
+    struct SwsContext *sws;
+    AVFrame *frame;
+} Rung;
+
+typedef struct ScaleLadderContext {
+    const AVClass *class;
+    char *sizes_str;
+    char *flags_str;
+    int cascade;
+
+    unsigned int flags;
+    Rung rungs[MAX_RUNGS];
+    int nb_rungs;
+    int order[MAX_RUNGS];       ///< rung indices, sources before their users
+} ScaleLadderContext;
+
+static int64_t rung_area(const Rung *r)
+{
+    return (int64_t)r->w * r->h;
+}
+
+static int config_output(AVFilterLink *outlink);
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+    const char *p = s->sizes_str;
+    int i, j, ret;
+
+    if (!p || !*p) {
+        av_log(ctx, AV_LOG_ERROR, "No output sizes given.\n");
+        return AVERROR(EINVAL);
+    }
+
+    while (*p) {
+        char *size = av_get_token(&p, "|");
+        Rung *r = &s->rungs[s->nb_rungs];
+
+        if (!size)
+            return AVERROR(ENOMEM);
+        if (s->nb_rungs == MAX_RUNGS) {
+            av_log(ctx, AV_LOG_ERROR, "At most %d sizes are supported.\n", MAX_RUNGS);
+            av_free(size);
+            return AVERROR(EINVAL);
+        }
+        ret = av_parse_video_size(&r->w, &r->h, size);
+        if (ret < 0) {
+            av_log(ctx, AV_LOG_ERROR, "Invalid size '%s'\n", size);
+            av_free(size);
+            return ret;
+        }
+        av_free(size);
+        s->order[s->nb_rungs] = s->nb_rungs;
+        s->nb_rungs++;
+        if (*p)
+            p++;
+    }
+
+    /* Processing the rungs by decreasing area guarantees that a source
+     * has been scaled before any rung depending on it. */
+    for (i = 0; i < s->nb_rungs; i++)
+        for (j = i; j > 0 && rung_area(&s->rungs[s->order[j - 1]]) <
+                              rung_area(&s->rungs[s->order[j]]); j--)
+            FFSWAP(int, s->order[j - 1], s->order[j]);
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        Rung *r = &s->rungs[s->order[i]];
+
+        r->src = -1;
+        if (!s->cascade)
+            continue;
+        for (j = i - 1; j >= 0; j--) {
+            const Rung *src = &s->rungs[s->order[j]];
+            if (src->w >= 2 * r->w && src->h >= 2 * r->h) {
+                r->src = s->order[j];
+                break;
+            }
+        }
+    }
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        char name[32];
+        AVFilterPad pad = { 0 };
+
+        snprintf(name, sizeof(name), "output%d", i);
+        pad.type         = AVMEDIA_TYPE_VIDEO;
+        pad.name         = av_strdup(name);
+        pad.config_props = config_output;
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+
+        ff_insert_outpad(ctx, i, &pad);
+    }
+
+    if (s->flags_str) {
+        const AVClass *class = sws_get_class();
+        const AVOption    *o = av_opt_find(&class, "sws_flags", NULL, 0,
+                                           AV_OPT_SEARCH_FAKE_OBJ);
+        ret = av_opt_eval_flags(&class, o, s->flags_str, &s->flags);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+    int i;
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        sws_freeContext(s->rungs[i].sws);
+        s->rungs[i].sws = NULL;
+        av_frame_free(&s->rungs[i].frame);
+    }
+    for (i = 0; i < ctx->nb_outputs; i++)
+        av_freep(&ctx->output_pads[i].name);
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    AVFilterFormats *in_formats = NULL, *out_formats = NULL;
+    const AVPixFmtDescriptor *desc = NULL;
+    int i, ret;
+
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+
+        if (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+            continue;
+        if (sws_isSupportedInput(pix_fmt) &&
+            (ret = ff_add_format(&in_formats, pix_fmt)) < 0)
+            goto fail;
+        /* the cascaded rungs read the outputs back */
+        if (sws_isSupportedInput(pix_fmt) && sws_isSupportedOutput(pix_fmt) &&
+            (ret = ff_add_format(&out_formats, pix_fmt)) < 0)
+            goto fail;
+    }
+
+    ff_formats_ref(in_formats, &ctx->inputs[0]->out_formats);
+    /* all the rungs share the same format */
+    for (i = 0; i < ctx->nb_outputs; i++)
+        ff_formats_ref(out_formats, &ctx->outputs[i]->in_formats);
+
+    return 0;
+fail:
+    ff_formats_unref(&in_formats);
+    ff_formats_unref(&out_formats);
+    return ret;
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    ScaleLadderContext *s = ctx->priv;
+    int i;
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        Rung *r = &s->rungs[i];
+        AVFilterLink *outlink = ctx->outputs[i];
+        int src_w   = r->src < 0 ? inlink->w      : s->rungs[r->src].w;
+        int src_h   = r->src < 0 ? inlink->h      : s->rungs[r->src].h;
+        int src_fmt = r->src < 0 ? inlink->format : outlink->format;
+
+        sws_freeContext(r->sws);
+        r->sws = sws_alloc_context();
+        if (!r->sws)
+            return AVERROR(ENOMEM);
+
+        av_opt_set_int(r->sws, "srcw",       src_w,           0);
+        av_opt_set_int(r->sws, "srch",       src_h,           0);
+        av_opt_set_int(r->sws, "src_format", src_fmt,         0);
+        av_opt_set_int(r->sws, "dstw",       r->w,            0);
+        av_opt_set_int(r->sws, "dsth",       r->h,            0);
+        av_opt_set_int(r->sws, "dst_format", outlink->format, 0);
+        av_opt_set_int(r->sws, "sws_flags",  s->flags,        0);
+        av_opt_set_int(r->sws, "threads",    ctx->graph->nb_threads, 0);
+
+        if (sws_init_context(r->sws, NULL, NULL) < 0) {
+            av_log(ctx, AV_LOG_ERROR, "Cannot scale %dx%d %s to %dx%d %s.\n",
+                   src_w, src_h, av_get_pix_fmt_name(src_fmt),
+                   r->w, r->h, av_get_pix_fmt_name(outlink->format));
+            return AVERROR(EINVAL);
+        }
+
+        av_log(ctx, AV_LOG_VERBOSE, "rung %d: %dx%d from %s %dx%d\n",
+               i, r->w, r->h, r->src < 0 ? "input" : "rung", src_w, src_h);
+    }
+
+    return 0;
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    AVFilterLink *inlink = ctx->inputs[0];
+    ScaleLadderContext *s = ctx->priv;
+    const Rung *r = &s->rungs[FF_OUTLINK_IDX(outlink)];
+
+    outlink->w = r->w;
+    outlink->h = r->h;
+
+    if (inlink->sample_aspect_ratio.num)
+        outlink->sample_aspect_ratio = av_mul_q((AVRational){ outlink->h * inlink->w,
+                                                              outlink->w * inlink->h },
+                                                inlink->sample_aspect_ratio);
+    else
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *in)
+{
+    AVFilterContext *ctx = inlink->dst;
+    ScaleLadderContext *s = ctx->priv;
+    int i, ret = 0;
+
+    if (in->width != inlink->w || in->height != inlink->h ||
+        in->format != inlink->format) {
+        av_log(ctx, AV_LOG_ERROR, "Changing the input size or format is not supported.\n");
+        av_frame_free(&in);
+        return AVERROR_PATCHWELCOME;
+    }
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        int idx = s->order[i];
+        Rung *r = &s->rungs[idx];
+        AVFilterLink *outlink = ctx->outputs[idx];
+        const AVFrame *src = r->src < 0 ? in : s->rungs[r->src].frame;
+
+        r->frame = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!r->frame) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        av_frame_copy_props(r->frame, in);
+        r->frame->width  = outlink->w;
+        r->frame->height = outlink->h;
+        av_reduce(&r->frame->sample_aspect_ratio.num, &r->frame->sample_aspect_ratio.den,
+                  (int64_t)in->sample_aspect_ratio.num * outlink->h * inlink->w,
+                  (int64_t)in->sample_aspect_ratio.den * outlink->w * inlink->h,
+                  INT_MAX);
+
+        if (av_pix_fmt_desc_get(outlink->format)->flags & AV_PIX_FMT_FLAG_PSEUDOPAL)
+            avpriv_set_systematic_pal2((uint32_t *)r->frame->data[1], outlink->format);
+
+        sws_scale(r->sws, (const uint8_t * const *)src->data, src->linesize,
+                  0, src->height, r->frame->data, r->frame->linesize);
+    }
+
+    for (i = 0; i < s->nb_rungs; i++) {
+        AVFrame *out = s->rungs[i].frame;
+
+        s->rungs[i].frame = NULL;
+        if (ctx->outputs[i]->closed) {
+            av_frame_free(&out);
+            continue;
+        }
+        ret = ff_filter_frame(ctx->outputs[i], out);
+        if (ret < 0)
+            break;
+    }
+
+end:
+    for (i = 0; i < s->nb_rungs; i++)
+        av_frame_free(&s->rungs[i].frame);
+    av_frame_free(&in);
+    return ret;
+}
+
+#define OFFSET(x) offsetof(ScaleLadderContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption scaleladder_options[] = {
+    { "sizes",   "set the '|' separated output sizes", OFFSET(sizes_str), AV_OPT_TYPE_STRING, { .str = NULL },      .flags = FLAGS },
+    { "flags",   "Flags to pass to libswscale",        OFFSET(flags_str), AV_OPT_TYPE_STRING, { .str = "bicubic" }, .flags = FLAGS },
+    { "cascade", "scale the smaller rungs from the larger ones", OFFSET(cascade), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, 1, FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(scaleladder);
+
+static const AVFilterPad scaleladder_inputs[] = {
+    {
+        .name         = "default",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .filter_frame = filter_frame,
+        .config_props = config_input,
+    },
+    { NULL }
+};
+
+AVFilter ff_vf_scaleladder = {
+    .name          = "scaleladder",
+    .description   = NULL_IF_CONFIG_SMALL("Scale the input video to several sizes in one pass."),
+    .priv_size     = sizeof(ScaleLadderContext),
+    .priv_class    = &scaleladder_class,
+    .init          = init,
+    .uninit        = uninit,
+    .query_formats = query_formats,
+    .inputs        = scaleladder_inputs,
+    .outputs       = NULL,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+};
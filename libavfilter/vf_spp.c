@@ -326,6 +326,18 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, fmts_list);
 }
 
+av_cold void ff_spp_init(SPPContext *s)
+{
+    s->store_slice = store_slice_c;
+    switch (s->mode) {
+    case MODE_HARD: s->requantize = hardthresh_c; break;
+    case MODE_SOFT: s->requantize = softthresh_c; break;
+    }
+
+    if (ARCH_X86)
+        ff_spp_init_x86(s);
+}
+
 static int config_input(AVFilterLink *inlink)
 {
     SPPContext *s = inlink->dst->priv;
@@ -336,8 +348,7 @@ static int config_input(AVFilterLink *inlink)
     av_opt_set_int(s->dct, "bits_per_sample", bps, 0);
     avcodec_dct_init(s->dct);
 
-    if (ARCH_X86)
-        ff_spp_init_x86(s);
+    ff_spp_init(s);
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
@@ -474,11 +485,6 @@ static av_cold int init_dict(AVFilterContext *ctx, AVDictionary **opts)
         av_dict_free(opts);
     }
 
-    s->store_slice = store_slice_c;
-    switch (s->mode) {
-    case MODE_HARD: s->requantize = hardthresh_c; break;
-    case MODE_SOFT: s->requantize = softthresh_c; break;
-    }
     return 0;
 }
 
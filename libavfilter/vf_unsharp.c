@@ -48,16 +48,19 @@
 #include "unsharp.h"
 #include "unsharp_opencl.h"
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
 static void apply_unsharp(      uint8_t *dst, int dst_stride,
                           const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+                          int width, int height, int slice_start, int slice_end,
+                          UnsharpFilterParam *fp, uint32_t **sc)
 {
-    uint32_t **sc = fp->sc;
     uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
 
     int32_t res;
     int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
     const int amount = fp->amount;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
@@ -65,16 +68,19 @@ static void apply_unsharp(      uint8_t *dst, int dst_stride,
     const int32_t halfscale = fp->halfscale;
 
     if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
 
     for (y = 0; y < 2 * steps_y; y++)
         memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
 
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
+    /* The vertical state only depends on the last 2 * steps_y input rows,
+     * so each slice primes it from the rows above its first output row. */
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        const uint8_t *src2 = src + av_clip(y, 0, height - 1) * src_stride;
 
         memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
         for (x = -steps_x; x < width + steps_x; x++) {
@@ -87,25 +93,24 @@ static void apply_unsharp(      uint8_t *dst, int dst_stride,
                 tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
                 tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
             }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
+            if (x >= steps_x && y >= slice_start + steps_y) {
+                const uint8_t *srx = src + (y - steps_y) * src_stride + x - steps_x;
+                uint8_t *dsx       = dst + (y - steps_y) * dst_stride + x - steps_x;
 
                 res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
                 *dsx = av_clip_uint8(res);
             }
         }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
-        }
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *unsharp = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in  = td->in;
+    AVFrame *out = td->out;
     int i, plane_w[3], plane_h[3];
     UnsharpFilterParam *fp[3];
     plane_w[0] = inlink->w;
@@ -115,11 +120,29 @@ static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
     fp[0] = &unsharp->luma;
     fp[1] = fp[2] = &unsharp->chroma;
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        const int slice_start = (plane_h[i] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (plane_h[i] * (jobnr+1)) / nb_jobs;
+
+        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i],
+                      plane_w[i], plane_h[i], slice_start, slice_end,
+                      fp[i], fp[i]->sc + 2 * fp[i]->steps_y * jobnr);
     }
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    UnsharpContext *unsharp = ctx->priv;
+    ThreadData td;
+    int nb_jobs = FFMIN(FF_CEIL_RSHIFT(ctx->inputs[0]->h, unsharp->vsub),
+                        unsharp->nb_threads);
+
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL, nb_jobs);
+    return 0;
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -169,7 +192,8 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, fmts_list);
 }
 
-static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
+static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type,
+                             int width, int nb_threads)
 {
     int z;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
@@ -184,7 +208,9 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
+    if (!(fp->sc = av_mallocz_array(2 * fp->steps_y * nb_threads, sizeof(*fp->sc))))
+        return AVERROR(ENOMEM);
+    for (z = 0; z < 2 * fp->steps_y * nb_threads; z++)
         if (!(fp->sc[z] = av_malloc_array(width + 2 * fp->steps_x,
                                           sizeof(*(fp->sc[z])))))
             return AVERROR(ENOMEM);
@@ -200,23 +226,28 @@ static int config_props(AVFilterLink *link)
 
     unsharp->hsub = desc->log2_chroma_w;
     unsharp->vsub = desc->log2_chroma_h;
+    unsharp->nb_threads = FFMAX(1, link->dst->graph->nb_threads);
 
-    ret = init_filter_param(link->dst, &unsharp->luma,   "luma",   link->w);
+    ret = init_filter_param(link->dst, &unsharp->luma,   "luma",   link->w, unsharp->nb_threads);
     if (ret < 0)
         return ret;
-    ret = init_filter_param(link->dst, &unsharp->chroma, "chroma", FF_CEIL_RSHIFT(link->w, unsharp->hsub));
+    ret = init_filter_param(link->dst, &unsharp->chroma, "chroma", FF_CEIL_RSHIFT(link->w, unsharp->hsub),
+                            unsharp->nb_threads);
     if (ret < 0)
         return ret;
 
     return 0;
 }
 
-static void free_filter_param(UnsharpFilterParam *fp)
+static void free_filter_param(UnsharpFilterParam *fp, int nb_threads)
 {
     int z;
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
+    if (!fp->sc)
+        return;
+    for (z = 0; z < 2 * fp->steps_y * nb_threads; z++)
         av_freep(&fp->sc[z]);
+    av_freep(&fp->sc);
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -227,8 +258,8 @@ static av_cold void uninit(AVFilterContext *ctx)
         ff_opencl_unsharp_uninit(ctx);
     }
 
-    free_filter_param(&unsharp->luma);
-    free_filter_param(&unsharp->chroma);
+    free_filter_param(&unsharp->luma,   unsharp->nb_threads);
+    free_filter_param(&unsharp->chroma, unsharp->nb_threads);
 }
 
 static int filter_frame(AVFilterLink *link, AVFrame *in)
@@ -310,5 +341,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
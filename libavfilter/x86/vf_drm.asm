@@ -0,0 +1,544 @@
+;*****************************************************************************
+;* x86-optimized functions for drmEmb/drmDec filters
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+; qp 4 quant/dequant rows 0-3 (rows 4-7 repeat them), each row stored twice
+; so that the same offset works for xmm and ymm loads
+%macro QUANT_ROWS 8
+    dw %1, %2, %3, %4, %1, %2, %3, %4
+    dw %1, %2, %3, %4, %1, %2, %3, %4
+    dw %5, %6, %7, %8, %5, %6, %7, %8
+    dw %5, %6, %7, %8, %5, %6, %7, %8
+%endmacro
+
+drm_quant_mf:   QUANT_ROWS  8192,  7740, 10486,  7740,  7740,  7346,  9777,  7346
+                QUANT_ROWS 10486,  9777, 13159,  9777,  7740,  7346,  9777,  7346
+drm_dequant_mf: QUANT_ROWS    32,    30,    40,    30,    30,    28,    38,    28
+                QUANT_ROWS    40,    38,    51,    38,    30,    28,    38,    28
+
+pw_7ffd: times 16 dw 0x7ffd
+pw_8000: times 16 dw 0x8000
+pd_2:    times  8 dd 2
+pb_80:   times 32 db 0x80
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; in: m0..m7 = SRC(0)..SRC(7), out: m0..m7 = DST(0)..DST(7), clobbers m8-m15
+%macro DCT8_1D 0
+    paddw      m8, m0, m7       ; s07
+    psubw      m0, m7           ; d07
+    paddw      m9, m1, m6       ; s16
+    psubw      m1, m6           ; d16
+    paddw     m10, m2, m5       ; s25
+    psubw      m2, m5           ; d25
+    paddw     m11, m3, m4       ; s34
+    psubw      m3, m4           ; d34
+
+    paddw     m12, m8, m11      ; a0
+    psubw      m8, m11          ; a2
+    paddw     m13, m9, m10      ; a1
+    psubw      m9, m10          ; a3
+
+    psraw      m4, m0, 1
+    psraw      m5, m1, 1
+    psraw      m6, m2, 1
+    psraw      m7, m3, 1
+    paddw      m4, m0           ; d07 + (d07>>1)
+    paddw      m5, m1           ; d16 + (d16>>1)
+    paddw      m6, m2           ; d25 + (d25>>1)
+    paddw      m7, m3           ; d34 + (d34>>1)
+    paddw     m10, m1, m2
+    paddw     m10, m4           ; a4
+    psubw     m11, m1, m2
+    paddw     m11, m7           ; a7
+    psubw     m14, m0, m3
+    psubw     m14, m6           ; a5
+    paddw     m15, m0, m3
+    psubw     m15, m5           ; a6
+
+    paddw      m0, m12, m13     ; a0 + a1
+    psubw      m4, m12, m13     ; a0 - a1
+    psraw      m2, m9, 1
+    paddw      m2, m8           ; a2 + (a3>>1)
+    psraw      m6, m8, 1
+    psubw      m6, m9           ; (a2>>1) - a3
+    psraw      m1, m11, 2
+    paddw      m1, m10          ; a4 + (a7>>2)
+    psraw      m7, m10, 2
+    psubw      m7, m11          ; (a4>>2) - a7
+    psraw      m3, m15, 2
+    paddw      m3, m14          ; a5 + (a6>>2)
+    psraw     m14, 2
+    psubw      m5, m15, m14     ; a6 - (a5>>2)
+%endmacro
+
+; in: m0..m7 = SRC(0)..SRC(7), out: m0..m7 = DST(0)..DST(7), clobbers m8-m15
+%macro IDCT8_1D 0
+    paddw      m8, m0, m4       ; a0
+    psubw      m0, m4           ; a2
+    psraw      m9, m2, 1
+    psubw      m9, m6           ; a4
+    psraw      m6, 1
+    paddw      m6, m2           ; a6
+    paddw     m10, m8, m6       ; b0
+    psubw      m8, m6           ; b6
+    paddw     m11, m0, m9       ; b2
+    psubw      m0, m9           ; b4
+
+    psraw      m2, m7, 1
+    paddw      m2, m7           ; s7 + (s7>>1)
+    psubw     m12, m5, m3
+    psubw     m12, m2           ; a1
+    psraw      m4, m3, 1
+    paddw      m4, m3           ; s3 + (s3>>1)
+    psubw     m13, m1, m4
+    paddw     m13, m7           ; a3
+    psraw      m6, m5, 1
+    paddw      m6, m5           ; s5 + (s5>>1)
+    psubw     m14, m7, m1
+    paddw     m14, m6           ; a5
+    psraw      m9, m1, 1
+    paddw      m9, m1           ; s1 + (s1>>1)
+    paddw     m15, m3, m5
+    paddw     m15, m9           ; a7
+
+    psraw      m1, m15, 2
+    paddw      m1, m12          ; b1
+    psraw     m12, 2
+    psubw     m15, m12          ; b7
+    psraw      m3, m14, 2
+    paddw      m3, m13          ; b3
+    psraw     m13, 2
+    psubw     m13, m14          ; b5
+
+    psubw      m5, m0, m3       ; b4 - b3
+    paddw      m2, m0, m3       ; b4 + b3
+    paddw      m3, m8, m1       ; b6 + b1
+    psubw      m4, m8, m1       ; b6 - b1
+    paddw      m0, m10, m15     ; b0 + b7
+    psubw      m7, m10, m15     ; b0 - b7
+    paddw      m1, m11, m13     ; b2 + b5
+    psubw      m6, m11, m13     ; b2 - b5
+%endmacro
+
+; %1 = coef reg, %2 = row, %3-%5 = tmp regs
+%macro QUANT_ROW 5
+    psraw     m%3, m%1, 15
+    pxor      m%1, m%3
+    psubw     m%1, m%3          ; |c|
+    mova      m%5, [drm_quant_mf + (%2 & 3) * 32]
+    pmullw    m%4, m%1, m%5
+    pmulhuw   m%1, m%5
+    pxor      m%4, [pw_8000]
+    pcmpgtw   m%4, [pw_7ffd]    ; low word + f (2) carries into the high word
+    psubw     m%1, m%4
+    pxor      m%1, m%3
+    psubw     m%1, m%3
+%endmacro
+
+; %1 = coef reg, %2 = row, %3-%4 = tmp regs
+%macro DEQUANT_ROW 4
+    mova      m%4, [drm_dequant_mf + (%2 & 3) * 32]
+    pmulhw    m%3, m%1, m%4
+    pmullw    m%1, m%4
+    punpckhwd m%4, m%1, m%3
+    punpcklwd m%1, m%3
+    paddd     m%1, [pd_2]
+    paddd     m%4, [pd_2]
+    psrad     m%1, 2
+    psrad     m%4, 2
+    packssdw  m%1, m%4
+%endmacro
+
+; %1 = number of blocks (1, or 2 with ymm)
+%macro FDCT8_BLOCKS 1
+%if mmsize == 32 && %1 == 2
+    pmovzxbw   m0, [srcq]
+    pmovzxbw   m1, [srcq+strideq]
+    pmovzxbw   m2, [srcq+strideq*2]
+    pmovzxbw   m3, [srcq+stride3q]
+    pmovzxbw   m4, [src4q]
+    pmovzxbw   m5, [src4q+strideq]
+    pmovzxbw   m6, [src4q+strideq*2]
+    pmovzxbw   m7, [src4q+stride3q]
+%elif mmsize == 32
+    pmovzxbw  xm0, [srcq]
+    pmovzxbw  xm1, [srcq+strideq]
+    pmovzxbw  xm2, [srcq+strideq*2]
+    pmovzxbw  xm3, [srcq+stride3q]
+    pmovzxbw  xm4, [src4q]
+    pmovzxbw  xm5, [src4q+strideq]
+    pmovzxbw  xm6, [src4q+strideq*2]
+    pmovzxbw  xm7, [src4q+stride3q]
+%else
+    pxor       m8, m8
+    movq       m0, [srcq]
+    movq       m1, [srcq+strideq]
+    movq       m2, [srcq+strideq*2]
+    movq       m3, [srcq+stride3q]
+    movq       m4, [src4q]
+    movq       m5, [src4q+strideq]
+    movq       m6, [src4q+strideq*2]
+    movq       m7, [src4q+stride3q]
+    punpcklbw  m0, m8
+    punpcklbw  m1, m8
+    punpcklbw  m2, m8
+    punpcklbw  m3, m8
+    punpcklbw  m4, m8
+    punpcklbw  m5, m8
+    punpcklbw  m6, m8
+    punpcklbw  m7, m8
+%endif
+    DCT8_1D
+    TRANSPOSE8x8W 0, 1, 2, 3, 4, 5, 6, 7, 8
+    DCT8_1D
+%assign %%i 0
+%rep 8
+    QUANT_ROW %%i, %%i, 8, 9, 10
+%if mmsize == 32
+    mova  [coefq+%%i*16], xm %+ %%i
+%if %1 == 2
+    vextracti128 [coefq+128+%%i*16], m %+ %%i, 1
+%endif
+%else
+    mova  [coefq+%%i*16], m %+ %%i
+%endif
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+; %1 = number of blocks (1, or 2 with ymm)
+%macro IDCT8_BLOCKS 1
+%assign %%i 0
+%rep 8
+%if mmsize == 32
+    mova      xm %+ %%i, [coefq+%%i*16]
+%if %1 == 2
+    vinserti128 m %+ %%i, m %+ %%i, [coefq+128+%%i*16], 1
+%endif
+%else
+    mova       m %+ %%i, [coefq+%%i*16]
+%endif
+    DEQUANT_ROW %%i, %%i, 8, 9
+%assign %%i %%i+1
+%endrep
+    IDCT8_1D
+    TRANSPOSE8x8W 0, 1, 2, 3, 4, 5, 6, 7, 8
+    IDCT8_1D
+%assign %%i 0
+%rep 8
+    psraw      m %+ %%i, 6
+%assign %%i %%i+1
+%endrep
+    packuswb   m0, m1
+    packuswb   m2, m3
+    packuswb   m4, m5
+    packuswb   m6, m7
+%if mmsize == 32 && %1 == 2
+    vpermq     m0, m0, q3120
+    vpermq     m2, m2, q3120
+    vpermq     m4, m4, q3120
+    vpermq     m6, m6, q3120
+    movu          [dstq], xm0
+    vextracti128  [dstq+strideq], m0, 1
+    movu          [dstq+strideq*2], xm2
+    vextracti128  [dstq+stride3q], m2, 1
+    movu          [dst4q], xm4
+    vextracti128  [dst4q+strideq], m4, 1
+    movu          [dst4q+strideq*2], xm6
+    vextracti128  [dst4q+stride3q], m6, 1
+%else
+    movq          [dstq], xm0
+    movhps        [dstq+strideq], xm0
+    movq          [dstq+strideq*2], xm2
+    movhps        [dstq+stride3q], xm2
+    movq          [dst4q], xm4
+    movhps        [dst4q+strideq], xm4
+    movq          [dst4q+strideq*2], xm6
+    movhps        [dst4q+stride3q], xm6
+%endif
+%endmacro
+
+; void ff_drm_fdct8_quant(int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb)
+; void ff_drm_idct8_put(uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb)
+%macro DRM_DCT_FUNCS 0
+cglobal drm_fdct8_quant, 4, 6, 16, coef, src, stride, nb, stride3, src4
+    lea   stride3q, [strideq*3]
+%if mmsize == 32
+.loop2:
+    cmp        nbd, 2
+    jl .tail
+    lea      src4q, [srcq+strideq*4]
+    FDCT8_BLOCKS 2
+    add       srcq, 16
+    add      coefq, 256
+    sub        nbd, 2
+    jmp .loop2
+.tail:
+    test       nbd, nbd
+    jz .end
+    lea      src4q, [srcq+strideq*4]
+    FDCT8_BLOCKS 1
+.end:
+%else
+.loop:
+    lea      src4q, [srcq+strideq*4]
+    FDCT8_BLOCKS 1
+    add       srcq, 8
+    add      coefq, 128
+    dec        nbd
+    jg .loop
+%endif
+    RET
+
+cglobal drm_idct8_put, 4, 6, 16, dst, stride, coef, nb, stride3, dst4
+    lea   stride3q, [strideq*3]
+%if mmsize == 32
+.loop2:
+    cmp        nbd, 2
+    jl .tail
+    lea      dst4q, [dstq+strideq*4]
+    IDCT8_BLOCKS 2
+    add       dstq, 16
+    add      coefq, 256
+    sub        nbd, 2
+    jmp .loop2
+.tail:
+    test       nbd, nbd
+    jz .end
+    lea      dst4q, [dstq+strideq*4]
+    IDCT8_BLOCKS 1
+.end:
+%else
+.loop:
+    lea      dst4q, [dstq+strideq*4]
+    IDCT8_BLOCKS 1
+    add       dstq, 8
+    add      coefq, 128
+    dec        nbd
+    jg .loop
+%endif
+    RET
+%endmacro
+
+INIT_XMM sse2
+DRM_DCT_FUNCS
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DRM_DCT_FUNCS
+%endif
+
+%endif ; ARCH_X86_64
+
+;-----------------------------------------------------------------------------
+; dc modulation helpers: m4 = q, m5 = q/2, m6 = q/4 as words, m7 = q as float
+;-----------------------------------------------------------------------------
+
+%macro STEP_CONSTANTS 0
+    movd      xm4, stepd
+%if cpuflag(avx2)
+    vpbroadcastd m4, xm4
+%else
+    pshufd     m4, m4, 0
+%endif
+    cvtdq2ps   m7, m4
+    psrld      m5, m4, 1
+    psrld      m6, m4, 2
+    packssdw   m4, m4
+    packssdw   m5, m5
+    packssdw   m6, m6
+%endmacro
+
+; m%1 = m%2 / q with C truncation, m%3 is clobbered
+%macro DIVQ 3
+    punpcklwd m%1, m%2, m%2
+    punpckhwd m%3, m%2, m%2
+    psrad     m%1, 16
+    psrad     m%3, 16
+    cvtdq2ps  m%1, m%1
+    cvtdq2ps  m%3, m%3
+    divps     m%1, m7
+    divps     m%3, m7
+    cvttps2dq m%1, m%1
+    cvttps2dq m%3, m%3
+    packssdw  m%1, m%3
+%endmacro
+
+; void ff_drm_dc_modulate(int16_t *dc, const uint8_t *bits, int n, int dm_step)
+%macro DC_MODULATE 0
+cglobal drm_dc_modulate, 4, 4, 8, dc, bits, n, step
+    STEP_CONSTANTS
+.loop:
+%if mmsize == 32
+    movu      xm0, [bitsq]
+%else
+    movq       m0, [bitsq]
+%endif
+    pxor       m1, m1
+    pxor       m0, [pb_80]
+    pcmpgtb    m0, m1           ; bits > 128
+%if mmsize == 32
+    pmovsxbw   m0, xm0
+%else
+    punpcklbw  m0, m0
+%endif
+    pxor       m3, m6, m0
+    psubw      m3, m0           ; d = bit ? -q/4 : q/4
+    mova       m0, [dcq]
+    paddw      m0, m3
+    paddw      m0, m5           ; x + d + q/2
+    DIVQ        1, 0, 2         ; (x + d + q/2) / q
+    pmullw     m1, m4
+    psubw      m1, m3
+    mova    [dcq], m1
+    add       dcq, mmsize
+    add     bitsq, mmsize/2
+    sub        nd, mmsize/2
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+DC_MODULATE
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DC_MODULATE
+%endif
+
+; void ff_drm_dc_demodulate(uint8_t *bits, const int16_t *dc, int n, int dm_step)
+%macro DC_DEMODULATE 0
+cglobal drm_dc_demodulate, 4, 4, 8, bits, dc, n, step
+    STEP_CONSTANTS
+.loop:
+    mova       m0, [dcq]
+    paddw      m0, m5
+    paddw      m1, m0, m6       ; x + q/4 + q/2
+    psubw      m0, m6           ; x - q/4 + q/2
+    DIVQ        2, 1, 3
+    DIVQ        1, 0, 3
+    pmullw     m2, m4
+    pmullw     m1, m4
+    psubw      m2, m6           ; binary_dm(x, 0, q)
+    paddw      m1, m6           ; binary_dm(x, 1, q)
+    mova       m0, [dcq]
+    psubw      m2, m0
+    psubw      m1, m0
+    ABS1       m2, m3           ; e0
+    ABS1       m1, m3           ; e1
+    pcmpgtw    m2, m1           ; e1 < e0
+    packsswb   m2, m2
+%if mmsize == 32
+    vpermq     m2, m2, q3120
+    movu  [bitsq], xm2
+%else
+    movq  [bitsq], m2
+%endif
+    add     bitsq, mmsize/2
+    add       dcq, mmsize
+    sub        nd, mmsize/2
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+DC_DEMODULATE
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DC_DEMODULATE
+%endif
+
+; sum of 8 rows of psadbw against zero, one qword per 8 pixels
+%macro SUM8ROWS 5 ; load op, 4 regs, the last one zeroed
+    lea      src4q, [srcq+strideq*4]
+    %1         %2, [srcq]
+    %1         %3, [srcq+strideq]
+    psadbw     %2, %5
+    psadbw     %3, %5
+    paddw      %2, %3
+    %1         %3, [srcq+strideq*2]
+    %1         %4, [srcq+stride3q]
+    psadbw     %3, %5
+    psadbw     %4, %5
+    paddw      %2, %3
+    paddw      %2, %4
+    %1         %3, [src4q]
+    %1         %4, [src4q+strideq]
+    psadbw     %3, %5
+    psadbw     %4, %5
+    paddw      %2, %3
+    paddw      %2, %4
+    %1         %3, [src4q+strideq*2]
+    %1         %4, [src4q+stride3q]
+    psadbw     %3, %5
+    psadbw     %4, %5
+    paddw      %2, %3
+    paddw      %2, %4
+    psrlw      %2, 3
+%endmacro
+
+; void ff_drm_dc8x8(int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb)
+%macro DC8X8 0
+cglobal drm_dc8x8, 4, 6, 4, dc, src, stride, nb, stride3, src4
+    lea   stride3q, [strideq*3]
+    pxor       m3, m3
+    sub        nbd, mmsize/8
+    jl .tail
+.loop:
+    SUM8ROWS movu, m0, m1, m2, m3
+    pshufd     m0, m0, q3120
+%if mmsize == 32
+    vpermq     m0, m0, q3120
+    packssdw  xm0, xm0
+    movq    [dcq], xm0
+%else
+    packssdw   m0, m0
+    movd    [dcq], xm0
+%endif
+    add       srcq, mmsize
+    add        dcq, mmsize/4
+    sub        nbd, mmsize/8
+    jge .loop
+.tail:
+    add        nbd, mmsize/8
+    jz .end
+.tail_loop:
+    SUM8ROWS movq, xm0, xm1, xm2, xm3
+    ; the upper word of the psadbw qword is zero, so this also clears
+    ; dc[1], which the caller pads or the next block overwrites
+    movd    [dcq], xm0
+    add       srcq, 8
+    add        dcq, 2
+    dec        nbd
+    jg .tail_loop
+.end:
+    RET
+%endmacro
+
+INIT_XMM sse2
+DC8X8
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DC8X8
+%endif
@@ -0,0 +1,58 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+
+#include "libavfilter/vf_drm.h"
+
+void ff_drm_fdct8_quant_sse2(int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb);
+void ff_drm_fdct8_quant_avx2(int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb);
+void ff_drm_idct8_put_sse2(uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb);
+void ff_drm_idct8_put_avx2(uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb);
+void ff_drm_dc_modulate_sse2(int16_t *dc, const uint8_t *bits, int n, int dm_step);
+void ff_drm_dc_modulate_avx2(int16_t *dc, const uint8_t *bits, int n, int dm_step);
+void ff_drm_dc_demodulate_sse2(uint8_t *bits, const int16_t *dc, int n, int dm_step);
+void ff_drm_dc_demodulate_avx2(uint8_t *bits, const int16_t *dc, int n, int dm_step);
+void ff_drm_dc8x8_sse2(int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb);
+void ff_drm_dc8x8_avx2(int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb);
+
+av_cold void ff_drm_dsp_init_x86(DrmDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->dc_modulate   = ff_drm_dc_modulate_sse2;
+        dsp->dc_demodulate = ff_drm_dc_demodulate_sse2;
+        dsp->dc8x8         = ff_drm_dc8x8_sse2;
+        if (ARCH_X86_64) {
+            dsp->fdct8_quant = ff_drm_fdct8_quant_sse2;
+            dsp->idct8_put   = ff_drm_idct8_put_sse2;
+        }
+    }
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        dsp->dc_modulate   = ff_drm_dc_modulate_avx2;
+        dsp->dc_demodulate = ff_drm_dc_demodulate_avx2;
+        dsp->dc8x8         = ff_drm_dc8x8_avx2;
+        if (ARCH_X86_64) {
+            dsp->fdct8_quant = ff_drm_fdct8_quant_avx2;
+            dsp->idct8_put   = ff_drm_idct8_put_avx2;
+        }
+    }
+}
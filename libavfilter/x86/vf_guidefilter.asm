@@ -0,0 +1,91 @@
+;*****************************************************************************
+;* x86-optimized functions for the guided filter box filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_guidefilter_slide(float *dst, float *acc, const float *add,
+;                           const float *sub, int w, float scale)
+;------------------------------------------------------------------------------
+
+%macro GUIDEFILTER_SLIDE 0
+%if UNIX64
+cglobal guidefilter_slide, 5, 5, 4, dst, acc, add, sub, w
+%else
+cglobal guidefilter_slide, 5, 5, 4, dst, acc, add, sub, w, scale
+    movss       xm0, scalem
+%endif
+    shufps      xm0, xm0, 0
+%if mmsize == 32
+    vinsertf128  m0, m0, xm0, 1
+%endif
+    movsxdifnidn wq, wd
+    shl          wq, 2
+    add        dstq, wq
+    add        accq, wq
+    add        addq, wq
+    add        subq, wq
+    neg          wq
+.loop:
+    ; dst may alias sub, so load everything before storing
+    movu         m1, [addq+wq]
+    movu         m2, [subq+wq]
+    movu         m3, [accq+wq]
+    subps        m1, m2
+    addps        m3, m1
+    movu [accq+wq], m3
+    mulps        m3, m0
+    movu [dstq+wq], m3
+    add          wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_guidefilter_accumulate(float *acc, const float *src, int w)
+;------------------------------------------------------------------------------
+
+%macro GUIDEFILTER_ACCUMULATE 0
+cglobal guidefilter_accumulate, 3, 3, 2, acc, src, w
+    movsxdifnidn wq, wd
+    shl          wq, 2
+    add        accq, wq
+    add        srcq, wq
+    neg          wq
+.loop:
+    movu         m0, [accq+wq]
+    movu         m1, [srcq+wq]
+    addps        m0, m1
+    movu [accq+wq], m0
+    add          wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse
+GUIDEFILTER_SLIDE
+GUIDEFILTER_ACCUMULATE
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+GUIDEFILTER_SLIDE
+GUIDEFILTER_ACCUMULATE
+%endif
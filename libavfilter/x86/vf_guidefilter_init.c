@@ -0,0 +1,44 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+
+#include "libavfilter/vf_guidefilter.h"
+
+void ff_guidefilter_slide_sse(float *dst, float *acc, const float *add,
+                              const float *sub, int w, float scale);
+void ff_guidefilter_slide_avx(float *dst, float *acc, const float *add,
+                              const float *sub, int w, float scale);
+void ff_guidefilter_accumulate_sse(float *acc, const float *src, int w);
+void ff_guidefilter_accumulate_avx(float *acc, const float *src, int w);
+
+av_cold void ff_guidefilter_dsp_init_x86(GuideFilterDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE(cpu_flags)) {
+        dsp->slide      = ff_guidefilter_slide_sse;
+        dsp->accumulate = ff_guidefilter_accumulate_sse;
+    }
+    if (EXTERNAL_AVX(cpu_flags)) {
+        dsp->slide      = ff_guidefilter_slide_avx;
+        dsp->accumulate = ff_guidefilter_accumulate_avx;
+    }
+}
@@ -29,6 +29,12 @@ static void line_noise_mmx(uint8_t *dst, const uint8_t *src,
                            const int8_t *noise, int len, int shift)
 {
     x86_reg mmx_len= len & (~7);
+
+    /* the loop below always runs at least once */
+    if (!mmx_len) {
+        ff_line_noise_c(dst, src, noise, len, shift);
+        return;
+    }
     noise += shift;
 
     __asm__ volatile(
@@ -59,6 +65,11 @@ static void line_noise_avg_mmx(uint8_t *dst, const uint8_t *src,
 {
     x86_reg mmx_len = len & (~7);
 
+    if (!mmx_len) {
+        ff_line_noise_avg_c(dst, src, len, shift);
+        return;
+    }
+
     __asm__ volatile(
             "mov %5, %%"REG_a"              \n\t"
             ".p2align 4                     \n\t"
@@ -101,6 +112,11 @@ static void line_noise_mmxext(uint8_t *dst, const uint8_t *src,
                               const int8_t *noise, int len, int shift)
 {
     x86_reg mmx_len = len & (~7);
+
+    if (!mmx_len) {
+        ff_line_noise_c(dst, src, noise, len, shift);
+        return;
+    }
     noise += shift;
 
     __asm__ volatile(
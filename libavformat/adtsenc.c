@@ -26,26 +26,14 @@
 #include "libavcodec/mpeg4audio.h"
 #include "libavutil/opt.h"
 #include "avformat.h"
+#include "adtsenc.h"
 #include "apetag.h"
 #include "id3v2.h"
 
-#define ADTS_HEADER_SIZE 7
-
-typedef struct ADTSContext {
-    AVClass *class;
-    int write_adts;
-    int objecttype;
-    int sample_rate_index;
-    int channel_conf;
-    int pce_size;
-    int apetag;
-    int id3v2tag;
-    uint8_t pce_data[MAX_PCE_SIZE];
-} ADTSContext;
-
 #define ADTS_MAX_FRAME_BYTES ((1 << 13) - 1)
 
-static int adts_decode_extradata(AVFormatContext *s, ADTSContext *adts, const uint8_t *buf, int size)
+int ff_adts_decode_extradata(AVFormatContext *s, ADTSContext *adts,
+                             const uint8_t *buf, int size)
 {
     GetBitContext gb;
     PutBitContext pb;
@@ -102,14 +90,14 @@ static int adts_write_header(AVFormatContext *s)
     if (adts->id3v2tag)
         ff_id3v2_write_simple(s, 4, ID3v2_DEFAULT_MAGIC);
     if (avc->extradata_size > 0)
-        return adts_decode_extradata(s, adts, avc->extradata,
-                                     avc->extradata_size);
+        return ff_adts_decode_extradata(s, adts, avc->extradata,
+                                        avc->extradata_size);
 
     return 0;
 }
 
-static int adts_write_frame_header(ADTSContext *ctx,
-                                   uint8_t *buf, int size, int pce_size)
+int ff_adts_write_frame_header(ADTSContext *ctx,
+                               uint8_t *buf, int size, int pce_size)
 {
     PutBitContext pb;
 
@@ -155,7 +143,7 @@ static int adts_write_packet(AVFormatContext *s, AVPacket *pkt)
     if (!pkt->size)
         return 0;
     if (adts->write_adts) {
-        int err = adts_write_frame_header(adts, buf, pkt->size,
+        int err = ff_adts_write_frame_header(adts, buf, pkt->size,
                                              adts->pce_size);
         if (err < 0)
             return err;
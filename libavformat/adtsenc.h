@@ -0,0 +1,58 @@
+/*
+ * ADTS muxer.
+ * Copyright (c) 2006 Baptiste Coudurier <baptiste.coudurier@smartjog.com>
+ *                    Mans Rullgard <mans@mansr.com>
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_ADTSENC_H
+#define AVFORMAT_ADTSENC_H
+
+#include <stdint.h>
+
+#include "libavcodec/mpeg4audio.h"
+#include "avformat.h"
+
+#define ADTS_HEADER_SIZE 7
+
+typedef struct ADTSContext {
+    AVClass *class;
+    int write_adts;
+    int objecttype;
+    int sample_rate_index;
+    int channel_conf;
+    int pce_size;
+    int apetag;
+    int id3v2tag;
+    uint8_t pce_data[MAX_PCE_SIZE];
+} ADTSContext;
+
+/**
+ * Parse an AudioSpecificConfig into the fields of the ADTS header.
+ */
+int ff_adts_decode_extradata(AVFormatContext *s, ADTSContext *adts,
+                             const uint8_t *buf, int size);
+
+/**
+ * Write the ADTS_HEADER_SIZE bytes of the header of a frame carrying size
+ * bytes of raw AAC, followed by pce_size bytes of program config element.
+ */
+int ff_adts_write_frame_header(ADTSContext *ctx,
+                               uint8_t *buf, int size, int pce_size);
+
+#endif /* AVFORMAT_ADTSENC_H */
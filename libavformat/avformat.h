@@ -1172,6 +1172,12 @@ typedef struct AVStream {
     AVRational display_aspect_ratio;
 
     struct FFFrac *priv_pts;
+
+    /**
+     * Timestamp up to which the index holds every keyframe, set while the
+     * seek index is built for the seek index cache.
+     */
+    int64_t seek_index_end;
 } AVStream;
 
 AVRational av_stream_get_r_frame_rate(const AVStream *s);
@@ -1810,6 +1816,34 @@ typedef struct AVFormatContext {
      * Demuxing: Set by user.
      */
     int (*open_cb)(struct AVFormatContext *s, AVIOContext **p, const char *url, int flags, const AVIOInterruptCB *int_cb, AVDictionary **options);
+
+    /**
+     * Number of threads avformat_find_stream_info() decodes the streams
+     * with. Packets are still demuxed on the calling thread, the decoding
+     * of different streams is spread over the threads. 0 or 1 to decode
+     * on the calling thread only.
+     * - demuxing: Set by user.
+     */
+    int probe_threads;
+
+    /**
+     * URL of a file holding the stream parameters of this input, as written
+     * by avformat_export_stream_info(). If it matches the input,
+     * avformat_find_stream_info() takes the parameters from it instead of
+     * probing, otherwise it probes and rewrites the file.
+     * - demuxing: Set by user.
+     */
+    char *stream_info_cache;
+
+    /**
+     * URL of a file holding the seek index of this input. For inputs the
+     * demuxer neither indexes nor seeks in itself, like MPEG-TS and MPEG-PS,
+     * the keyframes are indexed while demuxing, written to this file when
+     * the input is closed and read back from it when the same input is
+     * opened again, so that seeks within the indexed part need no search.
+     * - demuxing: Set by user.
+     */
+    char *seek_index_cache;
 } AVFormatContext;
 
 int av_format_get_probe_score(const AVFormatContext *s);
@@ -2110,6 +2144,34 @@ int av_demuxer_open(AVFormatContext *ic);
  */
 int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options);
 
+/**
+ * Serialize the stream parameters of an input, normally after
+ * avformat_find_stream_info() was called on it. Besides the codec
+ * parameters, the blob holds the durations and index entries of the streams
+ * and the size and modification time of the input.
+ *
+ * @param ic    media file handle
+ * @param bufp  set to a buffer which must be freed with av_free()
+ * @param size  set to the size of the buffer
+ * @return >=0 on success, a negative AVERROR code on failure
+ */
+int avformat_export_stream_info(AVFormatContext *ic, uint8_t **bufp, int *size);
+
+/**
+ * Set the stream parameters of an input from a blob written by
+ * avformat_export_stream_info(), in place of avformat_find_stream_info().
+ * The blob is only used if the input has the same size, modification time,
+ * format and streams as the one it was exported from.
+ *
+ * @param ic    media file handle, just opened with avformat_open_input()
+ * @param buf   the blob
+ * @param size  size of the blob
+ * @return >=0 on success, AVERROR(EINVAL) if the blob does not apply to this
+ *         input, in which case ic is left untouched, another negative
+ *         AVERROR code on failure
+ */
+int avformat_import_stream_info(AVFormatContext *ic, const uint8_t *buf, int size);
+
 /**
  * Find the programs which belong to a given stream.
  *
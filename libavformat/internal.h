@@ -113,6 +113,19 @@ struct AVFormatInternal {
     int inject_global_side_data;
 
     int avoid_negative_ts_use_pts;
+
+    /**
+     * Number of index entries read from the seek index cache, -1 if the
+     * index is not cached.
+     */
+    int seek_index_entries;
+
+    /**
+     * Add the keyframes of the demuxed packets to the index, for inputs
+     * whose demuxer does not index them itself. Cleared once a seek
+     * leaves the index, so it never has gaps.
+     */
+    int build_seek_index;
 };
 
 #ifdef __GNUC__
@@ -511,4 +524,38 @@ int ff_copy_whitelists(AVFormatContext *dst, AVFormatContext *src);
 int ffio_open2_wrapper(struct AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
                        const AVIOInterruptCB *int_cb, AVDictionary **options);
 
+/**
+ * Set the stream parameters from the file named by s->stream_info_cache.
+ *
+ * @return 1 if they were set, 0 if the file is missing or does not match
+ *         the input, a negative AVERROR code on failure
+ */
+int ff_stream_info_cache_load(AVFormatContext *s);
+
+/**
+ * Write the stream parameters to the file named by s->stream_info_cache.
+ * Failures are only logged.
+ */
+void ff_stream_info_cache_store(AVFormatContext *s);
+
+/**
+ * AVIndexEntry.flags of the keyframes indexed for the seek index cache, as
+ * opposed to the entries the demuxer adds itself.
+ */
+#define AVINDEX_SEEK_INDEX 0x0002
+
+/**
+ * Read the index entries from the file named by s->seek_index_cache if no
+ * stream was indexed by the demuxer, and start keeping the index.
+ *
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int ff_seek_index_cache_load(AVFormatContext *s);
+
+/**
+ * Write the index entries to the file named by s->seek_index_cache if they
+ * changed since ff_seek_index_cache_load(). Failures are only logged.
+ */
+void ff_seek_index_cache_store(AVFormatContext *s);
+
 #endif /* AVFORMAT_INTERNAL_H */
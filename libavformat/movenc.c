@@ -69,6 +69,7 @@ static const AVOption options[] = {
     { "global_sidx", "Write a global sidx index at the start of the file", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_GLOBAL_SIDX}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "write_colr", "Write colr atom (Experimental, may be renamed or changed, do not use from scripts)", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_WRITE_COLR}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "write_gama", "Write deprecated gama atom", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_WRITE_GAMA}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
+    { "reserve_moov", "Reserve space for the moov atom at the beginning of the file, sized from the stream durations or moov_size, and only run the faststart second pass if it does not fit", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RESERVE_MOOV}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     FF_RTP_FLAG_OPTS(MOVMuxContext, rtp_flags),
     { "skip_iods", "Skip writing iods atom.", offsetof(MOVMuxContext, iods_skip), AV_OPT_TYPE_INT, {.i64 = 1}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
     { "iods_audio_profile", "iods audio profile atom.", offsetof(MOVMuxContext, iods_audio_profile), AV_OPT_TYPE_INT, {.i64 = -1}, -1, 255, AV_OPT_FLAG_ENCODING_PARAM},
@@ -4944,6 +4945,59 @@ static int mov_create_dvd_sub_decoder_specific_info(MOVTrack *track,
     return 0;
 }
 
+/*
+ * Estimate how large the moov atom will get from the stream durations the
+ * caller gave as a hint. This assumes the worst case of one chunk per sample
+ * with 64 bit chunk offsets, and per sample timing and composition offsets
+ * for video. Returns 0 if any of the durations is unknown, and
+ * AVERROR(ERANGE) if the estimate does not fit in an int.
+ */
+static int estimate_moov_size(AVFormatContext *s)
+{
+    int64_t size = 4096;
+    int i;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        AVCodecContext *enc = st->codec;
+        AVRational sample_duration;
+        int entry_size = 4 + 12 + 8; /* stsz, stsc and co64 entries */
+        int64_t samples;
+
+        if (st->duration <= 0)
+            return 0;
+
+        switch (enc->codec_type) {
+        case AVMEDIA_TYPE_VIDEO:
+            if (st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0)
+                sample_duration = av_inv_q(st->avg_frame_rate);
+            else if (st->r_frame_rate.num > 0 && st->r_frame_rate.den > 0)
+                sample_duration = av_inv_q(st->r_frame_rate);
+            else
+                return 0;
+            entry_size += 8 + 8 + 4; /* stts, ctts and stss entries */
+            break;
+        case AVMEDIA_TYPE_AUDIO:
+            if (enc->sample_rate <= 0)
+                return 0;
+            sample_duration = (AVRational){ enc->frame_size > 0 ? enc->frame_size : 1024,
+                                            enc->sample_rate };
+            break;
+        default:
+            sample_duration = (AVRational){ 1, 1 };
+            break;
+        }
+        samples = av_rescale_q_rnd(st->duration, st->time_base, sample_duration,
+                                   AV_ROUND_UP);
+        if (samples > (INT_MAX - size) / entry_size)
+            return AVERROR(ERANGE);
+        size += 1024 + samples * entry_size;
+        if (size > INT_MAX)
+            return AVERROR(ERANGE);
+    }
+    return size;
+}
+
 static int mov_write_header(AVFormatContext *s)
 {
     AVIOContext *pb = s->pb;
@@ -4985,7 +5039,28 @@ static int mov_write_header(AVFormatContext *s)
         mov->flags |= FF_MOV_FLAG_FRAGMENT | FF_MOV_FLAG_EMPTY_MOOV |
                       FF_MOV_FLAG_DEFAULT_BASE_MOOF;
 
-    if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+    if (mov->flags & FF_MOV_FLAG_FRAGMENT)
+        mov->flags &= ~FF_MOV_FLAG_RESERVE_MOOV;
+    if (mov->flags & FF_MOV_FLAG_RESERVE_MOOV) {
+        mov->flags |= FF_MOV_FLAG_FASTSTART;
+        if (!mov->reserved_moov_size) {
+            int size = estimate_moov_size(s);
+            if (size == AVERROR(ERANGE))
+                av_log(s, AV_LOG_WARNING, "The moov atom estimated from the "
+                       "stream durations exceeds %d bytes, using the faststart "
+                       "second pass\n", INT_MAX);
+            else if (!size)
+                av_log(s, AV_LOG_WARNING, "Stream durations are unknown and no "
+                       "moov_size was given, using the faststart second pass\n");
+            mov->reserved_moov_size = FFMAX(size, 0);
+        }
+        if (mov->reserved_moov_size > 0)
+            av_log(s, AV_LOG_VERBOSE, "Reserving %d bytes for the moov atom\n",
+                   mov->reserved_moov_size);
+    }
+
+    if (mov->flags & FF_MOV_FLAG_FASTSTART &&
+        !(mov->flags & FF_MOV_FLAG_RESERVE_MOOV && mov->reserved_moov_size > 0)) {
         mov->reserved_moov_size = -1;
     }
 
@@ -5245,7 +5320,7 @@ static int mov_write_header(AVFormatContext *s)
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -5345,18 +5420,25 @@ static int get_sidx_size(AVFormatContext *s)
  * offset table can switch between stco (32-bit entries) to co64 (64-bit
  * entries) when the moov is moved to the beginning, so the size of the moov
  * would change. It also updates the chunk offset tables.
+ * If a region that turned out too small was reserved for the moov, only the
+ * missing part plus room for a free atom header is inserted, and the amount
+ * the data has to be shifted by is returned instead.
  */
 static int compute_moov_size(AVFormatContext *s)
 {
-    int i, moov_size, moov_size2;
+    int i, moov_size, moov_size2, shift;
     MOVMuxContext *mov = s->priv_data;
 
     moov_size = get_moov_size(s);
     if (moov_size < 0)
         return moov_size;
 
+    shift = moov_size;
+    if (mov->reserved_moov_size > 0)
+        shift += 8 - mov->reserved_moov_size;
+
     for (i = 0; i < mov->nb_streams; i++)
-        mov->tracks[i].data_offset += moov_size;
+        mov->tracks[i].data_offset += shift;
 
     moov_size2 = get_moov_size(s);
     if (moov_size2 < 0)
@@ -5368,7 +5450,7 @@ static int compute_moov_size(AVFormatContext *s)
         for (i = 0; i < mov->nb_streams; i++)
             mov->tracks[i].data_offset += moov_size2 - moov_size;
 
-    return moov_size2;
+    return shift + moov_size2 - moov_size;
 }
 
 static int compute_sidx_size(AVFormatContext *s)
@@ -5388,7 +5470,7 @@ static int compute_sidx_size(AVFormatContext *s)
 
 static int shift_data(AVFormatContext *s)
 {
-    int ret = 0, moov_size;
+    int ret = 0, moov_size, block_size;
     MOVMuxContext *mov = s->priv_data;
     int64_t pos, pos_end = avio_tell(s->pb);
     uint8_t *buf, *read_buf[2];
@@ -5403,11 +5485,14 @@ static int shift_data(AVFormatContext *s)
     if (moov_size < 0)
         return moov_size;
 
-    buf = av_malloc(moov_size * 2);
+    /* any block size of at least the shift works, but the shift left after
+     * filling a reserved moov region can be just a few bytes */
+    block_size = FFMAX(moov_size, 1 << 16);
+    buf = av_malloc(block_size * 2);
     if (!buf)
         return AVERROR(ENOMEM);
     read_buf[0] = buf;
-    read_buf[1] = buf + moov_size;
+    read_buf[1] = buf + block_size;
 
     /* Shift the data: the AVIO context of the output can only be used for
      * writing, so we re-open the same output, but for reading. It also avoids
@@ -5430,11 +5515,11 @@ static int shift_data(AVFormatContext *s)
     pos = avio_tell(read_pb);
 
 #define READ_BLOCK do {                                                             \
-    read_size[read_buf_id] = avio_read(read_pb, read_buf[read_buf_id], moov_size);  \
+    read_size[read_buf_id] = avio_read(read_pb, read_buf[read_buf_id], block_size); \
     read_buf_id ^= 1;                                                               \
 } while (0)
 
-    /* shift data by chunk of at most moov_size */
+    /* shift data by chunk of at most block_size */
     READ_BLOCK;
     do {
         int n;
@@ -5457,7 +5542,7 @@ static int mov_write_trailer(AVFormatContext *s)
     MOVMuxContext *mov = s->priv_data;
     AVIOContext *pb = s->pb;
     int res = 0;
-    int i;
+    int i, shift;
     int64_t moov_pos;
 
     /*
@@ -5500,29 +5585,49 @@ static int mov_write_trailer(AVFormatContext *s)
             ffio_wfourcc(pb, "mdat");
             avio_wb64(pb, mov->mdat_size + 16);
         }
-        avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
+        shift = mov->flags & FF_MOV_FLAG_FASTSTART;
+        if (shift && mov->reserved_moov_size > 0) {
+            /* fill the reserved region in place if the moov fits, either
+             * exactly or with room left for a free atom */
+            if ((res = get_moov_size(s)) < 0)
+                goto error;
+            if (res == mov->reserved_moov_size || res + 8 <= mov->reserved_moov_size)
+                shift = 0;
+            else
+                av_log(s, AV_LOG_INFO, "The moov atom needs %d bytes but only %d "
+                       "were reserved\n", res, mov->reserved_moov_size);
+        }
+        avio_seek(pb, mov->reserved_moov_size > 0 && !shift ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (shift) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res == 0) {
                 avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
                 if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
                     goto error;
+                /* the data was shifted so that the reserved region turned
+                 * into an empty free atom */
+                if (mov->reserved_moov_size > 0) {
+                    avio_wb32(pb, 8);
+                    ffio_wfourcc(pb, "free");
+                }
             }
         } else if (mov->reserved_moov_size > 0) {
             int64_t size;
             if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
                 goto error;
             size = mov->reserved_moov_size - (avio_tell(pb) - mov->reserved_header_pos);
-            if (size < 8){
+            if (size && size < 8) {
                 av_log(s, AV_LOG_ERROR, "reserved_moov_size is too small, needed %"PRId64" additional\n", 8-size);
                 res = AVERROR(EINVAL);
                 goto error;
             }
-            avio_wb32(pb, size);
-            ffio_wfourcc(pb, "free");
-            ffio_fill(pb, 0, size - 8);
+            if (size) {
+                avio_wb32(pb, size);
+                ffio_wfourcc(pb, "free");
+                ffio_fill(pb, 0, size - 8);
+            }
             avio_seek(pb, moov_pos, SEEK_SET);
         } else {
             if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
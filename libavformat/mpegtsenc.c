@@ -29,6 +29,7 @@
 
 #include "libavcodec/internal.h"
 
+#include "adtsenc.h"
 #include "avformat.h"
 #include "avio_internal.h"
 #include "internal.h"
@@ -225,7 +226,8 @@ typedef struct MpegTSWriteStream {
     int64_t payload_dts;
     int payload_flags;
     uint8_t *payload;
-    AVFormatContext *amux;
+    ADTSContext *adts;     ///< ADTS header state, for raw AAC
+    AVFormatContext *amux; ///< LATM muxer, for raw AAC with -mpegts_flags latm
     AVRational user_tb;
 } MpegTSWriteStream;
 
@@ -717,16 +719,26 @@ static int mpegts_write_header(AVFormatContext *s)
             pcr_st           = st;
         }
         if (st->codec->codec_id == AV_CODEC_ID_AAC &&
-            st->codec->extradata_size > 0) {
+            st->codec->extradata_size > 0 &&
+            !(ts->flags & MPEGTS_FLAG_AAC_LATM)) {
+            ts_st->adts = av_mallocz(sizeof(*ts_st->adts));
+            if (!ts_st->adts) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+            ret = ff_adts_decode_extradata(s, ts_st->adts, st->codec->extradata,
+                                           st->codec->extradata_size);
+            if (ret < 0)
+                goto fail;
+        } else if (st->codec->codec_id == AV_CODEC_ID_AAC &&
+                   st->codec->extradata_size > 0) {
             AVStream *ast;
             ts_st->amux = avformat_alloc_context();
             if (!ts_st->amux) {
                 ret = AVERROR(ENOMEM);
                 goto fail;
             }
-            ts_st->amux->oformat =
-                av_guess_format((ts->flags & MPEGTS_FLAG_AAC_LATM) ? "latm" : "adts",
-                                NULL, NULL);
+            ts_st->amux->oformat = av_guess_format("latm", NULL, NULL);
             if (!ts_st->amux->oformat) {
                 ret = AVERROR(EINVAL);
                 goto fail;
@@ -829,6 +841,7 @@ fail:
         ts_st = st->priv_data;
         if (ts_st) {
             av_freep(&ts_st->payload);
+            av_freep(&ts_st->adts);
             if (ts_st->amux) {
                 avformat_free_context(ts_st->amux);
                 ts_st->amux = NULL;
@@ -981,8 +994,10 @@ static uint8_t *get_ts_payload_start(uint8_t *pkt)
 /* Add a PES header to the front of the payload, and segment into an integer
  * number of TS packets. The final TS packet is padded using an oversized
  * adaptation header to exactly fill the last TS packet.
- * NOTE: 'payload' contains a complete PES payload. */
+ * NOTE: 'prefix' followed by 'payload' make up a complete PES payload, the
+ * prefix carries what the muxer inserts so that the packet is not copied. */
 static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
+                             const uint8_t *prefix, int prefix_size,
                              const uint8_t *payload, int payload_size,
                              int64_t pts, int64_t dts, int key)
 {
@@ -1001,6 +1016,7 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
         force_pat = 1;
     }
 
+    payload_size += prefix_size;
     is_start = 1;
     while (payload_size > 0) {
         retransmit_si_info(s, force_pat, dts);
@@ -1216,14 +1232,20 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
             }
         }
 
+        val = FFMIN(prefix_size, len);
+        if (val) {
+            memcpy(buf + TS_PACKET_SIZE - len, prefix, val);
+            prefix      += val;
+            prefix_size -= val;
+        }
         if (is_dvb_subtitle && payload_size == len) {
-            memcpy(buf + TS_PACKET_SIZE - len, payload, len - 1);
+            memcpy(buf + TS_PACKET_SIZE - len + val, payload, len - val - 1);
             buf[TS_PACKET_SIZE - 1] = 0xff; /* end_of_PES_data_field_marker: an 8-bit field with fixed contents 0xff for DVB subtitle */
         } else {
-            memcpy(buf + TS_PACKET_SIZE - len, payload, len);
+            memcpy(buf + TS_PACKET_SIZE - len + val, payload, len - val);
         }
 
-        payload      += len;
+        payload      += len - val;
         payload_size -= len;
         mpegts_prefix_m2ts_header(s);
         avio_write(s->pb, buf, TS_PACKET_SIZE);
@@ -1267,6 +1289,9 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
     int size = pkt->size;
     uint8_t *buf = pkt->data;
     uint8_t *data = NULL;
+    const uint8_t *prefix = NULL;
+    int prefix_size = 0;
+    uint8_t adts_header[ADTS_HEADER_SIZE + MAX_PCE_SIZE];
     MpegTSWrite *ts = s->priv_data;
     MpegTSWriteStream *ts_st = st->priv_data;
     const int64_t delay = av_rescale(s->max_delay, 90000, AV_TIME_BASE) * 2;
@@ -1320,16 +1345,15 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
         if ((state & 0x1f) != 5)
             extradd = 0;
         if ((state & 0x1f) != 9) { // AUD NAL
-            data = av_malloc(pkt->size + 6 + extradd);
+            data = av_malloc(6 + extradd);
             if (!data)
                 return AVERROR(ENOMEM);
             memcpy(data + 6, st->codec->extradata, extradd);
-            memcpy(data + 6 + extradd, pkt->data, pkt->size);
             AV_WB32(data, 0x00000001);
-            data[4] = 0x09;
-            data[5] = 0xf0; // any slice type (0xe) + rbsp stop one bit
-            buf     = data;
-            size    = pkt->size + 6 + extradd;
+            data[4]     = 0x09;
+            data[5]     = 0xf0; // any slice type (0xe) + rbsp stop one bit
+            prefix      = data;
+            prefix_size = 6 + extradd;
         }
     } else if (st->codec->codec_id == AV_CODEC_ID_AAC) {
         if (pkt->size < 2) {
@@ -1340,7 +1364,19 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
             int ret;
             AVPacket pkt2;
 
-            if (!ts_st->amux) {
+            if (ts_st->adts) {
+                /* the header, and the PCE of the first frame, are written
+                 * ahead of the packet data instead of into a copy of it */
+                ADTSContext *adts = ts_st->adts;
+                ret = ff_adts_write_frame_header(adts, adts_header, pkt->size,
+                                                 adts->pce_size);
+                if (ret < 0)
+                    return ret;
+                memcpy(adts_header + ADTS_HEADER_SIZE, adts->pce_data, adts->pce_size);
+                prefix         = adts_header;
+                prefix_size    = ADTS_HEADER_SIZE + adts->pce_size;
+                adts->pce_size = 0;
+            } else if (!ts_st->amux) {
                 av_log(s, AV_LOG_ERROR, "AAC bitstream not in ADTS format "
                                         "and extradata missing\n");
                 if (!st->nb_frames)
@@ -1379,7 +1415,7 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
             MpegTSWriteStream *ts_st2 = st2->priv_data;
             if (   ts_st2->payload_size
                && (ts_st2->payload_dts == AV_NOPTS_VALUE || dts - ts_st2->payload_dts > delay/2)) {
-                mpegts_write_pes(s, st2, ts_st2->payload, ts_st2->payload_size,
+                mpegts_write_pes(s, st2, NULL, 0, ts_st2->payload, ts_st2->payload_size,
                                 ts_st2->payload_pts, ts_st2->payload_dts,
                                 ts_st2->payload_flags & AV_PKT_FLAG_KEY);
                 ts_st2->payload_size = 0;
@@ -1387,20 +1423,21 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
         }
     }
 
-    if (ts_st->payload_size && (ts_st->payload_size + size > ts->pes_payload_size ||
+    if (ts_st->payload_size && (ts_st->payload_size + prefix_size + size > ts->pes_payload_size ||
         (dts != AV_NOPTS_VALUE && ts_st->payload_dts != AV_NOPTS_VALUE &&
          av_compare_ts(dts - ts_st->payload_dts, st->time_base,
                        s->max_delay, AV_TIME_BASE_Q) >= 0))) {
-        mpegts_write_pes(s, st, ts_st->payload, ts_st->payload_size,
+        mpegts_write_pes(s, st, NULL, 0, ts_st->payload, ts_st->payload_size,
                          ts_st->payload_pts, ts_st->payload_dts,
                          ts_st->payload_flags & AV_PKT_FLAG_KEY);
         ts_st->payload_size = 0;
     }
 
-    if (st->codec->codec_type != AVMEDIA_TYPE_AUDIO || size > ts->pes_payload_size) {
+    if (st->codec->codec_type != AVMEDIA_TYPE_AUDIO ||
+        prefix_size + size > ts->pes_payload_size) {
         av_assert0(!ts_st->payload_size);
         // for video and subtitle, write a single pes packet
-        mpegts_write_pes(s, st, buf, size, pts, dts,
+        mpegts_write_pes(s, st, prefix, prefix_size, buf, size, pts, dts,
                          pkt->flags & AV_PKT_FLAG_KEY);
         av_free(data);
         return 0;
@@ -1412,8 +1449,10 @@ static int mpegts_write_packet_internal(AVFormatContext *s, AVPacket *pkt)
         ts_st->payload_flags = pkt->flags;
     }
 
-    memcpy(ts_st->payload + ts_st->payload_size, buf, size);
-    ts_st->payload_size += size;
+    if (prefix_size)
+        memcpy(ts_st->payload + ts_st->payload_size, prefix, prefix_size);
+    memcpy(ts_st->payload + ts_st->payload_size + prefix_size, buf, size);
+    ts_st->payload_size += prefix_size + size;
 
     av_free(data);
 
@@ -1429,7 +1468,7 @@ static void mpegts_write_flush(AVFormatContext *s)
         AVStream *st = s->streams[i];
         MpegTSWriteStream *ts_st = st->priv_data;
         if (ts_st->payload_size > 0) {
-            mpegts_write_pes(s, st, ts_st->payload, ts_st->payload_size,
+            mpegts_write_pes(s, st, NULL, 0, ts_st->payload, ts_st->payload_size,
                              ts_st->payload_pts, ts_st->payload_dts,
                              ts_st->payload_flags & AV_PKT_FLAG_KEY);
             ts_st->payload_size = 0;
@@ -1460,6 +1499,7 @@ static int mpegts_write_end(AVFormatContext *s)
         AVStream *st = s->streams[i];
         MpegTSWriteStream *ts_st = st->priv_data;
         av_freep(&ts_st->payload);
+        av_freep(&ts_st->adts);
         if (ts_st->amux) {
             avformat_free_context(ts_st->amux);
             ts_st->amux = NULL;
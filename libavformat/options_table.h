@@ -100,6 +100,9 @@ static const AVOption avformat_options[] = {
 {"unofficial", "allow unofficial extensions", 0, AV_OPT_TYPE_CONST, {.i64 = FF_COMPLIANCE_UNOFFICIAL }, INT_MIN, INT_MAX, D|E, "strict"},
 {"experimental", "allow non-standardized experimental variants", 0, AV_OPT_TYPE_CONST, {.i64 = FF_COMPLIANCE_EXPERIMENTAL }, INT_MIN, INT_MAX, D|E, "strict"},
 {"max_ts_probe", "maximum number of packets to read while waiting for the first timestamp", OFFSET(max_ts_probe), AV_OPT_TYPE_INT, { .i64 = 50 }, 0, INT_MAX, D },
+{"probe_threads", "number of threads decoding the streams while probing", OFFSET(probe_threads), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, D },
+{"stream_info_cache", "file to read the stream parameters from or write them to", OFFSET(stream_info_cache), AV_OPT_TYPE_STRING, {.str = NULL}, CHAR_MIN, CHAR_MAX, D },
+{"seek_index_cache", "file to read the seek index from and write it to", OFFSET(seek_index_cache), AV_OPT_TYPE_STRING, {.str = NULL}, CHAR_MIN, CHAR_MAX, D },
 {"avoid_negative_ts", "shift timestamps so they start at 0", OFFSET(avoid_negative_ts), AV_OPT_TYPE_INT, {.i64 = -1}, -1, 2, E, "avoid_negative_ts"},
 {"auto",              "enabled when required by target format",    0, AV_OPT_TYPE_CONST, {.i64 = AVFMT_AVOID_NEG_TS_AUTO },              INT_MIN, INT_MAX, E, "avoid_negative_ts"},
 {"disabled",          "do not change timestamps",                  0, AV_OPT_TYPE_CONST, {.i64 = 0 },                                    INT_MIN, INT_MAX, E, "avoid_negative_ts"},
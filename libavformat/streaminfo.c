@@ -0,0 +1,624 @@
+/*
+ * Stream parameter and seek index export and import
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Serialization of the stream parameters found by avformat_find_stream_info()
+ * and of the seek index built while demuxing, so that files which were opened
+ * before can skip probing and seek without searching.
+ *
+ * Both blobs start with a tag and a version, followed by the size and
+ * modification time of the input and the name of the demuxer, and end with a
+ * CRC of everything before it. All values are big-endian.
+ *
+ * The "FFSI" stream info blob goes on with the ids of the streams and the
+ * metadata of the input. Each stream then has its AVStream and AVCodecContext
+ * parameters, its extradata, metadata and index entries.
+ *
+ * The "FFSX" seek index blob has the id, time base, end of the gapless part
+ * of the index and index entries of each stream.
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/crc.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavcodec/internal.h"
+#include "avformat.h"
+#include "avio_internal.h"
+#include "internal.h"
+#include "os_support.h"
+
+#define STREAM_INFO_VERSION 1
+#define SEEK_INDEX_VERSION  1
+
+/* size of the largest blob that is read back from a cache file */
+#define MAX_BLOB_SIZE (64 << 20)
+
+static void input_identity(AVFormatContext *ic, int64_t *size, int64_t *mtime)
+{
+    const char *proto = avio_find_protocol_name(ic->filename);
+    const char *path  = ic->filename;
+    struct stat st;
+
+    *size  = ic->pb ? avio_size(ic->pb) : -1;
+    *mtime = 0;
+    if (proto && !strcmp(proto, "file")) {
+        av_strstart(path, "file:", &path);
+        if (!stat(path, &st))
+            *mtime = st.st_mtime;
+    }
+}
+
+static void put_header(AVIOContext *pb, AVFormatContext *ic,
+                       const char *tag, int version)
+{
+    int64_t file_size, mtime;
+
+    input_identity(ic, &file_size, &mtime);
+    ffio_wfourcc(pb, tag);
+    avio_wb32(pb, version);
+    avio_wb64(pb, file_size);
+    avio_wb64(pb, mtime);
+    avio_put_str(pb, ic->iformat->name);
+}
+
+/**
+ * Check that buf is an intact blob of the given kind written for this very
+ * input and set up pb to read what follows its header.
+ */
+static int check_header(AVIOContext *pb, AVFormatContext *ic, const uint8_t *buf,
+                        int size, const char *tag, int version, const char *what)
+{
+    int64_t file_size, mtime, blob_size, blob_mtime;
+    char name[128];
+
+    if (size < 12 || AV_RL32(buf) != AV_RL32(tag) || AV_RB32(buf + 4) != version ||
+        AV_RB32(buf + size - 4) != av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), 0, buf, size - 4)) {
+        av_log(ic, AV_LOG_VERBOSE, "Cached %s is damaged or of another version\n", what);
+        return AVERROR(EINVAL);
+    }
+    ffio_init_context(pb, (uint8_t *)buf + 8, size - 12, 0, NULL, NULL, NULL, NULL);
+
+    input_identity(ic, &file_size, &mtime);
+    blob_size  = avio_rb64(pb);
+    blob_mtime = avio_rb64(pb);
+    avio_get_str(pb, INT_MAX, name, sizeof(name));
+    /* without a modification time a changed input cannot be told apart */
+    if (file_size < 0 || !mtime || blob_size != file_size || blob_mtime != mtime ||
+        strcmp(name, ic->iformat->name)) {
+        av_log(ic, AV_LOG_VERBOSE, "Cached %s does not match the input\n", what);
+        return AVERROR(EINVAL);
+    }
+    return 0;
+}
+
+/* close the dynamic buffer and append the CRC */
+static int close_blob(AVIOContext *pb, uint8_t **bufp, int *size)
+{
+    uint8_t *buf;
+    int len = avio_close_dyn_buf(pb, &buf);
+
+    if (!buf || av_reallocp(&buf, len + 4) < 0)
+        return AVERROR(ENOMEM);
+    AV_WB32(buf + len, av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), 0, buf, len));
+    *bufp = buf;
+    *size = len + 4;
+    return 0;
+}
+
+/* write the index entries that have all of the given flags set */
+static void put_index_entries(AVIOContext *pb, AVStream *st, int flags)
+{
+    int i, count = 0;
+
+    for (i = 0; i < st->nb_index_entries; i++)
+        count += (st->index_entries[i].flags & flags) == flags;
+    avio_wb32(pb, count);
+    for (i = 0; i < st->nb_index_entries; i++) {
+        AVIndexEntry *e = &st->index_entries[i];
+        if ((e->flags & flags) != flags)
+            continue;
+        avio_wb64(pb, e->pos);
+        avio_wb64(pb, e->timestamp);
+        avio_wb32(pb, e->flags & (AVINDEX_KEYFRAME | AVINDEX_SEEK_INDEX));
+        avio_wb32(pb, e->size);
+        avio_wb32(pb, e->min_distance);
+    }
+}
+
+/* read index entries, adding them to st unless it is NULL */
+static int get_index_entries(AVIOContext *pb, AVStream *st)
+{
+    int i, nb_index_entries = avio_rb32(pb);
+
+    for (i = 0; i < nb_index_entries && !avio_feof(pb); i++) {
+        int64_t pos       = avio_rb64(pb);
+        int64_t timestamp = avio_rb64(pb);
+        int flags         = avio_rb32(pb);
+        int size          = avio_rb32(pb);
+        int distance      = avio_rb32(pb);
+        if (st)
+            av_add_index_entry(st, pos, timestamp, size, distance, flags);
+    }
+    return avio_feof(pb) ? AVERROR_INVALIDDATA : 0;
+}
+
+/**
+ * Read a whole cache file.
+ *
+ * @return 1 if it was read, 0 if it is missing or too large, a negative
+ *         AVERROR code on failure
+ */
+static int read_blob(AVFormatContext *ic, const char *url, uint8_t **bufp, int *size)
+{
+    AVIOContext *pb;
+    int64_t len;
+    int ret;
+
+    if (avio_open2(&pb, url, AVIO_FLAG_READ, &ic->interrupt_callback, NULL) < 0)
+        return 0;
+    len = avio_size(pb);
+    if (len <= 0 || len > MAX_BLOB_SIZE) {
+        avio_closep(&pb);
+        return 0;
+    }
+    if (!(*bufp = av_malloc(len))) {
+        avio_closep(&pb);
+        return AVERROR(ENOMEM);
+    }
+    ret = avio_read(pb, *bufp, len);
+    avio_closep(&pb);
+    if (ret != len) {
+        av_freep(bufp);
+        return 0;
+    }
+    *size = len;
+    return 1;
+}
+
+static void write_blob(AVFormatContext *ic, const char *url, uint8_t *buf, int size)
+{
+    AVIOContext *pb;
+    int64_t file_size, mtime;
+    int ret;
+
+    /* check_header() would refuse it anyway */
+    input_identity(ic, &file_size, &mtime);
+    if (file_size < 0 || !mtime) {
+        av_log(ic, AV_LOG_VERBOSE, "Not caching %s, the input is not a local file\n", url);
+        return;
+    }
+
+    ret = avio_open2(&pb, url, AVIO_FLAG_WRITE, &ic->interrupt_callback, NULL);
+    if (ret >= 0) {
+        avio_write(pb, buf, size);
+        ret = avio_closep(&pb);
+    }
+    if (ret < 0)
+        av_log(ic, AV_LOG_WARNING, "Could not write cache %s\n", url);
+}
+
+static void put_rational(AVIOContext *pb, AVRational q)
+{
+    avio_wb32(pb, q.num);
+    avio_wb32(pb, q.den);
+}
+
+static AVRational get_rational(AVIOContext *pb)
+{
+    AVRational q;
+    q.num = avio_rb32(pb);
+    q.den = avio_rb32(pb);
+    return q;
+}
+
+static void put_string(AVIOContext *pb, const char *str)
+{
+    int len = strlen(str);
+    avio_wb32(pb, len);
+    avio_write(pb, str, len);
+}
+
+/* pb reads from memory, nothing can be longer than what is left of it */
+static int get_string(AVIOContext *pb, char **str)
+{
+    int len = avio_rb32(pb);
+
+    if (len < 0 || len > pb->buf_end - pb->buf_ptr)
+        return AVERROR_INVALIDDATA;
+    if (!(*str = av_malloc(len + 1)))
+        return AVERROR(ENOMEM);
+    avio_read(pb, *str, len);
+    (*str)[len] = 0;
+    return 0;
+}
+
+/* metadata may come from packets read while probing, e.g. FLV onMetaData,
+ * what the demuxer set while reading the header is kept as is */
+static void put_metadata(AVIOContext *pb, AVDictionary *m)
+{
+    AVDictionaryEntry *t = NULL;
+
+    avio_wb32(pb, av_dict_count(m));
+    while ((t = av_dict_get(m, "", t, AV_DICT_IGNORE_SUFFIX))) {
+        put_string(pb, t->key);
+        put_string(pb, t->value);
+    }
+}
+
+static int get_metadata(AVIOContext *pb, AVDictionary **m)
+{
+    char *key = NULL, *value = NULL;
+    int i, ret = 0, count = avio_rb32(pb);
+
+    for (i = 0; i < count && !avio_feof(pb); i++) {
+        if ((ret = get_string(pb, &key)) < 0 ||
+            (ret = get_string(pb, &value)) < 0)
+            break;
+        ret = av_dict_set(m, key, value, AV_DICT_DONT_STRDUP_KEY |
+                         AV_DICT_DONT_STRDUP_VAL | AV_DICT_DONT_OVERWRITE);
+        key = value = NULL;
+        if (ret < 0)
+            break;
+    }
+    av_free(key);
+    av_free(value);
+    return ret < 0 ? ret : avio_feof(pb) ? AVERROR_INVALIDDATA : 0;
+}
+
+static void put_codec_params(AVIOContext *pb, AVCodecContext *avctx)
+{
+    avio_wb32(pb, avctx->codec_type);
+    avio_wb32(pb, avctx->codec_id);
+    avio_wb32(pb, avctx->codec_tag);
+    avio_wb32(pb, avctx->bit_rate);
+    avio_wb32(pb, avctx->rc_max_rate);
+    avio_wb32(pb, avctx->profile);
+    avio_wb32(pb, avctx->level);
+    put_rational(pb, avctx->time_base);
+    avio_wb32(pb, avctx->ticks_per_frame);
+    put_rational(pb, avctx->framerate);
+    avio_wb32(pb, avctx->bits_per_coded_sample);
+    avio_wb32(pb, avctx->bits_per_raw_sample);
+
+    avio_wb32(pb, avctx->width);
+    avio_wb32(pb, avctx->height);
+    avio_wb32(pb, avctx->coded_width);
+    avio_wb32(pb, avctx->coded_height);
+    avio_wb32(pb, avctx->pix_fmt);
+    put_rational(pb, avctx->sample_aspect_ratio);
+    avio_wb32(pb, avctx->has_b_frames);
+    avio_wb32(pb, avctx->refs);
+    avio_wb32(pb, avctx->field_order);
+    avio_wb32(pb, avctx->color_range);
+    avio_wb32(pb, avctx->color_primaries);
+    avio_wb32(pb, avctx->color_trc);
+    avio_wb32(pb, avctx->colorspace);
+    avio_wb32(pb, avctx->chroma_sample_location);
+    avio_wb64(pb, avctx->timecode_frame_start);
+
+    avio_wb32(pb, avctx->sample_rate);
+    avio_wb32(pb, avctx->channels);
+    avio_wb64(pb, avctx->channel_layout);
+    avio_wb32(pb, avctx->sample_fmt);
+    avio_wb32(pb, avctx->frame_size);
+    avio_wb32(pb, avctx->block_align);
+    avio_wb32(pb, avctx->initial_padding);
+    avio_wb32(pb, avctx->audio_service_type);
+
+    avio_wb32(pb, avctx->extradata_size);
+    avio_write(pb, avctx->extradata, avctx->extradata_size);
+}
+
+static int get_codec_params(AVIOContext *pb, AVCodecContext *avctx)
+{
+    int extradata_size;
+
+    avctx->codec_type             = avio_rb32(pb);
+    avctx->codec_id               = avio_rb32(pb);
+    avctx->codec_tag              = avio_rb32(pb);
+    avctx->bit_rate               = avio_rb32(pb);
+    avctx->rc_max_rate            = avio_rb32(pb);
+    avctx->profile                = avio_rb32(pb);
+    avctx->level                  = avio_rb32(pb);
+    avctx->time_base              = get_rational(pb);
+    avctx->ticks_per_frame        = avio_rb32(pb);
+    avctx->framerate              = get_rational(pb);
+    avctx->bits_per_coded_sample  = avio_rb32(pb);
+    avctx->bits_per_raw_sample    = avio_rb32(pb);
+
+    avctx->width                  = avio_rb32(pb);
+    avctx->height                 = avio_rb32(pb);
+    avctx->coded_width            = avio_rb32(pb);
+    avctx->coded_height           = avio_rb32(pb);
+    avctx->pix_fmt                = avio_rb32(pb);
+    avctx->sample_aspect_ratio    = get_rational(pb);
+    avctx->has_b_frames           = avio_rb32(pb);
+    avctx->refs                   = avio_rb32(pb);
+    avctx->field_order            = avio_rb32(pb);
+    avctx->color_range            = avio_rb32(pb);
+    avctx->color_primaries        = avio_rb32(pb);
+    avctx->color_trc              = avio_rb32(pb);
+    avctx->colorspace             = avio_rb32(pb);
+    avctx->chroma_sample_location = avio_rb32(pb);
+    avctx->timecode_frame_start   = avio_rb64(pb);
+
+    avctx->sample_rate            = avio_rb32(pb);
+    avctx->channels               = avio_rb32(pb);
+    avctx->channel_layout         = avio_rb64(pb);
+    avctx->sample_fmt             = avio_rb32(pb);
+    avctx->frame_size             = avio_rb32(pb);
+    avctx->block_align            = avio_rb32(pb);
+    avctx->initial_padding        = avio_rb32(pb);
+    avctx->audio_service_type     = avio_rb32(pb);
+
+    /* the values end up in tables and allocations sized by them */
+    if (avctx->codec_type < AVMEDIA_TYPE_UNKNOWN || avctx->codec_type >= AVMEDIA_TYPE_NB ||
+        avctx->pix_fmt < AV_PIX_FMT_NONE || avctx->pix_fmt >= AV_PIX_FMT_NB ||
+        avctx->sample_fmt < AV_SAMPLE_FMT_NONE || avctx->sample_fmt >= AV_SAMPLE_FMT_NB ||
+        (unsigned)avctx->channels > FF_SANE_NB_CHANNELS)
+        return AVERROR_INVALIDDATA;
+    if ((avctx->width || avctx->height) &&
+        av_image_check_size(avctx->width, avctx->height, 0, NULL) < 0)
+        return AVERROR_INVALIDDATA;
+    if ((avctx->coded_width || avctx->coded_height) &&
+        av_image_check_size(avctx->coded_width, avctx->coded_height, 0, NULL) < 0)
+        return AVERROR_INVALIDDATA;
+
+    extradata_size = avio_rb32(pb);
+    if (extradata_size < 0 || extradata_size > pb->buf_end - pb->buf_ptr)
+        return AVERROR_INVALIDDATA;
+    av_freep(&avctx->extradata);
+    avctx->extradata_size = 0;
+    if (extradata_size) {
+        if (ff_get_extradata(avctx, pb, extradata_size) < 0)
+            return AVERROR_INVALIDDATA;
+    }
+    return 0;
+}
+
+int avformat_export_stream_info(AVFormatContext *ic, uint8_t **bufp, int *size)
+{
+    AVIOContext *pb;
+    int i, ret;
+
+    *bufp = NULL;
+    *size = 0;
+    if ((ret = avio_open_dyn_buf(&pb)) < 0)
+        return ret;
+
+    put_header(pb, ic, "FFSI", STREAM_INFO_VERSION);
+    avio_wb32(pb, ic->nb_streams);
+    for (i = 0; i < ic->nb_streams; i++)
+        avio_wb32(pb, ic->streams[i]->id);
+
+    avio_wb64(pb, ic->start_time);
+    avio_wb64(pb, ic->duration);
+    avio_wb32(pb, ic->bit_rate);
+    avio_wb32(pb, ic->duration_estimation_method);
+    put_metadata(pb, ic->metadata);
+
+    for (i = 0; i < ic->nb_streams; i++) {
+        AVStream *st = ic->streams[i];
+
+        put_rational(pb, st->time_base);
+        avio_wb64(pb, st->start_time);
+        avio_wb64(pb, st->duration);
+        avio_wb64(pb, st->nb_frames);
+        avio_wb32(pb, st->disposition);
+        put_rational(pb, st->sample_aspect_ratio);
+        put_rational(pb, st->avg_frame_rate);
+        put_rational(pb, st->r_frame_rate);
+        avio_wb32(pb, st->codec_info_nb_frames);
+        put_codec_params(pb, st->codec);
+        put_metadata(pb, st->metadata);
+        put_index_entries(pb, st, 0);
+    }
+
+    return close_blob(pb, bufp, size);
+}
+
+int avformat_import_stream_info(AVFormatContext *ic, const uint8_t *buf, int size)
+{
+    AVIOContext pb;
+    int i, ret, nb_streams;
+
+    /* make sure the blob describes this very file before touching it */
+    if ((ret = check_header(&pb, ic, buf, size, "FFSI", STREAM_INFO_VERSION,
+                            "stream info")) < 0)
+        return ret;
+    nb_streams = avio_rb32(&pb);
+    if (nb_streams != ic->nb_streams) {
+        av_log(ic, AV_LOG_VERBOSE, "Stream info has %d streams, the input %d\n",
+               nb_streams, ic->nb_streams);
+        return AVERROR(EINVAL);
+    }
+    for (i = 0; i < ic->nb_streams; i++) {
+        if (avio_rb32(&pb) != ic->streams[i]->id) {
+            av_log(ic, AV_LOG_VERBOSE, "Stream info does not match the id of stream %d\n", i);
+            return AVERROR(EINVAL);
+        }
+    }
+
+    ic->start_time                 = avio_rb64(&pb);
+    ic->duration                   = avio_rb64(&pb);
+    ic->bit_rate                   = avio_rb32(&pb);
+    ic->duration_estimation_method = avio_rb32(&pb);
+    if ((ret = get_metadata(&pb, &ic->metadata)) < 0)
+        goto fail;
+
+    for (i = 0; i < ic->nb_streams; i++) {
+        AVStream *st = ic->streams[i];
+        /* the demuxer may have built the index while reading the header */
+        AVStream *index_st = st->nb_index_entries ? NULL : st;
+
+        st->time_base           = get_rational(&pb);
+        st->start_time          = avio_rb64(&pb);
+        st->duration            = avio_rb64(&pb);
+        st->nb_frames           = avio_rb64(&pb);
+        st->disposition         = avio_rb32(&pb);
+        st->sample_aspect_ratio = get_rational(&pb);
+        st->avg_frame_rate      = get_rational(&pb);
+        st->r_frame_rate        = get_rational(&pb);
+        st->codec_info_nb_frames = avio_rb32(&pb);
+        if ((ret = get_codec_params(&pb, st->codec)) < 0 ||
+            (ret = get_metadata(&pb, &st->metadata)) < 0)
+            goto fail;
+        if (st->request_probe > 0)
+            st->request_probe = -1;
+
+        if ((ret = get_index_entries(&pb, index_st)) < 0)
+            goto fail;
+    }
+
+    /* leave the streams as avformat_find_stream_info() does */
+    for (i = 0; i < ic->nb_streams; i++) {
+        AVStream *st = ic->streams[i];
+        if (st->codec->codec_type != AVMEDIA_TYPE_AUDIO)
+            st->codec->thread_count = 0;
+        if (st->info)
+            av_freep(&st->info->duration_error);
+        av_freep(&st->info);
+    }
+    return 0;
+
+fail:
+    av_log(ic, AV_LOG_ERROR, "Invalid stream info\n");
+    return ret;
+}
+
+int ff_stream_info_cache_load(AVFormatContext *ic)
+{
+    uint8_t *buf;
+    int size, ret;
+
+    if ((ret = read_blob(ic, ic->stream_info_cache, &buf, &size)) <= 0)
+        return ret;
+    ret = avformat_import_stream_info(ic, buf, size);
+    av_free(buf);
+    if (ret < 0) {
+        /* anything but a mismatch leaves the streams half imported */
+        if (ret != AVERROR(EINVAL))
+            return ret;
+        av_log(ic, AV_LOG_VERBOSE, "Not using stream info cache %s\n",
+               ic->stream_info_cache);
+        return 0;
+    }
+    av_log(ic, AV_LOG_DEBUG, "Stream info read from %s\n", ic->stream_info_cache);
+    return 1;
+}
+
+void ff_stream_info_cache_store(AVFormatContext *ic)
+{
+    uint8_t *buf;
+    int size;
+
+    if (avformat_export_stream_info(ic, &buf, &size) < 0) {
+        av_log(ic, AV_LOG_WARNING, "Could not export the stream info\n");
+        return;
+    }
+    write_blob(ic, ic->stream_info_cache, buf, size);
+    av_free(buf);
+}
+
+static int nb_index_entries(AVFormatContext *ic)
+{
+    int i, j, count = 0;
+
+    for (i = 0; i < ic->nb_streams; i++)
+        for (j = 0; j < ic->streams[i]->nb_index_entries; j++)
+            count += !!(ic->streams[i]->index_entries[j].flags & AVINDEX_SEEK_INDEX);
+    return count;
+}
+
+int ff_seek_index_cache_load(AVFormatContext *ic)
+{
+    AVIOContext pb;
+    uint8_t *buf;
+    int i, size, ret, nb_streams;
+
+    ic->internal->seek_index_entries = -1;
+    for (i = 0; i < ic->nb_streams; i++)
+        if (ic->streams[i]->nb_index_entries)
+            return 0;
+
+    /* the index is kept from now on, whether or not it could be loaded */
+    ic->internal->seek_index_entries = 0;
+    ic->internal->build_seek_index   = !(ic->iformat->flags & AVFMT_GENERIC_INDEX) &&
+                                       !ic->iformat->read_seek;
+
+    if ((ret = read_blob(ic, ic->seek_index_cache, &buf, &size)) <= 0)
+        return ret;
+    if ((ret = check_header(&pb, ic, buf, size, "FFSX", SEEK_INDEX_VERSION,
+                            "seek index")) < 0) {
+        av_free(buf);
+        return 0;
+    }
+
+    /* streams the demuxer creates later on are not known yet, skip them */
+    nb_streams = avio_rb32(&pb);
+    for (i = 0; i < nb_streams && !avio_feof(&pb); i++) {
+        AVStream *st = i < ic->nb_streams ? ic->streams[i] : NULL;
+        int id = avio_rb32(&pb);
+        AVRational time_base = get_rational(&pb);
+        int64_t index_end    = avio_rb64(&pb);
+
+        if (st && (st->id != id || av_cmp_q(st->time_base, time_base)))
+            st = NULL;
+        if (get_index_entries(&pb, st) < 0)
+            break;
+        if (st)
+            st->seek_index_end = index_end;
+    }
+    av_free(buf);
+
+    ic->internal->seek_index_entries = nb_index_entries(ic);
+    av_log(ic, AV_LOG_DEBUG, "%d index entries read from %s\n",
+           ic->internal->seek_index_entries, ic->seek_index_cache);
+    return 0;
+}
+
+void ff_seek_index_cache_store(AVFormatContext *ic)
+{
+    AVIOContext *pb;
+    uint8_t *buf;
+    int i, size;
+
+    if (ic->internal->seek_index_entries < 0 ||
+        ic->internal->seek_index_entries >= nb_index_entries(ic))
+        return;
+
+    if (avio_open_dyn_buf(&pb) < 0)
+        return;
+    put_header(pb, ic, "FFSX", SEEK_INDEX_VERSION);
+    avio_wb32(pb, ic->nb_streams);
+    for (i = 0; i < ic->nb_streams; i++) {
+        AVStream *st = ic->streams[i];
+        avio_wb32(pb, st->id);
+        put_rational(pb, st->time_base);
+        avio_wb64(pb, st->seek_index_end);
+        put_index_entries(pb, st, AVINDEX_SEEK_INDEX);
+    }
+    if (close_blob(pb, &buf, &size) < 0)
+        return;
+    write_blob(ic, ic->seek_index_cache, buf, size);
+    av_free(buf);
+}
@@ -32,6 +32,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/timestamp.h"
 
@@ -491,6 +492,9 @@ int avformat_open_input(AVFormatContext **ps, const char *filename,
 
     s->internal->raw_packet_buffer_remaining_size = RAW_PACKET_BUFFER_SIZE;
 
+    if (s->seek_index_cache && s->pb && (ret = ff_seek_index_cache_load(s)) < 0)
+        goto fail;
+
     if (options) {
         av_dict_free(options);
         *options = tmp;
@@ -1559,6 +1563,16 @@ return_packet:
         ff_reduce_index(s, st->index);
         av_add_index_entry(st, pkt->pos, pkt->dts, 0, 0, AVINDEX_KEYFRAME);
     }
+    /* packets split from a larger one by a parser have no position and
+     * cannot be seeked to */
+    if (s->internal->build_seek_index && pkt->dts != AV_NOPTS_VALUE && !is_relative(pkt->dts)) {
+        if (pkt->flags & AV_PKT_FLAG_KEY && pkt->pos >= 0) {
+            ff_reduce_index(s, st->index);
+            av_add_index_entry(st, pkt->pos, pkt->dts, 0, 0,
+                               AVINDEX_KEYFRAME | AVINDEX_SEEK_INDEX);
+        }
+        st->seek_index_end = FFMAX(st->seek_index_end, pkt->dts);
+    }
 
     if (is_relative(pkt->dts))
         pkt->dts -= RELATIVE_TS_BASE;
@@ -1728,9 +1742,13 @@ int ff_add_index_entry(AVIndexEntry **index_entries,
             memmove(entries + index + 1, entries + index,
                     sizeof(AVIndexEntry) * (*nb_index_entries - index));
             (*nb_index_entries)++;
-        } else if (ie->pos == pos && distance < ie->min_distance)
+        } else if (ie->pos == pos) {
             // do not reduce the distance
-            distance = ie->min_distance;
+            if (distance < ie->min_distance)
+                distance = ie->min_distance;
+            // nor drop the entry from the seek index cache
+            flags |= ie->flags & AVINDEX_SEEK_INDEX;
+        }
     }
 
     ie->pos          = pos;
@@ -2088,6 +2106,34 @@ static int seek_frame_byte(AVFormatContext *s, int stream_index,
     return 0;
 }
 
+/**
+ * Find the entry of the index built for the seek index cache to seek to,
+ * skipping the entries the demuxer added itself, which need not be
+ * keyframes.
+ *
+ * @return the index of the entry, -1 if the seek is not covered
+ */
+static int seek_index_search(AVStream *st, int64_t timestamp, int flags)
+{
+    int step  = flags & AVSEEK_FLAG_BACKWARD ? -1 : 1;
+    int index = av_index_search_timestamp(st, timestamp, flags | AVSEEK_FLAG_ANY);
+
+    /* the index is built from the start of the file, nothing before its
+     * first keyframe can be decoded */
+    if (index < 0 && step < 0) {
+        index = 0;
+        step  = 1;
+    }
+    while (index >= 0 && index < st->nb_index_entries &&
+           !(st->index_entries[index].flags & AVINDEX_SEEK_INDEX))
+        index += step;
+    if (index < 0 || index >= st->nb_index_entries ||
+        st->seek_index_end == AV_NOPTS_VALUE ||
+        FFMAX(timestamp, st->index_entries[index].timestamp) > st->seek_index_end)
+        return -1;
+    return index;
+}
+
 static int seek_frame_generic(AVFormatContext *s, int stream_index,
                               int64_t timestamp, int flags)
 {
@@ -2176,6 +2222,22 @@ static int seek_frame_internal(AVFormatContext *s, int stream_index,
                                AV_TIME_BASE * (int64_t) st->time_base.num);
     }
 
+    /* the index built while demuxing has every keyframe up to
+     * seek_index_end and saves searching within that range; it only
+     * keeps growing as long as no seek leaves it */
+    if (s->internal->seek_index_entries >= 0 && !s->iformat->read_seek) {
+        int index = seek_index_search(s->streams[stream_index], timestamp, flags);
+        if (index >= 0) {
+            AVIndexEntry *ie = &s->streams[stream_index]->index_entries[index];
+            ff_read_frame_flush(s);
+            if (avio_seek(s->pb, ie->pos, SEEK_SET) >= 0) {
+                ff_update_cur_dts(s, s->streams[stream_index], ie->timestamp);
+                return 0;
+            }
+        }
+        s->internal->build_seek_index = 0;
+    }
+
     /* first, we try the format specific seek */
     if (s->iformat->read_seek) {
         ff_read_frame_flush(s);
@@ -2760,6 +2822,222 @@ fail:
     return ret;
 }
 
+static void flush_probe_decoder(AVFormatContext *ic, AVStream *st,
+                                AVDictionary **options)
+{
+    AVPacket empty_pkt = { 0 };
+    int err;
+
+    av_init_packet(&empty_pkt);
+    do {
+        err = try_decode_frame(ic, st, &empty_pkt, options);
+    } while (err > 0 && !has_codec_parameters(st, NULL));
+
+    if (err < 0) {
+        av_log(ic, AV_LOG_INFO,
+            "decoding for stream %d failed\n", st->index);
+    }
+}
+
+/**
+ * A probe decoding job. Only one job per stream is queued at a time, and a
+ * stream with a queued job is not touched by the demuxing side until the
+ * jobs have been run, so the jobs never share any state.
+ */
+typedef struct ProbeJob {
+    AVStream *st;
+    AVPacket *pkt;          ///< packet to decode, NULL to flush the decoder
+    AVDictionary **options;
+} ProbeJob;
+
+typedef struct ProbeThreadContext {
+    AVFormatContext *ic;
+    ProbeJob *jobs;
+    int nb_jobs;
+    int max_jobs;
+#if HAVE_THREADS
+    pthread_t *threads;
+    int nb_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    int nb_run;             ///< number of jobs handed to the threads
+    int next_job;
+    int jobs_done;
+    int exit;
+#endif
+} ProbeThreadContext;
+
+static void run_probe_job(ProbeThreadContext *pt, ProbeJob *job)
+{
+    AVStream *st = job->st;
+
+    if (!job->pkt) {
+        flush_probe_decoder(pt->ic, st, job->options);
+        return;
+    }
+    /* the packet was already counted when it was queued */
+    st->codec_info_nb_frames--;
+    try_decode_frame(pt->ic, st, job->pkt, job->options);
+    st->codec_info_nb_frames++;
+}
+
+#if HAVE_THREADS
+static void *probe_worker(void *arg)
+{
+    ProbeThreadContext *pt = arg;
+
+    pthread_mutex_lock(&pt->mutex);
+    for (;;) {
+        int job;
+
+        while (!pt->exit && pt->next_job >= pt->nb_run)
+            pthread_cond_wait(&pt->work_cond, &pt->mutex);
+        if (pt->exit)
+            break;
+        job = pt->next_job++;
+        pthread_mutex_unlock(&pt->mutex);
+
+        run_probe_job(pt, &pt->jobs[job]);
+
+        pthread_mutex_lock(&pt->mutex);
+        if (++pt->jobs_done == pt->nb_run)
+            pthread_cond_signal(&pt->done_cond);
+    }
+    pthread_mutex_unlock(&pt->mutex);
+    return NULL;
+}
+#endif
+
+static void probe_threads_uninit(ProbeThreadContext *pt)
+{
+#if HAVE_THREADS
+    int i;
+
+    if (!pt->threads)
+        return;
+    pthread_mutex_lock(&pt->mutex);
+    pt->exit = 1;
+    pthread_cond_broadcast(&pt->work_cond);
+    pthread_mutex_unlock(&pt->mutex);
+    for (i = 0; i < pt->nb_threads; i++)
+        pthread_join(pt->threads[i], NULL);
+    pthread_cond_destroy(&pt->done_cond);
+    pthread_cond_destroy(&pt->work_cond);
+    pthread_mutex_destroy(&pt->mutex);
+    av_freep(&pt->threads);
+    pt->nb_threads = 0;
+#endif
+    av_freep(&pt->jobs);
+    pt->nb_jobs = pt->max_jobs = 0;
+}
+
+/**
+ * Start the threads decoding the streams in parallel while probing.
+ *
+ * @return the number of started threads, 0 if probing is done serially
+ */
+static int probe_threads_init(AVFormatContext *ic, ProbeThreadContext *pt)
+{
+    memset(pt, 0, sizeof(*pt));
+    pt->ic = ic;
+#if HAVE_THREADS
+    /* the caller's thread runs jobs too */
+    if (ic->probe_threads > 1 && !(ic->flags & AVFMT_FLAG_NOBUFFER)) {
+        int i;
+
+        pt->threads = av_mallocz_array(ic->probe_threads - 1, sizeof(*pt->threads));
+        if (!pt->threads)
+            return 0;
+        pthread_mutex_init(&pt->mutex, NULL);
+        pthread_cond_init(&pt->work_cond, NULL);
+        pthread_cond_init(&pt->done_cond, NULL);
+        for (i = 0; i < ic->probe_threads - 1; i++) {
+            if (pthread_create(&pt->threads[i], NULL, probe_worker, pt))
+                break;
+            pt->nb_threads++;
+        }
+        if (!pt->nb_threads) {
+            av_log(ic, AV_LOG_WARNING,
+                   "Could not start probe threads, probing serially\n");
+            probe_threads_uninit(pt);
+        }
+        return pt->nb_threads;
+    }
+#endif
+    return 0;
+}
+
+static int probe_job_pending(ProbeThreadContext *pt, AVStream *st)
+{
+    int i;
+
+    for (i = 0; i < pt->nb_jobs; i++)
+        if (pt->jobs[i].st == st)
+            return 1;
+    return 0;
+}
+
+static int probe_delay_pending(ProbeThreadContext *pt)
+{
+    int i;
+
+    for (i = 0; i < pt->nb_jobs; i++)
+        if (!has_decode_delay_been_guessed(pt->jobs[i].st))
+            return 1;
+    return 0;
+}
+
+static int probe_threads_queue(ProbeThreadContext *pt, AVStream *st,
+                               AVPacket *pkt, AVDictionary **options)
+{
+    ProbeJob *job;
+
+    if (pt->nb_jobs == pt->max_jobs) {
+        int ret, max_jobs = FFMAX(2 * pt->max_jobs, 16);
+        if ((ret = av_reallocp_array(&pt->jobs, max_jobs, sizeof(*pt->jobs))) < 0) {
+            pt->nb_jobs = pt->max_jobs = 0;
+            return ret;
+        }
+        pt->max_jobs = max_jobs;
+    }
+    job          = &pt->jobs[pt->nb_jobs++];
+    job->st      = st;
+    job->pkt     = pkt;
+    job->options = options;
+    return 0;
+}
+
+/**
+ * Run all queued jobs on the probe threads and the calling thread, and
+ * wait for them to finish.
+ */
+static void probe_threads_run(ProbeThreadContext *pt)
+{
+#if HAVE_THREADS
+    if (!pt->nb_jobs)
+        return;
+
+    pthread_mutex_lock(&pt->mutex);
+    pt->nb_run    = pt->nb_jobs;
+    pt->next_job  = 0;
+    pt->jobs_done = 0;
+    pthread_cond_broadcast(&pt->work_cond);
+    while (pt->next_job < pt->nb_run) {
+        int job = pt->next_job++;
+        pthread_mutex_unlock(&pt->mutex);
+        run_probe_job(pt, &pt->jobs[job]);
+        pthread_mutex_lock(&pt->mutex);
+        pt->jobs_done++;
+    }
+    while (pt->jobs_done < pt->nb_run)
+        pthread_cond_wait(&pt->done_cond, &pt->mutex);
+    pt->nb_run = pt->next_job = 0;
+    pthread_mutex_unlock(&pt->mutex);
+#endif
+    pt->nb_jobs = 0;
+}
+
 unsigned int ff_codec_get_tag(const AVCodecTag *tags, enum AVCodecID id)
 {
     while (tags->id != AV_CODEC_ID_NONE) {
@@ -3098,6 +3376,8 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 #endif
     int64_t max_stream_analyze_duration;
     int64_t max_subtitle_analyze_duration;
+    ProbeThreadContext pt;
+    int probe_threads;
 #if FF_API_PROBESIZE_32
     int64_t probesize = ic->probesize2;
 #else
@@ -3110,6 +3390,13 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         probesize = ic->probesize;
     flush_codecs = probesize > 0;
 
+    if (ic->stream_info_cache && (ret = ff_stream_info_cache_load(ic))) {
+        if (ret < 0)
+            return ret;
+        compute_chapters_end(ic);
+        return 0;
+    }
+
     av_opt_set(ic, "skip_clear", "1", AV_OPT_SEARCH_CHILDREN);
 
     max_stream_analyze_duration = max_analyze_duration;
@@ -3189,6 +3476,8 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         ic->streams[i]->info->fps_last_dts  = AV_NOPTS_VALUE;
     }
 
+    probe_threads = probe_threads_init(ic, &pt);
+
     count     = 0;
     read_size = 0;
     for (;;) {
@@ -3236,6 +3525,13 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
                  st->codec->codec_type == AVMEDIA_TYPE_AUDIO))
                 break;
         }
+        /* the stream holding us back may only look incomplete because its
+         * last packet has not been decoded yet */
+        if (i < ic->nb_streams && probe_threads &&
+            probe_job_pending(&pt, ic->streams[i])) {
+            probe_threads_run(&pt);
+            continue;
+        }
         analyzed_all_streams = 0;
         if (i == ic->nb_streams) {
             analyzed_all_streams = 1;
@@ -3265,6 +3561,11 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
             break;
         }
 
+        /* the timestamps of the next packet depend on the decoding of the
+         * queued ones until the reorder delay has been guessed */
+        if (probe_threads && probe_delay_pending(&pt))
+            probe_threads_run(&pt);
+
         /* NOTE: A new stream can be added there if no header in file
          * (AVFMTCTX_NOHEADER). */
         ret = read_frame_internal(ic, &pkt1);
@@ -3291,6 +3592,10 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         }
 
         st = ic->streams[pkt->stream_index];
+        /* decode the previous packet of this stream first, it may update the
+         * codec parameters used below */
+        if (probe_threads && probe_job_pending(&pt, st))
+            probe_threads_run(&pt);
         if (!(st->disposition & AV_DISPOSITION_ATTACHED_PIC))
             read_size += pkt->size;
 
@@ -3372,8 +3677,10 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         if (st->parser && st->parser->parser->split && !st->codec->extradata) {
             int i = st->parser->parser->split(st->codec, pkt->data, pkt->size);
             if (i > 0 && i < FF_MAX_EXTRADATA_SIZE) {
-                if (ff_alloc_extradata(st->codec, i))
-                    return AVERROR(ENOMEM);
+                if (ff_alloc_extradata(st->codec, i)) {
+                    ret = AVERROR(ENOMEM);
+                    goto find_stream_info_err;
+                }
                 memcpy(st->codec->extradata, pkt->data,
                        st->codec->extradata_size);
             }
@@ -3388,8 +3695,14 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
          * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+        if (probe_threads) {
+            if ((ret = probe_threads_queue(&pt, st, pkt,
+                                           (options && st->index < orig_nb_streams)
+                                           ? &options[st->index] : NULL)) < 0)
+                goto find_stream_info_err;
+        } else
+            try_decode_frame(ic, st, pkt,
+                             (options && i < orig_nb_streams) ? &options[i] : NULL);
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(pkt);
@@ -3398,30 +3711,30 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
         count++;
     }
 
+    if (probe_threads)
+        probe_threads_run(&pt);
+
     if (flush_codecs) {
-        AVPacket empty_pkt = { 0 };
-        int err = 0;
-        av_init_packet(&empty_pkt);
+        int err;
 
         for (i = 0; i < ic->nb_streams; i++) {
+            AVDictionary **opts = (options && i < orig_nb_streams) ? &options[i] : NULL;
 
             st = ic->streams[i];
 
             /* flush the decoders */
             if (st->info->found_decoder == 1) {
-                do {
-                    err = try_decode_frame(ic, st, &empty_pkt,
-                                            (options && i < orig_nb_streams)
-                                            ? &options[i] : NULL);
-                } while (err > 0 && !has_codec_parameters(st, NULL));
-
-                if (err < 0) {
-                    av_log(ic, AV_LOG_INFO,
-                        "decoding for stream %d failed\n", st->index);
+                if (!probe_threads)
+                    flush_probe_decoder(ic, st, opts);
+                else if ((err = probe_threads_queue(&pt, st, NULL, opts)) < 0) {
+                    ret = err;
+                    goto find_stream_info_err;
                 }
             }
         }
+        probe_threads_run(&pt);
     }
+    probe_threads_uninit(&pt);
 
     // close codecs which were opened in try_decode_frame()
     for (i = 0; i < ic->nb_streams; i++) {
@@ -3537,7 +3850,11 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 
     compute_chapters_end(ic);
 
+    if (!ret && ic->stream_info_cache)
+        ff_stream_info_cache_store(ic);
+
 find_stream_info_err:
+    probe_threads_uninit(&pt);
     for (i = 0; i < ic->nb_streams; i++) {
         st = ic->streams[i];
         if (ic->streams[i]->codec->codec_type != AVMEDIA_TYPE_AUDIO)
@@ -3735,6 +4052,9 @@ void avformat_close_input(AVFormatContext **ps)
 
     flush_packet_queue(s);
 
+    if (s->seek_index_cache)
+        ff_seek_index_cache_store(s);
+
     if (s->iformat)
         if (s->iformat->read_close)
             s->iformat->read_close(s);
@@ -3797,6 +4117,7 @@ AVStream *avformat_new_stream(AVFormatContext *s, const AVCodec *c)
 
     st->last_IP_pts = AV_NOPTS_VALUE;
     st->last_dts_for_order_check = AV_NOPTS_VALUE;
+    st->seek_index_end = AV_NOPTS_VALUE;
     for (i = 0; i < MAX_REORDER_DELAY + 1; i++)
         st->pts_buffer[i] = AV_NOPTS_VALUE;
 
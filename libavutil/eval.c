@@ -152,7 +152,7 @@ struct AVExpr {
         e_if, e_ifnot, e_print, e_bitand, e_bitor, e_between, e_clip
     } type;
     double value; // is sign in other types
-    union {
+    union ExprArg {
         int const_index;
         double (*func0)(double);
         double (*func1)(void *, double);
@@ -160,8 +160,30 @@ struct AVExpr {
     } a;
     struct AVExpr *param[3];
     double *var;
+    struct ExprProgram *prog;   ///< bytecode of the whole expression, only set on the root
+    int nb_consts;              ///< number of entries of const_names, only set on the root
 };
 
+#define EXPR_BATCH    32    ///< number of lanes evaluated by one bytecode pass
+#define EXPR_MAX_REGS 32    ///< registers available to the bytecode
+
+/**
+ * One bytecode instruction; op is the AVExpr type it was compiled from and
+ * computes dst from the src registers exactly like eval_expr() does.
+ */
+typedef struct ExprInsn {
+    int op;
+    int dst, src[3];            ///< register indices, src[i] < 0 if the parameter is absent
+    double value;
+    union ExprArg a;
+} ExprInsn;
+
+typedef struct ExprProgram {
+    ExprInsn *insn;
+    int nb_insn;
+    int nb_regs;
+} ExprProgram;
+
 static double etime(double v)
 {
     return av_gettime() * 0.000001;
@@ -317,6 +339,9 @@ void av_expr_free(AVExpr *e)
     av_expr_free(e->param[1]);
     av_expr_free(e->param[2]);
     av_freep(&e->var);
+    if (e->prog)
+        av_freep(&e->prog->insn);
+    av_freep(&e->prog);
     av_freep(&e);
 }
 
@@ -650,6 +675,115 @@ static int verify_expr(AVExpr *e)
     }
 }
 
+/**
+ * Replace every subtree which does not depend on constants, variables or
+ * user functions by its value.
+ */
+static void fold_expr(AVExpr *e)
+{
+    int i, foldable = 1;
+
+    for (i = 0; i < 3; i++) {
+        if (e->param[i]) {
+            fold_expr(e->param[i]);
+            foldable &= e->param[i]->type == e_value;
+        }
+    }
+
+    switch (e->type) {
+    case e_value:
+    case e_const:
+    case e_func1:
+    case e_func2:
+    case e_ld:
+    case e_st:
+    case e_random:
+    case e_print:
+    case e_while:
+    case e_taylor:
+    case e_root:
+        return;
+    case e_func0:
+        if (e->a.func0 == etime)
+            return;
+    default:
+        break;
+    }
+
+    if (foldable) {
+        Parser p = { 0 };
+        e->value = eval_expr(&p, e);
+        e->type  = e_value;
+        for (i = 0; i < 3; i++) {
+            av_expr_free(e->param[i]);
+            e->param[i] = NULL;
+        }
+    }
+}
+
+/**
+ * Emit the code computing e into register reg, using the registers above
+ * reg as temporaries.
+ * @return 0 on success, a negative value if e cannot be run as bytecode
+ */
+static int compile_expr(ExprProgram *prog, AVExpr *e, int reg)
+{
+    ExprInsn *insn;
+    int i, ret;
+
+    switch (e->type) {
+    case e_st:
+    case e_random:
+    case e_print:
+    case e_while:
+    case e_taylor:
+    case e_root:
+        /* these update the variables, their lanes cannot run in lockstep */
+        return AVERROR(ENOSYS);
+    default:
+        break;
+    }
+
+    for (i = 0; i < 3; i++) {
+        if (!e->param[i])
+            continue;
+        if (reg + i >= EXPR_MAX_REGS)
+            return AVERROR(ENOSYS);
+        if ((ret = compile_expr(prog, e->param[i], reg + i)) < 0)
+            return ret;
+    }
+
+    insn = av_dynarray2_add((void **)&prog->insn, &prog->nb_insn, sizeof(*insn), NULL);
+    if (!insn)
+        return AVERROR(ENOMEM);
+    insn->op    = e->type;
+    insn->dst   = reg;
+    insn->value = e->value;
+    for (i = 0; i < 3; i++)
+        insn->src[i] = e->param[i] ? reg + i : -1;
+    insn->a     = e->a;
+    prog->nb_regs = FFMAX(prog->nb_regs, reg + 1);
+    return 0;
+}
+
+static int compile_program(AVExpr *e)
+{
+    ExprProgram *prog = av_mallocz(sizeof(*prog));
+    int ret;
+
+    if (!prog)
+        return AVERROR(ENOMEM);
+    ret = compile_expr(prog, e, 0);
+    if (ret < 0) {
+        av_freep(&prog->insn);
+        av_freep(&prog);
+        /* the tree walker handles everything the bytecode does not */
+        return ret == AVERROR(ENOSYS) ? 0 : ret;
+    }
+    e->prog = prog;
+    return 0;
+}
+
 int av_expr_parse(AVExpr **expr, const char *s,
                   const char * const *const_names,
                   const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -692,6 +826,11 @@ int av_expr_parse(AVExpr **expr, const char *s,
         ret = AVERROR(EINVAL);
         goto end;
     }
+    fold_expr(e);
+    if ((ret = compile_program(e)) < 0)
+        goto end;
+    for (e->nb_consts = 0; const_names && const_names[e->nb_consts]; e->nb_consts++)
+        ;
     e->var= av_mallocz(sizeof(double) *VARS);
     if (!e->var) {
         ret = AVERROR(ENOMEM);
@@ -715,6 +854,151 @@ double av_expr_eval(AVExpr *e, const double *const_values, void *opaque)
     return eval_expr(&p, e);
 }
 
+/**
+ * Run the bytecode for nb_lanes <= EXPR_BATCH lanes, lane i using the
+ * constants const_arrays[k][offset + i] and the opaque pointer
+ * opaques[offset + i].
+ *
+ * A register whose value is the same in all lanes is only computed for the
+ * first lane, and copied to the others once a per-lane instruction reads it.
+ */
+static void run_program(const ExprProgram *prog, double *var, double *res, int nb_lanes, int offset,
+                        const double *const_values, const double * const *const_arrays,
+                        void *opaque, void * const *opaques)
+{
+    double reg[EXPR_MAX_REGS][EXPR_BATCH];
+    uint8_t uniform[EXPR_MAX_REGS]; ///< only lane 0 of the register is valid
+    int n, i, j, nb;
+
+    for (n = 0; n < prog->nb_insn; n++) {
+        const ExprInsn *insn = &prog->insn[n];
+        const double v = insn->value;
+        double *d = reg[insn->dst];
+        const double *a = insn->src[0] >= 0 ? reg[insn->src[0]] : NULL;
+        const double *b = insn->src[1] >= 0 ? reg[insn->src[1]] : NULL;
+        const double *c = insn->src[2] >= 0 ? reg[insn->src[2]] : NULL;
+        int is_uniform = 1;
+
+        for (j = 0; j < 3; j++)
+            if (insn->src[j] >= 0)
+                is_uniform &= uniform[insn->src[j]];
+        if (insn->op == e_const && const_arrays && const_arrays[insn->a.const_index])
+            is_uniform = 0;
+        if ((insn->op == e_func1 || insn->op == e_func2) && opaques)
+            is_uniform = 0;
+
+        if (!is_uniform) {
+            for (j = 0; j < 3; j++) {
+                int src = insn->src[j];
+                if (src >= 0 && uniform[src]) {
+                    for (i = 1; i < nb_lanes; i++)
+                        reg[src][i] = reg[src][0];
+                    uniform[src] = 0;
+                }
+            }
+        }
+        uniform[insn->dst] = is_uniform;
+        nb = is_uniform ? 1 : nb_lanes;
+
+#define LOOP(expr) for (i = 0; i < nb; i++) d[i] = expr; break
+#define OPAQUE(i) (opaques ? opaques[offset + (i)] : opaque)
+        switch (insn->op) {
+        case e_value:  LOOP(v);
+        case e_const: {
+            const double *src = const_arrays ? const_arrays[insn->a.const_index] : NULL;
+            if (src) {
+                src += offset;
+                LOOP(v * src[i]);
+            } else {
+                const double cv = v * const_values[insn->a.const_index];
+                LOOP(cv);
+            }
+        }
+        case e_func0:  LOOP(v * insn->a.func0(a[i]));
+        case e_func1:  LOOP(v * insn->a.func1(OPAQUE(i), a[i]));
+        case e_func2:  LOOP(v * insn->a.func2(OPAQUE(i), a[i], b[i]));
+        case e_squish: LOOP(1/(1+exp(4*a[i])));
+        case e_gauss:  LOOP(exp(-a[i]*a[i]/2)/sqrt(2*M_PI));
+        case e_ld:     LOOP(v * var[av_clip(a[i], 0, VARS-1)]);
+        case e_isnan:  LOOP(v * !!isnan(a[i]));
+        case e_isinf:  LOOP(v * !!isinf(a[i]));
+        case e_floor:  LOOP(v * floor(a[i]));
+        case e_ceil:   LOOP(v * ceil (a[i]));
+        case e_trunc:  LOOP(v * trunc(a[i]));
+        case e_sqrt:   LOOP(v * sqrt (a[i]));
+        case e_not:    LOOP(v * (a[i] == 0));
+        /* both branches have been computed, which is only valid because
+         * nothing compiled to bytecode has side effects */
+        case e_if:     LOOP(v * (a[i] ? b[i] : c ? c[i] : 0));
+        case e_ifnot:  LOOP(v * (!a[i] ? b[i] : c ? c[i] : 0));
+        case e_clip:
+            for (i = 0; i < nb; i++) {
+                if (isnan(b[i]) || isnan(c[i]) || isnan(a[i]) || b[i] > c[i])
+                    d[i] = NAN;
+                else
+                    d[i] = v * av_clipd(a[i], b[i], c[i]);
+            }
+            break;
+        case e_between: LOOP(v * (a[i] >= b[i] && a[i] <= c[i]));
+        case e_mod:    LOOP(v * (a[i] - floor((!CONFIG_FTRAPV || b[i]) ? a[i] / b[i] : a[i] * INFINITY) * b[i]));
+        case e_gcd:    LOOP(v * av_gcd(a[i], b[i]));
+        case e_max:    LOOP(v * (a[i] >  b[i] ? a[i] : b[i]));
+        case e_min:    LOOP(v * (a[i] <  b[i] ? a[i] : b[i]));
+        case e_eq:     LOOP(v * (a[i] == b[i] ? 1.0 : 0.0));
+        case e_gt:     LOOP(v * (a[i] >  b[i] ? 1.0 : 0.0));
+        case e_gte:    LOOP(v * (a[i] >= b[i] ? 1.0 : 0.0));
+        case e_lt:     LOOP(v * (a[i] <  b[i] ? 1.0 : 0.0));
+        case e_lte:    LOOP(v * (a[i] <= b[i] ? 1.0 : 0.0));
+        case e_pow:    LOOP(v * pow(a[i], b[i]));
+        case e_mul:    LOOP(v * (a[i] * b[i]));
+        case e_div:    LOOP(v * ((!CONFIG_FTRAPV || b[i]) ? (a[i] / b[i]) : a[i] * INFINITY));
+        case e_add:    LOOP(v * (a[i] + b[i]));
+        case e_last:   LOOP(v * b[i]);
+        case e_hypot:  LOOP(v * (sqrt(a[i]*a[i] + b[i]*b[i])));
+        case e_bitand: LOOP(isnan(a[i]) || isnan(b[i]) ? NAN : v * ((long int)a[i] & (long int)b[i]));
+        case e_bitor:  LOOP(isnan(a[i]) || isnan(b[i]) ? NAN : v * ((long int)a[i] | (long int)b[i]));
+        default:       LOOP(NAN);
+        }
+#undef OPAQUE
+#undef LOOP
+    }
+
+    if (uniform[0]) {
+        for (i = 0; i < nb_lanes; i++)
+            res[i] = reg[0][0];
+    } else {
+        memcpy(res, reg[0], nb_lanes * sizeof(*res));
+    }
+}
+
+int av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                       const double *const_values, const double * const *const_arrays,
+                       void *opaque, void * const *opaques)
+{
+    double *values;
+    int i, j;
+
+    if (e->prog) {
+        for (i = 0; i < nb; i += EXPR_BATCH)
+            run_program(e->prog, e->var, res + i, FFMIN(nb - i, EXPR_BATCH), i,
+                        const_values, const_arrays, opaque, opaques);
+        return 0;
+    }
+
+    /* evaluate the lanes one after the other, so that the variables are
+     * updated in the same order as with av_expr_eval() */
+    values = av_malloc_array(FFMAX(e->nb_consts, 1), sizeof(*values));
+    if (!values)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb; i++) {
+        for (j = 0; j < e->nb_consts; j++)
+            values[j] = const_arrays && const_arrays[j] ? const_arrays[j][i] : const_values[j];
+        res[i] = av_expr_eval(e, values, opaques ? opaques[i] : opaque);
+    }
+    av_free(values);
+    return 0;
+}
+
 int av_expr_parse_and_eval(double *d, const char *s,
                            const char * const *const_names, const double *const_values,
                            const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -748,11 +1032,93 @@ static const char *const const_names[] = {
     0
 };
 
+#define BATCH_LANES 37    ///< more than one block, the last one partial
+
+static int same_double(double a, double b)
+{
+    return a == b || (isnan(a) && isnan(b));
+}
+
+/**
+ * Evaluate s for BATCH_LANES lanes with av_expr_eval_batch() and with one
+ * av_expr_eval() per lane, using two separately parsed copies so that the
+ * variables of both start from the same state.
+ * @param nb_arrays number of leading constants which get per-lane values,
+ *                  the others use the same value for all lanes
+ */
+static int check_batch(const char *s, int nb_arrays)
+{
+    double lane_values[2][BATCH_LANES], values[2];
+    const double *arrays[2] = { NULL, NULL };
+    double res[BATCH_LANES], ref;
+    AVExpr *e = NULL, *e_ref = NULL;
+    int i, j, mismatch = 0;
+
+    if (av_expr_parse(&e, s, const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0 ||
+        av_expr_parse(&e_ref, s, const_names, NULL, NULL, NULL, NULL, 0, NULL) < 0) {
+        av_expr_free(e);
+        return -1;
+    }
+
+    for (i = 0; i < BATCH_LANES; i++) {
+        lane_values[0][i] = const_values[0] + 0.5 * i - 4;
+        lane_values[1][i] = const_values[1] * (i % 5) - 3;
+    }
+    for (j = 0; j < nb_arrays; j++)
+        arrays[j] = lane_values[j];
+
+    av_expr_eval_batch(e, res, BATCH_LANES, const_values,
+                       nb_arrays ? arrays : NULL, NULL, NULL);
+    for (i = 0; i < BATCH_LANES; i++) {
+        for (j = 0; j < 2; j++)
+            values[j] = arrays[j] ? arrays[j][i] : const_values[j];
+        ref = av_expr_eval(e_ref, values, NULL);
+        if (!same_double(res[i], ref)) {
+            printf("lane %d with %d arrays: %f != %f\n", i, nb_arrays, res[i], ref);
+            mismatch = 1;
+        }
+    }
+
+    if (!nb_arrays)
+        printf("'%s' -> %s, %d instructions\n", s,
+               e->type == e_value ? "folded" : e->prog ? "compiled" : "sequential",
+               e->prog ? e->prog->nb_insn : 0);
+
+    av_expr_free(e);
+    av_expr_free(e_ref);
+    return mismatch;
+}
+
 int main(int argc, char **argv)
 {
     int i;
     double d;
     const char *const *expr;
+    static const char *const batch_exprs[] = {
+        "PI*2+E",
+        "-PI",
+        "sin(1)+cos(2)*PI",
+        "(1+2)*(3+4)+PI*(5-6)",
+        "if(gt(PI, 4), sin(PI), E)",
+        "ifnot(lt(PI, E), PI/E, -E)",
+        "clip(PI, 3.5, E)",
+        "between(PI, 2, 8) + mod(PI, E)",
+        "max(PI, E) - min(PI, E) + hypot(PI, E)",
+        "floor(PI) + ceil(E) + trunc(-PI) + sqrt(PI)",
+        "bitand(PI, 6) + bitor(E, 1) + gcd(PI, 12)",
+        "squish(PI) + gauss(E) + isnan(PI/0*0) + isinf(1/PI)",
+        "eq(floor(PI), 5) + gte(PI, E) + lte(PI, 3) + not(PI - 3.5)",
+        "pow(PI, E) / E",
+        "ld(0)*PI",
+        "1; PI; E",
+        "st(0, PI); ld(0)",
+        "st(1, ld(1) + PI); ld(1)",
+        "while(lt(ld(0), PI), st(0, ld(0) + 1))",
+        "PI + random(0)",
+        "root(ld(0) - abs(PI), 20)",
+        "taylor(PI, 1)",
+        NULL
+    };
     static const char *const exprs[] = {
         "",
         "1;2",
@@ -872,6 +1238,16 @@ int main(int argc, char **argv)
                            NULL, NULL, NULL, NULL, NULL, 0, NULL);
     printf("%f == 0.931322575\n", d);
 
+    printf("\nBatch evaluation\n");
+    for (i = 0; i < 2; i++) {
+        for (expr = i ? batch_exprs : exprs; *expr; expr++) {
+            int nb_arrays;
+            for (nb_arrays = 0; nb_arrays <= 2; nb_arrays++)
+                if (check_batch(*expr, nb_arrays) > 0)
+                    printf("'%s' -> batch mismatch\n", *expr);
+        }
+    }
+
     if (argc > 1 && !strcmp(argv[1], "-t")) {
         for (i = 0; i < 1050; i++) {
             START_TIMER;
@@ -86,6 +86,33 @@ int av_expr_parse(AVExpr **expr, const char *s,
  */
 double av_expr_eval(AVExpr *e, const double *const_values, void *opaque);
 
+/**
+ * Evaluate a previously parsed expression for nb different sets of
+ * constant values. This is much faster than calling av_expr_eval() nb
+ * times for expressions which do not use st(), random(), while(),
+ * taylor(), root() or print(). The results are the same.
+ *
+ * The functions from funcs1 and funcs2 may be called for values whose
+ * result is discarded, for example for both branches of if(), so they
+ * must not have side effects.
+ *
+ * @param res array where the nb results are written
+ * @param nb number of evaluations
+ * @param const_values array of values for the identifiers from av_expr_parse() const_names,
+ *                     used for all evaluations
+ * @param const_arrays NULL or an array with one entry per identifier from
+ *                     const_names; a non-NULL entry is an array of nb values
+ *                     overriding const_values, entry i being used for the
+ *                     i-th evaluation
+ * @param opaque a pointer which will be passed to all functions from funcs1 and funcs2
+ * @param opaques NULL or an array of nb pointers, overriding opaque: the i-th
+ *                evaluation passes opaques[i] to the functions
+ * @return >= 0 in case of success, a negative AVERROR code otherwise
+ */
+int av_expr_eval_batch(AVExpr *e, double *res, int nb,
+                       const double *const_values, const double * const *const_arrays,
+                       void *opaque, void * const *opaques);
+
 /**
  * Free a parsed expression previously created with av_expr_parse().
  */
@@ -28,9 +28,12 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/avutil.h"
+#include "libavutil/cpu.h"
 #include "libavutil/crc.h"
+#include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/lfg.h"
+#include "libavutil/time.h"
 #include "swscale.h"
 
 /* HACK Duplicated from swscale_internal.h.
@@ -340,6 +343,82 @@ static int fileTest(uint8_t *ref[4], int refStride[4], int w, int h, FILE *fp,
     return 0;
 }
 
+static int benchPair(enum AVPixelFormat srcFormat, enum AVPixelFormat dstFormat,
+                     int srcW, int srcH, int dstW, int dstH, int flags,
+                     int runs, AVLFG *rand)
+{
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL };
+    int srcStride[4], dstStride[4];
+    struct SwsContext *ctx = NULL;
+    int64_t t;
+    int i, size, res = -1;
+
+    size = av_image_alloc(src, srcStride, srcW, srcH, srcFormat, 32);
+    if (size < 0 || av_image_alloc(dst, dstStride, dstW, dstH, dstFormat, 32) < 0)
+        goto end;
+    /* random data, the palette of paletted formats included */
+    for (i = 0; i < size; i++)
+        src[0][i] = av_lfg_get(rand);
+
+    ctx = sws_getContext(srcW, srcH, srcFormat, dstW, dstH, dstFormat,
+                         flags, NULL, NULL, NULL);
+    if (!ctx) {
+        fprintf(stderr, "Failed to get %s ---> %s\n",
+                av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+        goto end;
+    }
+
+    /* warm up the caches and the lazily initialized tables */
+    sws_scale(ctx, (const uint8_t * const*)src, srcStride, 0, srcH, dst, dstStride);
+
+    t = av_gettime_relative();
+    for (i = 0; i < runs; i++)
+        sws_scale(ctx, (const uint8_t * const*)src, srcStride, 0, srcH, dst, dstStride);
+    t = FFMAX(av_gettime_relative() - t, 1);
+
+    printf(" %s %dx%d -> %s %dx%d flags=%2d %8.2f Mpix/s\n",
+           av_get_pix_fmt_name(srcFormat), srcW, srcH,
+           av_get_pix_fmt_name(dstFormat), dstW, dstH, flags,
+           (double)dstW * dstH * runs / t);
+    fflush(stdout);
+    res = 0;
+
+end:
+    sws_freeContext(ctx);
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    return res;
+}
+
+/* Time every supported pair, or only the given formats, at the given sizes
+ * and report the output throughput. */
+static void benchTest(enum AVPixelFormat srcFormat_in,
+                      enum AVPixelFormat dstFormat_in,
+                      int srcW, int srcH, int dstW, int dstH, int flags,
+                      int runs)
+{
+    enum AVPixelFormat srcFormat, dstFormat;
+    AVLFG rand;
+
+    av_lfg_init(&rand, 1);
+
+    for (srcFormat = srcFormat_in != AV_PIX_FMT_NONE ? srcFormat_in : 0;
+         srcFormat < AV_PIX_FMT_NB; srcFormat++) {
+        if (sws_isSupportedInput(srcFormat)) {
+            for (dstFormat = dstFormat_in != AV_PIX_FMT_NONE ? dstFormat_in : 0;
+                 dstFormat < AV_PIX_FMT_NB; dstFormat++) {
+                if (sws_isSupportedOutput(dstFormat))
+                    benchPair(srcFormat, dstFormat, srcW, srcH, dstW, dstH,
+                              flags, runs, &rand);
+                if (dstFormat_in != AV_PIX_FMT_NONE)
+                    break;
+            }
+        }
+        if (srcFormat_in != AV_PIX_FMT_NONE)
+            break;
+    }
+}
+
 #define W 96
 #define H 96
 
@@ -359,6 +438,10 @@ int main(int argc, char **argv)
     int res = -1;
     int i;
     FILE *fp = NULL;
+    int bench_runs = 0;
+    int bench_flags = SWS_BICUBIC;
+    int bench_srcW = 1920, bench_srcH = 1080;
+    int bench_dstW = 0,    bench_dstH = 0;
 
     if (!rgb_data || !data)
         return -1;
@@ -384,6 +467,28 @@ int main(int argc, char **argv)
                 fprintf(stderr, "invalid pixel format %s\n", argv[i + 1]);
                 return -1;
             }
+        } else if (!strcmp(argv[i], "-bench")) {
+            bench_runs = atoi(argv[i + 1]);
+            if (bench_runs <= 0) {
+                fprintf(stderr, "invalid number of runs %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-s") || !strcmp(argv[i], "-d")) {
+            int *w = argv[i][1] == 's' ? &bench_srcW : &bench_dstW;
+            int *h = argv[i][1] == 's' ? &bench_srcH : &bench_dstH;
+            if (av_parse_video_size(w, h, argv[i + 1]) < 0) {
+                fprintf(stderr, "invalid size %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-flags")) {
+            bench_flags = strtol(argv[i + 1], NULL, 0);
+        } else if (!strcmp(argv[i], "-cpuflags")) {
+            unsigned cpu_flags = av_get_cpu_flags();
+            if (av_parse_cpu_caps(&cpu_flags, argv[i + 1]) < 0) {
+                fprintf(stderr, "invalid cpu flags %s\n", argv[i + 1]);
+                return -1;
+            }
+            av_force_cpu_flags(cpu_flags);
         } else {
 bad_option:
             fprintf(stderr, "bad option or argument missing (%s)\n", argv[i]);
@@ -391,6 +496,20 @@ bad_option:
         }
     }
 
+    if (bench_runs) {
+        if (!bench_dstW)
+            bench_dstW = bench_srcW;
+        if (!bench_dstH)
+            bench_dstH = bench_srcH;
+        benchTest(srcFormat, dstFormat, bench_srcW, bench_srcH,
+                  bench_dstW, bench_dstH, bench_flags, bench_runs);
+        if (fp)
+            fclose(fp);
+        av_free(rgb_data);
+        res = 0;
+        goto error;
+    }
+
     sws = sws_getContext(W / 12, H / 12, AV_PIX_FMT_RGB32, W, H,
                          AV_PIX_FMT_YUVA420P, SWS_BILINEAR, NULL, NULL, NULL);
 
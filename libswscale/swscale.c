@@ -372,6 +372,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     const int chrSrcSliceH           = FF_CEIL_RSHIFT(srcSliceH,   c->chrSrcVSubSample);
     int should_dither                = is9_OR_10BPS(c->srcFormat) ||
                                        is16BPS(c->srcFormat);
+    const int bandEnd                = c->bandY + c->bandH;
     int lastDstY;
 
     /* vars which will change and which we need to store back in the context */
@@ -392,6 +393,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     SwsSlice *hout_slice = &c->slice[c->numSlice-2];
     SwsSlice *vout_slice = &c->slice[c->numSlice-1];
     SwsFilterDescriptor *desc = c->desc;
+    uint8_t *vout_dst[4];
 
     int hasLumHoles = 1;
     int hasChrHoles = 1;
@@ -456,7 +458,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     if (srcSliceY == 0) {
         lumBufIndex  = -1;
         chrBufIndex  = -1;
-        dstY         = 0;
+        dstY         = c->bandY;
         lastInLumBuf = -1;
         lastInChrBuf = -1;
     }
@@ -473,9 +475,16 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     ff_init_slice_from_src(src_slice, (uint8_t**)src, srcStride, c->srcW,
             srcSliceY, srcSliceH, chrSrcSliceY, chrSrcSliceH);
 
-    ff_init_slice_from_src(vout_slice, (uint8_t**)dst, dstStride, c->dstW,
-            dstY, dstH, dstY >> c->chrDstVSubSample,
-            FF_CEIL_RSHIFT(dstH, c->chrDstVSubSample));
+    {
+        int i;
+        for (i = 0; i < 4; i++) {
+            int y = i == 1 || i == 2 ? dstY >> c->chrDstVSubSample : dstY;
+            vout_dst[i] = dst[i] ? dst[i] + y * dstStride[i] : NULL;
+        }
+    }
+    ff_init_slice_from_src(vout_slice, vout_dst, dstStride, c->dstW,
+            dstY, bandEnd - dstY, dstY >> c->chrDstVSubSample,
+            FF_CEIL_RSHIFT(bandEnd, c->chrDstVSubSample) - (dstY >> c->chrDstVSubSample));
     if (srcSliceY == 0) {
         hout_slice->plane[0].sliceY = lastInLumBuf + 1;
         hout_slice->plane[1].sliceY = lastInChrBuf + 1;
@@ -490,7 +499,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     }
 #endif
 
-    for (; dstY < dstH; dstY++) {
+    for (; dstY < bandEnd; dstY++) {
         const int chrDstY = dstY >> c->chrDstVSubSample;
 #ifndef NEW_FILTER
         uint8_t *dest[4]  = {
@@ -1034,6 +1043,61 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
  * swscale wrapper, so we don't need to export the SwsContext.
  * Assumes planar YUV to be in YUV order instead of YVU.
  */
+typedef struct BandArgs {
+    const uint8_t **src;
+    int *srcStride;
+    int srcSliceY, srcSliceH;
+    uint8_t **dst;
+    int *dstStride;
+} BandArgs;
+
+static void scale_band(SwsContext *c, void *arg, int jobnr)
+{
+    const BandArgs *a = arg;
+    SwsContext *band  = c->slice_ctx[jobnr];
+    const uint8_t *src[4];
+    uint8_t *dst[4];
+    int srcStride[4], dstStride[4];
+
+    /* swscale() adjusts these in place */
+    memcpy(src,       a->src,       sizeof(src));
+    memcpy(srcStride, a->srcStride, sizeof(srcStride));
+    memcpy(dst,       a->dst,       sizeof(dst));
+    memcpy(dstStride, a->dstStride, sizeof(dstStride));
+
+    band->swscale(band, src, srcStride, a->srcSliceY, a->srcSliceH,
+                  dst, dstStride);
+}
+
+/**
+ * Scale with the band contexts when the whole picture is available,
+ * with c itself otherwise.
+ */
+static int scale_internal(SwsContext *c, const uint8_t *src[],
+                          int srcStride[], int srcSliceY, int srcSliceH,
+                          uint8_t *dst[], int dstStride[])
+{
+    BandArgs args = { src, srcStride, srcSliceY, srcSliceH, dst, dstStride };
+    int i, ret = 0;
+
+    if (!HAVE_THREADS || !c->nb_slice_ctx || srcSliceY || srcSliceH != c->srcH)
+        return c->swscale(c, src, srcStride, srcSliceY, srcSliceH,
+                          dst, dstStride);
+
+    if (usePal(c->srcFormat)) {
+        for (i = 0; i < c->nb_slice_ctx; i++) {
+            memcpy(c->slice_ctx[i]->pal_yuv, c->pal_yuv, sizeof(c->pal_yuv));
+            memcpy(c->slice_ctx[i]->pal_rgb, c->pal_rgb, sizeof(c->pal_rgb));
+        }
+    }
+
+    ff_sws_thread_execute(c, scale_band, &args);
+
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        ret += c->slice_ctx[i]->dstY - c->slice_ctx[i]->bandY;
+    return ret;
+}
+
 int attribute_align_arg sws_scale(struct SwsContext *c,
                                   const uint8_t * const srcSlice[],
                                   const int srcStride[], int srcSliceY,
@@ -1235,8 +1299,8 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
         if (srcSliceY + srcSliceH == c->srcH)
             c->sliceDir = 0;
 
-        ret = c->swscale(c, src2, srcStride2, srcSliceY, srcSliceH, dst2,
-                          dstStride2);
+        ret = scale_internal(c, src2, srcStride2, srcSliceY, srcSliceH, dst2,
+                             dstStride2);
     } else {
         // slices go from bottom to top => we flip the image internally
         int srcStride2[4] = { -srcStride[0], -srcStride[1], -srcStride[2],
@@ -1261,8 +1325,8 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
         if (!srcSliceY)
             c->sliceDir = 0;
 
-        ret = c->swscale(c, src2, srcStride2, c->srcH-srcSliceY-srcSliceH,
-                          srcSliceH, dst2, dstStride2);
+        ret = scale_internal(c, src2, srcStride2, c->srcH-srcSliceY-srcSliceH,
+                             srcSliceH, dst2, dstStride2);
     }
 
 
@@ -323,6 +323,16 @@ typedef struct SwsContext {
     int cascaded1_tmpStride[4];
     uint8_t *cascaded1_tmp[4];
 
+    /* With several threads the destination is split into horizontal bands,
+     * each scaled by a context of its own with its own filters and ring
+     * buffers.
+     */
+    int nb_threads;               ///< Number of threads requested by the user, 0 for automatic.
+    struct SwsContext **slice_ctx;
+    int nb_slice_ctx;
+    struct SwsThreadContext *thread;
+    int bandY, bandH;             ///< Destination lines output by this context.
+
     double gamma_value;
     int gamma_flag;
     int is_internal_gamma;
@@ -1020,6 +1030,16 @@ int ff_init_filters(SwsContext *c);
 // Free all filter data
 int ff_free_filters(SwsContext *c);
 
+int  ff_sws_thread_init(SwsContext *c);
+void ff_sws_thread_free(SwsContext *c);
+
+/**
+ * Run func once for each of the band contexts of c, in parallel.
+ */
+void ff_sws_thread_execute(SwsContext *c,
+                           void (*func)(SwsContext *c, void *arg, int jobnr),
+                           void *arg);
+
 /*
  function for applying ring buffer logic into slice s
  It checks if the slice can hold more @lum lines, if yes
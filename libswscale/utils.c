@@ -830,6 +830,12 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
     int need_reinit = 0;
+    int i;
+
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange, table,
+                                 dstRange, brightness, contrast, saturation);
+
     memmove(c->srcColorspaceTable, inv_table, sizeof(int) * 4);
     memmove(c->dstColorspaceTable, table, sizeof(int) * 4);
 
@@ -1099,6 +1105,51 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
+/* Bands smaller than this spend more time on the source lines they share
+ * with their neighbours than they gain from running in parallel. */
+#define MIN_BAND_LINES 16
+
+static av_cold int init_slice_contexts(SwsContext *c, SwsFilter *srcFilter,
+                                       SwsFilter *dstFilter)
+{
+    int nb_bands = c->nb_threads ? c->nb_threads : av_cpu_count();
+    int band_h, i, ret;
+
+    /* error diffusion carries its state from one line to the next */
+    if (c->dither == SWS_DITHER_ED)
+        return 0;
+
+    nb_bands = FFMIN(nb_bands, c->dstH / MIN_BAND_LINES);
+    if (nb_bands < 2)
+        return 0;
+
+    /* keep the bands on chroma line boundaries */
+    band_h   = FFALIGN((c->dstH + nb_bands - 1) / nb_bands, 1 << c->chrDstVSubSample);
+    nb_bands = (c->dstH + band_h - 1) / band_h;
+
+    c->slice_ctx = av_mallocz_array(nb_bands, sizeof(*c->slice_ctx));
+    if (!c->slice_ctx)
+        return AVERROR(ENOMEM);
+    c->nb_slice_ctx = nb_bands;
+
+    for (i = 0; i < nb_bands; i++) {
+        SwsContext *band = c->slice_ctx[i] = sws_alloc_context();
+        if (!band)
+            return AVERROR(ENOMEM);
+        ret = av_opt_copy(band, c);
+        if (ret < 0)
+            return ret;
+        band->nb_threads = 1;
+        ret = sws_init_context(band, srcFilter, dstFilter);
+        if (ret < 0)
+            return ret;
+        band->bandY = i * band_h;
+        band->bandH = FFMIN(band_h, c->dstH - band->bandY);
+    }
+
+    return ff_sws_thread_init(c);
+}
+
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                              SwsFilter *dstFilter)
 {
@@ -1127,6 +1178,9 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
 
     unscaled = (srcW == dstW && srcH == dstH);
 
+    c->bandY = 0;
+    c->bandH = dstH;
+
     c->srcRange |= handle_jpeg(&c->srcFormat);
     c->dstRange |= handle_jpeg(&c->dstFormat);
 
@@ -1779,7 +1833,12 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     }
 
     c->swscale = ff_getSwsFunc(c);
-    return ff_init_filters(c);
+    ret = ff_init_filters(c);
+    if (ret < 0)
+        return ret;
+    if (HAVE_THREADS && c->nb_threads != 1)
+        return init_slice_contexts(c, srcFilter, dstFilter);
+    return 0;
 fail: // FIXME replace things by appropriate error codes
     if (ret == RETCODE_USE_CASCADE)  {
         int tmpW = sqrt(srcW * (int64_t)dstW);
@@ -2286,6 +2345,12 @@ void sws_freeContext(SwsContext *c)
     av_freep(&c->yuvTable);
     av_freep(&c->formatConvBuffer);
 
+    if (HAVE_THREADS)
+        ff_sws_thread_free(c);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+
     sws_freeContext(c->cascaded_context[0]);
     sws_freeContext(c->cascaded_context[1]);
     sws_freeContext(c->cascaded_context[2]);
@@ -22,20 +22,24 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
-
-minshort:      times 8 dw 0x8000
-yuv2yuvX_16_start:  times 4 dd 0x4000 - 0x40000000
-yuv2yuvX_10_start:  times 4 dd 0x10000
-yuv2yuvX_9_start:   times 4 dd 0x20000
-yuv2yuvX_10_upper:  times 8 dw 0x3ff
-yuv2yuvX_9_upper:   times 8 dw 0x1ff
-pd_4:          times 4 dd 4
-pd_4min0x40000:times 4 dd 4 - (0x40000)
-pw_16:         times 8 dw 16
-pw_32:         times 8 dw 32
-pw_512:        times 8 dw 512
-pw_1024:       times 8 dw 1024
+SECTION_RODATA 32
+
+minshort:      times 16 dw 0x8000
+yuv2yuvX_16_start:  times 8 dd 0x4000 - 0x40000000
+yuv2yuvX_10_start:  times 8 dd 0x10000
+yuv2yuvX_9_start:   times 8 dd 0x20000
+yuv2yuvX_10_upper:  times 16 dw 0x3ff
+yuv2yuvX_9_upper:   times 16 dw 0x1ff
+pd_4:          times 8 dd 4
+pd_4min0x40000:times 8 dd 4 - (0x40000)
+pw_16:         times 16 dw 16
+pw_32:         times 16 dw 32
+pw_512:        times 16 dw 512
+pw_1024:       times 16 dw 1024
+nv12_shuf:     db 0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15
+               db 0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15
+nv21_shuf:     db 8, 0, 9, 1, 10, 2, 11, 3, 12, 4, 13, 5, 14, 6, 15, 7
+               db 8, 0, 9, 1, 10, 2, 11, 3, 12, 4, 13, 5, 14, 6, 15, 7
 
 SECTION .text
 
@@ -271,6 +275,181 @@ yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
 %endif
 
+; The AVX2 version does 16 pixels per iteration and, like the SSE ones, may
+; write up to 7 pixels past dstW.
+%macro yuv2planeX_avx2_fn 1
+cglobal yuv2planeX_%1, 7, 9, 10, filter, fltsize, src, dst, w, dither, offset
+%if %1 == 8
+    ; dither for pixels 0-3 in m8 and 4-7 in m9, repeated in both lanes
+    ; since the pattern is 8 pixels long
+    pxor            m6,  m6
+    movq           xm8, [ditherq]
+    test       offsetd,  offsetd
+    jz              .no_rot
+    punpcklqdq     xm8,  xm8
+    palignr        xm8,  xm8,  3
+.no_rot:
+    punpcklbw      xm8,  xm6
+    punpckhwd      xm9,  xm8,  xm6
+    punpcklwd      xm8,  xm6
+    pslld          xm8,  12
+    pslld          xm9,  12
+    vinserti128     m8,  m8,  xm8,  1
+    vinserti128     m9,  m9,  xm9,  1
+%else ; %1 == 9/10
+    mova            m8, [yuv2yuvX_%1_start]
+    mova            m9,  m8
+%endif ; %1 == 8/9/10
+
+    xor             r5,  r5
+
+.pixelloop:
+    mova            m2,  m8
+    mova            m1,  m9
+    movsxd          r7,  fltsized
+.filterloop:
+    mov             r8, [srcq+gprsize*r7-2*gprsize]
+    movu            m3, [r8+r5*2]
+    mov             r8, [srcq+gprsize*r7-gprsize]
+    movu            m4, [r8+r5*2]
+    vpbroadcastd    m0, [filterq+2*r7-4] ; coeff[0], coeff[1]
+
+    ; pixels 0-3 and 8-11 in m5, 4-7 and 12-15 in m3
+    punpcklwd       m5,  m3,  m4
+    punpckhwd       m3,  m4
+    pmaddwd         m5,  m0
+    pmaddwd         m3,  m0
+    paddd           m2,  m5
+    paddd           m1,  m3
+
+    sub             r7,  2
+    jg .filterloop
+
+    psrad           m2,  27 - %1
+    psrad           m1,  27 - %1
+%if %1 == 8
+    packssdw        m2,  m1
+    packuswb        m2,  m2
+    vpermq          m2,  m2,  q0020
+    cmp             wd,  8
+    jle .last
+    movu   [dstq+r5*1], xm2
+%else ; %1 == 9/10
+    packusdw        m2,  m1
+    pminsw          m2, [yuv2yuvX_%1_upper]
+    cmp             wd,  8
+    jle .last
+    movu   [dstq+r5*2],  m2
+%endif ; %1 == 8/9/10
+
+    add             r5,  16
+    sub             wd,  16
+    jg .pixelloop
+    RET
+
+.last:
+%if %1 == 8
+    movq   [dstq+r5*1], xm2
+%else ; %1 == 9/10
+    movu   [dstq+r5*2], xm2
+%endif ; %1 == 8/9/10
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2planeX_avx2_fn  8
+yuv2planeX_avx2_fn  9
+yuv2planeX_avx2_fn 10
+%endif
+
+;-----------------------------------------------------------------------------
+; void yuv2nv12cX_<opt>(const int16_t *filter, int filterSize,
+;                       const int16_t **usrc, const int16_t **vsrc,
+;                       uint8_t *dst, int dstW, const uint8_t *dither)
+;
+; Vertically scale and interleave the chroma planes of NV12/NV21 output,
+; 16 pixels per iteration. $dstW must be a multiple of 16 and $filterSize
+; a multiple of 2.
+;-----------------------------------------------------------------------------
+
+%macro yuv2nv12cX_fn 1
+cglobal yuv2%1cX, 7, 10, 14, filter, fltsize, usrc, vsrc, dst, w, dither
+    ; U uses dither[i & 7] and V dither[(i + 3) & 7]
+    pxor            m6,  m6
+    movq          xm10, [ditherq]
+    punpcklqdq    xm11, xm10, xm10
+    palignr       xm11, xm11, 3
+    punpcklbw     xm10, xm6
+    punpcklbw     xm11, xm6
+    punpckhwd     xm12, xm10, xm6
+    punpcklwd     xm10, xm6
+    punpckhwd     xm13, xm11, xm6
+    punpcklwd     xm11, xm6
+    pslld         xm10, 12
+    pslld         xm11, 12
+    pslld         xm12, 12
+    pslld         xm13, 12
+    vinserti128    m10, m10, xm10, 1
+    vinserti128    m11, m11, xm11, 1
+    vinserti128    m12, m12, xm12, 1
+    vinserti128    m13, m13, xm13, 1
+
+    xor             r6,  r6
+
+.pixelloop:
+    mova            m1,  m10
+    mova            m2,  m12
+    mova            m3,  m11
+    mova            m4,  m13
+    movsxd          r7,  fltsized
+.filterloop:
+    vpbroadcastd    m0, [filterq+2*r7-4]
+    mov             r8, [usrcq+gprsize*r7-2*gprsize]
+    mov             r9, [usrcq+gprsize*r7-gprsize]
+    movu            m5, [r8+r6*2]
+    movu            m7, [r9+r6*2]
+    punpcklwd       m8,  m5,  m7
+    punpckhwd       m5,  m7
+    pmaddwd         m8,  m0
+    pmaddwd         m5,  m0
+    paddd           m1,  m8
+    paddd           m2,  m5
+    mov             r8, [vsrcq+gprsize*r7-2*gprsize]
+    mov             r9, [vsrcq+gprsize*r7-gprsize]
+    movu            m5, [r8+r6*2]
+    movu            m7, [r9+r6*2]
+    punpcklwd       m8,  m5,  m7
+    punpckhwd       m5,  m7
+    pmaddwd         m8,  m0
+    pmaddwd         m5,  m0
+    paddd           m3,  m8
+    paddd           m4,  m5
+    sub             r7,  2
+    jg .filterloop
+
+    psrad           m1,  19
+    psrad           m2,  19
+    psrad           m3,  19
+    psrad           m4,  19
+    packssdw        m1,  m2
+    packssdw        m3,  m4
+    packuswb        m1,  m3                 ; U 0-7, V 0-7 | U 8-15, V 8-15
+    pshufb          m1, [%1_shuf]
+    movu   [dstq+r6*2],  m1
+
+    add             r6,  16
+    sub             wd,  16
+    jg .pixelloop
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2nv12cX_fn nv12
+yuv2nv12cX_fn nv21
+%endif
+
 ; %1=outout-bpc, %2=alignment (u/a)
 %macro yuv2plane1_mainloop 2
 .loop_%2:
@@ -280,6 +459,9 @@ yuv2planeX_fn 10,  7, 5
     psraw           m0, 7
     psraw           m1, 7
     packuswb        m0, m1
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+%endif
     mov%2    [dstq+wq], m0
 %elif %1 == 16
     paddd           m0, m4, [srcq+wq*4+mmsize*0]
@@ -293,6 +475,10 @@ yuv2planeX_fn 10,  7, 5
 %if cpuflag(sse4) ; avx/sse4
     packusdw        m0, m1
     packusdw        m2, m3
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+%endif
 %else ; mmx/sse2
     packssdw        m0, m1
     packssdw        m2, m3
@@ -338,20 +524,23 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4               ; zero
 
     ; create registers holding dither
-    movq            m3, [ditherq]        ; dither
+    movq           xm3, [ditherq]        ; dither
     test       offsetd, offsetd
     jz              .no_rot
-%if mmsize == 16
-    punpcklqdq      m3, m3
-%endif ; mmsize == 16
-    PALIGNR         m3, m3, 3, m2
+%if mmsize >= 16
+    punpcklqdq     xm3, xm3
+%endif ; mmsize >= 16
+    PALIGNR        xm3, xm3, 3, xm2
 .no_rot:
 %if mmsize == 8
     mova            m2, m3
     punpckhbw       m3, m4               ; byte->word
     punpcklbw       m2, m4               ; byte->word
 %else
-    punpcklbw       m3, m4
+    punpcklbw      xm3, xm4
+%if mmsize == 32
+    vinserti128     m3, m3, xm3, 1       ; the dither repeats every 8 pixels
+%endif
     mova            m2, m3
 %endif
 %elif %1 == 9
@@ -374,14 +563,14 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     ; actual pixel scaling
 %if mmsize == 8
     yuv2plane1_mainloop %1, a
-%else ; mmsize == 16
-    test          dstq, 15
+%else ; mmsize == 16/32
+    test          dstq, mmsize - 1
     jnz .unaligned
     yuv2plane1_mainloop %1, a
     REP_RET
 .unaligned:
     yuv2plane1_mainloop %1, u
-%endif ; mmsize == 8/16
+%endif ; mmsize == 8/16/32
     REP_RET
 %endmacro
 
@@ -411,3 +600,12 @@ yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
 yuv2plane1_fn 16, 5, 3
 %endif
+
+; The AVX2 versions require dstW to be a multiple of 32.
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2plane1_fn  8, 5, 5
+yuv2plane1_fn  9, 5, 3
+yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 16, 5, 3
+%endif
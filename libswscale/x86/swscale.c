@@ -355,6 +355,7 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+VSCALEX_FUNCS(avx2);
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -371,6 +372,67 @@ VSCALE_FUNCS(mmx, mmxext);
 VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
+VSCALE_FUNCS(avx2, avx2);
+
+void ff_yuv2nv12cX_avx2(const int16_t *filter, int filterSize,
+                        const int16_t **usrc, const int16_t **vsrc,
+                        uint8_t *dst, int dstW, const uint8_t *dither);
+void ff_yuv2nv21cX_avx2(const int16_t *filter, int filterSize,
+                        const int16_t **usrc, const int16_t **vsrc,
+                        uint8_t *dst, int dstW, const uint8_t *dither);
+
+#if HAVE_AVX2_EXTERNAL
+/* The AVX2 yuv2plane1 works on blocks of 32 pixels, the AVX version
+ * finishes the line so as not to write further past its end. */
+#define VSCALE_AVX2_FUNC(size) \
+static void yuv2plane1_ ## size ## _avx2(const int16_t *src, uint8_t *dest, int dstW, \
+                                         const uint8_t *dither, int offset) \
+{ \
+    int n = dstW & ~31; \
+    if (n) \
+        ff_yuv2plane1_ ## size ## _avx2(src, dest, n, dither, offset); \
+    if (dstW > n) \
+        ff_yuv2plane1_ ## size ## _avx((const int16_t *)((const uint8_t *)src + n * (size == 16 ? 4 : 2)), \
+                                       dest + n * ((size + 7) >> 3), dstW - n, dither, offset); \
+}
+
+VSCALE_AVX2_FUNC(8)
+VSCALE_AVX2_FUNC(9)
+VSCALE_AVX2_FUNC(10)
+VSCALE_AVX2_FUNC(16)
+
+#if ARCH_X86_64
+static void yuv2nv12cX_avx2(SwsContext *c, const int16_t *chrFilter, int chrFilterSize,
+                            const int16_t **chrUSrc, const int16_t **chrVSrc,
+                            uint8_t *dest, int chrDstW)
+{
+    const uint8_t *chrDither = c->chrDither8;
+    int nv12 = c->dstFormat == AV_PIX_FMT_NV12;
+    int n    = chrFilterSize & 1 ? 0 : chrDstW & ~15;
+    int i;
+
+    if (n) {
+        if (nv12)
+            ff_yuv2nv12cX_avx2(chrFilter, chrFilterSize, chrUSrc, chrVSrc, dest, n, chrDither);
+        else
+            ff_yuv2nv21cX_avx2(chrFilter, chrFilterSize, chrUSrc, chrVSrc, dest, n, chrDither);
+    }
+
+    for (i = n; i < chrDstW; i++) {
+        int u = chrDither[i & 7] << 12;
+        int v = chrDither[(i + 3) & 7] << 12;
+        int j;
+        for (j = 0; j < chrFilterSize; j++) {
+            u += chrUSrc[j][i] * chrFilter[j];
+            v += chrVSrc[j][i] * chrFilter[j];
+        }
+
+        dest[2 * i +  !nv12] = av_clip_uint8(u >> 19);
+        dest[2 * i + !!nv12] = av_clip_uint8(v >> 19);
+    }
+}
+#endif /* ARCH_X86_64 */
+#endif /* HAVE_AVX2_EXTERNAL */
 
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
@@ -604,4 +666,21 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#if HAVE_AVX2_EXTERNAL
+    if (EXTERNAL_AVX2(cpu_flags)) {
+#if ARCH_X86_64
+        ASSIGN_VSCALEX_FUNC(c->yuv2planeX, avx2, , 1);
+        if ((c->dstFormat == AV_PIX_FMT_NV12 || c->dstFormat == AV_PIX_FMT_NV21) &&
+            !c->use_mmx_vfilter)
+            c->yuv2nv12cX = yuv2nv12cX_avx2;
+#endif
+        switch (c->dstBpc) {
+        case 16: if (!isBE(c->dstFormat)) c->yuv2plane1 = yuv2plane1_16_avx2; break;
+        case 10: if (!isBE(c->dstFormat)) c->yuv2plane1 = yuv2plane1_10_avx2; break;
+        case 9:  if (!isBE(c->dstFormat)) c->yuv2plane1 = yuv2plane1_9_avx2;  break;
+        case 8:                           c->yuv2plane1 = yuv2plane1_8_avx2;  break;
+        }
+    }
+#endif
 }
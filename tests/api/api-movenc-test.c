@@ -0,0 +1,153 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * movenc reserve_moov test.
+ * Muxes the same packets with -movflags reserve_moov, sizing the reserved
+ * region from moov_size or from the stream durations, and prints the top
+ * level atoms of each file, which show whether the moov atom was written
+ * into the reserved region or the data was shifted to make room for it.
+ */
+
+#include "libavformat/avformat.h"
+#include "libavutil/dict.h"
+#include "libavutil/intreadwrite.h"
+
+#define NB_PACKETS  50
+#define PACKET_SIZE 100
+
+static int mux_file(const char *filename, const char *moov_size, int64_t duration)
+{
+    AVFormatContext *oc = NULL;
+    AVDictionary *opts = NULL;
+    AVStream *st;
+    AVPacket pkt;
+    uint8_t data[PACKET_SIZE];
+    int i, result;
+
+    result = avformat_alloc_output_context2(&oc, NULL, "mp4", filename);
+    if (result < 0)
+        return result;
+    oc->flags |= AVFMT_FLAG_BITEXACT;
+
+    st = avformat_new_stream(oc, NULL);
+    if (!st) {
+        result = AVERROR(ENOMEM);
+        goto end;
+    }
+    st->codec->codec_type = AVMEDIA_TYPE_VIDEO;
+    st->codec->codec_id   = AV_CODEC_ID_MPEG4;
+    st->codec->width      = 64;
+    st->codec->height     = 48;
+    st->codec->flags     |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    st->time_base         = (AVRational){ 1, 25 };
+    st->avg_frame_rate    = (AVRational){ 25, 1 };
+    st->duration          = duration;
+
+    result = avio_open(&oc->pb, filename, AVIO_FLAG_WRITE);
+    if (result < 0)
+        goto end;
+
+    av_dict_set(&opts, "movflags", "reserve_moov", 0);
+    if (moov_size)
+        av_dict_set(&opts, "moov_size", moov_size, 0);
+    result = avformat_write_header(oc, &opts);
+    if (result < 0)
+        goto end;
+
+    for (i = 0; i < NB_PACKETS; i++) {
+        memset(data, i, sizeof(data));
+        av_init_packet(&pkt);
+        pkt.data         = data;
+        pkt.size         = sizeof(data);
+        pkt.stream_index = 0;
+        pkt.pts = pkt.dts = i;
+        pkt.duration     = 1;
+        pkt.flags        = i % 10 ? 0 : AV_PKT_FLAG_KEY;
+        result = av_write_frame(oc, &pkt);
+        if (result < 0)
+            goto end;
+    }
+    result = av_write_trailer(oc);
+
+end:
+    av_dict_free(&opts);
+    if (oc)
+        avio_closep(&oc->pb);
+    avformat_free_context(oc);
+    return result;
+}
+
+static int print_atoms(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    uint8_t header[8];
+
+    if (!f)
+        return -1;
+    while (fread(header, 1, sizeof(header), f) == sizeof(header)) {
+        uint32_t size = AV_RB32(header);
+        printf(" %.4s %u", (const char *)header + 4, size);
+        if (size < 8 || fseek(f, size - 8, SEEK_CUR)) {
+            fclose(f);
+            return -1;
+        }
+    }
+    printf("\n");
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        const char *moov_size;
+        int64_t duration;
+    } tests[] = {
+        { "moov_size fits",      "4096", 0 },
+        { "moov_size too small", "64",   0 },
+        { "stream durations",    NULL,   NB_PACKETS },
+        { "estimate too large",  NULL,   INT64_MAX / 2 },
+    };
+    int i, result;
+
+    if (argc < 2) {
+        av_log(NULL, AV_LOG_ERROR, "Incorrect input: expected %s <name of the output file>\n", argv[0]);
+        return 1;
+    }
+
+    av_register_all();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        result = mux_file(argv[1], tests[i].moov_size, tests[i].duration);
+        if (result < 0) {
+            av_log(NULL, AV_LOG_ERROR, "Error muxing %s\n", tests[i].name);
+            return 1;
+        }
+        printf("%s:", tests[i].name);
+        if (print_atoms(argv[1]) < 0) {
+            av_log(NULL, AV_LOG_ERROR, "Error parsing %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
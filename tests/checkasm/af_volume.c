@@ -0,0 +1,94 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/af_volume.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define SAMPLES  1024
+#define BUF_SIZE (SAMPLES * 4)
+
+#define randomize_buffer(buf)                 \
+    do {                                      \
+        int k;                                \
+        for (k = 0; k < BUF_SIZE; k += 4)     \
+            AV_WN32A(buf + k, rnd());         \
+    } while (0)
+
+/* The s32 versions work in double precision and round halves to even, so
+ * they may be off by one from the C code. */
+static int samples_differ(const uint8_t *a, const uint8_t *b, int nb_samples,
+                          enum AVSampleFormat fmt)
+{
+    const int32_t *a32 = (const int32_t *)a;
+    const int32_t *b32 = (const int32_t *)b;
+    int i;
+
+    if (fmt == AV_SAMPLE_FMT_S16)
+        return memcmp(a, b, nb_samples * 2);
+
+    for (i = 0; i < nb_samples; i++)
+        if (FFABS((int64_t)a32[i] - b32[i]) > 1)
+            return 1;
+    return 0;
+}
+
+static void check_scale_samples(enum AVSampleFormat fmt, int volume_i)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    VolumeContext vol = { 0 };
+    declare_func(void, uint8_t *dst, const uint8_t *src, int nb_samples,
+                 int volume);
+
+    vol.sample_fmt = fmt;
+    vol.volume_i   = volume_i;
+    ff_volume_init(&vol);
+
+    if (check_func(vol.scale_samples, "scale_samples_%s_%s",
+                   av_get_sample_fmt_name(fmt),
+                   volume_i < 0x100 ? "attenuate" : "amplify")) {
+        /* the filter always passes a multiple of samples_align */
+        int nb_samples = FFALIGN(1 + rnd() % SAMPLES, vol.samples_align);
+
+        if (nb_samples > SAMPLES)
+            nb_samples -= vol.samples_align;
+        randomize_buffer(src);
+        memset(dst0, 0, BUF_SIZE);
+        memset(dst1, 0, BUF_SIZE);
+        call_ref(dst0, src, nb_samples, volume_i);
+        call_new(dst1, src, nb_samples, volume_i);
+        if (samples_differ(dst0, dst1, nb_samples, fmt))
+            fail();
+        bench_new(dst1, src, SAMPLES, volume_i);
+    }
+}
+
+void checkasm_check_af_volume(void)
+{
+    /* volumes are in 8.8 fixed point */
+    check_scale_samples(AV_SAMPLE_FMT_S16, 1 + rnd() % 0xff);
+    check_scale_samples(AV_SAMPLE_FMT_S16, 0x100 + rnd() % 0x7f00);
+    check_scale_samples(AV_SAMPLE_FMT_S32, 1 + rnd() % 0xff);
+    check_scale_samples(AV_SAMPLE_FMT_S32, 0x100 + rnd() % 0xff00);
+    report("scale_samples");
+}
@@ -20,6 +20,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -27,6 +28,8 @@
 #include "checkasm.h"
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/intfloat.h"
 #include "libavutil/random_seed.h"
 
 #if HAVE_IO_H
@@ -57,15 +60,93 @@ static const struct {
     const char *name;
     void (*func)(void);
 } tests[] = {
+#if CONFIG_AVCODEC
 #if CONFIG_BSWAPDSP
     { "bswapdsp", checkasm_check_bswapdsp },
 #endif
+#if CONFIG_FMTCONVERT
+    { "fmtconvert", checkasm_check_fmtconvert },
+#endif
+#if CONFIG_H264DSP
+    { "h264dsp", checkasm_check_h264dsp },
+#endif
 #if CONFIG_H264PRED
     { "h264pred", checkasm_check_h264pred },
 #endif
 #if CONFIG_H264QPEL
     { "h264qpel", checkasm_check_h264qpel },
 #endif
+#if CONFIG_HEVC_DECODER
+    { "hevcdsp", checkasm_check_hevcdsp },
+    { "hevcpred", checkasm_check_hevcpred },
+#endif
+#if CONFIG_ME_CMP
+    { "me_cmp", checkasm_check_me_cmp },
+#endif
+#if CONFIG_VIDEODSP
+    { "videodsp", checkasm_check_videodsp },
+#endif
+#if CONFIG_VP9_DECODER
+    { "vp9dsp", checkasm_check_vp9dsp },
+#endif
+#endif
+#if CONFIG_AVFILTER
+#if CONFIG_VOLUME_FILTER
+    { "af_volume", checkasm_check_af_volume },
+#endif
+#if CONFIG_DRMDEC_FILTER || CONFIG_DRMEMB_FILTER
+    { "vf_drm", checkasm_check_vf_drm },
+#endif
+#if CONFIG_EQ_FILTER
+    { "vf_eq", checkasm_check_vf_eq },
+#endif
+#if CONFIG_FSPP_FILTER
+    { "vf_fspp", checkasm_check_vf_fspp },
+#endif
+#if CONFIG_GRADFUN_FILTER
+    { "vf_gradfun", checkasm_check_vf_gradfun },
+#endif
+#if CONFIG_DEFOG_FILTER
+    { "vf_guidefilter", checkasm_check_vf_guidefilter },
+#endif
+#if CONFIG_IDET_FILTER
+    { "vf_idet", checkasm_check_vf_idet },
+#endif
+#if CONFIG_INTERLACE_FILTER
+    { "vf_interlace", checkasm_check_vf_interlace },
+#endif
+#if CONFIG_NOISE_FILTER
+    { "vf_noise", checkasm_check_vf_noise },
+#endif
+#if CONFIG_PP7_FILTER
+    { "vf_pp7", checkasm_check_vf_pp7 },
+#endif
+#if CONFIG_PSNR_FILTER
+    { "vf_psnr", checkasm_check_vf_psnr },
+#endif
+#if CONFIG_PULLUP_FILTER
+    { "vf_pullup", checkasm_check_vf_pullup },
+#endif
+#if CONFIG_SPP_FILTER
+    { "vf_spp", checkasm_check_vf_spp },
+#endif
+#if CONFIG_SSIM_FILTER
+    { "vf_ssim", checkasm_check_vf_ssim },
+#endif
+#if CONFIG_TINTERLACE_FILTER
+    { "vf_tinterlace", checkasm_check_vf_tinterlace },
+#endif
+#if CONFIG_YADIF_FILTER
+    { "vf_yadif", checkasm_check_vf_yadif },
+#endif
+#endif
+#if CONFIG_SWRESAMPLE
+    { "swresample", checkasm_check_swresample },
+#endif
+#if CONFIG_SWSCALE
+    { "swscale", checkasm_check_swscale },
+#endif
+    { "float_dsp", checkasm_check_float_dsp },
     { NULL }
 };
 
@@ -131,6 +212,7 @@ static struct {
     CheckasmFunc *current_func;
     CheckasmFuncVersion *current_func_ver;
     const char *current_test_name;
+    const char *test_name;
     const char *bench_pattern;
     int bench_pattern_len;
     int num_checked;
@@ -186,6 +268,69 @@ static void color_printf(int color, const char *fmt, ...)
     }
 }
 
+static int is_negative(union av_intfloat32 u)
+{
+    return u.i >> 31;
+}
+
+int float_near_ulp(float a, float b, unsigned max_ulp)
+{
+    union av_intfloat32 x, y;
+
+    x.f = a;
+    y.f = b;
+
+    if (is_negative(x) != is_negative(y)) {
+        // handle -0.0 == +0.0
+        return a == b;
+    }
+
+    return llabs((int64_t)x.i - y.i) <= max_ulp;
+}
+
+int float_near_ulp_array(const float *a, const float *b, unsigned max_ulp,
+                         unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++)
+        if (!float_near_ulp(a[i], b[i], max_ulp))
+            return 0;
+    return 1;
+}
+
+int float_near_abs_eps(float a, float b, float eps)
+{
+    return fabsf(a - b) < eps;
+}
+
+int float_near_abs_eps_array(const float *a, const float *b, float eps,
+                             unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++)
+        if (!float_near_abs_eps(a[i], b[i], eps))
+            return 0;
+    return 1;
+}
+
+int double_near_abs_eps(double a, double b, double eps)
+{
+    return fabs(a - b) < eps;
+}
+
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++)
+        if (!double_near_abs_eps(a[i], b[i], eps))
+            return 0;
+    return 1;
+}
+
 /* Deallocate a tree */
 static void destroy_func_tree(CheckasmFunc *f)
 {
@@ -319,8 +464,13 @@ static void check_cpu_flag(const char *name, int flag)
 
         state.cpu_flag_name = name;
         for (i = 0; tests[i].func; i++) {
+            if (state.test_name && strcmp(tests[i].name, state.test_name))
+                continue;
             state.current_test_name = tests[i].name;
             tests[i].func();
+            /* MMX functions are called without emms, so clear the state
+             * before any floating-point code in the next test runs */
+            emms_c();
         }
     }
 }
@@ -343,21 +493,37 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    if (argc > 1 && !strncmp(argv[1], "--bench", 7)) {
+    while (argc > 1) {
+        if (!strncmp(argv[1], "--bench", 7)) {
 #ifndef AV_READ_TIME
-        fprintf(stderr, "checkasm: --bench is not supported on your system\n");
-        return 1;
+            fprintf(stderr, "checkasm: --bench is not supported on your system\n");
+            return 1;
 #endif
-        if (argv[1][7] == '=') {
-            state.bench_pattern = argv[1] + 8;
-            state.bench_pattern_len = strlen(state.bench_pattern);
-        } else
-            state.bench_pattern = "";
+            if (argv[1][7] == '=') {
+                state.bench_pattern = argv[1] + 8;
+                state.bench_pattern_len = strlen(state.bench_pattern);
+            } else
+                state.bench_pattern = "";
+        } else if (!strncmp(argv[1], "--test=", 7)) {
+            state.test_name = argv[1] + 7;
+        } else {
+            break;
+        }
 
         argc--;
         argv++;
     }
 
+    if (state.test_name) {
+        for (i = 0; tests[i].func; i++)
+            if (!strcmp(tests[i].name, state.test_name))
+                break;
+        if (!tests[i].func) {
+            fprintf(stderr, "checkasm: unknown test %s\n", state.test_name);
+            return 1;
+        }
+    }
+
     seed = (argc > 1) ? atoi(argv[1]) : av_get_random_seed();
     fprintf(stderr, "checkasm: using random seed %u\n", seed);
     av_lfg_init(&checkasm_lfg, seed);
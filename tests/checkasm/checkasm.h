@@ -29,9 +29,35 @@
 #include "libavutil/lfg.h"
 #include "libavutil/timer.h"
 
+void checkasm_check_af_volume(void);
 void checkasm_check_bswapdsp(void);
+void checkasm_check_float_dsp(void);
+void checkasm_check_fmtconvert(void);
+void checkasm_check_h264dsp(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
+void checkasm_check_hevcdsp(void);
+void checkasm_check_hevcpred(void);
+void checkasm_check_me_cmp(void);
+void checkasm_check_swresample(void);
+void checkasm_check_swscale(void);
+void checkasm_check_vf_drm(void);
+void checkasm_check_vf_eq(void);
+void checkasm_check_vf_fspp(void);
+void checkasm_check_vf_gradfun(void);
+void checkasm_check_vf_guidefilter(void);
+void checkasm_check_vf_idet(void);
+void checkasm_check_vf_interlace(void);
+void checkasm_check_vf_noise(void);
+void checkasm_check_vf_pp7(void);
+void checkasm_check_vf_psnr(void);
+void checkasm_check_vf_pullup(void);
+void checkasm_check_vf_spp(void);
+void checkasm_check_vf_ssim(void);
+void checkasm_check_vf_tinterlace(void);
+void checkasm_check_vf_yadif(void);
+void checkasm_check_videodsp(void);
+void checkasm_check_vp9dsp(void);
 
 void *checkasm_check_func(void *func, const char *name, ...) av_printf_format(2, 3);
 int checkasm_bench_func(void);
@@ -39,6 +65,16 @@ void checkasm_fail_func(const char *msg, ...) av_printf_format(1, 2);
 void checkasm_update_bench(int iterations, uint64_t cycles);
 void checkasm_report(const char *name, ...) av_printf_format(1, 2);
 
+int float_near_ulp(float a, float b, unsigned max_ulp);
+int float_near_abs_eps(float a, float b, float eps);
+int float_near_ulp_array(const float *a, const float *b, unsigned max_ulp,
+                         unsigned len);
+int float_near_abs_eps_array(const float *a, const float *b, float eps,
+                             unsigned len);
+int double_near_abs_eps(double a, double b, double eps);
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len);
+
 extern AVLFG checkasm_lfg;
 #define rnd() av_lfg_get(&checkasm_lfg)
 
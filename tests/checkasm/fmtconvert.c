@@ -0,0 +1,90 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/fmtconvert.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define BUF_SIZE 1024
+
+static const int lengths[] = { 8, 16, 24, 256, BUF_SIZE };
+
+static int floats_differ(const float *a, const float *b, int len)
+{
+    int i;
+
+    /* conversion and multiply round the same way in SIMD, allow 1 ulp anyway */
+    for (i = 0; i < len; i++)
+        if (!float_near_ulp(a[i], b[i], 1))
+            return 1;
+    return 0;
+}
+
+void checkasm_check_fmtconvert(void)
+{
+    FmtConvertContext c;
+    LOCAL_ALIGNED_16(int32_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float,   dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float,   dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float,   mul,  [BUF_SIZE / 8]);
+    int i;
+
+    for (i = 0; i < BUF_SIZE; i++)
+        src[i] = (int32_t)rnd() >> (rnd() % 24);
+    for (i = 0; i < BUF_SIZE / 8; i++)
+        mul[i] = (float)((int)(rnd() % 2001) - 1000) / (1 << 15);
+
+    ff_fmt_convert_init(&c, NULL);
+
+    if (check_func(c.int32_to_float_fmul_scalar, "int32_to_float_fmul_scalar")) {
+        declare_func(void, float *dst, const int32_t *src, float mul, int len);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            memset(dst0, 0, sizeof(*dst0) * BUF_SIZE);
+            memset(dst1, 0, sizeof(*dst1) * BUF_SIZE);
+            call_ref(dst0, src, mul[i], lengths[i]);
+            call_new(dst1, src, mul[i], lengths[i]);
+            if (floats_differ(dst0, dst1, BUF_SIZE)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(dst1, src, mul[0], BUF_SIZE);
+    }
+    report("int32_to_float_fmul_scalar");
+
+    if (check_func(c.int32_to_float_fmul_array8, "int32_to_float_fmul_array8")) {
+        declare_func(void, FmtConvertContext *c, float *dst,
+                     const int32_t *src, const float *mul, int len);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            memset(dst0, 0, sizeof(*dst0) * BUF_SIZE);
+            memset(dst1, 0, sizeof(*dst1) * BUF_SIZE);
+            call_ref(&c, dst0, src, mul, lengths[i]);
+            call_new(&c, dst1, src, mul, lengths[i]);
+            if (floats_differ(dst0, dst1, BUF_SIZE)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(&c, dst1, src, mul, BUF_SIZE);
+    }
+    report("int32_to_float_fmul_array8");
+}
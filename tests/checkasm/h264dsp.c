@@ -0,0 +1,338 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/h264dsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define SIZEOF_COEF  (2 * ((bit_depth + 7) / 8))
+#define PIXEL_MAX    ((1 << bit_depth) - 1)
+
+static void write_pixel(uint8_t *buf, int i, int v, int bit_depth)
+{
+    if (bit_depth > 8)
+        AV_WN16A(buf + 2 * i, v);
+    else
+        buf[i] = v;
+}
+
+static int read_pixel(const uint8_t *buf, int i, int bit_depth)
+{
+    return bit_depth > 8 ? AV_RN16A(buf + 2 * i) : buf[i];
+}
+
+/* Rows of the H.264 inverse core transforms; they are mutually orthogonal,
+ * so the forward transform is the transpose scaled by the row norms. */
+static const double transform4[4][4] = {
+    { 1.0,  1.0,  1.0,  1.0 },
+    { 1.0,  0.5, -0.5, -1.0 },
+    { 1.0, -1.0, -1.0,  1.0 },
+    { 0.5, -1.0,  1.0, -0.5 },
+};
+
+static const double transform8[8][8] = {
+    { 8 / 8.0,   8 / 8.0,   8 / 8.0,   8 / 8.0,   8 / 8.0,   8 / 8.0,   8 / 8.0,   8 / 8.0 },
+    { 12 / 8.0, 10 / 8.0,   6 / 8.0,   3 / 8.0,  -3 / 8.0,  -6 / 8.0, -10 / 8.0, -12 / 8.0 },
+    { 8 / 8.0,   4 / 8.0,  -4 / 8.0,  -8 / 8.0,  -8 / 8.0,  -4 / 8.0,   4 / 8.0,   8 / 8.0 },
+    { 10 / 8.0, -3 / 8.0, -12 / 8.0,  -6 / 8.0,   6 / 8.0,  12 / 8.0,   3 / 8.0, -10 / 8.0 },
+    { 8 / 8.0,  -8 / 8.0,  -8 / 8.0,   8 / 8.0,   8 / 8.0,  -8 / 8.0,  -8 / 8.0,   8 / 8.0 },
+    { 6 / 8.0, -12 / 8.0,   3 / 8.0,  10 / 8.0, -10 / 8.0,  -3 / 8.0,  12 / 8.0,  -6 / 8.0 },
+    { 4 / 8.0,  -8 / 8.0,   8 / 8.0,  -4 / 8.0,  -4 / 8.0,   8 / 8.0,  -8 / 8.0,   4 / 8.0 },
+    { 3 / 8.0,  -6 / 8.0,  10 / 8.0, -12 / 8.0,  12 / 8.0, -10 / 8.0,   6 / 8.0,  -3 / 8.0 },
+};
+
+/* Compute the coefficients which the (size x size) inverse transform turns
+ * back into the residual src - dst, so that the idct inputs stay within the
+ * range a real encoder produces. */
+static void forward_dct(uint8_t *coef, const uint8_t *src, const uint8_t *dst,
+                        int size, int stride, int bit_depth)
+{
+    const double *t = size == 4 ? &transform4[0][0] : &transform8[0][0];
+    double res[8][8], tmp[8][8], norm[8];
+    int i, j, k;
+
+    for (i = 0; i < size; i++) {
+        norm[i] = 0;
+        for (k = 0; k < size; k++)
+            norm[i] += t[i * size + k] * t[i * size + k];
+        for (j = 0; j < size; j++)
+            res[i][j] = read_pixel(src + i * stride, j, bit_depth) -
+                        read_pixel(dst + i * stride, j, bit_depth);
+    }
+
+    for (i = 0; i < size; i++)
+        for (j = 0; j < size; j++) {
+            tmp[i][j] = 0;
+            for (k = 0; k < size; k++)
+                tmp[i][j] += t[i * size + k] * res[k][j];
+        }
+
+    for (i = 0; i < size; i++)
+        for (j = 0; j < size; j++) {
+            double sum = 0;
+            int c;
+            for (k = 0; k < size; k++)
+                sum += tmp[i][k] * t[j * size + k];
+            c = lrint(64 * sum / (norm[i] * norm[j]));
+            if (bit_depth > 8)
+                AV_WN32A(coef + 4 * (i * size + j), c);
+            else
+                AV_WN16A(coef + 2 * (i * size + j), c);
+        }
+}
+
+static void check_idct(H264DSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,   [8 * 16]);
+    LOCAL_ALIGNED_16(uint8_t, dst,   [8 * 16]);
+    LOCAL_ALIGNED_16(uint8_t, dst0,  [8 * 16]);
+    LOCAL_ALIGNED_16(uint8_t, dst1,  [8 * 16]);
+    LOCAL_ALIGNED_16(uint8_t, coef,  [8 * 8 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, coef0, [8 * 8 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, coef1, [8 * 8 * 4]);
+    const int stride = 16;
+    int size, dc, i;
+    declare_func(void, uint8_t *dst, int16_t *block, int stride);
+
+    for (size = 4; size <= 8; size += 4) {
+        int coef_size = size * size * SIZEOF_COEF;
+
+        for (i = 0; i < 8 * 16 / SIZEOF_PIXEL; i++) {
+            write_pixel(src, i, rnd() & PIXEL_MAX, bit_depth);
+            write_pixel(dst, i, rnd() & PIXEL_MAX, bit_depth);
+        }
+        forward_dct(coef, src, dst, size, stride, bit_depth);
+
+        for (dc = 0; dc < 2; dc++) {
+            void (*func)(uint8_t *dst, int16_t *block, int stride);
+
+            if (size == 4)
+                func = dc ? h->h264_idct_dc_add  : h->h264_idct_add;
+            else
+                func = dc ? h->h264_idct8_dc_add : h->h264_idct8_add;
+
+            if (check_func(func, "h264_idct%d_%sadd_%dbpp",
+                           size, dc ? "dc_" : "", bit_depth)) {
+                memcpy(coef0, coef, coef_size);
+                if (dc)
+                    memset(coef0 + SIZEOF_COEF, 0, coef_size - SIZEOF_COEF);
+                memcpy(coef1, coef0, coef_size);
+                memcpy(dst0, dst, 8 * 16);
+                memcpy(dst1, dst, 8 * 16);
+                call_ref(dst0, (int16_t *)coef0, stride);
+                call_new(dst1, (int16_t *)coef1, stride);
+                if (memcmp(dst0, dst1, 8 * 16) ||
+                    memcmp(coef0, coef1, coef_size))
+                    fail();
+                bench_new(dst1, (int16_t *)coef1, stride);
+            }
+        }
+        /* forward_dct() uses floating point */
+        emms_c();
+    }
+}
+
+#define LF_STRIDE 64
+#define LF_ROWS   32
+#define LF_SIZE   (LF_STRIDE * LF_ROWS)
+
+/* Fill the buffer with pixels scattered around a common base value, so that
+ * the edge thresholds are met often enough for the filters to actually
+ * modify pixels. */
+static void randomize_lf_buffer(uint8_t *buf, int bit_depth)
+{
+    int base  = rnd() & PIXEL_MAX;
+    int noise = (4 << (rnd() % 5)) << (bit_depth - 8);
+    int i;
+
+    for (i = 0; i < LF_SIZE / SIZEOF_PIXEL; i++) {
+        int v = base + (int)(rnd() % (2 * noise + 1)) - noise;
+        write_pixel(buf, i, av_clip(v, 0, PIXEL_MAX), bit_depth);
+    }
+}
+
+static void check_loop_filter(H264DSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, buf0, [LF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, buf1, [LF_SIZE]);
+    uint8_t *pix;
+    int8_t tc0[4];
+    int alpha, beta, i, j;
+
+    /* args is the parenthesized argument list, in terms of pix */
+#define CHECK_LF(name, args)                                                  \
+    do {                                                                      \
+        if (check_func(h->name, #name "_%dbpp", bit_depth)) {                 \
+            for (j = 0; j < 16; j++) {                                        \
+                alpha = rnd() & 0xff;                                         \
+                beta  = rnd() % 19;                                           \
+                for (i = 0; i < 4; i++)                                       \
+                    tc0[i] = (int)(rnd() % 27) - 1;                           \
+                randomize_lf_buffer(buf0, bit_depth);                         \
+                memcpy(buf1, buf0, LF_SIZE);                                  \
+                pix = buf0 + 8 * LF_STRIDE + 16;                              \
+                call_ref args;                                                \
+                pix = buf1 + 8 * LF_STRIDE + 16;                              \
+                call_new args;                                                \
+                if (memcmp(buf0, buf1, LF_SIZE)) {                            \
+                    fail();                                                   \
+                    break;                                                    \
+                }                                                             \
+            }                                                                 \
+            bench_new args;                                                   \
+        }                                                                     \
+    } while (0)
+
+    {
+        declare_func(void, uint8_t *pix, int stride, int alpha, int beta,
+                     int8_t *tc0);
+
+#define LF_ARGS (pix, LF_STRIDE, alpha, beta, tc0)
+        CHECK_LF(h264_v_loop_filter_luma,         LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_luma,         LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_luma_mbaff,   LF_ARGS);
+        CHECK_LF(h264_v_loop_filter_chroma,       LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_chroma,       LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_chroma_mbaff, LF_ARGS);
+#undef LF_ARGS
+    }
+    {
+        declare_func(void, uint8_t *pix, int stride, int alpha, int beta);
+
+#define LF_ARGS (pix, LF_STRIDE, alpha, beta)
+        CHECK_LF(h264_v_loop_filter_luma_intra,         LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_luma_intra,         LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_luma_mbaff_intra,   LF_ARGS);
+        CHECK_LF(h264_v_loop_filter_chroma_intra,       LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_chroma_intra,       LF_ARGS);
+        CHECK_LF(h264_h_loop_filter_chroma_mbaff_intra, LF_ARGS);
+#undef LF_ARGS
+    }
+#undef CHECK_LF
+}
+
+#define WEIGHT_STRIDE 64
+#define WEIGHT_SIZE   (WEIGHT_STRIDE * 16)
+
+static void check_weight(H264DSPContext *h, int bit_depth)
+{
+    static const int heights[4][4] = {
+        { 16, 8 }, { 16, 8, 4 }, { 8, 4, 2 }, { 4, 2 },
+    };
+    LOCAL_ALIGNED_16(uint8_t, src,  [WEIGHT_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst,  [WEIGHT_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [WEIGHT_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [WEIGHT_SIZE]);
+    int i, j, k;
+
+    for (i = 0; i < WEIGHT_SIZE / SIZEOF_PIXEL; i++) {
+        write_pixel(src, i, rnd() & PIXEL_MAX, bit_depth);
+        write_pixel(dst, i, rnd() & PIXEL_MAX, bit_depth);
+    }
+
+    for (i = 0; i < 4; i++) {
+        int width = 16 >> i;
+
+        for (j = 0; j < 4 && heights[i][j]; j++) {
+            int height = heights[i][j];
+            int log2_denom, weightd, weights, offset;
+
+            {
+                declare_func(void, uint8_t *block, int stride, int height,
+                             int log2_denom, int weight, int offset);
+
+                if (check_func(h->weight_h264_pixels_tab[i],
+                               "h264_weight_%dx%d_%dbpp", width, height, bit_depth)) {
+                    for (k = 0; k < 4; k++) {
+                        log2_denom = rnd() % 8;
+                        weightd    = (int)(rnd() & 0xff) - 128;
+                        offset     = (int)(rnd() & 0xff) - 128;
+                        memcpy(dst0, dst, WEIGHT_SIZE);
+                        memcpy(dst1, dst, WEIGHT_SIZE);
+                        call_ref(dst0, WEIGHT_STRIDE, height, log2_denom, weightd, offset);
+                        call_new(dst1, WEIGHT_STRIDE, height, log2_denom, weightd, offset);
+                        if (memcmp(dst0, dst1, WEIGHT_SIZE)) {
+                            fail();
+                            break;
+                        }
+                    }
+                    bench_new(dst1, WEIGHT_STRIDE, height, log2_denom, weightd, offset);
+                }
+            }
+            {
+                declare_func(void, uint8_t *dst, uint8_t *src, int stride,
+                             int height, int log2_denom, int weightd,
+                             int weights, int offset);
+
+                if (check_func(h->biweight_h264_pixels_tab[i],
+                               "h264_biweight_%dx%d_%dbpp", width, height, bit_depth)) {
+                    for (k = 0; k < 4; k++) {
+                        log2_denom = rnd() % 8;
+                        weightd    = (int)(rnd() & 0xff) - 128;
+                        /* the sum of both weights is bounded by the spec */
+                        weights    = FFMAX(-128, -128 - weightd) +
+                                     (int)(rnd() % (FFMIN(127, 127 - weightd) -
+                                                    FFMAX(-128, -128 - weightd) + 1));
+                        offset     = (int)(rnd() & 0xff) - 128;
+                        memcpy(dst0, dst, WEIGHT_SIZE);
+                        memcpy(dst1, dst, WEIGHT_SIZE);
+                        call_ref(dst0, src, WEIGHT_STRIDE, height, log2_denom,
+                                 weightd, weights, offset);
+                        call_new(dst1, src, WEIGHT_STRIDE, height, log2_denom,
+                                 weightd, weights, offset);
+                        if (memcmp(dst0, dst1, WEIGHT_SIZE)) {
+                            fail();
+                            break;
+                        }
+                    }
+                    bench_new(dst1, src, WEIGHT_STRIDE, height, log2_denom,
+                              weightd, weights, offset);
+                }
+            }
+        }
+    }
+}
+
+void checkasm_check_h264dsp(void)
+{
+    H264DSPContext h;
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_h264dsp_init(&h, bit_depth, 1);
+        check_idct(&h, bit_depth);
+    }
+    report("idct");
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_h264dsp_init(&h, bit_depth, 1);
+        check_loop_filter(&h, bit_depth);
+    }
+    report("loop_filter");
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_h264dsp_init(&h, bit_depth, 1);
+        check_weight(&h, bit_depth);
+    }
+    report("weight");
+}
@@ -0,0 +1,455 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/hevcdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+static const int bit_depths[] = { 8, 10, 12 };
+static const int pel_widths[10] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+static const char *const pel_types[2][2] = { { "pixels", "h" }, { "v", "hv" } };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define PIXEL_MAX    ((1 << bit_depth) - 1)
+
+static void randomize_pixels(uint8_t *buf, int size, int bit_depth)
+{
+    int i;
+
+    if (bit_depth > 8) {
+        for (i = 0; i < size; i += 2)
+            AV_WN16A(buf + i, rnd() & PIXEL_MAX);
+    } else {
+        for (i = 0; i < size; i++)
+            buf[i] = rnd();
+    }
+}
+
+/* Compare width x height pixels (or int16 samples) of two images; SIMD
+ * versions are free to write past the end of each row. */
+static int blocks_differ(const uint8_t *a, const uint8_t *b, ptrdiff_t stride,
+                         int row_size, int height)
+{
+    int y;
+
+    for (y = 0; y < height; y++)
+        if (memcmp(a + y * stride, b + y * stride, row_size))
+            return 1;
+    return 0;
+}
+
+#define MC_SRC_STRIDE (2 * (MAX_PB_SIZE + 16))
+#define MC_SRC_SIZE   (MC_SRC_STRIDE * (MAX_PB_SIZE + 8))
+/* the filters read 3 rows/columns before the block */
+#define MC_SRC_OFFSET (3 * MC_SRC_STRIDE + 16)
+#define MC_DST_STRIDE (2 * MAX_PB_SIZE)
+#define MC_DST_SIZE   (MC_DST_STRIDE * MAX_PB_SIZE)
+
+static int mc_frac(int qpel, int frac)
+{
+    return frac ? 1 + rnd() % (qpel ? 3 : 7) : 0;
+}
+
+static void check_mc(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t,  src,  [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(int16_t,  src2, [MAX_PB_SIZE * MAX_PB_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t,  dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t,  dst1, [MC_DST_SIZE]);
+    int qpel, size, i, j;
+
+    randomize_pixels(src, MC_SRC_SIZE, bit_depth);
+    for (i = 0; i < MAX_PB_SIZE * MAX_PB_SIZE; i++)
+        src2[i] = (rnd() & ((1 << 14) - 1)) - (1 << 13);
+
+    for (qpel = 0; qpel < 2; qpel++) {
+        const char *type = qpel ? "qpel" : "epel";
+
+        for (size = 0; size < 10; size++) {
+            int width  = pel_widths[size];
+            int height = width;
+
+            for (j = 0; j < 2; j++) {
+                for (i = 0; i < 2; i++) {
+                    uint8_t *s  = src + MC_SRC_OFFSET;
+                    intptr_t mx = mc_frac(qpel, i);
+                    intptr_t my = mc_frac(qpel, j);
+                    int denom   = rnd() % 8;
+                    int wx0     = (1 << denom) + (int)(rnd() & 0xff) - 128;
+                    int wx1     = (1 << denom) + (int)(rnd() & 0xff) - 128;
+                    int ox0     = (int)(rnd() & 0xff) - 128;
+                    int ox1     = (int)(rnd() & 0xff) - 128;
+
+                    {
+                        declare_func(void, int16_t *dst, uint8_t *src,
+                                     ptrdiff_t srcstride, int height,
+                                     intptr_t mx, intptr_t my, int width);
+
+                        if (check_func(qpel ? h->put_hevc_qpel[size][j][i] :
+                                              h->put_hevc_epel[size][j][i],
+                                       "put_hevc_%s_%s%d_%dbpp", type,
+                                       pel_types[j][i], width, bit_depth)) {
+                            call_ref((int16_t *)dst0, s, MC_SRC_STRIDE, height, mx, my, width);
+                            call_new((int16_t *)dst1, s, MC_SRC_STRIDE, height, mx, my, width);
+                            if (blocks_differ(dst0, dst1, MC_DST_STRIDE, width * 2, height))
+                                fail();
+                            bench_new((int16_t *)dst1, s, MC_SRC_STRIDE, height, mx, my, width);
+                        }
+                    }
+                    {
+                        declare_func(void, uint8_t *dst, ptrdiff_t dststride,
+                                     uint8_t *src, ptrdiff_t srcstride,
+                                     int height, intptr_t mx, intptr_t my,
+                                     int width);
+
+                        if (check_func(qpel ? h->put_hevc_qpel_uni[size][j][i] :
+                                              h->put_hevc_epel_uni[size][j][i],
+                                       "put_hevc_%s_uni_%s%d_%dbpp", type,
+                                       pel_types[j][i], width, bit_depth)) {
+                            call_ref(dst0, MC_DST_STRIDE, s, MC_SRC_STRIDE, height, mx, my, width);
+                            call_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, height, mx, my, width);
+                            if (blocks_differ(dst0, dst1, MC_DST_STRIDE,
+                                              width * SIZEOF_PIXEL, height))
+                                fail();
+                            bench_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, height, mx, my, width);
+                        }
+                    }
+                    {
+                        declare_func(void, uint8_t *dst, ptrdiff_t dststride,
+                                     uint8_t *src, ptrdiff_t srcstride,
+                                     int height, int denom, int wx, int ox,
+                                     intptr_t mx, intptr_t my, int width);
+
+                        if (check_func(qpel ? h->put_hevc_qpel_uni_w[size][j][i] :
+                                              h->put_hevc_epel_uni_w[size][j][i],
+                                       "put_hevc_%s_uni_w_%s%d_%dbpp", type,
+                                       pel_types[j][i], width, bit_depth)) {
+                            call_ref(dst0, MC_DST_STRIDE, s, MC_SRC_STRIDE, height,
+                                     denom, wx0, ox0, mx, my, width);
+                            call_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, height,
+                                     denom, wx0, ox0, mx, my, width);
+                            if (blocks_differ(dst0, dst1, MC_DST_STRIDE,
+                                              width * SIZEOF_PIXEL, height))
+                                fail();
+                            bench_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, height,
+                                      denom, wx0, ox0, mx, my, width);
+                        }
+                    }
+                    {
+                        declare_func(void, uint8_t *dst, ptrdiff_t dststride,
+                                     uint8_t *src, ptrdiff_t srcstride,
+                                     int16_t *src2, int height,
+                                     intptr_t mx, intptr_t my, int width);
+
+                        if (check_func(qpel ? h->put_hevc_qpel_bi[size][j][i] :
+                                              h->put_hevc_epel_bi[size][j][i],
+                                       "put_hevc_%s_bi_%s%d_%dbpp", type,
+                                       pel_types[j][i], width, bit_depth)) {
+                            call_ref(dst0, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                     height, mx, my, width);
+                            call_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                     height, mx, my, width);
+                            if (blocks_differ(dst0, dst1, MC_DST_STRIDE,
+                                              width * SIZEOF_PIXEL, height))
+                                fail();
+                            bench_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                      height, mx, my, width);
+                        }
+                    }
+                    {
+                        /* the qpel and epel prototypes order the weights and
+                         * offsets differently, but both take four ints here */
+                        declare_func(void, uint8_t *dst, ptrdiff_t dststride,
+                                     uint8_t *src, ptrdiff_t srcstride,
+                                     int16_t *src2, int height, int denom,
+                                     int w0, int w1, int o0, int o1,
+                                     intptr_t mx, intptr_t my, int width);
+                        int a = wx0, b = qpel ? wx1 : ox0;
+                        int c = qpel ? ox0 : wx1, d = ox1;
+
+                        if (check_func(qpel ? h->put_hevc_qpel_bi_w[size][j][i] :
+                                              h->put_hevc_epel_bi_w[size][j][i],
+                                       "put_hevc_%s_bi_w_%s%d_%dbpp", type,
+                                       pel_types[j][i], width, bit_depth)) {
+                            call_ref(dst0, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                     height, denom, a, b, c, d, mx, my, width);
+                            call_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                     height, denom, a, b, c, d, mx, my, width);
+                            if (blocks_differ(dst0, dst1, MC_DST_STRIDE,
+                                              width * SIZEOF_PIXEL, height))
+                                fail();
+                            bench_new(dst1, MC_DST_STRIDE, s, MC_SRC_STRIDE, src2,
+                                      height, denom, a, b, c, d, mx, my, width);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void check_transform(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(int16_t, coeffs,  [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, coeffs0, [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, coeffs1, [32 * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst,     [32 * 32 * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,    [32 * 32 * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,    [32 * 32 * 2]);
+    int i, n;
+
+    for (i = 0; i < 4; i++) {
+        int size   = 4 << i;
+        int stride = size * SIZEOF_PIXEL;
+        int count  = size * size;
+
+        /* residuals of a sane stream stay well within this range */
+        for (n = 0; n < count; n++)
+            coeffs[n] = (int)(rnd() % (4 << bit_depth)) - (2 << bit_depth);
+        randomize_pixels(dst, count * SIZEOF_PIXEL, bit_depth);
+
+        {
+            declare_func(void, uint8_t *dst, int16_t *coeffs, ptrdiff_t stride);
+
+            if (check_func(h->transform_add[i], "hevc_transform_add%d_%dbpp",
+                           size, bit_depth)) {
+                memcpy(coeffs0, coeffs, count * sizeof(*coeffs));
+                memcpy(coeffs1, coeffs, count * sizeof(*coeffs));
+                memcpy(dst0, dst, count * SIZEOF_PIXEL);
+                memcpy(dst1, dst, count * SIZEOF_PIXEL);
+                call_ref(dst0, coeffs0, stride);
+                call_new(dst1, coeffs1, stride);
+                if (memcmp(dst0, dst1, count * SIZEOF_PIXEL))
+                    fail();
+                bench_new(dst1, coeffs1, stride);
+            }
+        }
+        {
+            declare_func(void, int16_t *coeffs);
+
+            if (check_func(h->idct_dc[i], "hevc_idct%dx%d_dc_%dbpp",
+                           size, size, bit_depth)) {
+                memset(coeffs0, 0, count * sizeof(*coeffs0));
+                coeffs0[0] = rnd();
+                memcpy(coeffs1, coeffs0, count * sizeof(*coeffs0));
+                call_ref(coeffs0);
+                call_new(coeffs1);
+                if (memcmp(coeffs0, coeffs1, count * sizeof(*coeffs0)))
+                    fail();
+                bench_new(coeffs1);
+            }
+        }
+        {
+            declare_func(void, int16_t *coeffs, int col_limit);
+
+            if (check_func(h->idct[i], "hevc_idct%dx%d_%dbpp",
+                           size, size, bit_depth)) {
+                for (n = 0; n < count; n++)
+                    coeffs0[n] = (int16_t)rnd() >> 3;
+                memcpy(coeffs1, coeffs0, count * sizeof(*coeffs0));
+                call_ref(coeffs0, size);
+                call_new(coeffs1, size);
+                if (memcmp(coeffs0, coeffs1, count * sizeof(*coeffs0)))
+                    fail();
+                memcpy(coeffs1, coeffs, count * sizeof(*coeffs));
+                bench_new(coeffs1, size);
+            }
+        }
+    }
+}
+
+#define LF_STRIDE 64
+#define LF_SIZE   (LF_STRIDE * 32)
+
+/* Pixels scattered around a common base value, so that the edge decisions
+ * do not reject most of the segments. */
+static void randomize_lf_buffer(uint8_t *buf, int bit_depth)
+{
+    int base  = rnd() & PIXEL_MAX;
+    int noise = (2 << (rnd() % 5)) << (bit_depth - 8);
+    int i;
+
+    for (i = 0; i < LF_SIZE / SIZEOF_PIXEL; i++) {
+        int v = av_clip(base + (int)(rnd() % (2 * noise + 1)) - noise, 0, PIXEL_MAX);
+        if (bit_depth > 8)
+            AV_WN16A(buf + 2 * i, v);
+        else
+            buf[i] = v;
+    }
+}
+
+static void check_deblock(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [LF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [LF_SIZE]);
+    uint8_t no_p[2] = { 0, 0 };
+    uint8_t no_q[2] = { 0, 0 };
+    int32_t tc[2];
+    uint8_t *pix;
+    int beta, i, j;
+
+    /* args is the parenthesized argument list, in terms of pix */
+#define CHECK_DEBLOCK(name, args)                                             \
+    do {                                                                      \
+        if (check_func(h->name, #name "_%dbpp", bit_depth)) {                 \
+            for (j = 0; j < 16; j++) {                                        \
+                beta = rnd() % 65;                                            \
+                for (i = 0; i < 2; i++)                                       \
+                    tc[i] = rnd() % 25;                                       \
+                randomize_lf_buffer(buf0, bit_depth);                         \
+                memcpy(buf1, buf0, LF_SIZE);                                  \
+                pix = buf0 + 8 * LF_STRIDE + 16;                              \
+                call_ref args;                                                \
+                pix = buf1 + 8 * LF_STRIDE + 16;                              \
+                call_new args;                                                \
+                if (memcmp(buf0, buf1, LF_SIZE)) {                            \
+                    fail();                                                   \
+                    break;                                                    \
+                }                                                             \
+            }                                                                 \
+            bench_new args;                                                   \
+        }                                                                     \
+    } while (0)
+
+    {
+        declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta,
+                     int32_t *tc, uint8_t *no_p, uint8_t *no_q);
+
+        CHECK_DEBLOCK(hevc_h_loop_filter_luma,
+                      (pix, LF_STRIDE, beta, tc, no_p, no_q));
+        CHECK_DEBLOCK(hevc_v_loop_filter_luma,
+                      (pix, LF_STRIDE, beta, tc, no_p, no_q));
+    }
+    {
+        declare_func(void, uint8_t *pix, ptrdiff_t stride,
+                     int32_t *tc, uint8_t *no_p, uint8_t *no_q);
+
+        CHECK_DEBLOCK(hevc_h_loop_filter_chroma,
+                      (pix, LF_STRIDE, tc, no_p, no_q));
+        CHECK_DEBLOCK(hevc_v_loop_filter_chroma,
+                      (pix, LF_STRIDE, tc, no_p, no_q));
+    }
+#undef CHECK_DEBLOCK
+}
+
+#define SAO_STRIDE     (2 * MAX_PB_SIZE + AV_INPUT_BUFFER_PADDING_SIZE)
+#define SAO_SRC_SIZE   (SAO_STRIDE * (MAX_PB_SIZE + 3))
+#define SAO_DST_SIZE   (2 * MAX_PB_SIZE * MAX_PB_SIZE)
+
+static void check_sao(HEVCDSPContext *h, int bit_depth)
+{
+    static const int sao_widths[5] = { 8, 16, 32, 48, 64 };
+    LOCAL_ALIGNED_32(uint8_t, src,  [SAO_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [SAO_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [SAO_DST_SIZE]);
+    /* the edge filters read one pixel around the block */
+    uint8_t *s = src + SAO_STRIDE + 32;
+    int max_offset = (1 << (FFMIN(bit_depth, 10) - 5)) - 1;
+    int16_t offset_val[5];
+    int i, k;
+
+    randomize_pixels(src, SAO_SRC_SIZE, bit_depth);
+
+    for (i = 0; i < 5; i++) {
+        int width  = sao_widths[i];
+        int height = width;
+        int left_class, eo;
+
+        offset_val[0] = 0;
+        for (k = 1; k < 5; k++)
+            offset_val[k] = ((int)(rnd() % (2 * max_offset + 1)) - max_offset) <<
+                            (bit_depth - FFMIN(bit_depth, 10));
+
+        {
+            declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride_dst,
+                         ptrdiff_t stride_src, int16_t *sao_offset_val,
+                         int sao_left_class, int width, int height);
+
+            if (check_func(h->sao_band_filter[i], "hevc_sao_band_%d_%dbpp",
+                           width, bit_depth)) {
+                left_class = rnd() & 31;
+                memset(dst0, 0, SAO_DST_SIZE);
+                memset(dst1, 0, SAO_DST_SIZE);
+                call_ref(dst0, s, 2 * MAX_PB_SIZE, SAO_STRIDE, offset_val,
+                         left_class, width, height);
+                call_new(dst1, s, 2 * MAX_PB_SIZE, SAO_STRIDE, offset_val,
+                         left_class, width, height);
+                if (blocks_differ(dst0, dst1, 2 * MAX_PB_SIZE,
+                                  width * SIZEOF_PIXEL, height))
+                    fail();
+                bench_new(dst1, s, 2 * MAX_PB_SIZE, SAO_STRIDE, offset_val,
+                          left_class, width, height);
+            }
+        }
+        {
+            declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride_dst,
+                         int16_t *sao_offset_val, int sao_eo_class,
+                         int width, int height);
+
+            if (check_func(h->sao_edge_filter[i], "hevc_sao_edge_%d_%dbpp",
+                           width, bit_depth)) {
+                for (eo = 0; eo < 4; eo++) {
+                    memset(dst0, 0, SAO_DST_SIZE);
+                    memset(dst1, 0, SAO_DST_SIZE);
+                    call_ref(dst0, s, 2 * MAX_PB_SIZE, offset_val, eo, width, height);
+                    call_new(dst1, s, 2 * MAX_PB_SIZE, offset_val, eo, width, height);
+                    if (blocks_differ(dst0, dst1, 2 * MAX_PB_SIZE,
+                                      width * SIZEOF_PIXEL, height)) {
+                        fail();
+                        break;
+                    }
+                }
+                bench_new(dst1, s, 2 * MAX_PB_SIZE, offset_val, 0, width, height);
+            }
+        }
+    }
+}
+
+void checkasm_check_hevcdsp(void)
+{
+    HEVCDSPContext h;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_mc(&h, bit_depths[i]);
+    }
+    report("mc");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_transform(&h, bit_depths[i]);
+    }
+    report("transform");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_deblock(&h, bit_depths[i]);
+    }
+    report("deblock");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_sao(&h, bit_depths[i]);
+    }
+    report("sao");
+}
@@ -0,0 +1,177 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/hevcpred.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+static const int bit_depths[] = { 8, 9, 10, 12 };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define BUF_STRIDE   (64 * 2)
+#define BUF_SIZE     (32 * BUF_STRIDE)
+/* the prediction functions take the stride in pixels */
+#define STRIDE       (BUF_STRIDE / SIZEOF_PIXEL)
+/* 2 * 32 + 1 reference samples plus room for the SIMD overread */
+#define REF_SIZE     (2 * 128)
+
+static void randomize_pixels(uint8_t *buf, int size, int bit_depth)
+{
+    int mask = (1 << bit_depth) - 1;
+    int i;
+
+    if (bit_depth == 8) {
+        for (i = 0; i < size; i++)
+            buf[i] = rnd();
+    } else {
+        for (i = 0; i < size; i += 2)
+            AV_WN16A(buf + i, rnd() & mask);
+    }
+}
+
+#define randomize_buffers()                                 \
+    do {                                                    \
+        randomize_pixels(top_buf,  REF_SIZE, bit_depth);    \
+        randomize_pixels(left_buf, REF_SIZE, bit_depth);    \
+        randomize_pixels(dst0,     BUF_SIZE, bit_depth);    \
+        memcpy(dst1, dst0, BUF_SIZE);                       \
+    } while (0)
+
+/* Offset to allow room for top[-1] and left[-1] */
+#define top0  (top_buf  + 16)
+#define left0 (left_buf + 16)
+
+static void check_planar(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                         uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int i;
+    declare_func(void, uint8_t *src, const uint8_t *top,
+                 const uint8_t *left, ptrdiff_t stride);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+        if (check_func(h->pred_planar[i], "hevc_pred_planar_%dx%d_%d",
+                       size, size, bit_depth)) {
+            randomize_buffers();
+            call_ref(dst0, top0, left0, STRIDE);
+            call_new(dst1, top0, left0, STRIDE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+            bench_new(dst1, top0, left0, STRIDE);
+        }
+    }
+}
+
+static void check_dc(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                     uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int log2_size, c_idx;
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int log2_size, int c_idx);
+
+    for (log2_size = 2; log2_size <= 5; log2_size++) {
+        int size = 1 << log2_size;
+        for (c_idx = 0; c_idx < 2; c_idx++) {
+            if (check_func(h->pred_dc, "hevc_pred_dc_%dx%d_%s_%d", size, size,
+                           c_idx ? "chroma" : "luma", bit_depth)) {
+                randomize_buffers();
+                call_ref(dst0, top0, left0, STRIDE, log2_size, c_idx);
+                call_new(dst1, top0, left0, STRIDE, log2_size, c_idx);
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+                bench_new(dst1, top0, left0, STRIDE, log2_size, c_idx);
+            }
+        }
+    }
+}
+
+static void check_angular(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                          uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int i, c_idx, mode;
+    declare_func(void, uint8_t *src, const uint8_t *top,
+                 const uint8_t *left, ptrdiff_t stride, int c_idx, int mode);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+        for (c_idx = 0; c_idx < 2; c_idx++) {
+            if (check_func(h->pred_angular[i], "hevc_pred_angular_%dx%d_%s_%d",
+                           size, size, c_idx ? "chroma" : "luma", bit_depth)) {
+                for (mode = 2; mode <= 34; mode++) {
+                    randomize_buffers();
+                    call_ref(dst0, top0, left0, STRIDE, c_idx, mode);
+                    call_new(dst1, top0, left0, STRIDE, c_idx, mode);
+                    if (memcmp(dst0, dst1, BUF_SIZE))
+                        fail();
+                }
+                bench_new(dst1, top0, left0, STRIDE, c_idx, 5);
+            }
+        }
+    }
+}
+
+static void check_filter_ref(HEVCPredContext *h, uint8_t *dst0, uint8_t *dst1,
+                             uint8_t *top_buf, uint8_t *left_buf, int bit_depth)
+{
+    int i;
+    declare_func(void, uint8_t *dst, const uint8_t *src, int len);
+
+    if (check_func(h->filter_ref, "hevc_filter_ref_%d", bit_depth)) {
+        for (i = 0; i < 4; i++) {
+            int len = 2 * (4 << i) - 1;
+            randomize_buffers();
+            call_ref(dst0, top0, len);
+            call_new(dst1, top0, len);
+            if (memcmp(dst0, dst1, len * SIZEOF_PIXEL))
+                fail();
+        }
+        bench_new(dst1, top0, 63);
+    }
+}
+
+void checkasm_check_hevcpred(void)
+{
+    static const struct {
+        void (*func)(HEVCPredContext *, uint8_t *, uint8_t *,
+                     uint8_t *, uint8_t *, int);
+        const char *name;
+    } tests[] = {
+        { check_planar,     "planar"     },
+        { check_dc,         "dc"         },
+        { check_angular,    "angular"    },
+        { check_filter_ref, "filter_ref" },
+    };
+
+    LOCAL_ALIGNED_32(uint8_t, dst0,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, top_buf,  [REF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [REF_SIZE]);
+    HEVCPredContext h;
+    int test, i;
+
+    for (test = 0; test < FF_ARRAY_ELEMS(tests); test++) {
+        for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+            ff_hevc_pred_init(&h, bit_depths[i]);
+            tests[test].func(&h, dst0, dst1, top_buf, left_buf, bit_depths[i]);
+        }
+        report("%s", tests[test].name);
+    }
+}
@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/me_cmp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define STRIDE   64
+#define BUF_SIZE (STRIDE * 20)
+
+/* ref is src plus some noise, so that the hadamard sums of the asm versions
+ * stay clear of their 16 bit saturation */
+#define randomize_buffers()                                 \
+    do {                                                    \
+        int i;                                              \
+        for (i = 0; i < BUF_SIZE; i++) {                    \
+            src[i] = rnd();                                 \
+            ref[i] = av_clip_uint8(src[i] + (int)(rnd() % 33) - 16); \
+        }                                                   \
+    } while (0)
+
+static void check_cmp(me_cmp_func *tab, const char *name, uint8_t *src, uint8_t *ref)
+{
+    static const int heights[] = { 16, 8 };
+    int i;
+    declare_func(int, struct MpegEncContext *s, uint8_t *blk1, uint8_t *blk2,
+                 ptrdiff_t stride, int h);
+
+    if (check_func(tab[0], "%s16", name)) {
+        for (i = 0; i < FF_ARRAY_ELEMS(heights); i++) {
+            int res0, res1;
+            randomize_buffers();
+            res0 = call_ref(NULL, src, ref + 3, STRIDE, heights[i]);
+            res1 = call_new(NULL, src, ref + 3, STRIDE, heights[i]);
+            if (res0 != res1)
+                fail();
+        }
+        bench_new(NULL, src, ref + 3, STRIDE, 16);
+    }
+}
+
+static int sad16_ref(const uint8_t *blk1, const uint8_t *blk2, int h)
+{
+    int x, y, sum = 0;
+
+    for (y = 0; y < h; y++)
+        for (x = 0; x < 16; x++)
+            sum += FFABS(blk1[y * STRIDE + x] - blk2[y * STRIDE + x]);
+    return sum;
+}
+
+static void check_sad_x4(MECmpContext *c, uint8_t *src, uint8_t *ref)
+{
+    static const int heights[] = { 16, 8 };
+    static const int offsets[4] = { 1, STRIDE + 2, 2 * STRIDE - 1, 3 * STRIDE + 15 };
+    uint8_t *blk[4];
+    int scores[4];
+    int i, j;
+    declare_func(void, uint8_t *blk1, uint8_t *const blk2[4], ptrdiff_t stride,
+                 int h, int scores[4]);
+
+    for (j = 0; j < 4; j++)
+        blk[j] = ref + offsets[j];
+
+    /* there is no C version, compare against plain per candidate SADs */
+    if (check_func(c->sad_x4[0], "sad16_x4")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(heights); i++) {
+            randomize_buffers();
+            call_new(src, blk, STRIDE, heights[i], scores);
+            for (j = 0; j < 4; j++)
+                if (scores[j] != sad16_ref(src, blk[j], heights[i]))
+                    fail();
+        }
+        bench_new(src, blk, STRIDE, 16, scores);
+    }
+}
+
+void checkasm_check_me_cmp(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, ref, [BUF_SIZE]);
+    AVCodecContext avctx = { 0 };
+    MECmpContext c;
+
+    ff_me_cmp_init_static();
+    ff_me_cmp_init(&c, &avctx);
+
+    check_cmp(c.sad, "sad", src, ref);
+    check_cmp(c.sse, "sse", src, ref);
+    check_cmp(c.hadamard8_diff, "hadamard8_diff", src, ref);
+    report("cmp");
+
+    check_sad_x4(&c, src, ref);
+    report("sad_x4");
+}
@@ -0,0 +1,262 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define SRC_PIXELS       512
+#define MAX_FILTER_WIDTH 40
+#define MAX_VFILTER_SIZE 16
+#define HSCALE_SRC_SIZE  (SRC_PIXELS + MAX_FILTER_WIDTH + 64)
+#define VSCALE_DST_SIZE  (SRC_PIXELS * 2 + 64)
+
+/* Set up the context fields the DSP init looks at and pick the functions
+ * for the current cpu flags. SWS_ACCURATE_RND keeps the MMX vertical scaler,
+ * which takes its coefficients from the context, out of the way. */
+static void init_scale_funcs(SwsContext *c, enum AVPixelFormat dst_fmt,
+                             int filter_size)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst_fmt);
+
+    c->srcFormat      = AV_PIX_FMT_YUV420P;
+    c->dstFormat      = dst_fmt;
+    c->srcBpc         = 8;
+    c->dstBpc         = desc->comp[0].depth_minus1 + 1;
+    c->hLumFilterSize = filter_size;
+    c->hChrFilterSize = filter_size;
+    c->flags          = SWS_ACCURATE_RND;
+    ff_getSwsFunc(c);
+}
+
+static void check_hscale(SwsContext *c)
+{
+    static const int filter_sizes[] = { 4, 8, 12, 16, 32, 40 };
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P16LE,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src,       [HSCALE_SRC_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst0,      [SRC_PIXELS]);
+    LOCAL_ALIGNED_32(int32_t, dst1,      [SRC_PIXELS]);
+    LOCAL_ALIGNED_32(int16_t, filter,    [SRC_PIXELS * MAX_FILTER_WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, filterPos, [SRC_PIXELS]);
+    int f, s, i, j;
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    for (i = 0; i < HSCALE_SRC_SIZE; i++)
+        src[i] = rnd();
+
+    for (f = 0; f < FF_ARRAY_ELEMS(dst_fmts); f++) {
+        for (s = 0; s < FF_ARRAY_ELEMS(filter_sizes); s++) {
+            int width = filter_sizes[s];
+
+            /* mostly negative taps plus a single maximal one, which drives
+             * the accumulators towards both ends of their range */
+            for (i = 0; i < SRC_PIXELS; i++) {
+                filterPos[i] = i;
+                for (j = 0; j < width; j++)
+                    filter[i * width + j] = -((1 << 14) / (width - 1));
+                filter[i * width + (rnd() % width)] = (1 << 15) - 1;
+            }
+
+            init_scale_funcs(c, dst_fmts[f], width);
+            if (check_func(c->hyScale, "hscale_8_to_%d_width%d",
+                           c->dstBpc <= 14 ? 15 : 19, width)) {
+                memset(dst0, 0, SRC_PIXELS * sizeof(dst0[0]));
+                memset(dst1, 0, SRC_PIXELS * sizeof(dst1[0]));
+                call_ref(NULL, (int16_t *)dst0, SRC_PIXELS, src, filter, filterPos, width);
+                call_new(NULL, (int16_t *)dst1, SRC_PIXELS, src, filter, filterPos, width);
+                if (memcmp(dst0, dst1, SRC_PIXELS * (c->dstBpc <= 14 ? 2 : 4)))
+                    fail();
+                bench_new(NULL, (int16_t *)dst1, SRC_PIXELS, src, filter, filterPos, width);
+            }
+        }
+    }
+}
+
+static void check_vscale(SwsContext *c)
+{
+    static const int dst_widths[] = { 16, 56, 120, SRC_PIXELS };
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE, AV_PIX_FMT_YUV420P10LE,
+        AV_PIX_FMT_YUV420P16LE,
+    };
+    LOCAL_ALIGNED_32(int16_t, src,    [MAX_VFILTER_SIZE * SRC_PIXELS]);
+    LOCAL_ALIGNED_32(int32_t, src32,  [SRC_PIXELS]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,   [VSCALE_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,   [VSCALE_DST_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, filter, [MAX_VFILTER_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t,  dither, [8]);
+    const int16_t *srcp[MAX_VFILTER_SIZE];
+    int f, w, i;
+
+    for (i = 0; i < MAX_VFILTER_SIZE * SRC_PIXELS; i++)
+        src[i] = rnd() & 0x7fff;
+    /* 19-bit intermediates, pushed past both ends of the 16-bit output */
+    for (i = 0; i < SRC_PIXELS; i++)
+        src32[i] = (rnd() & 0xfffff) - 0x40000;
+    for (i = 0; i < MAX_VFILTER_SIZE; i++)
+        srcp[i] = src + i * SRC_PIXELS;
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(dst_fmts); f++) {
+        init_scale_funcs(c, dst_fmts[f], 4);
+
+        for (w = 0; w < FF_ARRAY_ELEMS(dst_widths); w++) {
+            int dstW     = dst_widths[w];
+            /* the callers only ever rotate the dither by 0 or 3 */
+            int offset   = rnd() & 1 ? 3 : 0;
+            int row_size = dstW * (c->dstBpc > 8 ? 2 : 1);
+
+            /* the 16-bit yuv2planeX would need 32-bit sources as well */
+            if (c->dstBpc < 16) {
+                declare_func(void, const int16_t *filter, int filterSize,
+                             const int16_t **src, uint8_t *dest, int dstW,
+                             const uint8_t *dither, int offset);
+
+                if (check_func(c->yuv2planeX, "yuv2planeX_%d_%d",
+                               c->dstBpc, dstW)) {
+                    /* vertical filters are padded to an even size on x86,
+                     * a single tap goes through yuv2plane1; the size only
+                     * depends on the width so that --bench compares alike */
+                    int filter_size = 2 << w;
+                    int sum = 0;
+
+                    /* the taps of a real vertical filter sum to 1 << 12 */
+                    for (i = 0; i < filter_size - 1; i++) {
+                        filter[i] = rnd() % (2 * (1 << 12) / filter_size);
+                        sum      += filter[i];
+                    }
+                    filter[filter_size - 1] = (1 << 12) - sum;
+
+                    memset(dst0, 0, VSCALE_DST_SIZE);
+                    memset(dst1, 0, VSCALE_DST_SIZE);
+                    call_ref(filter, filter_size, srcp, dst0, dstW, dither, offset);
+                    call_new(filter, filter_size, srcp, dst1, dstW, dither, offset);
+                    if (memcmp(dst0, dst1, row_size))
+                        fail();
+                    bench_new(filter, filter_size, srcp, dst1, dstW, dither, offset);
+                }
+            }
+            {
+                declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                             const uint8_t *dither, int offset);
+
+                const int16_t *in = c->dstBpc == 16 ? (const int16_t *)src32 : src;
+
+                if (check_func(c->yuv2plane1, "yuv2plane1_%d_%d",
+                               c->dstBpc, dstW)) {
+                    memset(dst0, 0, VSCALE_DST_SIZE);
+                    memset(dst1, 0, VSCALE_DST_SIZE);
+                    call_ref(in, dst0, dstW, dither, offset);
+                    call_new(in, dst1, dstW, dither, offset);
+                    if (memcmp(dst0, dst1, row_size))
+                        fail();
+                    bench_new(in, dst1, dstW, dither, offset);
+                }
+            }
+        }
+    }
+}
+
+static void check_yuv2nv12cX(SwsContext *c)
+{
+    static const int dst_widths[] = { 16, 56, 120, SRC_PIXELS };
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_NV12, AV_PIX_FMT_NV21,
+    };
+    LOCAL_ALIGNED_32(int16_t, usrc,   [MAX_VFILTER_SIZE * SRC_PIXELS]);
+    LOCAL_ALIGNED_32(int16_t, vsrc,   [MAX_VFILTER_SIZE * SRC_PIXELS]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,   [VSCALE_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,   [VSCALE_DST_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, filter, [MAX_VFILTER_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t,  dither, [8]);
+    const int16_t *usrcp[MAX_VFILTER_SIZE], *vsrcp[MAX_VFILTER_SIZE];
+    int f, w, i;
+    declare_func(void, SwsContext *c, const int16_t *filter, int filterSize,
+                 const int16_t **usrc, const int16_t **vsrc,
+                 uint8_t *dest, int dstW);
+
+    for (i = 0; i < MAX_VFILTER_SIZE * SRC_PIXELS; i++) {
+        usrc[i] = rnd() & 0x7fff;
+        vsrc[i] = rnd() & 0x7fff;
+    }
+    for (i = 0; i < MAX_VFILTER_SIZE; i++) {
+        usrcp[i] = usrc + i * SRC_PIXELS;
+        vsrcp[i] = vsrc + i * SRC_PIXELS;
+    }
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(dst_fmts); f++) {
+        init_scale_funcs(c, dst_fmts[f], 4);
+        c->chrDither8 = dither;
+
+        for (w = 0; w < FF_ARRAY_ELEMS(dst_widths); w++) {
+            int dstW = dst_widths[w];
+
+            if (check_func(c->yuv2nv12cX, "yuv2%scX_%d",
+                           av_get_pix_fmt_name(dst_fmts[f]), dstW)) {
+                /* the AVX2 wrapper finishes odd sizes in C, cover one */
+                int filter_size = (2 << w) + (w == 1);
+                int sum = 0;
+
+                for (i = 0; i < filter_size - 1; i++) {
+                    filter[i] = rnd() % (2 * (1 << 12) / filter_size);
+                    sum      += filter[i];
+                }
+                filter[filter_size - 1] = (1 << 12) - sum;
+
+                memset(dst0, 0, VSCALE_DST_SIZE);
+                memset(dst1, 0, VSCALE_DST_SIZE);
+                call_ref(c, filter, filter_size, usrcp, vsrcp, dst0, dstW);
+                call_new(c, filter, filter_size, usrcp, vsrcp, dst1, dstW);
+                if (memcmp(dst0, dst1, 2 * dstW))
+                    fail();
+                bench_new(c, filter, filter_size, usrcp, vsrcp, dst1, dstW);
+            }
+        }
+    }
+}
+
+void checkasm_check_swscale(void)
+{
+    SwsContext *c = sws_alloc_context();
+
+    if (!c) {
+        fprintf(stderr, "swscale: Out of memory error\n");
+        return;
+    }
+
+    check_hscale(c);
+    report("hscale");
+    check_vscale(c);
+    report("vscale");
+    check_yuv2nv12cX(c);
+    report("yuv2nv12cX");
+
+    sws_freeContext(c);
+}
@@ -0,0 +1,323 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libswresample/audioconvert.h"
+#include "libswresample/resample.h"
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#define BUF_SAMPLES 1024
+#define BUF_SIZE    (BUF_SAMPLES * 8)
+
+/* Fill buf with samples that are valid for fmt; floats stay strictly inside
+ * [-1, 1) so that conversions to integers never saturate. */
+static void randomize_samples(uint8_t *buf, enum AVSampleFormat fmt, int count)
+{
+    int i;
+
+    switch (av_get_packed_sample_fmt(fmt)) {
+    case AV_SAMPLE_FMT_S16:
+        for (i = 0; i < count; i++)
+            AV_WN16A(buf + 2 * i, rnd());
+        break;
+    case AV_SAMPLE_FMT_S32:
+        for (i = 0; i < count; i++)
+            AV_WN32A(buf + 4 * i, rnd());
+        break;
+    case AV_SAMPLE_FMT_FLT:
+        for (i = 0; i < count; i++)
+            ((float *)buf)[i] = ((int)(rnd() >> 8) - (1 << 23)) / (float)(1 << 23);
+        break;
+    case AV_SAMPLE_FMT_DBL:
+        for (i = 0; i < count; i++)
+            ((double *)buf)[i] = ((int)(rnd() >> 8) - (1 << 23)) / (double)(1 << 23);
+        break;
+    }
+}
+
+static int samples_differ(const uint8_t *a, const uint8_t *b,
+                          enum AVSampleFormat fmt, int count, int linear)
+{
+    int i;
+
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P:
+        /* the SIMD linear interpolation rounds differently */
+        for (i = 0; i < count; i++)
+            if (abs(((const int16_t *)a)[i] - ((const int16_t *)b)[i]) > linear)
+                return 1;
+        return 0;
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)a, (const float *)b,
+                                         1e-5, count);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)a, (const double *)b,
+                                          1e-12, count);
+    }
+    return memcmp(a, b, count * av_get_bytes_per_sample(fmt));
+}
+
+static void check_resample(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    static const int rates[][2] = { { 44100, 48000 }, { 48000, 44100 } };
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    int f, r, linear;
+    declare_func(int, struct ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        enum AVSampleFormat fmt = formats[f];
+        int bps = av_get_bytes_per_sample(fmt);
+
+        randomize_samples(src, fmt, BUF_SIZE / bps);
+
+        for (r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+            for (linear = 0; linear < 2; linear++) {
+                ResampleContext *c = swri_resampler.init(NULL, rates[r][1], rates[r][0],
+                                                         32, 10, linear, 0.97, fmt,
+                                                         SWR_FILTER_TYPE_KAISER, 9,
+                                                         0, 0);
+                if (!c) {
+                    fprintf(stderr, "swresample: Out of memory error\n");
+                    return;
+                }
+
+                if (check_func(c->dsp.resample, "resample_%s_%s_%d_%d",
+                               linear ? "linear" : "common",
+                               av_get_sample_fmt_name(fmt),
+                               rates[r][0], rates[r][1])) {
+                    int index = rnd() & c->phase_mask;
+                    int frac  = rnd() % c->src_incr;
+                    int64_t end_index = (1LL + BUF_SAMPLES / 2 - c->filter_length) << c->phase_shift;
+                    int64_t delta     = (end_index - index) * c->src_incr - frac;
+                    int n = FFMIN((delta + c->dst_incr - 1) / c->dst_incr,
+                                  BUF_SIZE / bps);
+                    int ret0, ret1, index0, frac0;
+
+                    memset(dst0, 0, BUF_SIZE);
+                    memset(dst1, 0, BUF_SIZE);
+                    c->index = index;
+                    c->frac  = frac;
+                    ret0   = call_ref(c, dst0, src, n, 1);
+                    index0 = c->index;
+                    frac0  = c->frac;
+                    c->index = index;
+                    c->frac  = frac;
+                    ret1   = call_new(c, dst1, src, n, 1);
+                    if (ret0 != ret1 || index0 != c->index || frac0 != c->frac ||
+                        samples_differ(dst0, dst1, fmt, n, linear))
+                        fail();
+                    c->index = index;
+                    c->frac  = frac;
+                    bench_new(c, dst1, src, n, 0);
+                }
+                swri_resampler.free(&c);
+            }
+        }
+    }
+}
+
+static void check_rematrix(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP,
+    };
+    LOCAL_ALIGNED_32(uint8_t, in1,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, in2,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out1, [BUF_SIZE]);
+    int f;
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        enum AVSampleFormat fmt = formats[f];
+        int bps  = av_get_bytes_per_sample(fmt);
+        int len  = BUF_SAMPLES / 2;
+        /* C and SIMD versions of the int16 mixers take differently scaled
+         * coefficients, so both tables are built here */
+        int     coeffs_c[2];
+        int16_t coeffs_simd[4];
+        float   coeffs_f[2];
+        void *cc, *cs;
+        struct SwrContext *s;
+
+        s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_MONO, fmt, 48000,
+                               AV_CH_LAYOUT_STEREO, fmt, 48000, 0, NULL);
+        if (!s || av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0) < 0 ||
+            swr_init(s) < 0) {
+            fprintf(stderr, "swresample: failed to set up rematrixing\n");
+            swr_free(&s);
+            return;
+        }
+
+        randomize_samples(in1, fmt, BUF_SIZE / bps);
+        randomize_samples(in2, fmt, BUF_SIZE / bps);
+        coeffs_c[0] = (int)(rnd() % 32768) - 16384;
+        coeffs_c[1] = (int)(rnd() % 32768) - 16384;
+        coeffs_simd[0] = coeffs_c[0];
+        coeffs_simd[1] = 15;
+        coeffs_simd[2] = coeffs_c[1];
+        coeffs_simd[3] = 15;
+        coeffs_f[0] = coeffs_c[0] / 32768.0f;
+        coeffs_f[1] = coeffs_c[1] / 32768.0f;
+        cc = fmt == AV_SAMPLE_FMT_S16P ? (void *)coeffs_c    : (void *)coeffs_f;
+        cs = fmt == AV_SAMPLE_FMT_S16P ? (void *)coeffs_simd : (void *)coeffs_f;
+
+        /* The mixers are only reachable through the SwrContext, and the
+         * first SIMD version has no C entry to be compared against, so
+         * the reference is always the C mixer called directly. */
+        if (check_func(s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f,
+                       "mix_1_1_%s", av_get_sample_fmt_name(fmt))) {
+            declare_func(void, void *out, const void *in, void *coeffp,
+                         integer index, integer len);
+
+            memset(out0, 0, BUF_SIZE);
+            memset(out1, 0, BUF_SIZE);
+            s->mix_1_1_f(out0, in1, cc, 1, len);
+            call_new(out1, in1, cs, 1, len);
+            if (samples_differ(out0, out1, fmt, len, 0))
+                fail();
+            bench_new(out1, in1, cs, 1, len);
+        }
+        if (check_func(s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f,
+                       "mix_2_1_%s", av_get_sample_fmt_name(fmt))) {
+            declare_func(void, void *out, const void *in1, const void *in2,
+                         void *coeffp, integer index1, integer index2,
+                         integer len);
+
+            memset(out0, 0, BUF_SIZE);
+            memset(out1, 0, BUF_SIZE);
+            s->mix_2_1_f(out0, in1, in2, cc, 0, 1, len);
+            call_new(out1, in1, in2, cs, 0, 1, len);
+            if (samples_differ(out0, out1, fmt, len, 0))
+                fail();
+            bench_new(out1, in1, in2, cs, 0, 1, len);
+        }
+        /* the int16 mixers may be MMX */
+        emms_c();
+        swr_free(&s);
+    }
+}
+
+static void setup_audio_data(AudioData *a, uint8_t *buf, enum AVSampleFormat fmt,
+                             int channels, int len)
+{
+    int i;
+
+    memset(a, 0, sizeof(*a));
+    a->data     = buf;
+    a->ch_count = channels;
+    a->bps      = av_get_bytes_per_sample(fmt);
+    a->count    = len;
+    a->planar   = av_sample_fmt_is_planar(fmt);
+    a->fmt      = fmt;
+    for (i = 0; i < channels; i++)
+        a->ch[i] = buf + i * (a->planar ? len * a->bps : a->bps);
+}
+
+static void check_audio_convert(void)
+{
+    static const enum AVSampleFormat formats[] = {
+        AV_SAMPLE_FMT_S16,  AV_SAMPLE_FMT_S32,  AV_SAMPLE_FMT_FLT,
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP,
+    };
+    static const int channels[] = { 1, 2, 6, 8 };
+    LOCAL_ALIGNED_32(uint8_t, in,   [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out1, [BUF_SIZE]);
+    int i, o, c;
+    declare_func(void, uint8_t **dst, const uint8_t **src, int len);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(formats); i++) {
+        for (o = 0; o < FF_ARRAY_ELEMS(formats); o++) {
+            enum AVSampleFormat in_fmt  = formats[i];
+            enum AVSampleFormat out_fmt = formats[o];
+
+            if (in_fmt == out_fmt)
+                continue;
+
+            for (c = 0; c < FF_ARRAY_ELEMS(channels); c++) {
+                int ch  = channels[c];
+                int len = BUF_SIZE / (8 * ch) & ~15;
+                AudioConvert *ac = swri_audio_convert_alloc(out_fmt, in_fmt, ch, NULL, 0);
+                AudioData ain, aout0, aout1;
+
+                if (!ac) {
+                    fprintf(stderr, "swresample: Out of memory error\n");
+                    return;
+                }
+
+                randomize_samples(in, in_fmt, len * ch);
+                setup_audio_data(&ain,   in,   in_fmt,  ch, len);
+                setup_audio_data(&aout0, out0, out_fmt, ch, len);
+                setup_audio_data(&aout1, out1, out_fmt, ch, len);
+
+                if (check_func(ac->simd_f, "audio_convert_%s_to_%s_%dch",
+                               av_get_sample_fmt_name(in_fmt),
+                               av_get_sample_fmt_name(out_fmt), ch)) {
+                    simd_func_type *simd_f = ac->simd_f;
+
+                    memset(out0, 0, BUF_SIZE);
+                    memset(out1, 0, BUF_SIZE);
+                    /* there is no C entry in the context to compare against,
+                     * so run the generic per-channel conversion instead */
+                    ac->simd_f = NULL;
+                    swri_audio_convert(ac, &aout0, &ain, len);
+                    ac->simd_f = simd_f;
+                    if (ain.planar == aout1.planar) {
+                        int planes = ain.planar ? ch : 1;
+                        int n      = ain.planar ? len : len * ch;
+                        int p;
+                        for (p = 0; p < planes; p++)
+                            call_new(aout1.ch + p, (const uint8_t **)ain.ch + p, n);
+                    } else {
+                        call_new(aout1.ch, (const uint8_t **)ain.ch, len);
+                    }
+                    if (memcmp(out0, out1, len * ch * aout0.bps))
+                        fail();
+                    bench_new(aout1.ch, (const uint8_t **)ain.ch, len);
+                }
+                swri_audio_convert_free(&ac);
+                emms_c();
+            }
+        }
+    }
+}
+
+void checkasm_check_swresample(void)
+{
+    check_resample();
+    report("resample");
+    check_rematrix();
+    report("rematrix");
+    check_audio_convert();
+    report("audio_convert");
+}
@@ -0,0 +1,179 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_drm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define NB_BLOCKS 16
+#define STRIDE    (NB_BLOCKS * 8 + 32)
+#define PIX_SIZE  (STRIDE * 8)
+#define COEF_SIZE (NB_BLOCKS * 64)
+
+#define randomize_pixels(buf)             \
+    do {                                  \
+        int k;                            \
+        for (k = 0; k < PIX_SIZE; k += 4) \
+            AV_WN32A(buf + k, rnd());     \
+    } while (0)
+
+static void check_fdct8_quant(DrmDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [PIX_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, coef0, [COEF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, coef1, [COEF_SIZE]);
+    int nb;
+    declare_func(void, int16_t *coef, const uint8_t *src, ptrdiff_t stride, int nb);
+
+    if (check_func(dsp->fdct8_quant, "drm_fdct8_quant")) {
+        for (nb = 1; nb <= NB_BLOCKS; nb++) {
+            randomize_pixels(src);
+            memset(coef0, 0, COEF_SIZE * sizeof(*coef0));
+            memset(coef1, 0, COEF_SIZE * sizeof(*coef1));
+            call_ref(coef0, src, STRIDE, nb);
+            call_new(coef1, src, STRIDE, nb);
+            if (memcmp(coef0, coef1, COEF_SIZE * sizeof(*coef0)))
+                fail();
+        }
+        bench_new(coef1, src, STRIDE, NB_BLOCKS);
+    }
+}
+
+static void check_idct8_put(DrmDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [PIX_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [PIX_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [PIX_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, coef, [COEF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, coef0, [COEF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, coef1, [COEF_SIZE]);
+    int nb, i;
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, int16_t *coef, int nb);
+
+    if (check_func(dsp->idct8_put, "drm_idct8_put")) {
+        for (nb = 1; nb <= NB_BLOCKS; nb++) {
+            /* coefficients as the filter feeds them: transformed pixels
+             * with a dither modulated DC */
+            randomize_pixels(src);
+            dsp->fdct8_quant(coef, src, STRIDE, NB_BLOCKS);
+            for (i = 0; i < NB_BLOCKS; i++)
+                coef[64 * i] += (int)(rnd() % 65) - 32;
+            memcpy(coef0, coef, COEF_SIZE * sizeof(*coef));
+            memcpy(coef1, coef, COEF_SIZE * sizeof(*coef));
+            randomize_pixels(dst0);
+            memcpy(dst1, dst0, PIX_SIZE);
+            call_ref(dst0, STRIDE, coef0, nb);
+            call_new(dst1, STRIDE, coef1, nb);
+            if (memcmp(dst0, dst1, PIX_SIZE))
+                fail();
+        }
+        memcpy(coef1, coef, COEF_SIZE * sizeof(*coef));
+        bench_new(dst1, STRIDE, coef1, NB_BLOCKS);
+    }
+}
+
+static void check_dc_modulate(DrmDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(int16_t, dc0, [NB_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, dc1, [NB_BLOCKS]);
+    LOCAL_ALIGNED_32(uint8_t, bits, [NB_BLOCKS]);
+    int n, i;
+    declare_func(void, int16_t *dc, const uint8_t *bits, int n, int dm_step);
+
+    if (check_func(dsp->dc_modulate, "drm_dc_modulate")) {
+        for (n = 1; n <= NB_BLOCKS; n++) {
+            int step = 1 + rnd() % 256;
+            for (i = 0; i < NB_BLOCKS; i++) {
+                dc0[i] = dc1[i] = rnd() % 2048;
+                bits[i] = rnd();
+            }
+            call_ref(dc0, bits, n, step);
+            call_new(dc1, bits, n, step);
+            if (memcmp(dc0, dc1, n * sizeof(*dc0)))
+                fail();
+        }
+        bench_new(dc1, bits, NB_BLOCKS, DEFAULT_DCDM_STEP);
+    }
+}
+
+static void check_dc8x8(DrmDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [PIX_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, dc0, [NB_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, dc1, [NB_BLOCKS]);
+    int nb;
+    declare_func(void, int16_t *dc, const uint8_t *src, ptrdiff_t stride, int nb);
+
+    if (check_func(dsp->dc8x8, "drm_dc8x8")) {
+        for (nb = 1; nb <= NB_BLOCKS; nb++) {
+            randomize_pixels(src);
+            call_ref(dc0, src, STRIDE, nb);
+            call_new(dc1, src, STRIDE, nb);
+            if (memcmp(dc0, dc1, nb * sizeof(*dc0)))
+                fail();
+        }
+        bench_new(dc1, src, STRIDE, NB_BLOCKS);
+    }
+}
+
+static void check_dc_demodulate(DrmDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(int16_t, dc, [NB_BLOCKS]);
+    LOCAL_ALIGNED_32(uint8_t, bits0, [NB_BLOCKS]);
+    LOCAL_ALIGNED_32(uint8_t, bits1, [NB_BLOCKS]);
+    int n, i;
+    declare_func(void, uint8_t *bits, const int16_t *dc, int n, int dm_step);
+
+    if (check_func(dsp->dc_demodulate, "drm_dc_demodulate")) {
+        for (n = 1; n <= NB_BLOCKS; n++) {
+            int step = 1 + rnd() % 256;
+            for (i = 0; i < NB_BLOCKS; i++)
+                dc[i] = rnd() % 2048;
+            call_ref(bits0, dc, n, step);
+            call_new(bits1, dc, n, step);
+            if (memcmp(bits0, bits1, n))
+                fail();
+        }
+        bench_new(bits1, dc, NB_BLOCKS, DEFAULT_DCDM_STEP);
+    }
+}
+
+void checkasm_check_vf_drm(void)
+{
+    DrmDSPContext dsp;
+
+    ff_drm_dsp_init(&dsp);
+
+    check_fdct8_quant(&dsp);
+    report("fdct8_quant");
+
+    check_idct8_put(&dsp);
+    report("idct8_put");
+
+    check_dc_modulate(&dsp);
+    report("dc_modulate");
+
+    check_dc8x8(&dsp);
+    report("dc8x8");
+
+    check_dc_demodulate(&dsp);
+    report("dc_demodulate");
+}
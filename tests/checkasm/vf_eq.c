@@ -0,0 +1,70 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_eq.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH    256
+#define HEIGHT   16
+#define STRIDE   (WIDTH + 32)
+#define BUF_SIZE (STRIDE * HEIGHT)
+
+static void check_process(EQContext *eq)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    EQParameters param = { 0 };
+    int i, w;
+    declare_func(void, EQParameters *param, uint8_t *dst, int dst_stride,
+                 const uint8_t *src, int src_stride, int w, int h);
+
+    if (check_func(eq->process, "eq_process")) {
+        for (i = 0; i < BUF_SIZE; i++)
+            src[i] = rnd();
+
+        /* the filter only takes this path for gamma 1 and a contrast below
+         * 7.9, the MMX version needs at least 8 pixels per row */
+        for (w = 8; w <= WIDTH; w += 1 + rnd() % 32) {
+            param.contrast   = ((int)(rnd() % 15800) - 7900) / 1000.0;
+            param.brightness = ((int)(rnd() % 2001) - 1000) / 1000.0;
+            param.gamma      = 1.0;
+
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(&param, dst0, STRIDE, src, STRIDE, w, HEIGHT);
+            call_new(&param, dst1, STRIDE, src, STRIDE, w, HEIGHT);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(&param, dst1, STRIDE, src, STRIDE, WIDTH, HEIGHT);
+    }
+}
+
+void checkasm_check_vf_eq(void)
+{
+    EQContext eq = { 0 };
+
+    ff_eq_init(&eq);
+
+    check_process(&eq);
+    report("process");
+}
@@ -0,0 +1,191 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_fspp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH      256
+#define STRIDE     (WIDTH + 16)
+#define BLOCK_SIZE (4 * 8 * BLOCKSZ * 2)
+
+static void randomize_slice(int16_t *src, int len, int log2_scale)
+{
+    int i;
+
+    /* keep the scaled sums inside the range the C version clips correctly */
+    for (i = 0; i < len; i++)
+        src[i] = ((int)(rnd() % 640) - 128) << (6 - log2_scale);
+}
+
+static void check_store_slice(FSPPContext *p)
+{
+    LOCAL_ALIGNED_16(int16_t, src,  [STRIDE * 24]);
+    LOCAL_ALIGNED_16(int16_t, src0, [STRIDE * 24]);
+    LOCAL_ALIGNED_16(int16_t, src1, [STRIDE * 24]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [STRIDE * 8]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [STRIDE * 8]);
+    int w, h, log2_scale;
+    declare_func(void, uint8_t *dst, int16_t *src,
+                 ptrdiff_t dst_stride, ptrdiff_t src_stride,
+                 ptrdiff_t width, ptrdiff_t height, ptrdiff_t log2_scale);
+
+    if (check_func(p->store_slice, "fspp_store_slice")) {
+        /* the filter stores 8 rows, or the remainder at the bottom, with a
+         * log2_scale of 5 - quality, quality being 4 or 5 */
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 32) {
+            h          = 1 + rnd() % 8;
+            log2_scale = rnd() % 2;
+            randomize_slice(src, STRIDE * 24, log2_scale);
+            memcpy(src0, src, sizeof(*src) * STRIDE * 24);
+            memcpy(src1, src, sizeof(*src) * STRIDE * 24);
+            memset(dst0, 0, STRIDE * 8);
+            memset(dst1, 0, STRIDE * 8);
+            call_ref(dst0, src0 + 8 * STRIDE, STRIDE, STRIDE, w, h, log2_scale);
+            call_new(dst1, src1 + 8 * STRIDE, STRIDE, STRIDE, w, h, log2_scale);
+            if (memcmp(dst0, dst1, STRIDE * 8) ||
+                memcmp(src0, src1, sizeof(*src) * STRIDE * 24))
+                fail();
+        }
+        bench_new(dst1, src1 + 8 * STRIDE, STRIDE, STRIDE, WIDTH, 8, 0);
+    }
+
+    if (check_func(p->store_slice2, "fspp_store_slice2")) {
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 32) {
+            h          = 1 + rnd() % 8;
+            log2_scale = rnd() % 2;
+            /* two slices are summed, halve the range of each */
+            randomize_slice(src, STRIDE * 24, log2_scale + 1);
+            memcpy(src0, src, sizeof(*src) * STRIDE * 24);
+            memcpy(src1, src, sizeof(*src) * STRIDE * 24);
+            memset(dst0, 0, STRIDE * 8);
+            memset(dst1, 0, STRIDE * 8);
+            call_ref(dst0, src0, STRIDE, STRIDE, w, h, log2_scale);
+            call_new(dst1, src1, STRIDE, STRIDE, w, h, log2_scale);
+            if (memcmp(dst0, dst1, STRIDE * 8) ||
+                memcmp(src0, src1, sizeof(*src) * STRIDE * 24))
+                fail();
+        }
+        bench_new(dst1, src1, STRIDE, STRIDE, WIDTH, 8, 0);
+    }
+}
+
+static void check_mul_thrmat(FSPPContext *p)
+{
+    LOCAL_ALIGNED_16(int16_t, noq,  [64]);
+    LOCAL_ALIGNED_16(int16_t, thr0, [64]);
+    LOCAL_ALIGNED_16(int16_t, thr1, [64]);
+    int i, q;
+    declare_func(void, int16_t *thr_adr_noq, int16_t *thr_adr, int q);
+
+    if (check_func(p->mul_thrmat, "fspp_mul_thrmat")) {
+        for (i = 0; i < 64; i++)
+            noq[i] = rnd() % 1024;
+        for (q = 1; q < 32; q++) {
+            memset(thr0, 0, sizeof(*thr0) * 64);
+            memset(thr1, 0, sizeof(*thr1) * 64);
+            call_ref(noq, thr0, q);
+            call_new(noq, thr1, q);
+            if (memcmp(thr0, thr1, sizeof(*thr0) * 64))
+                fail();
+        }
+        bench_new(noq, thr1, 31);
+    }
+}
+
+static void check_dct(FSPPContext *p)
+{
+    LOCAL_ALIGNED_16(uint8_t, pixels, [STRIDE * 8]);
+    LOCAL_ALIGNED_16(int16_t, thr,    [64]);
+    LOCAL_ALIGNED_16(int16_t, data,   [BLOCK_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, data0,  [BLOCK_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, data1,  [BLOCK_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, out,    [STRIDE * 8]);
+    LOCAL_ALIGNED_16(int16_t, out0,   [STRIDE * 8]);
+    LOCAL_ALIGNED_16(int16_t, out1,   [STRIDE * 8]);
+    const int cnt = 2 * (BLOCKSZ - 1);
+    int i;
+
+    for (i = 0; i < STRIDE * 8; i++)
+        pixels[i] = rnd();
+    for (i = 0; i < 64; i++)
+        thr[i] = rnd() % 64;
+
+    {
+        declare_func(void, int16_t *data, const uint8_t *pixels,
+                     ptrdiff_t line_size, int cnt);
+
+        if (check_func(p->row_fdct, "fspp_row_fdct")) {
+            memset(data0, 0, sizeof(*data0) * BLOCK_SIZE);
+            memset(data1, 0, sizeof(*data1) * BLOCK_SIZE);
+            call_ref(data0, pixels, STRIDE, cnt);
+            call_new(data1, pixels, STRIDE, cnt);
+            if (memcmp(data0, data1, sizeof(*data0) * BLOCK_SIZE))
+                fail();
+            bench_new(data1, pixels, STRIDE, cnt);
+        }
+    }
+
+    /* feed row_idct with what the previous stages produce, as the filter
+     * does, so the intermediate values stay in their real range */
+    memset(data, 0, sizeof(*data) * BLOCK_SIZE);
+    p->row_fdct(data, pixels, STRIDE, cnt);
+
+    /* column_fidct is not checked: the MMX version keeps the coefficients
+     * equal to the threshold, which the C version drops, and it rounds
+     * differently as it works in 16 bits, so the two are not bitexact */
+    for (i = 0; i < 64; i++)
+        out[i] = thr[i] * 8;
+    memset(data0, 0, sizeof(*data0) * BLOCK_SIZE);
+    p->column_fidct(out, data, data0, 4 * cnt);
+
+    {
+        declare_func(void, int16_t *workspace, int16_t *output_adr,
+                     ptrdiff_t output_stride, int cnt);
+
+        if (check_func(p->row_idct, "fspp_row_idct")) {
+            for (i = 0; i < STRIDE * 8; i++)
+                out[i] = rnd() % 4096;
+            memcpy(out0, out, sizeof(*out) * STRIDE * 8);
+            memcpy(out1, out, sizeof(*out) * STRIDE * 8);
+            call_ref(data0, out0, STRIDE, cnt);
+            call_new(data0, out1, STRIDE, cnt);
+            if (memcmp(out0, out1, sizeof(*out0) * STRIDE * 8))
+                fail();
+            bench_new(data0, out1, STRIDE, cnt);
+        }
+    }
+}
+
+void checkasm_check_vf_fspp(void)
+{
+    FSPPContext p = { 0 };
+
+    ff_fspp_init(&p);
+
+    check_store_slice(&p);
+    report("fspp_store_slice");
+
+    check_mul_thrmat(&p);
+    report("fspp_mul_thrmat");
+
+    check_dct(&p);
+    report("dct");
+}
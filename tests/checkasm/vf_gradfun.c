@@ -0,0 +1,116 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/gradfun.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH  1024
+#define STRIDE (WIDTH * 2 + 32)
+
+static void check_filter_line(GradFunContext *s)
+{
+    LOCAL_ALIGNED_16(uint8_t,  src,     [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t,  dst0,    [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t,  dst1,    [WIDTH]);
+    LOCAL_ALIGNED_16(uint16_t, dc,      [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, dithers, [8]);
+    int i, w;
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint16_t *dc,
+                 int width, int thresh, const uint16_t *dithers);
+
+    if (check_func(s->filter_line, "gradfun_filter_line")) {
+        for (i = 0; i < WIDTH; i++)
+            src[i] = rnd();
+        /* the blurred plane stays close to the source in smooth areas,
+         * which is where the filter does any work */
+        for (i = 0; i < WIDTH / 2; i++)
+            dc[i] = av_clip((src[2 * i] << 7) + (int)(rnd() % 1024) - 512, 0, 0x7fff);
+        for (i = 0; i < 8; i++)
+            dithers[i] = rnd() & 0x7f;
+
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 64) {
+            int thresh = (1 << 15) / (0.51 + (rnd() % 6300) / 100.0);
+
+            memset(dst0, 0, WIDTH);
+            memset(dst1, 0, WIDTH);
+            call_ref(dst0, src, dc, w, thresh, dithers);
+            call_new(dst1, src, dc, w, thresh, dithers);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, src, dc, WIDTH, 1 << 15, dithers);
+    }
+}
+
+static void check_blur_line(GradFunContext *s)
+{
+    LOCAL_ALIGNED_16(uint8_t,  src,  [STRIDE * 2]);
+    LOCAL_ALIGNED_16(uint16_t, buf1, [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, buf0, [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, buf,  [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, dc0,  [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, dc1,  [WIDTH / 2]);
+    LOCAL_ALIGNED_16(uint16_t, old,  [WIDTH / 2]);
+    int i, w, off;
+    declare_func(void, uint16_t *dc, uint16_t *buf, const uint16_t *buf1,
+                 const uint8_t *src, int src_linesize, int width);
+
+    if (check_func(s->blur_line, "gradfun_blur_line")) {
+        for (i = 0; i < STRIDE * 2; i++)
+            src[i] = rnd();
+        for (i = 0; i < WIDTH / 2; i++) {
+            buf1[i] = rnd() & 0x3fff;
+            old[i]  = rnd();
+        }
+
+        /* the filter passes half the plane width in multiples of 8, the
+         * SIMD version has an unaligned path for odd source pointers */
+        for (off = 0; off < 2; off++) {
+            for (w = 8; w <= WIDTH / 2 - 8; w += 8 * (1 + rnd() % 8)) {
+                memcpy(buf0, old, WIDTH);
+                memcpy(buf,  old, WIDTH);
+                memset(dc0, 0, WIDTH);
+                memset(dc1, 0, WIDTH);
+                call_ref(dc0, buf0, buf1, src + off, STRIDE, w);
+                call_new(dc1, buf,  buf1, src + off, STRIDE, w);
+                if (memcmp(dc0, dc1, WIDTH) || memcmp(buf0, buf, WIDTH))
+                    fail();
+            }
+        }
+        bench_new(dc1, buf, buf1, src, STRIDE, WIDTH / 2);
+    }
+}
+
+void checkasm_check_vf_gradfun(void)
+{
+    GradFunContext s = { 0 };
+
+    s.filter_line = ff_gradfun_filter_line_c;
+    s.blur_line   = ff_gradfun_blur_line_c;
+    if (ARCH_X86)
+        ff_gradfun_init_x86(&s);
+
+    check_filter_line(&s);
+    report("filter_line");
+
+    check_blur_line(&s);
+    report("blur_line");
+}
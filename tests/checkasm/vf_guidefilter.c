@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_guidefilter.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH 1920
+/* one spare float so that the kernels are also run unaligned */
+#define BUF_SIZE (WIDTH + 1)
+
+#define randomize_floats(buf, size)                      \
+    do {                                                 \
+        int k;                                           \
+        for (k = 0; k < size; k++)                       \
+            buf[k] = (rnd() & 0xffffff) / (float)(1 << 16); \
+    } while (0)
+
+static int floats_differ(const float *a, const float *b, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (fabsf(a[i] - b[i]) > 1e-5f * FFMAX(fabsf(a[i]), 1.0f))
+            return 1;
+    return 0;
+}
+
+static void check_slide(GuideFilterDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, add, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, sub, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, acc0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, acc1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, dst1, [BUF_SIZE]);
+    const float scale = 1.0f / 67;
+    int w, off;
+    declare_func(void, float *dst, float *acc, const float *add,
+                 const float *sub, int w, float scale);
+
+    if (check_func(dsp->slide, "guidefilter_slide")) {
+        for (w = 8; w <= 64; w += 8) {
+            off = rnd() & 1;
+            randomize_floats(add, BUF_SIZE);
+            randomize_floats(sub, BUF_SIZE);
+            randomize_floats(acc0, BUF_SIZE);
+            memcpy(acc1, acc0, BUF_SIZE * sizeof(*acc0));
+            memset(dst0, 0, BUF_SIZE * sizeof(*dst0));
+            memset(dst1, 0, BUF_SIZE * sizeof(*dst1));
+            call_ref(dst0 + off, acc0 + off, add + off, sub + off, w, scale);
+            call_new(dst1 + off, acc1 + off, add + off, sub + off, w, scale);
+            if (floats_differ(acc0, acc1, BUF_SIZE) ||
+                floats_differ(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(dst1, acc1, add, sub, WIDTH, scale);
+    }
+}
+
+static void check_accumulate(GuideFilterDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, acc0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, acc1, [BUF_SIZE]);
+    int w, off;
+    declare_func(void, float *acc, const float *src, int w);
+
+    if (check_func(dsp->accumulate, "guidefilter_accumulate")) {
+        for (w = 8; w <= 64; w += 8) {
+            off = rnd() & 1;
+            randomize_floats(src, BUF_SIZE);
+            randomize_floats(acc0, BUF_SIZE);
+            memcpy(acc1, acc0, BUF_SIZE * sizeof(*acc0));
+            call_ref(acc0 + off, src + off, w);
+            call_new(acc1 + off, src + off, w);
+            if (floats_differ(acc0, acc1, BUF_SIZE))
+                fail();
+        }
+        bench_new(acc1, src, WIDTH);
+    }
+}
+
+void checkasm_check_vf_guidefilter(void)
+{
+    GuideFilterDSPContext dsp;
+
+    ff_guidefilter_dsp_init(&dsp);
+
+    check_slide(&dsp);
+    report("slide");
+
+    check_accumulate(&dsp);
+    report("accumulate");
+}
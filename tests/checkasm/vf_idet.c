@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_idet.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH    1024
+#define BUF_SIZE (WIDTH * 2)
+
+static void randomize_line(uint8_t *buf, int depth)
+{
+    int i;
+
+    if (depth == 8) {
+        for (i = 0; i < BUF_SIZE; i++)
+            buf[i] = rnd();
+    } else {
+        for (i = 0; i < BUF_SIZE; i += 2)
+            AV_WN16A(buf + i, rnd() & ((1 << depth) - 1));
+    }
+}
+
+static void check_filter_line(int depth)
+{
+    LOCAL_ALIGNED_16(uint8_t, a, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, b, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, c, [BUF_SIZE]);
+    IDETContext idet = { 0 };
+    int w;
+    declare_func(int, const uint8_t *a, const uint8_t *b, const uint8_t *c, int w);
+
+    if (depth > 8)
+        idet.filter_line = (ff_idet_filter_func)ff_idet_filter_line_c_16bit;
+    else
+        idet.filter_line = ff_idet_filter_line_c;
+    if (ARCH_X86)
+        ff_idet_init_x86(&idet, depth > 8);
+
+    if (check_func(idet.filter_line, "idet_filter_line_%dbit", depth)) {
+        randomize_line(a, depth);
+        randomize_line(b, depth);
+        randomize_line(c, depth);
+
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 64) {
+            int sum0 = call_ref(a, b, c, w);
+            int sum1 = call_new(a, b, c, w);
+            if (sum0 != sum1)
+                fail();
+        }
+        bench_new(a, b, c, WIDTH);
+    }
+}
+
+void checkasm_check_vf_idet(void)
+{
+    check_filter_line(8);
+    check_filter_line(16);
+    report("filter_line");
+}
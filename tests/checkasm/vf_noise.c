@@ -0,0 +1,68 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_noise.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH 1024
+
+static void check_line_noise(NoiseContext *n)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,   [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, dst0,  [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t, dst1,  [WIDTH]);
+    LOCAL_ALIGNED_16(int8_t,  noise, [WIDTH + MAX_SHIFT]);
+    int i, w, shift;
+    declare_func(void, uint8_t *dst, const uint8_t *src, const int8_t *noise,
+                 int len, int shift);
+
+    if (check_func(n->line_noise, "noise_line_noise")) {
+        for (i = 0; i < WIDTH; i++)
+            src[i] = rnd();
+        for (i = 0; i < WIDTH + MAX_SHIFT; i++)
+            noise[i] = rnd();
+
+        /* the MMX versions do 8 pixels at a time and the rest in C */
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 64) {
+            shift = rnd() % MAX_SHIFT;
+            memset(dst0, 0, WIDTH);
+            memset(dst1, 0, WIDTH);
+            call_ref(dst0, src, noise, w, shift);
+            call_new(dst1, src, noise, w, shift);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, src, noise, WIDTH, 0);
+    }
+}
+
+void checkasm_check_vf_noise(void)
+{
+    NoiseContext n = { 0 };
+
+    ff_noise_init(&n);
+
+    /* line_noise_avg is not checked: the MMX version multiplies the pixels
+     * and the noise sum widened to 8.8 fixed point with pmulhw, which rounds
+     * differently from the C version by up to 2 for about half the inputs */
+    check_line_noise(&n);
+    report("line_noise");
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_pp7.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+static void check_dctB(PP7Context *p)
+{
+    LOCAL_ALIGNED_16(int16_t, src,  [7 * 4]);
+    LOCAL_ALIGNED_16(int16_t, dst0, [4 * 4]);
+    LOCAL_ALIGNED_16(int16_t, dst1, [4 * 4]);
+    int i, n;
+    declare_func(void, int16_t *dst, int16_t *src);
+
+    if (check_func(p->dctB, "pp7_dctB")) {
+        for (n = 0; n < 16; n++) {
+            /* the input is the output of the first pass over 8-bit pixels */
+            for (i = 0; i < 7 * 4; i++)
+                src[i] = (int)(rnd() % 8192) - 4096;
+            memset(dst0, 0, sizeof(*dst0) * 4 * 4);
+            memset(dst1, 0, sizeof(*dst1) * 4 * 4);
+            call_ref(dst0, src);
+            call_new(dst1, src);
+            if (memcmp(dst0, dst1, sizeof(*dst0) * 4 * 4))
+                fail();
+        }
+        bench_new(dst1, src);
+    }
+}
+
+void checkasm_check_vf_pp7(void)
+{
+    PP7Context p = { 0 };
+
+    /* requantize only has C versions */
+    ff_pp7_init(&p);
+
+    check_dctB(&p);
+    report("dctB");
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/psnr.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH    1920
+#define BUF_SIZE (WIDTH * 2 + 32)
+
+#define randomize_buffer(buf)                 \
+    do {                                      \
+        int k;                                \
+        for (k = 0; k < BUF_SIZE; k += 4)     \
+            AV_WN32A(buf + k, rnd());         \
+    } while (0)
+
+static void check_sse_line(int bpp)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [BUF_SIZE]);
+    PSNRDSPContext dsp;
+    int i, w;
+    declare_func(uint64_t, const uint8_t *buf, const uint8_t *ref, int w);
+
+    ff_psnr_dsp_init(&dsp, bpp);
+
+    if (check_func(dsp.sse_line, "sse_line_%dbit", bpp)) {
+        randomize_buffer(buf);
+        randomize_buffer(ref);
+        if (bpp > 8) {
+            for (i = 0; i < BUF_SIZE; i += 2) {
+                AV_WN16A(buf + i, AV_RN16A(buf + i) & ((1 << bpp) - 1));
+                AV_WN16A(ref + i, AV_RN16A(ref + i) & ((1 << bpp) - 1));
+            }
+        }
+
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 64) {
+            uint64_t sse0 = call_ref(buf, ref, w);
+            uint64_t sse1 = call_new(buf, ref, w);
+            if (sse0 != sse1)
+                fail();
+        }
+        bench_new(buf, ref, WIDTH);
+    }
+}
+
+void checkasm_check_vf_psnr(void)
+{
+    check_sse_line(8);
+    check_sse_line(10);
+    check_sse_line(15);
+    report("sse_line");
+}
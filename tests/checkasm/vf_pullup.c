@@ -0,0 +1,73 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_pullup.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define BLOCKS   32
+#define STRIDE   (BLOCKS * 8)
+/* one line of context above and below the 4 lines of a block */
+#define BUF_SIZE (STRIDE * 6)
+
+#define randomize_buffer(buf)                 \
+    do {                                      \
+        int k;                                \
+        for (k = 0; k < BUF_SIZE; k += 4)     \
+            AV_WN32A(buf + k, rnd());         \
+    } while (0)
+
+#define CHECK_METRIC(name)                                                 \
+    do {                                                                   \
+        if (check_func(s->name, "pullup_" #name)) {                        \
+            int x;                                                         \
+            randomize_buffer(a);                                           \
+            randomize_buffer(b);                                           \
+            for (x = 0; x < STRIDE; x += 8) {                              \
+                int res0 = call_ref(a + STRIDE + x, b + STRIDE + x, STRIDE); \
+                int res1 = call_new(a + STRIDE + x, b + STRIDE + x, STRIDE); \
+                if (res0 != res1)                                          \
+                    fail();                                                \
+            }                                                              \
+            bench_new(a + STRIDE, b + STRIDE, STRIDE);                     \
+        }                                                                  \
+    } while (0)
+
+static void check_metrics(PullupContext *s)
+{
+    LOCAL_ALIGNED_16(uint8_t, a, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, b, [BUF_SIZE]);
+    declare_func(int, const uint8_t *a, const uint8_t *b, ptrdiff_t s);
+
+    CHECK_METRIC(diff);
+    CHECK_METRIC(comb);
+    CHECK_METRIC(var);
+}
+
+void checkasm_check_vf_pullup(void)
+{
+    PullupContext s = { 0 };
+
+    ff_pullup_init(&s);
+
+    check_metrics(&s);
+    report("metrics");
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/avdct.h"
+#include "libavfilter/vf_spp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#define WIDTH  256
+#define STRIDE (WIDTH + 16)
+
+static void check_store_slice(SPPContext *s)
+{
+    LOCAL_ALIGNED_16(int16_t, src,    [STRIDE * 8]);
+    LOCAL_ALIGNED_16(uint8_t, dst0,   [STRIDE * 8]);
+    LOCAL_ALIGNED_16(uint8_t, dst1,   [STRIDE * 8]);
+    LOCAL_ALIGNED_8(uint8_t,  dither, [8], [8]);
+    int i, w, h, log2_scale;
+    declare_func(void, uint8_t *dst, const int16_t *src,
+                 int dst_stride, int src_stride,
+                 int width, int height, int log2_scale,
+                 const uint8_t dither[8][8]);
+
+    if (check_func(s->store_slice, "spp_store_slice")) {
+        for (i = 0; i < 64; i++)
+            dither[i / 8][i % 8] = rnd() % 64;
+
+        /* log2_scale is MAX_LEVEL - quality with a quality of at least 1 */
+        for (w = 1; w <= WIDTH; w += 1 + rnd() % 32) {
+            h          = 1 + rnd() % 8;
+            log2_scale = rnd() % MAX_LEVEL;
+            /* keep the sums inside the range the C version clips correctly */
+            for (i = 0; i < STRIDE * 8; i++)
+                src[i] = ((int)(rnd() % 640) - 128) << (MAX_LEVEL - log2_scale);
+            memset(dst0, 0, STRIDE * 8);
+            memset(dst1, 0, STRIDE * 8);
+            call_ref(dst0, src, STRIDE, STRIDE, w, h, log2_scale, dither);
+            call_new(dst1, src, STRIDE, STRIDE, w, h, log2_scale, dither);
+            if (memcmp(dst0, dst1, STRIDE * 8))
+                fail();
+        }
+        bench_new(dst1, src, STRIDE, STRIDE, WIDTH, 8, 3, dither);
+    }
+}
+
+static void check_requantize(SPPContext *s, const char *name)
+{
+    LOCAL_ALIGNED_16(uint8_t, pixels, [8 * 8]);
+    LOCAL_ALIGNED_16(int16_t, block,  [64]);
+    LOCAL_ALIGNED_16(int16_t, dst0,   [64]);
+    LOCAL_ALIGNED_16(int16_t, dst1,   [64]);
+    int i, qp;
+    declare_func(void, int16_t dst[64], const int16_t src[64],
+                 int qp, const uint8_t *permutation);
+
+    if (check_func(s->requantize, "%s", name)) {
+        for (qp = 1; qp < 32; qp++) {
+            for (i = 0; i < 8 * 8; i++)
+                pixels[i] = rnd();
+            s->dct->get_pixels(block, pixels, 8);
+            s->dct->fdct(block);
+
+            memset(dst0, 0, sizeof(*dst0) * 64);
+            memset(dst1, 0, sizeof(*dst1) * 64);
+            call_ref(dst0, block, qp, s->dct->idct_permutation);
+            call_new(dst1, block, qp, s->dct->idct_permutation);
+            if (memcmp(dst0, dst1, sizeof(*dst0) * 64))
+                fail();
+        }
+        bench_new(dst1, block, 8, s->dct->idct_permutation);
+    }
+}
+
+void checkasm_check_vf_spp(void)
+{
+    SPPContext s = { 0 };
+
+    s.dct = avcodec_dct_alloc();
+    if (!s.dct)
+        return;
+    /* the SIMD requantizers are only used for 8-bit input */
+    av_opt_set_int(s.dct, "bits_per_sample", 8, 0);
+    avcodec_dct_init(s.dct);
+
+    ff_spp_init(&s);
+    check_store_slice(&s);
+    report("spp_store_slice");
+
+    s.mode = 0;
+    ff_spp_init(&s);
+    check_requantize(&s, "spp_hardthresh");
+
+    s.mode = 1;
+    ff_spp_init(&s);
+    check_requantize(&s, "spp_softthresh");
+    report("requantize");
+
+    av_freep(&s.dct);
+}
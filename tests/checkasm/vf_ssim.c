@@ -0,0 +1,105 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/ssim.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH    1920
+#define STRIDE   (WIDTH + 32)
+#define BUF_SIZE (STRIDE * 4)
+/* the 4x4 sums of one row of blocks */
+#define SUMS     (WIDTH / 4 + 3)
+
+#define randomize_buffer(buf)                 \
+    do {                                      \
+        int k;                                \
+        for (k = 0; k < BUF_SIZE; k += 4)     \
+            AV_WN32A(buf + k, rnd());         \
+    } while (0)
+
+static void check_ssim_4x4_line(SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, sums0, [SUMS], [4]);
+    LOCAL_ALIGNED_32(int, sums1, [SUMS], [4]);
+    int w;
+    declare_func(void, const uint8_t *buf, ptrdiff_t buf_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int (*sums)[4], int w);
+
+    if (check_func(dsp->ssim_4x4_line, "ssim_4x4_line")) {
+        randomize_buffer(buf);
+        randomize_buffer(ref);
+
+        for (w = 1; w <= WIDTH / 4; w += 1 + rnd() % 16) {
+            memset(sums0, 0, sizeof(int) * SUMS * 4);
+            memset(sums1, 0, sizeof(int) * SUMS * 4);
+            call_ref(buf, STRIDE, ref, STRIDE, sums0, w);
+            call_new(buf, STRIDE, ref, STRIDE, sums1, w);
+            if (memcmp(sums0, sums1, sizeof(int) * 4 * w))
+                fail();
+        }
+        bench_new(buf, STRIDE, ref, STRIDE, sums1, WIDTH / 4);
+    }
+}
+
+static void check_ssim_end_line(SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int, sum0, [SUMS], [4]);
+    LOCAL_ALIGNED_32(int, sum1, [SUMS], [4]);
+    int w;
+    declare_func(float, const int (*sum0)[4], const int (*sum1)[4], int w);
+
+    if (check_func(dsp->ssim_end_line, "ssim_end_line")) {
+        /* sums of two rows of real blocks, as the filter passes them */
+        randomize_buffer(buf);
+        randomize_buffer(ref);
+        dsp->ssim_4x4_line(buf, STRIDE, ref, STRIDE, sum0, WIDTH / 4 + 1);
+        randomize_buffer(buf);
+        dsp->ssim_4x4_line(buf, STRIDE, ref, STRIDE, sum1, WIDTH / 4 + 1);
+
+        for (w = 1; w <= WIDTH / 4; w += 1 + rnd() % 16) {
+            float ssim0 = call_ref((const int (*)[4])sum0, (const int (*)[4])sum1, w);
+            float ssim1 = call_new((const int (*)[4])sum0, (const int (*)[4])sum1, w);
+            /* the SIMD version sums in a different order */
+            if (!float_near_abs_eps(ssim0, ssim1, 1e-5f * w))
+                fail();
+        }
+        bench_new((const int (*)[4])sum0, (const int (*)[4])sum1, WIDTH / 4);
+    }
+}
+
+void checkasm_check_vf_ssim(void)
+{
+    SSIMDSPContext dsp;
+
+    ff_ssim_dsp_init(&dsp);
+
+    check_ssim_4x4_line(&dsp);
+    report("ssim_4x4_line");
+
+    check_ssim_end_line(&dsp);
+    report("ssim_end_line");
+}
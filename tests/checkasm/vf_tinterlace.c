@@ -0,0 +1,74 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/tinterlace.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH    1920
+#define BUF_SIZE (WIDTH + 64)
+
+#define randomize_buffer(buf)                 \
+    do {                                      \
+        int k;                                \
+        for (k = 0; k < BUF_SIZE; k += 4)     \
+            AV_WN32A(buf + k, rnd());         \
+    } while (0)
+
+static void check_lowpass_line(TInterlaceContext *s)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,   [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, above, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, below, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,  [BUF_SIZE]);
+    int w;
+    declare_func(void, uint8_t *dstp, ptrdiff_t width, const uint8_t *srcp,
+                 const uint8_t *srcp_above, const uint8_t *srcp_below);
+
+    if (check_func(s->lowpass_line, "tinterlace_lowpass_line")) {
+        randomize_buffer(src);
+        randomize_buffer(above);
+        randomize_buffer(below);
+
+        /* the SIMD versions process 32 pixels at a time and rely on the
+         * padding of the frame for the remainder */
+        for (w = 32; w <= WIDTH; w += 32 * (1 + rnd() % 4)) {
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(dst0, w, src, above, below);
+            call_new(dst1, w, src, above, below);
+            if (memcmp(dst0, dst1, w))
+                fail();
+        }
+        bench_new(dst1, WIDTH, src, above, below);
+    }
+}
+
+void checkasm_check_vf_tinterlace(void)
+{
+    TInterlaceContext s = { 0 };
+
+    ff_tinterlace_init(&s);
+
+    check_lowpass_line(&s);
+    report("lowpass_line");
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/yadif.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/pixdesc.h"
+
+#define WIDTH    512
+#define STRIDE   (WIDTH * 2 + 64)
+/* filter_line reads two lines above and below the current one */
+#define ROWS     5
+#define BUF_SIZE (STRIDE * ROWS)
+
+static void randomize_plane(uint8_t *buf, int depth)
+{
+    int i;
+
+    if (depth == 8) {
+        for (i = 0; i < BUF_SIZE; i++)
+            buf[i] = rnd();
+    } else {
+        for (i = 0; i < BUF_SIZE; i += 2)
+            AV_WN16A(buf + i, rnd() & ((1 << depth) - 1));
+    }
+}
+
+static void check_filter_line(enum AVPixelFormat pix_fmt)
+{
+    LOCAL_ALIGNED_32(uint8_t, prev, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, cur,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, next, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [STRIDE]);
+    YADIFContext s = { 0 };
+    int depth, bps, parity, mode;
+    declare_func(void, void *dst, void *prev, void *cur, void *next,
+                 int w, int prefs, int mrefs, int parity, int mode);
+
+    s.csp = av_pix_fmt_desc_get(pix_fmt);
+    depth = s.csp->comp[0].depth_minus1 + 1;
+    bps   = (depth + 7) / 8;
+    ff_yadif_init(&s);
+
+    if (check_func(s.filter_line, "yadif_filter_line_%dbit", depth)) {
+        /* the filter skips 3 pixels on the left and up to 7 on the right,
+         * which filter_edges handles */
+        int w   = WIDTH - (3 + 8 / bps - 1);
+        int off = 2 * STRIDE + 3 * bps;
+
+        randomize_plane(prev, depth);
+        randomize_plane(cur,  depth);
+        randomize_plane(next, depth);
+
+        for (parity = 0; parity < 2; parity++) {
+            for (mode = 0; mode < 4; mode++) {
+                memset(dst0, 0, STRIDE);
+                memset(dst1, 0, STRIDE);
+                call_ref(dst0 + 3 * bps, prev + off, cur + off, next + off,
+                         w, STRIDE, -STRIDE, parity, mode);
+                call_new(dst1 + 3 * bps, prev + off, cur + off, next + off,
+                         w, STRIDE, -STRIDE, parity, mode);
+                if (memcmp(dst0 + 3 * bps, dst1 + 3 * bps, w * bps))
+                    fail();
+            }
+        }
+        bench_new(dst1 + 3 * bps, prev + off, cur + off, next + off,
+                  w, STRIDE, -STRIDE, 0, 0);
+    }
+}
+
+void checkasm_check_vf_yadif(void)
+{
+    check_filter_line(AV_PIX_FMT_YUV420P);
+    check_filter_line(AV_PIX_FMT_YUV420P10);
+    check_filter_line(AV_PIX_FMT_YUV420P16);
+    report("filter_line");
+}
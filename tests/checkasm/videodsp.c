@@ -0,0 +1,91 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/videodsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define MAX_BLOCK  64
+#define MAX_PIC    64
+/* room for blocks lying entirely left of / above the picture */
+#define SRC_STRIDE (2 * (MAX_PIC + 2 * MAX_BLOCK))
+#define SRC_SIZE   (SRC_STRIDE * (MAX_PIC + 2 * MAX_BLOCK))
+#define DST_STRIDE (2 * MAX_BLOCK)
+#define DST_SIZE   (DST_STRIDE * MAX_BLOCK)
+
+static void check_emulated_edge_mc(VideoDSPContext *vdsp, int bpc)
+{
+    LOCAL_ALIGNED_16(uint8_t, src,  [SRC_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [DST_SIZE]);
+    int pixel_size = (bpc + 7) / 8;
+    const uint8_t *pic = src + MAX_BLOCK * SRC_STRIDE + MAX_BLOCK * pixel_size;
+    int block_w, block_h, src_x, src_y, w, h, i, y;
+    declare_func(void, uint8_t *dst, const uint8_t *src,
+                 ptrdiff_t dst_linesize, ptrdiff_t src_linesize,
+                 int block_w, int block_h, int src_x, int src_y, int w, int h);
+
+    for (i = 0; i < SRC_SIZE; i++)
+        src[i] = rnd();
+
+    if (check_func(vdsp->emulated_edge_mc, "emulated_edge_mc_%dbpc", bpc)) {
+        for (i = 0; i < 256; i++) {
+            const uint8_t *s;
+
+            block_w = 1 + rnd() % MAX_BLOCK;
+            block_h = 1 + rnd() % MAX_BLOCK;
+            w       = 1 + rnd() % MAX_PIC;
+            h       = 1 + rnd() % MAX_PIC;
+            /* the block must overlap the picture by at least one sample */
+            src_x   = (int)(rnd() % (w + block_w - 1)) - (block_w - 1);
+            src_y   = (int)(rnd() % (h + block_h - 1)) - (block_h - 1);
+            s       = pic + src_y * SRC_STRIDE + src_x * pixel_size;
+
+            memset(dst0, 0, DST_SIZE);
+            memset(dst1, 0, DST_SIZE);
+            call_ref(dst0, s, DST_STRIDE, SRC_STRIDE,
+                     block_w, block_h, src_x, src_y, w, h);
+            call_new(dst1, s, DST_STRIDE, SRC_STRIDE,
+                     block_w, block_h, src_x, src_y, w, h);
+            for (y = 0; y < block_h; y++) {
+                if (memcmp(dst0 + y * DST_STRIDE, dst1 + y * DST_STRIDE,
+                           block_w * pixel_size)) {
+                    fail();
+                    break;
+                }
+            }
+            if (y < block_h)
+                break;
+        }
+        bench_new(dst1, pic - 8 * SRC_STRIDE - 8 * pixel_size,
+                  DST_STRIDE, SRC_STRIDE, 24, 24, -8, -8, MAX_PIC, MAX_PIC);
+    }
+}
+
+void checkasm_check_videodsp(void)
+{
+    VideoDSPContext vdsp;
+
+    ff_videodsp_init(&vdsp, 8);
+    check_emulated_edge_mc(&vdsp, 8);
+    ff_videodsp_init(&vdsp, 16);
+    check_emulated_edge_mc(&vdsp, 16);
+    report("emulated_edge_mc");
+}
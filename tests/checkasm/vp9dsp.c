@@ -0,0 +1,377 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/vp9dsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+static const int bit_depths[] = { 8, 10, 12 };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+
+static void randomize_pixels(uint8_t *buf, int size, int bit_depth)
+{
+    int mask = (1 << bit_depth) - 1;
+    int i;
+
+    if (bit_depth == 8) {
+        for (i = 0; i < size; i++)
+            buf[i] = rnd();
+    } else {
+        for (i = 0; i < size; i += 2)
+            AV_WN16A(buf + i, rnd() & mask);
+    }
+}
+
+#define IPRED_STRIDE    (32 * 2)
+#define IPRED_SIZE      (32 * IPRED_STRIDE)
+/* left, then top-left, top and top-right with top aligned */
+#define IPRED_EDGE_SIZE (256)
+#define IPRED_TOP       (96)
+
+static void check_ipred(void)
+{
+    static const char *const mode_names[N_INTRA_PRED_MODES] = {
+        [VERT_PRED]            = "vert",
+        [HOR_PRED]             = "hor",
+        [DC_PRED]              = "dc",
+        [DIAG_DOWN_LEFT_PRED]  = "diag_downleft",
+        [DIAG_DOWN_RIGHT_PRED] = "diag_downright",
+        [VERT_RIGHT_PRED]      = "vert_right",
+        [HOR_DOWN_PRED]        = "hor_down",
+        [VERT_LEFT_PRED]       = "vert_left",
+        [HOR_UP_PRED]          = "hor_up",
+        [TM_VP8_PRED]          = "tm",
+        [LEFT_DC_PRED]         = "dc_left",
+        [TOP_DC_PRED]          = "dc_top",
+        [DC_128_PRED]          = "dc_128",
+        [DC_127_PRED]          = "dc_127",
+        [DC_129_PRED]          = "dc_129",
+    };
+    LOCAL_ALIGNED_32(uint8_t, edge, [IPRED_EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [IPRED_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [IPRED_SIZE]);
+    VP9DSPContext dsp;
+    int tx, mode, i;
+    declare_func(void, uint8_t *dst, ptrdiff_t stride,
+                 const uint8_t *left, const uint8_t *top);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        const uint8_t *left = edge, *top = edge + IPRED_TOP;
+
+        ff_vp9dsp_init(&dsp, bit_depth);
+        for (tx = 0; tx < 4; tx++) {
+            int size = 4 << tx;
+
+            for (mode = 0; mode < N_INTRA_PRED_MODES; mode++) {
+                if (check_func(dsp.intra_pred[tx][mode], "vp9_%s_%dx%d_%dbpp",
+                               mode_names[mode], size, size, bit_depth)) {
+                    randomize_pixels(edge, IPRED_EDGE_SIZE, bit_depth);
+                    randomize_pixels(dst0, IPRED_SIZE, bit_depth);
+                    memcpy(dst1, dst0, IPRED_SIZE);
+                    call_ref(dst0, IPRED_STRIDE, left, top);
+                    call_new(dst1, IPRED_STRIDE, left, top);
+                    if (memcmp(dst0, dst1, IPRED_SIZE))
+                        fail();
+                    bench_new(dst1, IPRED_STRIDE, left, top);
+                }
+            }
+        }
+    }
+    report("ipred");
+}
+
+#define ITXFM_STRIDE    (32 * 2)
+#define ITXFM_SIZE      (32 * ITXFM_STRIDE)
+#define ITXFM_COEF_SIZE (32 * 32 * 4)
+
+/* VP9's inverse transforms are orthogonal up to the scaling of the DC basis
+ * function, so a floating-point forward DCT yields realistic coefficients for
+ * every transform type. */
+static void fdct_1d(double *out, const double *in, int sz, int stride)
+{
+    int k, n;
+
+    for (k = 0; k < sz; k++) {
+        double sum = 0.0;
+
+        for (n = 0; n < sz; n++)
+            sum += in[n * stride] * cos(M_PI * (2 * n + 1) * k / (2.0 * sz));
+        out[k * stride] = sum * (k ? 2.0 : M_SQRT2) / sz;
+    }
+}
+
+static int rnd_residual(int bit_depth)
+{
+    int max = (1 << bit_depth) - 1;
+
+    return (int) (rnd() % (2 * max + 1)) - max;
+}
+
+/* Random residual, forward transformed and scaled to what the inverse
+ * transform plus rounding shift expects. A DC-only block gets a random DC
+ * value instead, kept in a range where the C code does not overflow. */
+static void gen_coeffs(uint8_t *block, int sz, int lossless, int dc_only,
+                       int bit_depth)
+{
+    double res[32 * 32], tmp[32 * 32];
+    int bits = sz == 4 ? 4 : sz == 8 ? 5 : 6;
+    int i, n = dc_only ? 1 : sz * sz;
+
+    if (!lossless && !dc_only) {
+        for (i = 0; i < sz * sz; i++)
+            res[i] = rnd_residual(bit_depth) * (1 << bits);
+        for (i = 0; i < sz; i++)
+            fdct_1d(tmp + i, res + i, sz, sz);
+        for (i = 0; i < sz; i++)
+            fdct_1d(res + i * sz, tmp + i * sz, sz, 1);
+    }
+
+    for (i = 0; i < n; i++) {
+        int c = lossless ? rnd_residual(bit_depth)     :
+                dc_only  ? rnd_residual(bit_depth) * 16 : lrint(res[i]);
+
+        if (bit_depth == 8)
+            ((int16_t *) block)[i] = av_clip_int16(c);
+        else
+            ((int32_t *) block)[i] = c;
+    }
+}
+
+static void check_itxfm(void)
+{
+    static const char *const txtp_names[N_TXFM_TYPES] = {
+        [DCT_DCT]   = "dct_dct",
+        [DCT_ADST]  = "adst_dct",
+        [ADST_DCT]  = "dct_adst",
+        [ADST_ADST] = "adst_adst",
+    };
+    LOCAL_ALIGNED_32(uint8_t, coef0, [ITXFM_COEF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, coef1, [ITXFM_COEF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,  [ITXFM_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,  [ITXFM_SIZE]);
+    VP9DSPContext dsp;
+    int tx, txtp, i, dc_only;
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, int16_t *block, int eob);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+
+        ff_vp9dsp_init(&dsp, bit_depth);
+        for (tx = 0; tx <= 4; tx++) {
+            int lossless = tx == 4;
+            int sz = lossless ? 4 : 4 << tx;
+
+            for (txtp = 0; txtp < N_TXFM_TYPES; txtp++) {
+                if (check_func(dsp.itxfm_add[tx][txtp], "vp9_inv_%s_%dx%d_add_%dbpp",
+                               lossless ? "wht_wht" : txtp_names[txtp],
+                               sz, sz, bit_depth)) {
+                    for (dc_only = 0; dc_only <= !lossless; dc_only++) {
+                        int eob = dc_only ? 1 : sz * sz;
+
+                        memset(coef0, 0, ITXFM_COEF_SIZE);
+                        gen_coeffs(coef0, sz, lossless, dc_only, bit_depth);
+                        memcpy(coef1, coef0, ITXFM_COEF_SIZE);
+                        randomize_pixels(dst0, ITXFM_SIZE, bit_depth);
+                        memcpy(dst1, dst0, ITXFM_SIZE);
+                        call_ref(dst0, ITXFM_STRIDE, (int16_t *) coef0, eob);
+                        call_new(dst1, ITXFM_STRIDE, (int16_t *) coef1, eob);
+                        if (memcmp(dst0, dst1, ITXFM_SIZE) ||
+                            memcmp(coef0, coef1, ITXFM_COEF_SIZE))
+                            fail();
+                    }
+                    gen_coeffs(coef1, sz, lossless, 0, bit_depth);
+                    bench_new(dst1, ITXFM_STRIDE, (int16_t *) coef1, sz * sz);
+                }
+            }
+            /* the lossless transform is the same for every type */
+            if (lossless)
+                break;
+        }
+    }
+    report("itxfm");
+}
+
+#define LPF_STRIDE (16 * 2 * 2)
+#define LPF_SIZE   (16 * LPF_STRIDE)
+
+/* Fill a 16x16 block so that a filter across the edge in the middle (at
+ * column 8 for h, row 8 for v) takes every path of the C loop filter:
+ * each line along the edge is flat, smooth or noisy, with a step of random
+ * height across the edge. */
+static void randomize_lpf(uint8_t *buf, int dir, int bit_depth)
+{
+    int max = (1 << bit_depth) - 1, scale = 1 << (bit_depth - 8);
+    int line, pos;
+
+    for (line = 0; line < 16; line++) {
+        int type = rnd() % 4, base = rnd() & max;
+        int step = ((int) (rnd() % 33) - 16) * scale;
+        int noise = type == 0 ? 1 : type == 1 ? 4 : type == 2 ? 12 : 255;
+
+        for (pos = 0; pos < 16; pos++) {
+            int v = base + (pos >= 8 ? step : 0) +
+                    ((int) (rnd() % (2 * noise + 1)) - noise) * scale / 2;
+            int off = dir ? pos * LPF_STRIDE + line * SIZEOF_PIXEL
+                          : line * LPF_STRIDE + pos * SIZEOF_PIXEL;
+
+            v = av_clip(v, 0, max);
+            if (bit_depth == 8)
+                buf[off] = v;
+            else
+                AV_WN16A(buf + off, v);
+        }
+    }
+}
+
+static void check_loopfilter(void)
+{
+    static const char *const dir_names[2] = { "h", "v" };
+    static const int wds[3] = { 4, 8, 16 };
+    LOCAL_ALIGNED_32(uint8_t, buf0, [LPF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [LPF_SIZE]);
+    VP9DSPContext dsp;
+    int i, dir, wd, wd2, n;
+    declare_func(void, uint8_t *dst, ptrdiff_t stride, int E, int I, int H);
+
+#define LPF_DST(buf) (buf + (dir ? 8 * LPF_STRIDE : 8 * SIZEOF_PIXEL))
+#define LPF_E() (20 + rnd() % 60)
+#define LPF_I() (4 + rnd() % 30)
+#define LPF_H() (rnd() % 4)
+#define check_lpf(...)                                          \
+    do {                                                        \
+        for (n = 0; n < 16; n++) {                              \
+            randomize_lpf(buf0, dir, bit_depth);                \
+            memcpy(buf1, buf0, LPF_SIZE);                       \
+            call_ref(LPF_DST(buf0), LPF_STRIDE, __VA_ARGS__);   \
+            call_new(LPF_DST(buf1), LPF_STRIDE, __VA_ARGS__);   \
+            if (memcmp(buf0, buf1, LPF_SIZE))                   \
+                fail();                                         \
+        }                                                       \
+        bench_new(LPF_DST(buf1), LPF_STRIDE, __VA_ARGS__);      \
+    } while (0)
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        int E = LPF_E(), I = LPF_I(), H = LPF_H();
+
+        ff_vp9dsp_init(&dsp, bit_depth);
+        for (dir = 0; dir < 2; dir++) {
+            for (wd = 0; wd < 3; wd++) {
+                if (check_func(dsp.loop_filter_8[wd][dir], "vp9_loop_filter_%s_%d_8_%dbpp",
+                               dir_names[dir], wds[wd], bit_depth))
+                    check_lpf(E, I, H);
+            }
+            if (check_func(dsp.loop_filter_16[dir], "vp9_loop_filter_%s_16_16_%dbpp",
+                           dir_names[dir], bit_depth))
+                check_lpf(E, I, H);
+            for (wd = 0; wd < 2; wd++) {
+                for (wd2 = 0; wd2 < 2; wd2++) {
+                    if (check_func(dsp.loop_filter_mix2[wd][wd2][dir],
+                                   "vp9_loop_filter_mix2_%s_%d%d_16_%dbpp",
+                                   dir_names[dir], wds[wd], wds[wd2], bit_depth)) {
+                        int E2 = E | LPF_E() << 8, I2 = I | LPF_I() << 8;
+                        int H2 = H | LPF_H() << 8;
+                        check_lpf(E2, I2, H2);
+                    }
+                }
+            }
+        }
+    }
+    report("loopfilter");
+
+#undef check_lpf
+#undef LPF_H
+#undef LPF_I
+#undef LPF_E
+#undef LPF_DST
+}
+
+#define MC_SRC_STRIDE (72 * 2)
+#define MC_SRC_SIZE   (72 * MC_SRC_STRIDE)
+#define MC_DST_STRIDE (64 * 2)
+#define MC_DST_SIZE   (64 * MC_DST_STRIDE)
+
+static void check_mc(void)
+{
+    static const char *const filter_names[4] = {
+        "8tap_smooth", "8tap_regular", "8tap_sharp", "bilin"
+    };
+    static const char *const subpel_names[2][2] = { { "", "h" }, { "v", "hv" } };
+    LOCAL_ALIGNED_32(uint8_t, src_buf, [MC_SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MC_DST_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MC_DST_SIZE]);
+    VP9DSPContext dsp;
+    int i, hsize, filter, op, dx, dy;
+    declare_func(void, uint8_t *dst, ptrdiff_t dst_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int h, int mx, int my);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        /* room for the 3 rows/columns before and 4 after the block */
+        const uint8_t *src = src_buf + 3 * MC_SRC_STRIDE + 3 * SIZEOF_PIXEL;
+
+        ff_vp9dsp_init(&dsp, bit_depth);
+        for (hsize = 0; hsize < 5; hsize++) {
+            int size = 64 >> hsize;
+
+            for (filter = 0; filter < 4; filter++) {
+                for (op = 0; op < 2; op++) {
+                    for (dx = 0; dx < 2; dx++) {
+                        for (dy = 0; dy < 2; dy++) {
+                            if (check_func(dsp.mc[hsize][filter][op][dx][dy],
+                                           "vp9_%s_%s%d%s_%dbpp", op ? "avg" : "put",
+                                           dx || dy ? filter_names[filter] : "fpel",
+                                           size, subpel_names[dy][dx], bit_depth)) {
+                                int mx = dx ? 1 + rnd() % 15 : 0;
+                                int my = dy ? 1 + rnd() % 15 : 0;
+
+                                randomize_pixels(src_buf, MC_SRC_SIZE, bit_depth);
+                                randomize_pixels(dst0, MC_DST_SIZE, bit_depth);
+                                memcpy(dst1, dst0, MC_DST_SIZE);
+                                call_ref(dst0, MC_DST_STRIDE, src, MC_SRC_STRIDE,
+                                         size, mx, my);
+                                call_new(dst1, MC_DST_STRIDE, src, MC_SRC_STRIDE,
+                                         size, mx, my);
+                                if (memcmp(dst0, dst1, MC_DST_SIZE))
+                                    fail();
+                                bench_new(dst1, MC_DST_STRIDE, src, MC_SRC_STRIDE,
+                                          size, mx, my);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    report("mc");
+}
+
+void checkasm_check_vp9dsp(void)
+{
+    check_ipred();
+    check_itxfm();
+    check_loopfilter();
+    check_mc();
+}
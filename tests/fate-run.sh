@@ -244,6 +244,106 @@ gapless(){
     do_md5sum $decfile3
 }
 
+drmemb(){
+    sample=$(target_path $1)
+    markfile="${outdir}/${test}.pgm"
+    rawmark="${outdir}/${test}.mark"
+    embfile="${outdir}/${test}.h264"
+    decfile="${outdir}/${test}.out"
+    cleanfiles="$cleanfiles $markfile $rawmark $embfile $decfile"
+    errors=
+
+    ffmpeg -f lavfi -i "testsrc=s=16x16,format=gray,lutyuv=y=if(gt(val\,128)\,255\,0)" \
+        -frames:v 1 -y $markfile || return
+    ffmpeg -i $(target_path $markfile) -f rawvideo -y $rawmark || return
+    ffmpeg -i "$sample" -c copy -bsf:v h264_drmemb=wm=$(target_path $markfile) -f h264 -y $embfile || return
+    # count the watermark pixels read back wrong, before and after embedding,
+    # the intra 16x16 macroblocks carry no mark so a few may stay wrong
+    for f in "$sample" $(target_path $embfile); do
+        ffmpeg -i "$f" -frames:v 1 -vf drmDec=drmw=16:drmh=16 -pix_fmt gray -f rawvideo -y $decfile || return
+        errors="$errors $(cmp -l $rawmark $decfile | wc -l)"
+    done
+    set -- $errors
+    if [ $(($2 * 2)) -lt $1 ]; then
+        echo "watermark recovered"
+    else
+        echo "watermark not recovered: $1 wrong pixels before, $2 after embedding"
+    fi
+}
+
+slice_pipeline_noise(){
+    sample=$(target_path $1)
+    noisefile="${outdir}/${test}.h264"
+    reffile="${outdir}/${test}.ref"
+    pipefile="${outdir}/${test}.pipe"
+    cleanfiles="$cleanfiles $noisefile $reffile $pipefile"
+
+    # damage the CABAC data so the entropy stage of the pipeline fails
+    # mid slice, the reconstruction must still get to the end of each slice
+    ffmpeg -i "$sample" -c copy -bsf:v noise=$2 -f h264 -y $noisefile || return
+    framecrc -i $(target_path $noisefile) > $reffile || return
+    framecrc -slice_pipeline 1 -i $(target_path $noisefile) > $pipefile || return
+    if cmp -s $reffile $pipefile; then
+        echo "slice pipeline output matches"
+    else
+        echo "slice pipeline output differs"
+    fi
+}
+
+probe_threads(){
+    sample=$(target_path $1)
+    nb_threads=$2
+    shift 2
+    tsfile="${outdir}/${test}.ts"
+    reffile="${outdir}/${test}.ref"
+    probefile="${outdir}/${test}.probe"
+    cleanfiles="$cleanfiles $tsfile $reffile $probefile"
+    probe_cmd="ffprobe -show_packets -show_streams -bitexact -v 0"
+
+    ffmpeg -i "$sample" -c copy "$@" -f mpegts -y $tsfile || return
+    run $probe_cmd $(target_path $tsfile) > $reffile || return
+    run $probe_cmd -probe_threads $nb_threads $(target_path $tsfile) > $probefile || return
+    if cmp -s $reffile $probefile; then
+        echo "threaded probing matches"
+    else
+        echo "threaded probing differs"
+    fi
+}
+
+scale_threads(){
+    flags=$1
+    pix_fmt=$2
+    nb_threads=$3
+    raw_src="${target_path}/tests/vsynth1/%02d.pgm"
+    reffile="${outdir}/${test}.ref"
+    threadfile="${outdir}/${test}.threads"
+    cleanfiles="$cleanfiles $reffile $threadfile"
+    scale="scale=w=320:h=400:flags=${flags}+accurate_rnd+bitexact"
+
+    ffmpeg -f image2 -vcodec pgmyuv -i $raw_src -vf "${scale}:threads=1" \
+        -pix_fmt $pix_fmt -frames:v 5 -f framemd5 -y $reffile || return
+    ffmpeg -f image2 -vcodec pgmyuv -i $raw_src -vf "${scale}:threads=${nb_threads}" \
+        -pix_fmt $pix_fmt -frames:v 5 -f framemd5 -y $threadfile || return
+    if cmp -s $reffile $threadfile; then
+        echo "threaded scaling matches"
+    else
+        echo "threaded scaling differs"
+    fi
+}
+
+stream_info_cache(){
+    cachefile=$1
+    shift
+    logfile="${outdir}/${test}.log"
+    cleanfiles="$cleanfiles $logfile"
+
+    run "$@" -stream_info_cache $cachefile -v debug 2>$logfile || return
+    if ! grep -q "Stream info read from" $logfile; then
+        echo "stream info not read from $cachefile" >&2
+        return 1
+    fi
+}
+
 mkdir -p "$outdir"
 
 # Disable globbing: command arguments may contain globbing characters and
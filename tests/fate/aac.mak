@@ -194,6 +194,16 @@ fate-aac-pred-encode: CMP_TARGET = 652.60
 fate-aac-pred-encode: FUZZ = 10
 fate-aac-pred-encode: SIZE_TOLERANCE = 3560
 
+FATE_AAC_ENCODE += fate-aac-pred-aref-encode
+fate-aac-pred-aref-encode: ./tests/data/asynth-44100-2.wav
+fate-aac-pred-aref-encode: CMD = enc_dec_pcm adts wav s16le $(REF) -strict -2 -profile:a aac_main -c:a aac -aac_is 0 -aac_pns 0 -b:a 512k
+fate-aac-pred-aref-encode: CMP = stddev
+fate-aac-pred-aref-encode: REF = ./tests/data/asynth-44100-2.wav
+fate-aac-pred-aref-encode: CMP_SHIFT = -4096
+fate-aac-pred-aref-encode: CMP_TARGET = 564.34
+fate-aac-pred-aref-encode: SIZE_TOLERANCE = 2464
+fate-aac-pred-aref-encode: FUZZ = 6
+
 FATE_AAC_LATM += fate-aac-latm_000000001180bc60
 fate-aac-latm_000000001180bc60: CMD = pcm -i $(TARGET_SAMPLES)/aac/latm_000000001180bc60.mpg
 fate-aac-latm_000000001180bc60: REF = $(SAMPLES)/aac/latm_000000001180bc60.s16
@@ -214,7 +224,17 @@ $(FATE_AAC_ALL): FUZZ = 2
 
 FATE_AAC_ENCODE-$(call ENCMUX, AAC, ADTS) += $(FATE_AAC_ENCODE)
 
+# the channel elements are encoded in slice threads, the output must not
+# depend on the thread count
+FATE_AAC_THREADS = fate-aac-encode-threads-1 fate-aac-encode-threads-4
+$(FATE_AAC_THREADS): tests/data/asynth-44100-6.wav
+$(FATE_AAC_THREADS): CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-6.wav -strict -2 -c:a aac -b:a 384k -threads $(@:fate-aac-encode-threads-%=%) -flags +bitexact -fflags +bitexact -f adts
+$(FATE_AAC_THREADS): REF = $(SRC_PATH)/tests/ref/fate/aac-encode-threads
+
+FATE_AAC_THREADS-$(call ENCMUX, AAC, ADTS) += $(FATE_AAC_THREADS)
+
 FATE_SAMPLES_FFMPEG += $(FATE_AAC_ALL) $(FATE_AAC_ENCODE-yes)
+FATE_FFMPEG += $(FATE_AAC_THREADS-yes)
 
-fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE)
+fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE) $(FATE_AAC_THREADS-yes)
 fate-aac-latm: $(FATE_AAC_LATM-yes)
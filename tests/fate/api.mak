@@ -20,6 +20,10 @@ fate-api-seek: CMD = run $(APITESTSDIR)/api-seek-test $(TARGET_PATH)/tests/data/
 fate-api-seek: CMP = null
 fate-api-seek: REF = /dev/null
 
+FATE_API_LIBAVFORMAT-$(CONFIG_MP4_MUXER) += fate-api-movenc
+fate-api-movenc: $(APITESTSDIR)/api-movenc-test$(EXESUF)
+fate-api-movenc: CMD = run $(APITESTSDIR)/api-movenc-test $(TARGET_PATH)/tests/data/fate/api-movenc.mp4
+
 FATE_API_SAMPLES-$(CONFIG_AVFORMAT) += $(FATE_API_SAMPLES_LIBAVFORMAT-yes)
 
 ifdef SAMPLES
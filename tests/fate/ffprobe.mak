@@ -29,6 +29,22 @@ FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_xml
 fate-ffprobe_xml: $(FFPROBE_TEST_FILE)
 fate-ffprobe_xml: CMD = run $(FFPROBE_COMMAND) -of xml
 
+FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_probe_threads
+fate-ffprobe_probe_threads: $(FFPROBE_TEST_FILE)
+fate-ffprobe_probe_threads: CMD = run $(FFPROBE_COMMAND) -of default -probe_threads 3
+fate-ffprobe_probe_threads: REF = $(SRC_PATH)/tests/ref/fate/ffprobe_default
+
+# the first run writes the stream info, the second one must read it back
+FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_stream_info_cache_write
+fate-ffprobe_stream_info_cache_write: $(FFPROBE_TEST_FILE)
+fate-ffprobe_stream_info_cache_write: CMD = run $(FFPROBE_COMMAND) -of default -stream_info_cache $(TARGET_PATH)/tests/data/ffprobe-test.si
+fate-ffprobe_stream_info_cache_write: REF = $(SRC_PATH)/tests/ref/fate/ffprobe_default
+
+FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_stream_info_cache
+fate-ffprobe_stream_info_cache: fate-ffprobe_stream_info_cache_write
+fate-ffprobe_stream_info_cache: CMD = stream_info_cache $(TARGET_PATH)/tests/data/ffprobe-test.si $(FFPROBE_COMMAND) -of default
+fate-ffprobe_stream_info_cache: REF = $(SRC_PATH)/tests/ref/fate/ffprobe_default
+
 FATE_FFPROBE += $(FATE_FFPROBE-yes)
 
 fate-ffprobe: $(FATE_FFPROBE)
@@ -74,6 +74,20 @@ fate-filter-lavd-scalenorm: CMD = framecrc -f lavfi -graph_file $(TARGET_PATH)/t
 FATE_FILTER_VSYNTH-$(CONFIG_BOXBLUR_FILTER) += fate-filter-boxblur
 fate-filter-boxblur: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf boxblur=2:1
 
+FATE_FILTER_VSYNTH-$(call ALLYES, HFLIP_FILTER BOXBLUR_FILTER NEGATE_FILTER VFLIP_FILTER) += fate-filter-pipeline
+fate-filter-pipeline: CMD = framecrc -filter_pipeline_threads 3 -c:v pgmyuv -i $(SRC) -vf hflip,boxblur=2:1,negate,vflip
+
+# pad and vflip allocate the frames of the filter before them, they must stay in its stage
+FATE_FILTER_VSYNTH-$(call ALLYES, HFLIP_FILTER NEGATE_FILTER PAD_FILTER VFLIP_FILTER BOXBLUR_FILTER) += fate-filter-pipeline-pad
+fate-filter-pipeline-pad: CMD = framecrc -filter_pipeline_threads 3 -c:v pgmyuv -i $(SRC) -vf hflip,negate,pad=iw+32:ih+32:16:16,vflip,boxblur=2:1
+
+# the same graph with different slice thread counts must produce identical output
+FATE_FILTER_SLICE_THREADS-$(call ALLYES, SPLIT_FILTER SCALE_FILTER FORMAT_FILTER LUT_FILTER OVERLAY_FILTER UNSHARP_FILTER HQDN3D_FILTER EQ_FILTER LUTYUV_FILTER PAD_FILTER DRAWBOX_FILTER) += $(addprefix fate-filter-slice-threads-, 1 2 3 8)
+FATE_FILTER_VSYNTH-yes += $(FATE_FILTER_SLICE_THREADS-yes)
+$(FATE_FILTER_SLICE_THREADS-yes): tests/data/filtergraphs/slice_threads
+fate-filter-slice-threads-%: CMD = framecrc -filter_threads $(@:fate-filter-slice-threads-%=%) -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/slice_threads
+fate-filter-slice-threads-%: REF = $(SRC_PATH)/tests/ref/fate/filter-slice-threads
+
 FATE_FILTER_VSYNTH-$(call ALLYES, COLORCHANNELMIXER_FILTER FORMAT_FILTER PERMS_FILTER) += fate-filter-colorchannelmixer
 fate-filter-colorchannelmixer: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf format=rgb24,perms=random,colorchannelmixer=.31415927:.4:.31415927:0:.27182818:.8:.27182818:0:.2:.6:.2:0 -flags +bitexact -sws_flags +accurate_rnd+bitexact
 
@@ -165,6 +179,15 @@ FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_F
 fate-filter-overlay_yuv444: tests/data/filtergraphs/overlay_yuv444
 fate-filter-overlay_yuv444: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv444
 
+# every scaleladder output must match a separate scale of the same input
+FATE_FILTER_SCALELADDER-$(call ALLYES, FORMAT_FILTER SCALELADDER_FILTER) += fate-filter-scaleladder fate-filter-scaleladder-cascade
+FATE_FILTER_SCALELADDER-$(call ALLYES, FORMAT_FILTER SPLIT_FILTER SCALE_FILTER) += fate-filter-scaleladder-scale fate-filter-scaleladder-cascade-scale
+FATE_FILTER_VSYNTH-yes += $(FATE_FILTER_SCALELADDER-yes)
+$(FATE_FILTER_SCALELADDER-yes): fate-filter-%: tests/data/filtergraphs/%
+$(FATE_FILTER_SCALELADDER-yes): CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/$(@:fate-filter-%=%) -map "[a]" -map "[b]" -map "[c]" -map "[d]" -frames:v 10
+fate-filter-scaleladder fate-filter-scaleladder-scale: REF = $(SRC_PATH)/tests/ref/fate/filter-scaleladder
+fate-filter-scaleladder-cascade fate-filter-scaleladder-cascade-scale: REF = $(SRC_PATH)/tests/ref/fate/filter-scaleladder-cascade
+
 FATE_FILTER_VSYNTH-$(CONFIG_PHASE_FILTER) += fate-filter-phase
 fate-filter-phase: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf phase
 
@@ -547,6 +570,24 @@ fate-filter-pixfmts-rotate: CMD = pixfmts "2*PI*n/50"
 FATE_FILTER_PIXFMTS-$(CONFIG_SCALE_FILTER) += fate-filter-pixfmts-scale
 fate-filter-pixfmts-scale: CMD = pixfmts "200:100"
 
+# the same as pixfmts-scale, split into bands on 4 threads
+FATE_FILTER_PIXFMTS-$(CONFIG_SCALE_FILTER) += fate-filter-pixfmts-scale_threads
+fate-filter-pixfmts-scale_threads: CMD = pixfmts "200:100:threads=4"
+fate-filter-pixfmts-scale_threads: REF = $(SRC_PATH)/tests/ref/fate/filter-pixfmts-scale
+
+# each scaler, split into bands on 3 threads, against a single thread
+FATE_SCALE_THREADS = fast_bilinear bilinear bicubic experimental neighbor \
+                     area bicublin gauss sinc lanczos spline
+FATE_SCALE_THREADS := $(FATE_SCALE_THREADS:%=fate-filter-scale_threads-%)
+fate-filter-scale_threads-%: CMD = scale_threads $(@:fate-filter-scale_threads-%=%) yuv420p 3
+FATE_SCALE_THREADS += fate-filter-scale_threads-rgb24 fate-filter-scale_threads-yuv422p10
+fate-filter-scale_threads-rgb24:     CMD = scale_threads bicubic rgb24 3
+fate-filter-scale_threads-yuv422p10: CMD = scale_threads lanczos yuv422p10le 3
+$(FATE_SCALE_THREADS): CMP = oneline
+$(FATE_SCALE_THREADS): REF = threaded scaling matches
+FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += $(FATE_SCALE_THREADS)
+fate-filter-scale_threads: $(FATE_SCALE_THREADS)
+
 FATE_FILTER_PIXFMTS-$(CONFIG_SUPER2XSAI_FILTER) += fate-filter-pixfmts-super2xsai
 fate-filter-pixfmts-super2xsai: CMD = pixfmts
 
@@ -193,14 +193,105 @@ FATE_H264  := $(FATE_H264:%=fate-h264-conformance-%)                    \
               fate-h264-extreme-plane-pred                              \
               fate-h264-lossless                                        \
 
+# conformance streams decoded by slice threads with an optional decoding
+# path enabled, checked against the references of the default decoding
+define FATE_H264_THREADS_TEST
+FATE_H264 += fate-h264-$(1)-$(3)
+fate-h264-$(1)-$(3): CMD = framecrc -$(2) 1 -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/$(4)
+fate-h264-$(1)-$(3): REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-$(3)
+fate-h264-$(1)-$(3): THREADS = 4
+fate-h264-$(1)-$(3): THREAD_TYPE = slice
+endef
+
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,caba1_sony_d,CABA1_Sony_D.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,caba1_sva_b,CABA1_SVA_B.264))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,caba2_sony_e,CABA2_Sony_E.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,caba3_sva_b,CABA3_SVA_B.264))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,caba3_toshiba_e,CABA3_TOSHIBA_E.264))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cabac_mot_frm0_full,camp_mot_frm0_full.26l))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cabac_mot_mbaff0_full,camp_mot_mbaff0_full.26l))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cabac_mot_picaff0_full,camp_mot_picaff0_full.26l))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cabast3_sony_e,CABAST3_Sony_E.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cabastbr3_sony_b,CABASTBR3_Sony_B.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,capcm1_sand_e,CAPCM1_Sand_E.264))
+$(eval $(call FATE_H264_THREADS_TEST,slice-pipeline,slice_pipeline,cawp5_toshiba_e,CAWP5_TOSHIBA_E.264))
+
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,ba1_ft_c,BA1_FT_C.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,ba3_sva_c,BA3_SVA_C.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,basqp1_sony_c,BASQP1_Sony_C.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,caba3_sva_b,CABA3_SVA_B.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,cabac_mot_frm0_full,camp_mot_frm0_full.26l))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,cabast3_sony_e,CABAST3_Sony_E.jsv))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,capcm1_sand_e,CAPCM1_Sand_E.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,cavlc_mot_fld0_full_b,cvmp_mot_fld0_full_B.26l))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,cavlc_mot_frm0_full_b,cvmp_mot_frm0_full_B.26l))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,cvwp1_toshiba_e,CVWP1_TOSHIBA_E.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,frext-hpcv_brcm_a,FRext/HPCV_BRCM_A.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,mr1_bt_a,MR1_BT_A.h264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,nl3_sva_e,NL3_SVA_E.264))
+$(eval $(call FATE_H264_THREADS_TEST,deblock-postpass,deblock_postpass,sl1_sva_b,SL1_SVA_B.264))
+
+# corrupted CABAC streams, decoded with and without the slice pipeline
+define FATE_H264_SLICE_PIPELINE_NOISE_TEST
+FATE_H264_NOISE += fate-h264-slice-pipeline-noise-$(1)
+fate-h264-slice-pipeline-noise-$(1): CMD = slice_pipeline_noise $(TARGET_SAMPLES)/h264-conformance/$(2) $(3)
+fate-h264-slice-pipeline-noise-$(1): CMP = oneline
+fate-h264-slice-pipeline-noise-$(1): REF = slice pipeline output matches
+fate-h264-slice-pipeline-noise-$(1): THREADS = 4
+fate-h264-slice-pipeline-noise-$(1): THREAD_TYPE = slice
+endef
+
+$(eval $(call FATE_H264_SLICE_PIPELINE_NOISE_TEST,caba3_sva_b,CABA3_SVA_B.264,1000))
+$(eval $(call FATE_H264_SLICE_PIPELINE_NOISE_TEST,cabac_mot_frm0_full,camp_mot_frm0_full.26l,2000))
+$(eval $(call FATE_H264_SLICE_PIPELINE_NOISE_TEST,cabast3_sony_e,CABAST3_Sony_E.jsv,500))
+
+# B-frame conformance streams decoded by frame threads that return each
+# frame as soon as it is done, checked against the default decoding
+define FATE_H264_LOW_DELAY_THREADS_TEST
+FATE_H264 += fate-h264-low-delay-threads-$(1)
+fate-h264-low-delay-threads-$(1): CMD = framecrc -flags2 +low_delay_threads -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/$(2)
+fate-h264-low-delay-threads-$(1): REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-$(1)
+fate-h264-low-delay-threads-$(1): THREADS = 4
+fate-h264-low-delay-threads-$(1): THREAD_TYPE = frame
+endef
+
+$(eval $(call FATE_H264_LOW_DELAY_THREADS_TEST,caba3_sva_b,CABA3_SVA_B.264))
+$(eval $(call FATE_H264_LOW_DELAY_THREADS_TEST,cabac_mot_frm0_full,camp_mot_frm0_full.26l))
+$(eval $(call FATE_H264_LOW_DELAY_THREADS_TEST,cabac_mot_picaff0_full,camp_mot_picaff0_full.26l))
+$(eval $(call FATE_H264_LOW_DELAY_THREADS_TEST,capama3_sand_f,CAPAMA3_Sand_F.264))
+$(eval $(call FATE_H264_LOW_DELAY_THREADS_TEST,cavlc_mot_frm0_full_b,cvmp_mot_frm0_full_B.26l))
+
+# B-frame stream remuxed to MPEG-TS, probed with and without probe threads;
+# the packet timestamps depend on the reorder delay found by the decoder
+fate-h264-probe-threads: CMD = probe_threads $(TARGET_SAMPLES)/h264/direct-bff.mkv 3 -bsf:v h264_mp4toannexb
+fate-h264-probe-threads: CMP = oneline
+fate-h264-probe-threads: REF = threaded probing matches
+
+# MP4 without access unit delimiters remuxed to MPEG-TS, so the muxer has to
+# prepend an AUD, and SPS/PPS on the IDR pictures, to the copied payloads
+fate-h264-mpegts-remux: tests/data/h264-pcm.mp4
+fate-h264-mpegts-remux: CMD = md5 -i $(TARGET_PATH)/tests/data/h264-pcm.mp4 -c copy -bsf:v h264_mp4toannexb -flags +bitexact -fflags +bitexact -f mpegts
+
 FATE_H264-$(call DEMDEC, H264, H264) += $(FATE_H264)
 FATE_H264-$(call DEMDEC,  MOV, H264) += fate-h264-crop-to-container
 FATE_H264-$(call DEMDEC,  MOV, H264) += fate-h264-interlace-crop
 FATE_H264-$(call ALLYES, MOV_DEMUXER H264_MP4TOANNEXB_BSF) += fate-h264-bsf-mp4toannexb
+FATE_H264-$(call ALLYES, H264_DEMUXER H264_DECODER NOISE_BSF H264_MUXER) += $(FATE_H264_NOISE)
+FATE_H264-$(call ALLYES, H264_DEMUXER H264_DECODER H264_DRMEMB_BSF H264_MUXER \
+                         LAVFI_INDEV TESTSRC_FILTER LUTYUV_FILTER DRMDEC_FILTER \
+                         IMAGE2_MUXER PGM_ENCODER RAWVIDEO_MUXER) += fate-h264-bsf-drmemb
 FATE_H264-$(call DEMDEC, MATROSKA, H264) += fate-h264-direct-bff
 
+FATE_H264_FFPROBE-$(call ALLYES, MATROSKA_DEMUXER H264_PARSER H264_DECODER \
+                                 H264_MP4TOANNEXB_BSF MPEGTS_MUXER MPEGTS_DEMUXER) += fate-h264-probe-threads
+
+FATE_H264_REMUX-$(call ALLYES, H264_DEMUXER H264_PARSER MOV_MUXER MOV_DEMUXER \
+                               H264_MP4TOANNEXB_BSF MPEGTS_MUXER) += fate-h264-mpegts-remux
+
 FATE_SAMPLES_AVCONV += $(FATE_H264-yes)
-fate-h264: $(FATE_H264-yes)
+FATE_SAMPLES_FFPROBE += $(FATE_H264_FFPROBE-yes)
+FATE_FFMPEG += $(FATE_H264_REMUX-yes)
+fate-h264: $(FATE_H264-yes) $(FATE_H264_FFPROBE-yes) $(FATE_H264_REMUX-yes)
 
 fate-h264-conformance-aud_mw_e:                   CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/AUD_MW_E.264
 fate-h264-conformance-ba1_ft_c:                   CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/BA1_FT_C.264
@@ -388,6 +479,7 @@ fate-h264-conformance-sva_nl1_b:                  CMD = framecrc -vsync drop -i
 fate-h264-conformance-sva_nl2_e:                  CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264
 
 fate-h264-bsf-mp4toannexb:                        CMD = md5 -i $(TARGET_SAMPLES)/h264/interlaced_crop.mp4 -vcodec copy -bsf h264_mp4toannexb -f h264
+fate-h264-bsf-drmemb:                             CMD = drmemb $(TARGET_SAMPLES)/h264-conformance/FRext/HPCV_BRCM_A.264
 fate-h264-crop-to-container:                      CMD = framemd5 -i $(TARGET_SAMPLES)/h264/crop-to-container-dims-canon.mov
 fate-h264-extreme-plane-pred:                     CMD = framemd5 -i $(TARGET_SAMPLES)/h264/extreme-plane-pred.h264
 fate-h264-interlace-crop:                         CMD = framecrc -i $(TARGET_SAMPLES)/h264/interlaced_crop.mp4 -vframes 3
@@ -222,6 +222,33 @@ $(foreach N,$(HEVC_SAMPLES_422_10BIN),$(eval $(call FATE_HEVC_TEST_422_10BIN,$(N
 $(foreach N,$(HEVC_SAMPLES_444_8BIT),$(eval $(call FATE_HEVC_TEST_444_8BIT,$(N))))
 $(foreach N,$(HEVC_SAMPLES_444_12BIT),$(eval $(call FATE_HEVC_TEST_444_12BIT,$(N))))
 
+# multi-tile streams, decoded one tile per slice thread and filtered after
+# the picture is complete; the output must match single threaded decoding
+HEVC_SAMPLES_TILES = TILES_A_Cisco_2 TILES_B_Cisco_1
+
+define FATE_HEVC_TILE_THREADS_TEST
+FATE_HEVC += fate-hevc-tile-threads-$(1)
+fate-hevc-tile-threads-$(1): CMD = framecrc -flags unaligned -vsync drop -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit
+fate-hevc-tile-threads-$(1): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+fate-hevc-tile-threads-$(1): THREADS = 4
+fate-hevc-tile-threads-$(1): THREAD_TYPE = slice
+endef
+
+$(foreach N,$(HEVC_SAMPLES_TILES),$(eval $(call FATE_HEVC_TILE_THREADS_TEST,$(N))))
+
+# generated stream with dependent slice segments starting and ending inside
+# tiles, whose first and last tiles continue the CABAC state of the segments
+# around them
+FATE_HEVC_TILES_DEP = fate-hevc-tiles-dependent-slices fate-hevc-tile-threads-dependent-slices
+$(FATE_HEVC_TILES_DEP): tests/data/hevc-tiles.hevc
+$(FATE_HEVC_TILES_DEP): CMD = framecrc -i $(TARGET_PATH)/tests/data/hevc-tiles.hevc
+$(FATE_HEVC_TILES_DEP): REF = $(SRC_PATH)/tests/ref/fate/hevc-tiles-dependent-slices
+fate-hevc-tile-threads-dependent-slices: THREADS = 4
+fate-hevc-tile-threads-dependent-slices: THREAD_TYPE = slice
+
+FATE_HEVC_TILES_DEP-$(call DEMDEC, HEVC, HEVC) += $(FATE_HEVC_TILES_DEP)
+FATE_FFMPEG += $(FATE_HEVC_TILES_DEP-yes)
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -vsync 0 -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC += fate-hevc-paramchange-yuv420p-yuv420p10
 
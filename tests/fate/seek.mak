@@ -247,12 +247,25 @@ FATE_SEEK_EXTRA-$(CONFIG_MP3_DEMUXER)   += fate-seek-extra-mp3
 fate-seek-extra-mp3:  CMD = run libavformat/seek-test$(EXESUF) $(TARGET_SAMPLES)/gapless/gapless.mp3 -usetoc 0
 FATE_SEEK_EXTRA += $(FATE_SEEK_EXTRA-yes)
 
+# the first run reads the file through and writes its seek index, the second
+# one seeks with it and has to land on the indexed keyframes
+FATE_SEEK_INDEX_CACHE-$(call ENCDEC2, MPEG2VIDEO, MP2, MPEGTS) += fate-seek-index-cache-write
+fate-seek-index-cache-write: fate-lavf-ts
+fate-seek-index-cache-write: CMD = ffmpeg -seek_index_cache tests/data/lavf-ts.sx -i $(TARGET_PATH)/tests/data/lavf/lavf.ts -c copy -f null -
+fate-seek-index-cache-write: CMP = null
+fate-seek-index-cache-write: REF = /dev/null
+
+FATE_SEEK_INDEX_CACHE-$(call ENCDEC2, MPEG2VIDEO, MP2, MPEGTS) += fate-seek-index-cache-lavf-ts
+fate-seek-index-cache-lavf-ts: fate-seek-index-cache-write libavformat/seek-test$(EXESUF)
+fate-seek-index-cache-lavf-ts: CMD = run libavformat/seek-test$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.ts -seek_index_cache tests/data/lavf-ts.sx
+FATE_SEEK_INDEX_CACHE += $(FATE_SEEK_INDEX_CACHE-yes)
+
 
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA): libavformat/seek-test$(EXESUF)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): CMD = run libavformat/seek-test$(EXESUF) $(TARGET_PATH)/tests/data/$(SRC)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): fate-seek-%: fate-%
 fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
-FATE_AVCONV += $(FATE_SEEK)
+FATE_AVCONV += $(FATE_SEEK) $(FATE_SEEK_INDEX_CACHE)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_INDEX_CACHE)
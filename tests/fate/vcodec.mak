@@ -155,7 +155,8 @@ FATE_MPEG2 = mpeg2                                                      \
              mpeg2-ilace                                                \
              mpeg2-ivlc-qprd                                            \
              mpeg2-thread                                               \
-             mpeg2-thread-ivlc
+             mpeg2-thread-ivlc                                          \
+             mpeg2-wavefront
 
 FATE_VCODEC-$(call ENCDEC, MPEG2VIDEO, MPEG2VIDEO MPEGVIDEO) += $(FATE_MPEG2)
 
@@ -185,6 +186,11 @@ fate-vsynth%-mpeg2-thread:       ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
 fate-vsynth%-mpeg2-thread-ivlc:  ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
                                            -intra_vlc 1 -threads 2 -slices 2
 
+# field and B-frame motion estimation in a threaded wavefront, the output
+# matches the single threaded encode of the same options
+fate-vsynth%-mpeg2-wavefront:    ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
+                                           -threads 4 -me_wavefront 1
+
 FATE_MPEG4_MP4 = mpeg4
 FATE_MPEG4_AVI = mpeg4-rc                                               \
                  mpeg4-adv                                              \
@@ -192,6 +198,7 @@ FATE_MPEG4_AVI = mpeg4-rc                                               \
                  mpeg4-adap                                             \
                  mpeg4-qpel                                             \
                  mpeg4-thread                                           \
+                 mpeg4-wavefront                                        \
                  mpeg4-error                                            \
                  mpeg4-nr                                               \
                  mpeg4-nsse
@@ -236,6 +243,11 @@ fate-vsynth%-mpeg4-thread:       ENCOPTS = -b 500k -flags +mv4+aic         \
                                            -mbd bits -ps 200 -bf 2         \
                                            -threads 2 -slices 2
 
+# mpeg4-qpel with threaded wavefront motion estimation, same output
+fate-vsynth%-mpeg4-wavefront:    ENCOPTS = -qscale 7 -flags +mv4+qpel -mbd 2 \
+                                           -bf 2 -cmp 1 -subcmp 2            \
+                                           -threads 4 -me_wavefront 1
+
 FATE_VCODEC-$(call ENCDEC, MSMPEG4V3, AVI) += msmpeg4
 fate-vsynth%-msmpeg4:            ENCOPTS = -qscale 10
 
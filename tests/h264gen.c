@@ -0,0 +1,196 @@
+/*
+ * Generate a synthetic H.264 stream made of I_PCM macroblocks, with IDR and
+ * non-IDR pictures and no access unit delimiters, for testing remuxing.
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.c"
+
+#define WIDTH     64
+#define HEIGHT    48
+#define MB_W      (WIDTH  / 16)
+#define MB_H      (HEIGHT / 16)
+#define NB_FRAMES 10
+#define GOP_SIZE  5
+
+typedef struct BitWriter {
+    uint8_t buf[MB_W * MB_H * 400];
+    int bit_count;
+} BitWriter;
+
+static unsigned int seed = 1;
+
+static int myrnd(int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+static void put_bits(BitWriter *bw, int n, uint32_t v)
+{
+    int i;
+
+    for (i = n - 1; i >= 0; i--) {
+        int pos = bw->bit_count++;
+        if (!(pos & 7))
+            bw->buf[pos >> 3] = 0;
+        bw->buf[pos >> 3] |= ((v >> i) & 1) << (7 - (pos & 7));
+    }
+}
+
+static void put_ue(BitWriter *bw, uint32_t v)
+{
+    int n = 0;
+
+    while ((v + 1) >> (n + 1))
+        n++;
+    put_bits(bw, n, 0);
+    put_bits(bw, n + 1, v + 1);
+}
+
+static void put_se(BitWriter *bw, int v)
+{
+    put_ue(bw, v > 0 ? 2 * v - 1 : -2 * v);
+}
+
+static void align_zero(BitWriter *bw)
+{
+    while (bw->bit_count & 7)
+        put_bits(bw, 1, 0);
+}
+
+static void put_trailing_bits(BitWriter *bw)
+{
+    put_bits(bw, 1, 1);
+    align_zero(bw);
+}
+
+/* write a NAL unit with a start code and emulation prevention */
+static void write_nal(int ref_idc, int type, const BitWriter *bw)
+{
+    int i, zeros = 0;
+
+    fwrite("\0\0\0\1", 1, 4, stdout);
+    putchar(ref_idc << 5 | type);
+    for (i = 0; i < bw->bit_count >> 3; i++) {
+        if (zeros >= 2 && bw->buf[i] <= 3) {
+            putchar(3);
+            zeros = 0;
+        }
+        putchar(bw->buf[i]);
+        zeros = bw->buf[i] ? 0 : zeros + 1;
+    }
+}
+
+static void write_sps(BitWriter *bw)
+{
+    bw->bit_count = 0;
+    put_bits(bw, 8, 66);            // profile_idc: Baseline
+    put_bits(bw, 8, 0);             // constraint flags
+    put_bits(bw, 8, 30);            // level_idc
+    put_ue(bw, 0);                  // seq_parameter_set_id
+    put_ue(bw, 0);                  // log2_max_frame_num_minus4
+    put_ue(bw, 2);                  // pic_order_cnt_type
+    put_ue(bw, 1);                  // max_num_ref_frames
+    put_bits(bw, 1, 0);             // gaps_in_frame_num_value_allowed_flag
+    put_ue(bw, MB_W - 1);
+    put_ue(bw, MB_H - 1);
+    put_bits(bw, 1, 1);             // frame_mbs_only_flag
+    put_bits(bw, 1, 1);             // direct_8x8_inference_flag
+    put_bits(bw, 1, 0);             // frame_cropping_flag
+    put_bits(bw, 1, 0);             // vui_parameters_present_flag
+    put_trailing_bits(bw);
+    write_nal(3, 7, bw);
+}
+
+static void write_pps(BitWriter *bw)
+{
+    bw->bit_count = 0;
+    put_ue(bw, 0);                  // pic_parameter_set_id
+    put_ue(bw, 0);                  // seq_parameter_set_id
+    put_bits(bw, 1, 0);             // entropy_coding_mode_flag: CAVLC
+    put_bits(bw, 1, 0);             // bottom_field_pic_order_in_frame_present_flag
+    put_ue(bw, 0);                  // num_slice_groups_minus1
+    put_ue(bw, 0);                  // num_ref_idx_l0_default_active_minus1
+    put_ue(bw, 0);                  // num_ref_idx_l1_default_active_minus1
+    put_bits(bw, 1, 0);             // weighted_pred_flag
+    put_bits(bw, 2, 0);             // weighted_bipred_idc
+    put_se(bw, 0);                  // pic_init_qp_minus26
+    put_se(bw, 0);                  // pic_init_qs_minus26
+    put_se(bw, 0);                  // chroma_qp_index_offset
+    put_bits(bw, 1, 0);             // deblocking_filter_control_present_flag
+    put_bits(bw, 1, 0);             // constrained_intra_pred_flag
+    put_bits(bw, 1, 0);             // redundant_pic_cnt_present_flag
+    put_trailing_bits(bw);
+    write_nal(3, 8, bw);
+}
+
+static void write_picture(BitWriter *bw, int frame_num, int idr, int idr_id)
+{
+    int mb, i;
+
+    bw->bit_count = 0;
+    put_ue(bw, 0);                  // first_mb_in_slice
+    put_ue(bw, 7);                  // slice_type: I, all slices
+    put_ue(bw, 0);                  // pic_parameter_set_id
+    put_bits(bw, 4, frame_num);
+    if (idr) {
+        put_ue(bw, idr_id);
+        put_bits(bw, 1, 0);         // no_output_of_prior_pics_flag
+        put_bits(bw, 1, 0);         // long_term_reference_flag
+    } else {
+        put_bits(bw, 1, 0);         // adaptive_ref_pic_marking_mode_flag
+    }
+    put_se(bw, 0);                  // slice_qp_delta
+
+    for (mb = 0; mb < MB_W * MB_H; mb++) {
+        put_ue(bw, 25);             // mb_type: I_PCM
+        align_zero(bw);
+        for (i = 0; i < 256 + 2 * 64; i++)
+            put_bits(bw, 8, 1 + myrnd(255));
+    }
+    put_trailing_bits(bw);
+    write_nal(3, idr ? 5 : 1, bw);
+}
+
+int main(int argc, char **argv)
+{
+    static BitWriter bw;
+    int f;
+
+    if (argc != 2) {
+        printf("usage: %s file.h264\n"
+               "generate a test H.264 stream of I_PCM macroblocks\n",
+               argv[0]);
+        return 1;
+    }
+
+    err_if(!freopen(argv[1], "wb", stdout));
+
+    write_sps(&bw);
+    write_pps(&bw);
+    for (f = 0; f < NB_FRAMES; f++)
+        write_picture(&bw, f % GOP_SIZE, !(f % GOP_SIZE), f / GOP_SIZE);
+
+    return 0;
+}
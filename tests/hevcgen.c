@@ -0,0 +1,647 @@
+/*
+ * Generate a synthetic HEVC intra stream with tiles and dependent slice
+ * segments starting and ending inside tiles, for testing tile threading.
+ * Every CTB is a PCM coding unit with random SAO parameters, so the CABAC
+ * context state is carried from one slice segment into the next.
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.c"
+
+#define WIDTH    320
+#define HEIGHT   192
+#define CTB_SIZE 16
+#define WC       (WIDTH  / CTB_SIZE)
+#define HC       (HEIGHT / CTB_SIZE)
+#define NB_CTB   (WC * HC)
+#define NB_FRAMES 3
+
+#define BUF_SIZE (1 << 20)
+
+static const uint8_t lps_range[64][4] = {
+{128,176,208,240}, {128,167,197,227}, {128,158,187,216}, {123,150,178,205},
+{116,142,169,195}, {111,135,160,185}, {105,128,152,175}, {100,122,144,166},
+{ 95,116,137,158}, { 90,110,130,150}, { 85,104,123,142}, { 81, 99,117,135},
+{ 77, 94,111,128}, { 73, 89,105,122}, { 69, 85,100,116}, { 66, 80, 95,110},
+{ 62, 76, 90,104}, { 59, 72, 86, 99}, { 56, 69, 81, 94}, { 53, 65, 77, 89},
+{ 51, 62, 73, 85}, { 48, 59, 69, 80}, { 46, 56, 66, 76}, { 43, 53, 63, 72},
+{ 41, 50, 59, 69}, { 39, 48, 56, 65}, { 37, 45, 54, 62}, { 35, 43, 51, 59},
+{ 33, 41, 48, 56}, { 32, 39, 46, 53}, { 30, 37, 43, 50}, { 29, 35, 41, 48},
+{ 27, 33, 39, 45}, { 26, 31, 37, 43}, { 24, 30, 35, 41}, { 23, 28, 33, 39},
+{ 22, 27, 32, 37}, { 21, 26, 30, 35}, { 20, 24, 29, 33}, { 19, 23, 27, 31},
+{ 18, 22, 26, 30}, { 17, 21, 25, 28}, { 16, 20, 23, 27}, { 15, 19, 22, 25},
+{ 14, 18, 21, 24}, { 14, 17, 20, 23}, { 13, 16, 19, 22}, { 12, 15, 18, 21},
+{ 12, 14, 17, 20}, { 11, 14, 16, 19}, { 11, 13, 15, 18}, { 10, 12, 15, 17},
+{ 10, 12, 14, 16}, {  9, 11, 13, 15}, {  9, 11, 12, 14}, {  8, 10, 12, 14},
+{  8,  9, 11, 13}, {  7,  9, 11, 12}, {  7,  9, 10, 12}, {  7,  8, 10, 11},
+{  6,  8,  9, 11}, {  6,  7,  9, 10}, {  6,  7,  8,  9}, {  2,  2,  2,  2},
+};
+
+static const uint8_t lps_state[64] = {
+  0, 0, 1, 2, 2, 4, 4, 5,
+  6, 7, 8, 9, 9,11,11,12,
+ 13,13,15,15,16,16,18,18,
+ 19,19,21,21,22,22,23,24,
+ 24,25,26,26,27,27,28,29,
+ 29,30,30,30,31,32,32,33,
+ 33,33,34,34,35,35,35,36,
+ 36,36,37,37,37,38,38,63,
+};
+
+typedef struct BitWriter {
+    uint8_t *buf;
+    int bit_count;
+} BitWriter;
+
+typedef struct Context {
+    int state;
+    int mps;
+} Context;
+
+/* arithmetic encoder of the HEVC reference software */
+typedef struct Cabac {
+    BitWriter *bw;
+    uint64_t low;
+    int range;
+    int bits_left;
+    int nb_buffered;
+    int buffered;
+} Cabac;
+
+static unsigned int seed = 1;
+
+static int myrnd(int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+static void put_bits(BitWriter *bw, int n, uint32_t v)
+{
+    int i;
+
+    for (i = n - 1; i >= 0; i--) {
+        int pos = bw->bit_count++;
+        if (!(pos & 7))
+            bw->buf[pos >> 3] = 0;
+        bw->buf[pos >> 3] |= ((v >> i) & 1) << (7 - (pos & 7));
+    }
+}
+
+static void put_ue(BitWriter *bw, uint32_t v)
+{
+    int n = 0;
+
+    while ((v + 1) >> (n + 1))
+        n++;
+    put_bits(bw, n, 0);
+    put_bits(bw, n + 1, v + 1);
+}
+
+static void put_se(BitWriter *bw, int v)
+{
+    put_ue(bw, v > 0 ? 2 * v - 1 : -2 * v);
+}
+
+static void align_zero(BitWriter *bw)
+{
+    while (bw->bit_count & 7)
+        put_bits(bw, 1, 0);
+}
+
+static void put_trailing_bits(BitWriter *bw)
+{
+    put_bits(bw, 1, 1);
+    align_zero(bw);
+}
+
+static void init_context(Context *ctx, int init_value, int qp)
+{
+    int m   = (init_value >> 4) * 5 - 45;
+    int n   = ((init_value & 15) << 3) - 16;
+    int pre = ((m * qp) >> 4) + n;
+
+    pre      = pre < 1 ? 1 : pre > 126 ? 126 : pre;
+    ctx->mps = pre > 63;
+    ctx->state = ctx->mps ? pre - 64 : 63 - pre;
+}
+
+static void cabac_start(Cabac *c)
+{
+    c->low         = 0;
+    c->range       = 510;
+    c->bits_left   = 23;
+    c->nb_buffered = 0;
+    c->buffered    = 0xff;
+}
+
+static void cabac_write_out(Cabac *c)
+{
+    int lead = c->low >> (24 - c->bits_left);
+
+    c->bits_left += 8;
+    c->low       &= 0xffffffffu >> c->bits_left;
+    if (lead == 0xff) {
+        c->nb_buffered++;
+    } else if (c->nb_buffered) {
+        int carry = lead >> 8;
+        int byte  = c->buffered + carry;
+        c->buffered = lead & 0xff;
+        put_bits(c->bw, 8, byte);
+        byte = (0xff + carry) & 0xff;
+        while (c->nb_buffered > 1) {
+            put_bits(c->bw, 8, byte);
+            c->nb_buffered--;
+        }
+    } else {
+        c->nb_buffered = 1;
+        c->buffered    = lead;
+    }
+}
+
+static void cabac_test(Cabac *c)
+{
+    if (c->bits_left < 12)
+        cabac_write_out(c);
+}
+
+static void cabac_bin(Cabac *c, Context *ctx, int bin)
+{
+    int lps = lps_range[ctx->state][(c->range >> 6) & 3];
+
+    c->range -= lps;
+    if (bin != ctx->mps) {
+        int nbits = 0;
+        while ((lps << nbits) < 256)
+            nbits++;
+        c->low   = (c->low + c->range) << nbits;
+        c->range = lps << nbits;
+        if (!ctx->state)
+            ctx->mps = 1 - ctx->mps;
+        ctx->state    = lps_state[ctx->state];
+        c->bits_left -= nbits;
+    } else {
+        if (ctx->state < 62)
+            ctx->state++;
+        if (c->range >= 256)
+            return;
+        c->low   <<= 1;
+        c->range <<= 1;
+        c->bits_left--;
+    }
+    cabac_test(c);
+}
+
+static void cabac_bypass(Cabac *c, int bin)
+{
+    c->low <<= 1;
+    if (bin)
+        c->low += c->range;
+    c->bits_left--;
+    cabac_test(c);
+}
+
+static void cabac_bypass_bits(Cabac *c, int n, int v)
+{
+    int i;
+
+    for (i = n - 1; i >= 0; i--)
+        cabac_bypass(c, (v >> i) & 1);
+}
+
+static void cabac_terminate(Cabac *c, int bin)
+{
+    c->range -= 2;
+    if (bin) {
+        c->low          += c->range;
+        c->low         <<= 7;
+        c->range         = 2 << 7;
+        c->bits_left    -= 7;
+    } else if (c->range >= 256) {
+        return;
+    } else {
+        c->low   <<= 1;
+        c->range <<= 1;
+        c->bits_left--;
+    }
+    cabac_test(c);
+}
+
+static void cabac_finish(Cabac *c)
+{
+    if (c->low >> (32 - c->bits_left)) {
+        put_bits(c->bw, 8, c->buffered + 1);
+        while (c->nb_buffered > 1) {
+            put_bits(c->bw, 8, 0x00);
+            c->nb_buffered--;
+        }
+        c->low -= 1ULL << (32 - c->bits_left);
+    } else {
+        if (c->nb_buffered)
+            put_bits(c->bw, 8, c->buffered);
+        while (c->nb_buffered > 1) {
+            put_bits(c->bw, 8, 0xff);
+            c->nb_buffered--;
+        }
+    }
+    put_bits(c->bw, 24 - c->bits_left, c->low >> 8);
+}
+
+/**
+ * Write data with emulation prevention, and translate the positions in
+ * starts[] to positions in the escaped output. Nothing is written if out
+ * is NULL.
+ */
+static void write_escaped(FILE *out, const uint8_t *data, int size,
+                          int *starts, int nb_starts)
+{
+    int i, j = 0, zeros = 0, pos = 0;
+
+    for (i = 0; i < size; i++) {
+        for (; j < nb_starts && starts[j] == i; j++)
+            starts[j] = pos;
+        if (zeros >= 2 && data[i] <= 3) {
+            if (out)
+                putc(3, out);
+            pos++;
+            zeros = 0;
+        }
+        if (out)
+            putc(data[i], out);
+        pos++;
+        zeros = data[i] ? 0 : zeros + 1;
+    }
+    for (; j < nb_starts; j++)
+        starts[j] = pos;
+}
+
+static void write_nal_header(int type)
+{
+    fwrite("\0\0\0\1", 1, 4, stdout);
+    putchar(type << 1);
+    putchar(1);
+}
+
+static void write_nal(int type, BitWriter *bw)
+{
+    write_nal_header(type);
+    write_escaped(stdout, bw->buf, bw->bit_count >> 3, NULL, 0);
+}
+
+static void put_ptl(BitWriter *bw)
+{
+    put_bits(bw, 2, 0);
+    put_bits(bw, 1, 0);
+    put_bits(bw, 5, 1);             // Main profile
+    put_bits(bw, 32, 0x60000000);
+    put_bits(bw, 4, 9);             // progressive, frame only
+    put_bits(bw, 32, 0);
+    put_bits(bw, 12, 0);
+    put_bits(bw, 8, 120);           // level 4
+}
+
+static void write_vps(BitWriter *bw)
+{
+    bw->bit_count = 0;
+    put_bits(bw, 4, 0);
+    put_bits(bw, 2, 3);
+    put_bits(bw, 6, 0);
+    put_bits(bw, 3, 0);
+    put_bits(bw, 1, 1);
+    put_bits(bw, 16, 0xffff);
+    put_ptl(bw);
+    put_bits(bw, 1, 1);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 6, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 2, 0);
+    put_trailing_bits(bw);
+    write_nal(32, bw);
+}
+
+static void write_sps(BitWriter *bw)
+{
+    bw->bit_count = 0;
+    put_bits(bw, 4, 0);
+    put_bits(bw, 3, 0);
+    put_bits(bw, 1, 1);
+    put_ptl(bw);
+    put_ue(bw, 0);
+    put_ue(bw, 1);                  // 4:2:0
+    put_ue(bw, WIDTH);
+    put_ue(bw, HEIGHT);
+    put_bits(bw, 1, 0);
+    put_ue(bw, 0);                  // 8 bit
+    put_ue(bw, 0);
+    put_ue(bw, 4);
+    put_bits(bw, 1, 1);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_ue(bw, 1);                  // coding blocks and CTBs of 16x16
+    put_ue(bw, 0);
+    put_ue(bw, 0);                  // transform blocks of 4x4 to 16x16
+    put_ue(bw, 2);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 1, 0);             // no scaling list
+    put_bits(bw, 1, 0);             // no amp
+    put_bits(bw, 1, 1);             // sao
+    put_bits(bw, 1, 1);             // 8 bit PCM of 16x16 blocks
+    put_bits(bw, 4, 7);
+    put_bits(bw, 4, 7);
+    put_ue(bw, 1);
+    put_ue(bw, 0);
+    put_bits(bw, 1, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 3, 0);
+    put_bits(bw, 1, 0);             // no vui
+    put_bits(bw, 1, 0);
+    put_trailing_bits(bw);
+    write_nal(33, bw);
+}
+
+static void write_pps(BitWriter *bw, const int *cols, int nb_cols,
+                      const int *rows, int nb_rows)
+{
+    int i;
+
+    bw->bit_count = 0;
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 1, 1);             // dependent slice segments
+    put_bits(bw, 1, 0);
+    put_bits(bw, 3, 0);
+    put_bits(bw, 2, 0);
+    put_ue(bw, 0);
+    put_ue(bw, 0);
+    put_se(bw, 0);
+    put_bits(bw, 3, 0);
+    put_se(bw, 0);
+    put_se(bw, 0);
+    put_bits(bw, 4, 0);
+    put_bits(bw, 1, 1);             // tiles
+    put_bits(bw, 1, 0);
+    put_ue(bw, nb_cols - 1);
+    put_ue(bw, nb_rows - 1);
+    put_bits(bw, 1, 0);
+    for (i = 0; i < nb_cols - 1; i++)
+        put_ue(bw, cols[i] - 1);
+    for (i = 0; i < nb_rows - 1; i++)
+        put_ue(bw, rows[i] - 1);
+    put_bits(bw, 1, 1);             // loop filter across tiles
+    put_bits(bw, 1, 1);             // loop filter across slices
+    put_bits(bw, 1, 1);             // deblocking control
+    put_bits(bw, 1, 0);
+    put_bits(bw, 1, 0);
+    put_se(bw, 3);
+    put_se(bw, 3);
+    put_bits(bw, 2, 0);
+    put_ue(bw, 0);
+    put_bits(bw, 2, 0);
+    put_trailing_bits(bw);
+    write_nal(34, bw);
+}
+
+static int ts_to_rs[NB_CTB];
+static int tile_of[NB_CTB];
+static int slice_of[NB_CTB];
+
+static void tile_layout(const int *cols, int nb_cols, const int *rows, int nb_rows)
+{
+    int tx, ty, x, y, x0, y0 = 0, ts = 0;
+
+    for (ty = 0; ty < nb_rows; y0 += rows[ty++]) {
+        for (tx = 0, x0 = 0; tx < nb_cols; x0 += cols[tx++]) {
+            for (y = y0; y < y0 + rows[ty]; y++) {
+                for (x = x0; x < x0 + cols[tx]; x++) {
+                    ts_to_rs[ts++]   = y * WC + x;
+                    tile_of[y * WC + x] = ty * nb_cols + tx;
+                }
+            }
+        }
+    }
+}
+
+static int clip_pixel(int v)
+{
+    return v < 1 ? 1 : v > 254 ? 254 : v;
+}
+
+static void write_ctb(Cabac *c, BitWriter *bw, Context *ctx, int rs, int slice_addr)
+{
+    int x = rs % WC, y = rs / WC;
+    int left_ok = x > 0 && slice_of[rs - 1]  == slice_addr && tile_of[rs - 1]  == tile_of[rs];
+    int up_ok   = y > 0 && slice_of[rs - WC] == slice_addr && tile_of[rs - WC] == tile_of[rs];
+    int merged  = 0;
+    int i, k, px, py, base, gx, gy;
+
+    /* SAO syntax */
+    if (left_ok) {
+        merged = !myrnd(5);
+        cabac_bin(c, &ctx[0], merged);
+    }
+    if (up_ok && !merged) {
+        merged = !myrnd(5);
+        cabac_bin(c, &ctx[0], merged);
+    }
+    if (!merged) {
+        for (i = 0; i < 2; i++) {
+            int type = myrnd(4);
+            type = type == 3 ? 2 : type;
+            cabac_bin(c, &ctx[1], type != 0);
+            if (!type)
+                continue;
+            cabac_bypass(c, type == 2);
+            for (k = 0; k < (i ? 2 : 1); k++) {
+                int offsets[4], j;
+                for (j = 0; j < 4; j++) {
+                    offsets[j] = myrnd(8);
+                    cabac_bypass_bits(c, offsets[j], (1 << offsets[j]) - 1);
+                    if (offsets[j] < 7)
+                        cabac_bypass(c, 0);
+                }
+                if (type == 1) {
+                    for (j = 0; j < 4; j++)
+                        if (offsets[j])
+                            cabac_bypass(c, myrnd(2));
+                    cabac_bypass_bits(c, 5, myrnd(32));
+                } else if (!k) {
+                    cabac_bypass_bits(c, 2, myrnd(4));
+                }
+            }
+        }
+    }
+
+    /* part_mode 2Nx2N, pcm_flag and the PCM samples */
+    cabac_bin(c, &ctx[2], 1);
+    cabac_terminate(c, 1);
+    cabac_finish(c);
+    put_bits(bw, 1, 1);
+    align_zero(bw);
+    base = 40 + myrnd(161);
+    gx   = myrnd(17) - 8;
+    gy   = myrnd(17) - 8;
+    for (py = 0; py < 16; py++)
+        for (px = 0; px < 16; px++)
+            put_bits(bw, 8, clip_pixel(base + (gx * px + gy * py) / 4 + myrnd(5) - 2));
+    for (i = 0; i < 2; i++) {
+        base = 90 + myrnd(71);
+        for (py = 0; py < 8; py++)
+            for (px = 0; px < 8; px++)
+                put_bits(bw, 8, clip_pixel(base + myrnd(5) - 2 + (px + py) / 4));
+    }
+    cabac_start(c);
+}
+
+static void write_picture(BitWriter *hdr, BitWriter *data, int qp,
+                          const int (*slices)[3], int nb_slices)
+{
+    Context ctx[3];
+    Cabac c = { data };
+    int starts[NB_CTB + 1];
+    int i, j, ts, addr_bits = 0;
+
+    while ((NB_CTB - 1) >> addr_bits)
+        addr_bits++;
+    memset(slice_of, -1, sizeof(slice_of));
+
+    for (i = 0; i < nb_slices; i++) {
+        int start = slices[i][0], end = slices[i][1], dep = slices[i][2];
+        int nb_starts = 1, max_size = 1, offset_len = 1;
+        int slice_addr;
+
+        for (j = i; slices[j][2]; j--)
+            ;
+        slice_addr = slices[j][0];
+
+        data->bit_count = 0;
+        starts[0] = 0;
+        cabac_start(&c);
+        for (ts = start; ts < end; ts++) {
+            int rs = ts_to_rs[ts];
+
+            /* a dependent segment inside a tile continues the contexts */
+            if ((ts == start && !dep) ||
+                (ts && tile_of[rs] != tile_of[ts_to_rs[ts - 1]])) {
+                init_context(&ctx[0], 153, qp);
+                init_context(&ctx[1], 200, qp);
+                init_context(&ctx[2], 184, qp);
+            }
+            slice_of[rs] = slice_addr;
+            write_ctb(&c, data, ctx, rs, slice_addr);
+
+            cabac_terminate(&c, ts == end - 1);
+            if (ts == end - 1) {
+                cabac_finish(&c);
+                put_trailing_bits(data);
+            } else if (tile_of[ts_to_rs[ts + 1]] != tile_of[rs]) {
+                cabac_terminate(&c, 1);
+                cabac_finish(&c);
+                put_trailing_bits(data);
+                cabac_start(&c);
+                starts[nb_starts++] = data->bit_count >> 3;
+            }
+        }
+
+        /* the entry point offsets count the emulation prevention bytes */
+        starts[nb_starts] = data->bit_count >> 3;
+        write_escaped(NULL, data->buf, data->bit_count >> 3, starts, nb_starts + 1);
+        for (j = 0; j < nb_starts; j++)
+            if (starts[j + 1] - starts[j] > max_size)
+                max_size = starts[j + 1] - starts[j];
+        while ((max_size - 1) >> offset_len)
+            offset_len++;
+
+        hdr->bit_count = 0;
+        put_bits(hdr, 1, !start);
+        put_bits(hdr, 1, 0);
+        put_ue(hdr, 0);
+        if (start) {
+            put_bits(hdr, 1, dep);
+            put_bits(hdr, addr_bits, ts_to_rs[start]);
+        }
+        if (!dep) {
+            put_ue(hdr, 2);         // I slice
+            put_bits(hdr, 2, 3);    // SAO for luma and chroma
+            put_se(hdr, qp - 26);
+            put_bits(hdr, 1, 0);
+        }
+        put_ue(hdr, nb_starts - 1);
+        if (nb_starts > 1) {
+            put_ue(hdr, offset_len - 1);
+            for (j = 0; j < nb_starts - 1; j++)
+                put_bits(hdr, offset_len, starts[j + 1] - starts[j] - 1);
+        }
+        put_trailing_bits(hdr);
+
+        write_nal_header(19);       // IDR_W_RADL
+        write_escaped(stdout, hdr->buf,  hdr->bit_count  >> 3, NULL, 0);
+        write_escaped(stdout, data->buf, data->bit_count >> 3, NULL, 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t hdr_buf[4096], data_buf[BUF_SIZE];
+    BitWriter hdr  = { hdr_buf };
+    BitWriter data = { data_buf };
+    int cols[3] = { WC / 4, WC / 4, WC - 2 * (WC / 4) };
+    int rows[2] = { HC / 2, HC - HC / 2 };
+    int tile_start[7], slices[3][3];
+    int f, ts, t = 0;
+
+    if (argc != 2) {
+        printf("usage: %s file.hevc\n"
+               "generate a test HEVC stream with tiles and dependent slice segments\n",
+               argv[0]);
+        return 1;
+    }
+
+    err_if(!freopen(argv[1], "wb", stdout));
+
+    tile_layout(cols, 3, rows, 2);
+    for (ts = 0; ts < NB_CTB; ts++)
+        if (!ts || tile_of[ts_to_rs[ts]] != tile_of[ts_to_rs[ts - 1]])
+            tile_start[t++] = ts;
+    tile_start[t] = NB_CTB;
+
+    /* an independent segment ending inside the second tile, then two
+     * dependent segments starting inside the second and fourth tiles */
+    slices[0][0] = 0;
+    slices[0][1] = slices[1][0] = (tile_start[1] + tile_start[2]) / 2;
+    slices[1][1] = slices[2][0] = (tile_start[3] + tile_start[4]) / 2;
+    slices[2][1] = NB_CTB;
+    slices[0][2] = 0;
+    slices[1][2] = slices[2][2] = 1;
+
+    write_vps(&hdr);
+    write_sps(&hdr);
+    write_pps(&hdr, cols, 3, rows, 2);
+    for (f = 0; f < NB_FRAMES; f++)
+        write_picture(&hdr, &data, 30 + 3 * f, (const int (*)[3])slices, 3);
+
+    return 0;
+}